@@ -160,4 +160,5 @@ BufferType* BufferCollection::GetBufferPtr(BufferCollectionKey_t name)
 
 #define PIXEL_INDICES   "PixelIndices"
 #define DEPTH_IMAGES    "DepthImages"
+#define CLASS_IMAGES    "ClassImages"
 #define OFFSET_SCALES   "OffsetScales"
\ No newline at end of file
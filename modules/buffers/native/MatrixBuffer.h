@@ -35,6 +35,7 @@ public:
     void Incr(int m, int n, T value);
 
     const T* GetRowPtrUnsafe(int m) const;
+    T* GetRowPtrUnsafe(int m);
     void SetRow(int m, const VectorBufferTemplate<T>& row);
 
     T GetMax() const;
@@ -213,6 +214,12 @@ const T* MatrixBufferTemplate<T>::GetRowPtrUnsafe(int m) const
     return &mData[m*mN];
 }
 
+template <class T>
+T* MatrixBufferTemplate<T>::GetRowPtrUnsafe(int m)
+{
+    return &mData[m*mN];
+}
+
 template <class T>
 void MatrixBufferTemplate<T>::SetRow(int m, const VectorBufferTemplate<T>& row)
 {
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "BufferCollection.h"
+
+#if USE_BOOST_THREAD
+#include <boost/thread.hpp>
+#endif
+
+//Using #define for compatibility with swig
+#define NODE_HISTOGRAMS     "NodeHistograms"
+#define PARENT_HISTOGRAMS   "ParentHistograms"
+
+// ----------------------------------------------------------------------------
+//
+// NodeHistograms holds the per bin ys and sample counts that a histogram
+// split step built for each data dimension of one node.  The step writes them
+// to the node collection as a boost::shared_ptr<NodeHistograms> under
+// NODE_HISTOGRAMS so the tree learner can hand them to the children.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class NodeHistograms
+{
+public:
+    NodeHistograms()
+    : mYs()
+    , mCounts()
+    {}
+
+    void Set(IntType dimension, const std::vector<FloatType>& ys, const std::vector<IntType>& counts)
+    {
+        mYs[dimension] = ys;
+        mCounts[dimension] = counts;
+    }
+
+    bool Has(IntType dimension) const
+    {
+        return mCounts.find(dimension) != mCounts.end();
+    }
+
+    void GetDimensions(std::vector<IntType>& dimensions) const
+    {
+        dimensions.clear();
+        for(typename std::map< IntType, std::vector<IntType> >::const_iterator it = mCounts.begin(); it != mCounts.end(); ++it)
+        {
+            dimensions.push_back(it->first);
+        }
+    }
+
+    const std::vector<FloatType>& GetYs(IntType dimension) const
+    {
+        return mYs.find(dimension)->second;
+    }
+
+    const std::vector<IntType>& GetCounts(IntType dimension) const
+    {
+        return mCounts.find(dimension)->second;
+    }
+
+private:
+    std::map< IntType, std::vector<FloatType> > mYs;
+    std::map< IntType, std::vector<IntType> > mCounts;
+};
+
+// ----------------------------------------------------------------------------
+//
+// SiblingHistograms is shared by the two children of a split.  It keeps the
+// histograms of the parent and of whichever child is processed first so the
+// histograms of the other child can be derived as parent minus sibling
+// instead of being built from its samples.  The tree learners add it to both
+// children's indices collections under PARENT_HISTOGRAMS and process the
+// smaller child first so the larger child is the one that is derived.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class SiblingHistograms
+{
+public:
+    SiblingHistograms(const boost::shared_ptr< NodeHistograms<FloatType, IntType> >& parent)
+    : mParent(parent)
+    , mFirstChild()
+#if USE_BOOST_THREAD
+    , mMutex()
+#endif
+    {}
+
+    // Returns false if the parent or the sibling has no histogram for the
+    // dimension (the features were drawn per node) or if the sibling has not
+    // been processed yet
+    bool Subtract(IntType dimension, std::vector<FloatType>& ys, std::vector<IntType>& counts) const
+    {
+        boost::shared_ptr< NodeHistograms<FloatType, IntType> > sibling = GetFirstChild();
+        if( !sibling || !mParent->Has(dimension) || !sibling->Has(dimension) )
+        {
+            return false;
+        }
+
+        const std::vector<FloatType>& parentYs = mParent->GetYs(dimension);
+        const std::vector<FloatType>& siblingYs = sibling->GetYs(dimension);
+        ys.resize(parentYs.size());
+        for(size_t i=0; i<parentYs.size(); i++)
+        {
+            // Clamp rounding errors so empty bins stay empty
+            const FloatType y = parentYs[i] - siblingYs[i];
+            ys[i] = (y > FloatType(0)) ? y : FloatType(0);
+        }
+
+        const std::vector<IntType>& parentCounts = mParent->GetCounts(dimension);
+        const std::vector<IntType>& siblingCounts = sibling->GetCounts(dimension);
+        counts.resize(parentCounts.size());
+        for(size_t i=0; i<parentCounts.size(); i++)
+        {
+            counts[i] = parentCounts[i] - siblingCounts[i];
+        }
+        return true;
+    }
+
+    const NodeHistograms<FloatType, IntType>& GetParent() const
+    {
+        return *mParent;
+    }
+
+    bool HasFirstChild() const
+    {
+        return GetFirstChild().get() != NULL;
+    }
+
+    // Only the first child to finish is kept
+    void SetFirstChild(const boost::shared_ptr< NodeHistograms<FloatType, IntType> >& child)
+    {
+#if USE_BOOST_THREAD
+        boost::mutex::scoped_lock lock(mMutex);
+#endif
+        if( !mFirstChild )
+        {
+            mFirstChild = child;
+        }
+    }
+
+private:
+    boost::shared_ptr< NodeHistograms<FloatType, IntType> > GetFirstChild() const
+    {
+#if USE_BOOST_THREAD
+        boost::mutex::scoped_lock lock(mMutex);
+#endif
+        return mFirstChild;
+    }
+
+    const boost::shared_ptr< NodeHistograms<FloatType, IntType> > mParent;
+    boost::shared_ptr< NodeHistograms<FloatType, IntType> > mFirstChild;
+#if USE_BOOST_THREAD
+    mutable boost::mutex mMutex;
+#endif
+};
+
+// Called by the tree learners after a split.  Returns true if the node wrote
+// histograms and they were passed to the children.
+template <class FloatType, class IntType>
+bool InheritNodeHistograms( const BufferCollection& nodeData,
+                            BufferCollection& leftIndices,
+                            BufferCollection& rightIndices )
+{
+    typedef boost::shared_ptr< NodeHistograms<FloatType, IntType> > NodeHistogramsPtr;
+    if( !nodeData.HasBuffer<NodeHistogramsPtr>(NODE_HISTOGRAMS) )
+    {
+        return false;
+    }
+    boost::shared_ptr< SiblingHistograms<FloatType, IntType> > siblings(
+                    new SiblingHistograms<FloatType, IntType>(nodeData.GetBuffer<NodeHistogramsPtr>(NODE_HISTOGRAMS)) );
+    leftIndices.AddBuffer(PARENT_HISTOGRAMS, siblings);
+    rightIndices.AddBuffer(PARENT_HISTOGRAMS, siblings);
+    return true;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "asserts.h"
+#include "BufferCollection.h"
+
+//Using #define for compatibility with swig
+#define PRESORTED_INDICES   "PresortedIndices"
+
+// ----------------------------------------------------------------------------
+//
+// PresortedIndices holds, for every data dimension, the positions of a node's
+// samples (positions into its indices buffer) in increasing order of their
+// value.  A presorted split step writes it to the node collection as a
+// boost::shared_ptr<PresortedIndices> under PRESORTED_INDICES and after a
+// split the tree learner partitions it into the children (see
+// InheritPresortedIndices) so the sort order is kept without sorting again.
+//
+// ----------------------------------------------------------------------------
+template <class IntType>
+class PresortedIndices
+{
+public:
+    PresortedIndices( const BufferCollectionKey_t& indicesBufferId,
+                      const VectorBufferTemplate<IntType>& indices,
+                      const MatrixBufferTemplate<IntType>& sortedPositions )
+    : mIndicesBufferId(indicesBufferId)
+    , mIndices(indices)
+    , mSortedPositions(sortedPositions)
+    {}
+
+    const BufferCollectionKey_t& GetIndicesBufferId() const
+    {
+        return mIndicesBufferId;
+    }
+
+    // Row d is the sorted positions for dimension d
+    const MatrixBufferTemplate<IntType>& GetSortedPositions() const
+    {
+        return mSortedPositions;
+    }
+
+    // Stable partition of the sorted positions into a child that owns
+    // permutation[begin, end), a subsequence of this node's indices (as
+    // written by SplitSelectorInfo::PartitionIndices)
+    boost::shared_ptr< PresortedIndices<IntType> > Partition(const std::vector<IntType>& permutation,
+                                                             IntType begin, IntType end) const
+    {
+        // Equal indices have equal values so they always go to the same child
+        // and greedily matching the subsequence maps every position
+        const IntType numberOfSamples = mIndices.GetN();
+        const IntType numberOfChildSamples = end - begin;
+        std::vector<IntType> childPositions(numberOfSamples, -1);
+        VectorBufferTemplate<IntType> childIndices(numberOfChildSamples);
+        IntType childPosition = 0;
+        for(IntType i=0; i<numberOfSamples && childPosition<numberOfChildSamples; i++)
+        {
+            if( mIndices.Get(i) == permutation[begin + childPosition] )
+            {
+                childIndices.Set(childPosition, mIndices.Get(i));
+                childPositions[i] = childPosition++;
+            }
+        }
+        ASSERT_ARG_DIM_1D(childPosition, numberOfChildSamples)
+
+        const IntType numberOfDimensions = mSortedPositions.GetM();
+        MatrixBufferTemplate<IntType> childSortedPositions(numberOfDimensions, numberOfChildSamples);
+        for(IntType d=0; d<numberOfDimensions; d++)
+        {
+            IntType sortedIndex = 0;
+            for(IntType s=0; s<numberOfSamples; s++)
+            {
+                const IntType position = childPositions[mSortedPositions.Get(d, s)];
+                if( position >= 0 )
+                {
+                    childSortedPositions.Set(d, sortedIndex++, position);
+                }
+            }
+        }
+        return boost::shared_ptr< PresortedIndices<IntType> >(
+                    new PresortedIndices<IntType>(mIndicesBufferId, childIndices, childSortedPositions));
+    }
+
+private:
+    const BufferCollectionKey_t mIndicesBufferId;
+    const VectorBufferTemplate<IntType> mIndices;
+    const MatrixBufferTemplate<IntType> mSortedPositions;
+};
+
+// Called by the tree learners after a split with the children's ranges of
+// the tree's permutation.  Returns true if the node wrote presorted indices
+// and they were partitioned into the children.
+template <class IntType>
+bool InheritPresortedIndices( const BufferCollection& nodeData,
+                              const std::vector<IntType>& permutation,
+                              IntType begin, IntType split, IntType end,
+                              BufferCollection& leftIndices,
+                              BufferCollection& rightIndices )
+{
+    typedef boost::shared_ptr< PresortedIndices<IntType> > PresortedIndicesPtr;
+    if( !nodeData.HasBuffer<PresortedIndicesPtr>(PRESORTED_INDICES) )
+    {
+        return false;
+    }
+    const PresortedIndices<IntType>& presortedIndices = *nodeData.GetBuffer<PresortedIndicesPtr>(PRESORTED_INDICES);
+    leftIndices.AddBuffer(PRESORTED_INDICES, presortedIndices.Partition(permutation, begin, split));
+    rightIndices.AddBuffer(PRESORTED_INDICES, presortedIndices.Partition(permutation, split, end));
+    return true;
+}
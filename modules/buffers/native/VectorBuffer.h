@@ -292,7 +292,7 @@ bool VectorBufferTemplate<T>::operator==(VectorBufferTemplate<T> const& other) c
         return false;
     }
 
-    return std::equal(mData.begin(), mData.end(), other.mData.begin());
+    return std::equal(mData.begin(), mData.begin() + mN, other.mData.begin());
 }
 
 template <class T>
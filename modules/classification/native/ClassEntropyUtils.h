@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cmath> 
+#include <vector>
+
+#include <boost/cstdint.hpp>
 
 #include "VectorBuffer.h"
 #include "MatrixBuffer.h"
@@ -10,8 +13,10 @@
 #include "UniqueBufferId.h"
 
 template <class FloatType>
-FloatType calcDiscreteEntropy(FloatType totalCounts, VectorBufferTemplate<FloatType> classHistogram, VectorBufferTemplate<FloatType> logClassHistogram)
-{;
+FloatType calcDiscreteEntropy(FloatType totalCounts,
+                              const VectorBufferTemplate<FloatType>& classHistogram,
+                              const VectorBufferTemplate<FloatType>& logClassHistogram)
+{
     const FloatType inverseTotalCounts = 1.0f / totalCounts;
     const FloatType logTotalCounts = log2(totalCounts);
 
@@ -23,4 +28,57 @@ FloatType calcDiscreteEntropy(FloatType totalCounts, VectorBufferTemplate<FloatT
     }
 
     return entropy;
-}
\ No newline at end of file
+}
+
+// ----------------------------------------------------------------------------
+//
+// n*log2(n) terms in fixed point.  The entropy of a histogram with total N is
+// (N*log2(N) - sum_c n_c*log2(n_c)) / N so walkers can keep running sums of
+// the terms.  Each term is rounded to a multiple of 2^-NLOGN_FIXED_POINT_BITS
+// so the running sums are exact and only depend on the current histogram, not
+// on the order samples were moved in.
+//
+// ----------------------------------------------------------------------------
+enum { NLOGN_FIXED_POINT_BITS = 20 };
+
+typedef boost::int64_t FixedPointNLogN;
+
+inline double NLogNFixedPointScale()
+{
+    return double(boost::int64_t(1) << NLOGN_FIXED_POINT_BITS);
+}
+
+inline FixedPointNLogN ToFixedPointNLogN(double n)
+{
+    return (n > 0.0) ? FixedPointNLogN(std::floor(n * log2(n) * NLogNFixedPointScale() + 0.5)) : FixedPointNLogN(0);
+}
+
+inline double FromFixedPointNLogN(FixedPointNLogN nLogN)
+{
+    return double(nLogN) / NLogNFixedPointScale();
+}
+
+// table[n] is n*log2(n) for the integers 0..size-1
+inline void BuildNLogNTable(int size, std::vector<FixedPointNLogN>& table)
+{
+    table.resize(size);
+    for(int n=0; n<size; n++)
+    {
+        table[n] = ToFixedPointNLogN(double(n));
+    }
+}
+
+// Integer counts (from integer bootstrap weights) are looked up
+template <class FloatType>
+FixedPointNLogN LookupNLogN(const std::vector<FixedPointNLogN>& table, FloatType n)
+{
+    if( n >= FloatType(0) && n < FloatType(table.size()) )
+    {
+        const size_t i = static_cast<size_t>(n);
+        if( FloatType(i) == n )
+        {
+            return table[i];
+        }
+    }
+    return ToFixedPointNLogN(double(n));
+}
@@ -17,6 +17,11 @@
 // This class is called from BestSplitpointsWalkingSortedStep where
 // MoveLeftToRight is called for the sorted feature values
 //
+// The child totals and the sums of n*log2(n) over the classes of each child
+// are updated as samples move so Impurity is O(1) and does not allocate.
+// When the weights are integers (bootstrap counts) the n*log2(n) terms are
+// looked up in a table built by Bind.
+//
 // ----------------------------------------------------------------------------
 template <class FloatType, class IntType>
 class ClassInfoGainWalker
@@ -32,6 +37,11 @@ public:
 
     void MoveLeftToRight(IntType sampleIndex);
 
+    // Used by BestSplitpointsHistogramStep to accumulate samples into a
+    // histogram of GetYDim() class weights per bin and to move whole bins
+    void AddToYsHistogram(IntType sampleIndex, FloatType* ysHistogram) const;
+    void MoveYsHistogramLeftToRight(const FloatType* ysHistogram);
+
     FloatType Impurity();
 
     IntType GetYDim() const;
@@ -44,6 +54,9 @@ public:
     typedef IntType Int;
 
 private:
+    void MoveClassLeftToRight(IntType classIndex, FloatType weight);
+    FixedPointNLogN NLogN(FloatType n) const;
+
     const BufferId mSampleWeightsBufferId;
     const BufferId mClassesBufferId;
     const int mNumberOfClasses;
@@ -55,12 +68,18 @@ private:
     VectorBufferTemplate<FloatType> mLeftClassHistogram;
     VectorBufferTemplate<FloatType> mRightClassHistogram;
 
-    VectorBufferTemplate<FloatType> mLeftLogClassHistogram;
-    VectorBufferTemplate<FloatType> mRightLogClassHistogram;
+    FloatType mAllCounts;
+    FloatType mLeftCounts;
+    FloatType mRightCounts;
+
+    FixedPointNLogN mAllNLogN;
+    FixedPointNLogN mLeftNLogN;
+    FixedPointNLogN mRightNLogN;
 
-    FloatType mStartEntropy;
+    // N*log2(N) - sum_c n_c*log2(n_c) of all samples, N times the entropy
+    FixedPointNLogN mStartEntropy;
 
-    std::vector<bool> mRecomputeClassLog;
+    std::vector<FixedPointNLogN> mNLogNTable;
 };
 
 
@@ -76,10 +95,14 @@ ClassInfoGainWalker<FloatType, IntType>::ClassInfoGainWalker(const BufferId& sam
 , mAllClassHistogram(numberOfClasses)
 , mLeftClassHistogram(numberOfClasses)
 , mRightClassHistogram(numberOfClasses)
-, mLeftLogClassHistogram(numberOfClasses)
-, mRightLogClassHistogram(numberOfClasses)
+, mAllCounts(0)
+, mLeftCounts(0)
+, mRightCounts(0)
+, mAllNLogN(0)
+, mLeftNLogN(0)
+, mRightNLogN(0)
 , mStartEntropy(0)
-, mRecomputeClassLog(numberOfClasses)
+, mNLogNTable()
 {}
 
 template <class FloatType, class IntType>
@@ -95,10 +118,31 @@ void ClassInfoGainWalker<FloatType, IntType>::Bind(const BufferCollectionStack&
     mClasses = readCollection.GetBufferPtr< VectorBufferTemplate<IntType> >(mClassesBufferId);
     ASSERT_ARG_DIM_1D(mSampleWeights->GetN(), mClasses->GetN())
 
+    mAllClassHistogram.Zero();
+    mAllCounts = FloatType(0);
+    bool integerWeights = true;
     for(int i=0; i<mSampleWeights->GetN(); i++)
     {
-        mAllClassHistogram.Incr(mClasses->Get(i), mSampleWeights->Get(i));
+        const FloatType weight = mSampleWeights->Get(i);
+        mAllClassHistogram.Incr(mClasses->Get(i), weight);
+        mAllCounts += weight;
+        integerWeights = integerWeights && (weight == std::floor(weight));
+    }
+
+    // Counts of an integer weighted walk are integers up to the total.  The
+    // table is skipped for large weights so it stays about the node's size.
+    mNLogNTable.clear();
+    if( integerWeights && mAllCounts <= FloatType(2 * mSampleWeights->GetN()) )
+    {
+        BuildNLogNTable(static_cast<int>(mAllCounts) + 1, mNLogNTable);
+    }
+
+    mAllNLogN = 0;
+    for(int c=0; c<mNumberOfClasses; c++)
+    {
+        mAllNLogN += NLogN(mAllClassHistogram.Get(c));
     }
+    mStartEntropy = NLogN(mAllCounts) - mAllNLogN;
 
     Reset();
 }
@@ -106,56 +150,69 @@ void ClassInfoGainWalker<FloatType, IntType>::Bind(const BufferCollectionStack&
 template <class FloatType, class IntType>
 void ClassInfoGainWalker<FloatType, IntType>::Reset()
 {
-    mLeftClassHistogram.Zero();
+    mLeftClassHistogram = mAllClassHistogram;
     mRightClassHistogram.Zero();
-    mLeftLogClassHistogram.Zero();
-    mRightLogClassHistogram.Zero();
-    mRecomputeClassLog.clear();
 
-    mLeftClassHistogram = mAllClassHistogram;
+    mLeftCounts = mAllCounts;
+    mRightCounts = FloatType(0);
 
-    for(int c=0; c<mNumberOfClasses; c++)
-    {
-        const FloatType logClass = mAllClassHistogram.Get(c) > 0.0f ? log2(mAllClassHistogram.Get(c)) : 0.0f;
-        mLeftLogClassHistogram.Set(c, logClass);
-        mStartEntropy = calcDiscreteEntropy<FloatType>(mLeftClassHistogram.Sum(), mLeftClassHistogram, mLeftLogClassHistogram);
-    }
+    mLeftNLogN = mAllNLogN;
+    mRightNLogN = 0;
 }
 
 template <class FloatType, class IntType>
 void ClassInfoGainWalker<FloatType, IntType>::MoveLeftToRight(IntType sampleIndex)
 {
-    const FloatType weight = mSampleWeights->Get(sampleIndex);
-    const IntType classIndex = mClasses->Get(sampleIndex);
-    mLeftClassHistogram.Incr(classIndex, -weight);
-    mRightClassHistogram.Incr(classIndex, weight);
-    mRecomputeClassLog[classIndex] = true;
+    MoveClassLeftToRight(mClasses->Get(sampleIndex), mSampleWeights->Get(sampleIndex));
 }
 
 template <class FloatType, class IntType>
-FloatType ClassInfoGainWalker<FloatType, IntType>::Impurity()
+void ClassInfoGainWalker<FloatType, IntType>::AddToYsHistogram(IntType sampleIndex, FloatType* ysHistogram) const
+{
+    ysHistogram[mClasses->Get(sampleIndex)] += mSampleWeights->Get(sampleIndex);
+}
+
+template <class FloatType, class IntType>
+void ClassInfoGainWalker<FloatType, IntType>::MoveYsHistogramLeftToRight(const FloatType* ysHistogram)
 {
     for(int c=0; c<mNumberOfClasses; c++)
     {
-        if(mRecomputeClassLog[c])
+        if(ysHistogram[c] != FloatType(0))
         {
-            const FloatType leftLogClass = mLeftClassHistogram.Get(c) > 0.0f ? log2(mLeftClassHistogram.Get(c)) : 0.0f;
-            mLeftLogClassHistogram.Set(c, leftLogClass);
-            const FloatType rightLogClass = mRightClassHistogram.Get(c) > 0.0f ? log2(mRightClassHistogram.Get(c)) : 0.0f;
-            mRightLogClassHistogram.Set(c, rightLogClass);
+            MoveClassLeftToRight(c, ysHistogram[c]);
         }
     }
+}
+
+template <class FloatType, class IntType>
+void ClassInfoGainWalker<FloatType, IntType>::MoveClassLeftToRight(IntType classIndex, FloatType weight)
+{
+    const FloatType left = mLeftClassHistogram.Get(classIndex);
+    const FloatType right = mRightClassHistogram.Get(classIndex);
+    mLeftClassHistogram.Set(classIndex, left - weight);
+    mRightClassHistogram.Set(classIndex, right + weight);
+    mLeftNLogN += NLogN(left - weight) - NLogN(left);
+    mRightNLogN += NLogN(right + weight) - NLogN(right);
+    mLeftCounts -= weight;
+    mRightCounts += weight;
+}
 
-    const FloatType leftWeight = mLeftClassHistogram.Sum();
-    const FloatType rightWeight = mRightClassHistogram.Sum();
-    const FloatType totalWeight = leftWeight + rightWeight;
+template <class FloatType, class IntType>
+FixedPointNLogN ClassInfoGainWalker<FloatType, IntType>::NLogN(FloatType n) const
+{
+    return LookupNLogN<FloatType>(mNLogNTable, n);
+}
 
-    const FloatType leftEntropy = calcDiscreteEntropy<FloatType>(leftWeight, mLeftClassHistogram, mLeftLogClassHistogram);
-    const FloatType rightEntropy = calcDiscreteEntropy<FloatType>(rightWeight, mRightClassHistogram, mRightLogClassHistogram);
+template <class FloatType, class IntType>
+FloatType ClassInfoGainWalker<FloatType, IntType>::Impurity()
+{
+    // Child counts times child entropy, so dividing by the total counts
+    // weights each child's entropy by its share
+    const FixedPointNLogN leftEntropy = NLogN(mLeftCounts) - mLeftNLogN;
+    const FixedPointNLogN rightEntropy = NLogN(mRightCounts) - mRightNLogN;
 
-    const FloatType infoGain = mStartEntropy
-                                  - ((leftWeight / totalWeight) * leftEntropy)
-                                  - ((rightWeight / totalWeight) * rightEntropy);
+    const FloatType infoGain = FloatType( FromFixedPointNLogN(mStartEntropy - leftEntropy - rightEntropy)
+                                          / double(mAllCounts) );
     return infoGain;
 }
 
@@ -180,11 +237,11 @@ VectorBufferTemplate<FloatType> ClassInfoGainWalker<FloatType, IntType>::GetRigh
 template <class FloatType, class IntType>
 FloatType ClassInfoGainWalker<FloatType, IntType>::GetLeftChildCounts() const
 {
-    return mLeftClassHistogram.Sum();
+    return mLeftCounts;
 }
 
 template <class FloatType, class IntType>
 FloatType ClassInfoGainWalker<FloatType, IntType>::GetRightChildCounts() const
 {
-    return mRightClassHistogram.Sum();
+    return mRightCounts;
 }
\ No newline at end of file
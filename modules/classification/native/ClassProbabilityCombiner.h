@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MatrixBuffer.h"
+#include "Tree.h"
 
 // ----------------------------------------------------------------------------
 //
@@ -14,6 +15,7 @@ public:
     ClassProbabilityCombiner(int numberOfClasses);
     void Reset();
     void Combine(int nodeId, const MatrixBufferTemplate<FloatType>& estimatorParameters);
+    void Combine(int nodeId, const Tree& tree);
     void WriteResult(int row, MatrixBufferTemplate<FloatType>& results);
     int GetResultDim() const;
 
@@ -48,6 +50,21 @@ void ClassProbabilityCombiner<FloatType>::Combine(int nodeId, const MatrixBuffer
     mNumberOfTrees += FloatType(1);
 }
 
+template <class FloatType>
+void ClassProbabilityCombiner<FloatType>::Combine(int nodeId, const Tree& tree)
+{
+    if( tree.HasTrainingData() )
+    {
+        Combine(nodeId, tree.mYs);
+    }
+    else
+    {
+        // Inference only tree exported with Tree::LEAF_YS_FLOAT
+        tree.mFloatLeafYs.AddYs(nodeId, mCombinedResults);
+        mNumberOfTrees += FloatType(1);
+    }
+}
+
 template <class FloatType>
 void ClassProbabilityCombiner<FloatType>::WriteResult(int row, MatrixBufferTemplate<FloatType>& results)
 {
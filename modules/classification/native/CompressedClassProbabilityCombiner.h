@@ -0,0 +1,147 @@
+#pragma once
+
+#include "asserts.h"
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tree.h"
+#include "Forest.h"
+#include "CompressedLeafYs.h"
+
+// Quantized leaf ys of an inference only tree for a quantized type
+template <class QuantizedType>
+struct TreeQuantizedLeafYs;
+
+template <>
+struct TreeQuantizedLeafYs<unsigned char>
+{
+    static const QuantizedLeafYs<unsigned char>& Get(const Tree& tree) { return tree.mQuantizedU8LeafYs; }
+};
+
+template <>
+struct TreeQuantizedLeafYs<unsigned short>
+{
+    static const QuantizedLeafYs<unsigned short>& Get(const Tree& tree) { return tree.mQuantizedU16LeafYs; }
+};
+
+// ----------------------------------------------------------------------------
+//
+// Average the probabilities of each class across trees reading the leaf
+// distributions from uint8/uint16 quantized leafs (see QuantizedLeafYs).  The
+// forest must be exported with Forest::ExportForInference and
+// Tree::LEAF_YS_QUANTIZED_U8 or Tree::LEAF_YS_QUANTIZED_U16.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class QuantizedType>
+class QuantizedClassProbabilityCombiner
+{
+public:
+    QuantizedClassProbabilityCombiner(const Forest& forest);
+    void Reset();
+    void Combine(int nodeId, const Tree& tree);
+    void WriteResult(int row, MatrixBufferTemplate<FloatType>& results);
+    int GetResultDim() const;
+
+private:
+    VectorBufferTemplate<FloatType> mCombinedResults;
+    FloatType mNumberOfTrees;
+};
+
+template <class FloatType, class QuantizedType>
+QuantizedClassProbabilityCombiner<FloatType, QuantizedType>::QuantizedClassProbabilityCombiner(const Forest& forest)
+: mCombinedResults(forest.GetYDim())
+, mNumberOfTrees(FloatType(0))
+{
+}
+
+template <class FloatType, class QuantizedType>
+void QuantizedClassProbabilityCombiner<FloatType, QuantizedType>::Reset()
+{
+    mCombinedResults.Zero();
+    mNumberOfTrees = FloatType(0);
+}
+
+template <class FloatType, class QuantizedType>
+void QuantizedClassProbabilityCombiner<FloatType, QuantizedType>::Combine(int nodeId, const Tree& tree)
+{
+    TreeQuantizedLeafYs<QuantizedType>::Get(tree).AddYs(nodeId, mCombinedResults);
+    mNumberOfTrees += FloatType(1);
+}
+
+template <class FloatType, class QuantizedType>
+void QuantizedClassProbabilityCombiner<FloatType, QuantizedType>::WriteResult(int row, MatrixBufferTemplate<FloatType>& results)
+{
+    ASSERT_ARG_DIM_1D(mCombinedResults.GetN(), results.GetN())
+    FloatType numberOfTreeInv = mNumberOfTrees > FloatType(0) ? FloatType(1) / mNumberOfTrees : FloatType(0);
+    for(int i=0; i<mCombinedResults.GetN(); i++)
+    {
+        results.Set(row, i, numberOfTreeInv * mCombinedResults.Get(i));
+    }
+}
+
+template <class FloatType, class QuantizedType>
+int QuantizedClassProbabilityCombiner<FloatType, QuantizedType>::GetResultDim() const
+{
+    return mCombinedResults.GetN();
+}
+
+// ----------------------------------------------------------------------------
+//
+// Average the probabilities of each class across trees reading the leaf
+// distributions from their k most probable classes (see TopKLeafYs).  Classes
+// outside the top k of a leaf contribute zero probability for that tree.  The
+// forest must be exported with Forest::ExportForInference and
+// Tree::LEAF_YS_TOP_K.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType>
+class TopKClassProbabilityCombiner
+{
+public:
+    TopKClassProbabilityCombiner(const Forest& forest);
+    void Reset();
+    void Combine(int nodeId, const Tree& tree);
+    void WriteResult(int row, MatrixBufferTemplate<FloatType>& results);
+    int GetResultDim() const;
+
+private:
+    VectorBufferTemplate<FloatType> mCombinedResults;
+    FloatType mNumberOfTrees;
+};
+
+template <class FloatType>
+TopKClassProbabilityCombiner<FloatType>::TopKClassProbabilityCombiner(const Forest& forest)
+: mCombinedResults(forest.GetYDim())
+, mNumberOfTrees(FloatType(0))
+{
+}
+
+template <class FloatType>
+void TopKClassProbabilityCombiner<FloatType>::Reset()
+{
+    mCombinedResults.Zero();
+    mNumberOfTrees = FloatType(0);
+}
+
+template <class FloatType>
+void TopKClassProbabilityCombiner<FloatType>::Combine(int nodeId, const Tree& tree)
+{
+    tree.mTopKLeafYs.AddYs(nodeId, mCombinedResults);
+    mNumberOfTrees += FloatType(1);
+}
+
+template <class FloatType>
+void TopKClassProbabilityCombiner<FloatType>::WriteResult(int row, MatrixBufferTemplate<FloatType>& results)
+{
+    ASSERT_ARG_DIM_1D(mCombinedResults.GetN(), results.GetN())
+    FloatType numberOfTreeInv = mNumberOfTrees > FloatType(0) ? FloatType(1) / mNumberOfTrees : FloatType(0);
+    for(int i=0; i<mCombinedResults.GetN(); i++)
+    {
+        results.Set(row, i, numberOfTreeInv * mCombinedResults.Get(i));
+    }
+}
+
+template <class FloatType>
+int TopKClassProbabilityCombiner<FloatType>::GetResultDim() const
+{
+    return mCombinedResults.GetN();
+}
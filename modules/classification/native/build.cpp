@@ -5,4 +5,5 @@
 #include "ClassInfoGainWalker.h"
 #include "ClassStatsUpdater.h"
 #include "ClassProbabilityCombiner.h"
+#include "CompressedClassProbabilityCombiner.h"
 #include "ClassProbabilityOfError.h"
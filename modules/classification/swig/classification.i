@@ -24,6 +24,9 @@
 %template(ClassEstimatorFinalizer_f32) ClassEstimatorFinalizer<float>;
 %template(ClassEstimatorUpdater_f32i32) ClassEstimatorUpdater<float, int>;
 %template(ClassProbabilityCombiner_f32) ClassProbabilityCombiner<float>;
+%template(QuantizedClassProbabilityCombiner_f32u8) QuantizedClassProbabilityCombiner<float, unsigned char>;
+%template(QuantizedClassProbabilityCombiner_f32u16) QuantizedClassProbabilityCombiner<float, unsigned short>;
+%template(TopKClassProbabilityCombiner_f32) TopKClassProbabilityCombiner<float>;
 %template(ClassStatsUpdater_f32i32) ClassStatsUpdater<float,int>;
 %template(ClassStatsUpdaterOneStreamStep_f32i32) SplitpointStatsStep< ClassStatsUpdater<float,int> >;
 %template(ClassStatsUpdaterTwoStreamStep_f32i32) TwoStreamSplitpointStatsStep< ClassStatsUpdater<float,int> >;
\ No newline at end of file
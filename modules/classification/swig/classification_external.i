@@ -8,12 +8,14 @@
     #include "ClassEstimatorFinalizer.h"
     #include "ClassEstimatorUpdater.h"
     #include "ClassProbabilityCombiner.h"
+    #include "CompressedClassProbabilityCombiner.h"
     #include "ClassStatsUpdater.h"
 %}
 
 %include <exception.i>
 %import(module="rftk.asserts") "asserts.i"
 %import(module="rftk.buffers") "buffers.i"
+%import(module="rftk.forest_data") "forest_data.i"
 %import(module="rftk.pipeline") "pipeline_external.i"
 %import(module="rftk.splitpoints") "splitpoints_external.i"
 
@@ -24,4 +26,5 @@
 %include "ClassEstimatorFinalizer.h"
 %include "ClassEstimatorUpdater.h"
 %include "ClassProbabilityCombiner.h"
+%include "CompressedClassProbabilityCombiner.h"
 %include "ClassStatsUpdater.h"
\ No newline at end of file
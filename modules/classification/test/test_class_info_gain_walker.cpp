@@ -7,6 +7,8 @@
 #include "ClassInfoGainWalker.h"
 #include "BestSplitpointsWalkingSortedStep.h"
 
+#include <boost/random.hpp>
+
 
 struct ClassInfoGainWalkerFixture {
     ClassInfoGainWalkerFixture()
@@ -94,6 +96,43 @@ BOOST_AUTO_TEST_CASE(test_ClassInfoGainWalker_Reset)
     BOOST_CHECK_CLOSE(classInfoGainWalker.Impurity(), 0.199, 1);
 }
 
+BOOST_AUTO_TEST_CASE(test_ClassInfoGainWalker_copy_after_moves)
+{
+    ClassInfoGainWalker<float, int> classInfoGainWalker(weights_key, classes_key, number_of_classes);
+    classInfoGainWalker.Bind(stack);
+    classInfoGainWalker.MoveLeftToRight(2);
+    classInfoGainWalker.MoveLeftToRight(5);
+
+    ClassInfoGainWalker<float, int> copiedWalker = classInfoGainWalker;
+    BOOST_CHECK_CLOSE(copiedWalker.Impurity(), 0.467, 1);
+
+    copiedWalker.MoveLeftToRight(7);
+    BOOST_CHECK_CLOSE(copiedWalker.Impurity(), 0.949, 1);
+    BOOST_CHECK_CLOSE(classInfoGainWalker.Impurity(), 0.467, 1);
+
+    copiedWalker.Reset();
+    BOOST_CHECK_CLOSE(copiedWalker.Impurity(), 0.0, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_ClassInfoGainWalker_fractional_weights)
+{
+    // Scaling every weight does not change the gain
+    float weights_data[] = {0.5,0.5,0.5,0.5,0.5,0.5,0.5,0.5};
+    collection.AddBuffer(weights_key, VectorBufferTemplate<float>(&weights_data[0], 8));
+
+    ClassInfoGainWalker<float, int> classInfoGainWalker(weights_key, classes_key, number_of_classes);
+    classInfoGainWalker.Bind(stack);
+    BOOST_CHECK_CLOSE(classInfoGainWalker.Impurity(), 0.0, 1);
+
+    classInfoGainWalker.MoveLeftToRight(2);
+    BOOST_CHECK_CLOSE(classInfoGainWalker.Impurity(), 0.199, 1);
+
+    classInfoGainWalker.MoveLeftToRight(5);
+    BOOST_CHECK_CLOSE(classInfoGainWalker.Impurity(), 0.467, 1);
+    BOOST_CHECK_CLOSE(classInfoGainWalker.GetLeftChildCounts(), 3.0, 0.001);
+    BOOST_CHECK_CLOSE(classInfoGainWalker.GetRightChildCounts(), 1.0, 0.001);
+}
+
 BOOST_AUTO_TEST_CASE(test_ClassInfoGainWalker_BestSplitpointsWalkingSortedStep_ProcessStep_FEATURES_BY_DATAPOINTS)
 {
     ClassInfoGainWalker<float, int> classInfoGainWalker(weights_key, classes_key, number_of_classes);
@@ -139,4 +178,53 @@ BOOST_AUTO_TEST_CASE(test_ClassInfoGainWalker_BestSplitpointsWalkingSortedStep_P
     BOOST_CHECK_CLOSE(right_ys.Get(1,0,2), 0.6, 0.001);
 }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_CASE(test_ClassInfoGainWalker_BestSplitpointsWalkingSortedStep_sort_jobs)
+{
+    // Enough samples for the features to be shared by the sort jobs
+    const int numberOfFeatures = 5;
+    const int numberOfSamples = BestSplitpointsWalkingSortedStep< ClassInfoGainWalker<float, int> >::MIN_SAMPLES_PER_SORT_JOB;
+    boost::mt19937 dataGen(0);
+    boost::uniform_real<> valueDist(-1.0, 1.0);
+    boost::uniform_int<> classDist(0, number_of_classes-1);
+    MatrixBufferTemplate<float> featureValues(numberOfFeatures, numberOfSamples);
+    VectorBufferTemplate<int> classes(numberOfSamples);
+    VectorBufferTemplate<float> weights(numberOfSamples);
+    for(int s=0; s<numberOfSamples; s++)
+    {
+        classes.Set(s, classDist(dataGen));
+        weights.Set(s, 1.0f);
+        for(int f=0; f<numberOfFeatures; f++)
+        {
+            // Features depend on the class so the best splits are distinct
+            featureValues.Set(f, s, static_cast<float>(valueDist(dataGen)) + 0.1f*f*classes.Get(s));
+        }
+    }
+    BufferCollection data;
+    data.AddBuffer(fm_key, featureValues);
+    data.AddBuffer(classes_key, classes);
+    data.AddBuffer(weights_key, weights);
+    BufferCollectionStack dataStack;
+    dataStack.Push(&data);
+
+    ClassInfoGainWalker<float, int> classInfoGainWalker(weights_key, classes_key, number_of_classes);
+    BestSplitpointsWalkingSortedStep< ClassInfoGainWalker<float, int> > bestsplits(classInfoGainWalker, fm_key, FEATURES_BY_DATAPOINTS);
+    BestSplitpointsWalkingSortedStep< ClassInfoGainWalker<float, int> > bestsplitsJobs(classInfoGainWalker, fm_key, FEATURES_BY_DATAPOINTS, 3);
+    boost::mt19937 gen(0);
+    BufferCollection expected;
+    bestsplits.ProcessStep(dataStack, expected, gen);
+    BufferCollection result;
+    bestsplitsJobs.ProcessStep(dataStack, result, gen);
+
+    BOOST_CHECK( result.GetBuffer< MatrixBufferTemplate<float> >(bestsplitsJobs.ImpurityBufferId)
+                  == expected.GetBuffer< MatrixBufferTemplate<float> >(bestsplits.ImpurityBufferId) );
+    BOOST_CHECK( result.GetBuffer< MatrixBufferTemplate<float> >(bestsplitsJobs.SplitpointBufferId)
+                  == expected.GetBuffer< MatrixBufferTemplate<float> >(bestsplits.SplitpointBufferId) );
+    BOOST_CHECK( result.GetBuffer< Tensor3BufferTemplate<float> >(bestsplitsJobs.ChildCountsBufferId)
+                  == expected.GetBuffer< Tensor3BufferTemplate<float> >(bestsplits.ChildCountsBufferId) );
+    BOOST_CHECK( result.GetBuffer< Tensor3BufferTemplate<float> >(bestsplitsJobs.LeftYsBufferId)
+                  == expected.GetBuffer< Tensor3BufferTemplate<float> >(bestsplits.LeftYsBufferId) );
+    BOOST_CHECK( result.GetBuffer< Tensor3BufferTemplate<float> >(bestsplitsJobs.RightYsBufferId)
+                  == expected.GetBuffer< Tensor3BufferTemplate<float> >(bestsplits.RightYsBufferId) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,123 @@
+#include <boost/test/unit_test.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tree.h"
+#include "Forest.h"
+#include "CompressedLeafYs.h"
+#include "CompressedClassProbabilityCombiner.h"
+
+struct CompressedLeafYsFixture {
+    CompressedLeafYsFixture()
+    : forest(1)
+    {
+        int path_data[] = {1, 2,
+                          -1, -1,
+                           3, 4,
+                          -1, -1,
+                          -1, -1,
+                          -1, -1};
+        Int32MatrixBuffer path(&path_data[0], 6, 2);
+        float ys_data[] = {0.4, 0.4, 0.2,
+                           0.1, 0.9, 0.0,
+                           0.5, 0.0, 0.5,
+                           0.25, 0.25, 0.5,
+                           1.0, 0.0, 0.0,
+                           0.3, 0.3, 0.4};
+        Float32MatrixBuffer ys(&ys_data[0], 6, 3);
+        forest.mTrees[0] = Tree(path, Int32MatrixBuffer(6, 1), Float32MatrixBuffer(6, 1),
+                                Int32VectorBuffer(6), Float32VectorBuffer(6), ys);
+    }
+
+    Forest forest;
+};
+
+BOOST_FIXTURE_TEST_SUITE( CompressedClassProbabilityCombinerTests, CompressedLeafYsFixture )
+
+BOOST_AUTO_TEST_CASE(test_QuantizedLeafYs)
+{
+    const Tree& tree = forest.mTrees[0];
+    QuantizedLeafYs<unsigned char> leafYs(tree.mPath, tree.mYs);
+
+    // Node 5 is not reachable so only nodes 1, 3 and 4 are stored
+    BOOST_CHECK_EQUAL(leafYs.GetNumberOfLeafs(), 3);
+    BOOST_CHECK_EQUAL(leafYs.GetYDim(), 3);
+    BOOST_CHECK_CLOSE(leafYs.GetY(1, 1), 0.9, 0.1);
+    BOOST_CHECK_CLOSE(leafYs.GetY(1, 0), 0.1, 2.0);
+    BOOST_CHECK_SMALL(leafYs.GetY(1, 2), 1e-6f);
+    BOOST_CHECK_CLOSE(leafYs.GetY(3, 2), 0.5, 0.1);
+    BOOST_CHECK_CLOSE(leafYs.GetY(3, 0), 0.25, 1.0);
+    BOOST_CHECK_CLOSE(leafYs.GetY(4, 0), 1.0, 0.1);
+
+    QuantizedLeafYs<unsigned short> leafYs16(tree.mPath, tree.mYs);
+    BOOST_CHECK_CLOSE(leafYs16.GetY(1, 0), 0.1, 0.01);
+    BOOST_CHECK_CLOSE(leafYs16.GetY(3, 0), 0.25, 0.01);
+
+    QuantizedLeafYs<unsigned char> restored(leafYs.GetLeafRows(), leafYs.GetQuantizedYs(), leafYs.GetScales());
+    BOOST_CHECK_EQUAL(restored.GetNumberOfLeafs(), 3);
+    BOOST_CHECK_EQUAL(restored.GetY(1, 1), leafYs.GetY(1, 1));
+    BOOST_CHECK_EQUAL(restored.GetY(3, 0), leafYs.GetY(3, 0));
+
+    Int32MatrixBuffer outOfRange = leafYs.GetQuantizedYs();
+    outOfRange.Set(0, 0, 256);
+    BOOST_CHECK_THROW(QuantizedLeafYs<unsigned char>(leafYs.GetLeafRows(), outOfRange, leafYs.GetScales()), std::out_of_range);
+    outOfRange.Set(0, 0, -1);
+    BOOST_CHECK_THROW(QuantizedLeafYs<unsigned short>(leafYs.GetLeafRows(), outOfRange, leafYs.GetScales()), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(test_TopKLeafYs)
+{
+    const Tree& tree = forest.mTrees[0];
+    TopKLeafYs leafYs(tree.mPath, tree.mYs, 1);
+
+    BOOST_CHECK_EQUAL(leafYs.GetNumberOfLeafs(), 3);
+    BOOST_CHECK_EQUAL(leafYs.GetK(), 1);
+    BOOST_CHECK_CLOSE(leafYs.GetY(1, 1), 0.9, 0.1);
+    BOOST_CHECK_EQUAL(leafYs.GetY(1, 0), 0.0f);
+    BOOST_CHECK_CLOSE(leafYs.GetY(3, 2), 0.5, 0.1);
+    BOOST_CHECK_EQUAL(leafYs.GetY(3, 0), 0.0f);
+
+    TopKLeafYs allLeafYs(tree.mPath, tree.mYs, 10);
+    BOOST_CHECK_EQUAL(allLeafYs.GetK(), 3);
+    BOOST_CHECK_CLOSE(allLeafYs.GetY(3, 0), 0.25, 0.1);
+
+    TopKLeafYs restored(leafYs.GetLeafRows(), leafYs.GetClasses(), leafYs.GetLeafYs(), leafYs.GetYDim());
+    BOOST_CHECK_EQUAL(restored.GetK(), 1);
+    BOOST_CHECK_EQUAL(restored.GetY(1, 1), leafYs.GetY(1, 1));
+    BOOST_CHECK_EQUAL(restored.GetY(3, 0), 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_QuantizedCombine)
+{
+    const Forest exported = forest.ExportForInference(Tree::LEAF_YS_QUANTIZED_U8);
+    QuantizedClassProbabilityCombiner<float, unsigned char> combiner(exported);
+    BOOST_CHECK_EQUAL(combiner.GetResultDim(), 3);
+    MatrixBufferTemplate<float> result(1,3);
+
+    combiner.Combine(1, exported.mTrees[0]);
+    combiner.Combine(4, exported.mTrees[0]);
+    combiner.WriteResult(0, result);
+    BOOST_CHECK_CLOSE(result.Get(0,0), 0.55, 1.0);
+    BOOST_CHECK_CLOSE(result.Get(0,1), 0.45, 1.0);
+    BOOST_CHECK_SMALL(result.Get(0,2), 1e-6f);
+
+    combiner.Reset();
+    combiner.WriteResult(0, result);
+    BOOST_CHECK_EQUAL(result.Get(0,0), 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_TopKCombine)
+{
+    const Forest exported = forest.ExportForInference(Tree::LEAF_YS_TOP_K, 1);
+    TopKClassProbabilityCombiner<float> combiner(exported);
+    MatrixBufferTemplate<float> result(1,3);
+
+    combiner.Combine(1, exported.mTrees[0]);
+    combiner.Combine(4, exported.mTrees[0]);
+    combiner.WriteResult(0, result);
+    BOOST_CHECK_CLOSE(result.Get(0,0), 0.5, 0.1);
+    BOOST_CHECK_CLOSE(result.Get(0,1), 0.45, 0.1);
+    BOOST_CHECK_SMALL(result.Get(0,2), 1e-6f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,202 @@
+#include <utility>
+#include <functional>
+
+#include "CompressedLeafYs.h"
+
+int MapLeafRows(const Int32MatrixBuffer& path, Int32VectorBuffer& leafRows)
+{
+    const int numberOfNodes = path.GetM();
+    leafRows.Resize(numberOfNodes);
+    leafRows.SetAll(NULL_CHILD);
+
+    // Only visit nodes that can be reached from the root
+    std::vector<int> isReachable(numberOfNodes, 0);
+    std::vector<int> nodesToVisit;
+    if( numberOfNodes > 0 )
+    {
+        nodesToVisit.push_back(0);
+    }
+    while( !nodesToVisit.empty() )
+    {
+        const int nodeId = nodesToVisit.back();
+        nodesToVisit.pop_back();
+        isReachable[nodeId] = 1;
+        for(int childDirection=0; childDirection<2; childDirection++)
+        {
+            const int childNodeId = path.Get(nodeId, childDirection);
+            if( childNodeId != NULL_CHILD )
+            {
+                nodesToVisit.push_back(childNodeId);
+            }
+        }
+    }
+
+    int numberOfLeafs = 0;
+    for(int nodeId=0; nodeId<numberOfNodes; nodeId++)
+    {
+        const bool isLeaf = (path.Get(nodeId, 0) == NULL_CHILD
+                             || path.Get(nodeId, 1) == NULL_CHILD);
+        if( isReachable[nodeId] && isLeaf )
+        {
+            leafRows.Set(nodeId, numberOfLeafs);
+            numberOfLeafs++;
+        }
+    }
+    return numberOfLeafs;
+}
+
+FloatLeafYs::FloatLeafYs()
+: mLeafRows(0)
+, mYs(0,0)
+{}
+
+FloatLeafYs::FloatLeafYs(const Int32MatrixBuffer& path, const Float32MatrixBuffer& ys)
+: mLeafRows(path.GetM())
+, mYs(0,0)
+{
+    ASSERT_ARG_DIM_1D(path.GetM(), ys.GetM())
+    const int numberOfLeafs = MapLeafRows(path, mLeafRows);
+    mYs.Resize(numberOfLeafs, ys.GetN());
+    for(int nodeId=0; nodeId<mLeafRows.GetN(); nodeId++)
+    {
+        const int row = mLeafRows.Get(nodeId);
+        if( row == NULL_CHILD )
+        {
+            continue;
+        }
+        for(int y=0; y<ys.GetN(); y++)
+        {
+            mYs.Set(row, y, ys.Get(nodeId, y));
+        }
+    }
+}
+
+FloatLeafYs::FloatLeafYs(const Int32VectorBuffer& leafRows, const Float32MatrixBuffer& leafYs)
+: mLeafRows(leafRows)
+, mYs(leafYs)
+{}
+
+int FloatLeafYs::GetNumberOfLeafs() const
+{
+    return mYs.GetM();
+}
+
+int FloatLeafYs::GetYDim() const
+{
+    return mYs.GetN();
+}
+
+float FloatLeafYs::GetY(int nodeId, int y) const
+{
+    const int row = mLeafRows.Get(nodeId);
+    ASSERT_VALID_RANGE(row, 0, mYs.GetM())
+    return mYs.Get(row, y);
+}
+
+Int32VectorBuffer FloatLeafYs::GetLeafRows() const
+{
+    return mLeafRows;
+}
+
+Float32MatrixBuffer FloatLeafYs::GetLeafYs() const
+{
+    return mYs;
+}
+
+TopKLeafYs::TopKLeafYs()
+: mLeafRows(0)
+, mClasses(0,0)
+, mYs(0,0)
+, mYDim(0)
+{}
+
+TopKLeafYs::TopKLeafYs(const Int32MatrixBuffer& path, const Float32MatrixBuffer& ys, int k)
+: mLeafRows(path.GetM())
+, mClasses(0,0)
+, mYs(0,0)
+, mYDim(ys.GetN())
+{
+    ASSERT_ARG_DIM_1D(path.GetM(), ys.GetM())
+    ASSERT(k > 0);
+    const int numberOfLeafs = MapLeafRows(path, mLeafRows);
+    const int numberOfEntries = std::min(k, mYDim);
+    mClasses.Resize(numberOfLeafs, numberOfEntries);
+    mYs.Resize(numberOfLeafs, numberOfEntries);
+
+    std::vector< std::pair<float, int> > sortedYs(mYDim);
+    for(int nodeId=0; nodeId<mLeafRows.GetN(); nodeId++)
+    {
+        const int row = mLeafRows.Get(nodeId);
+        if( row == NULL_CHILD )
+        {
+            continue;
+        }
+        for(int y=0; y<mYDim; y++)
+        {
+            sortedYs[y] = std::make_pair(ys.Get(nodeId, y), y);
+        }
+        std::partial_sort(sortedYs.begin(), sortedYs.begin() + numberOfEntries, sortedYs.end(),
+                          std::greater< std::pair<float, int> >());
+        for(int i=0; i<numberOfEntries; i++)
+        {
+            mYs.Set(row, i, sortedYs[i].first);
+            mClasses.Set(row, i, sortedYs[i].second);
+        }
+    }
+}
+
+TopKLeafYs::TopKLeafYs(const Int32VectorBuffer& leafRows,
+                       const Int32MatrixBuffer& classes,
+                       const Float32MatrixBuffer& leafYs,
+                       int yDim)
+: mLeafRows(leafRows)
+, mClasses(classes)
+, mYs(leafYs)
+, mYDim(yDim)
+{
+    ASSERT_ARG_DIM_2D(mClasses.GetM(), mClasses.GetN(), mYs.GetM(), mYs.GetN())
+}
+
+int TopKLeafYs::GetNumberOfLeafs() const
+{
+    return mYs.GetM();
+}
+
+int TopKLeafYs::GetYDim() const
+{
+    return mYDim;
+}
+
+int TopKLeafYs::GetK() const
+{
+    return mYs.GetN();
+}
+
+float TopKLeafYs::GetY(int nodeId, int y) const
+{
+    const int row = mLeafRows.Get(nodeId);
+    ASSERT_VALID_RANGE(row, 0, mYs.GetM())
+    for(int i=0; i<mYs.GetN(); i++)
+    {
+        if( mClasses.Get(row, i) == y )
+        {
+            return mYs.Get(row, i);
+        }
+    }
+    return 0.0f;
+}
+
+Int32VectorBuffer TopKLeafYs::GetLeafRows() const
+{
+    return mLeafRows;
+}
+
+Int32MatrixBuffer TopKLeafYs::GetClasses() const
+{
+    return mClasses;
+}
+
+Float32MatrixBuffer TopKLeafYs::GetLeafYs() const
+{
+    return mYs;
+}
\ No newline at end of file
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include <asserts.h>
+#include <VectorBuffer.h>
+#include <MatrixBuffer.h>
+
+const int NULL_CHILD = -1;
+
+// Map each node of a tree (given by its path) to a row of leaf estimators.
+// Nodes that are not reachable leafs are mapped to NULL_CHILD.  Returns the
+// number of leafs.
+int MapLeafRows(const Int32MatrixBuffer& path, Int32VectorBuffer& leafRows);
+
+// ----------------------------------------------------------------------------
+//
+// Leaf class distributions of a tree in full precision.  Only reachable leafs
+// are kept so internal nodes do not cost any storage.  Inference only trees
+// keep them (see Tree::ExportForInference).
+//
+// ----------------------------------------------------------------------------
+class FloatLeafYs
+{
+public:
+    FloatLeafYs();
+    FloatLeafYs(const Int32MatrixBuffer& path, const Float32MatrixBuffer& ys);
+    // Restore from the buffers returned by the getters (used by pickling)
+    FloatLeafYs(const Int32VectorBuffer& leafRows, const Float32MatrixBuffer& leafYs);
+
+    int GetNumberOfLeafs() const;
+    int GetYDim() const;
+    float GetY(int nodeId, int y) const;
+
+    Int32VectorBuffer GetLeafRows() const;
+    Float32MatrixBuffer GetLeafYs() const;
+
+    template <class FloatType>
+    void AddYs(int nodeId, VectorBufferTemplate<FloatType>& ys) const;
+
+private:
+    Int32VectorBuffer mLeafRows;
+    Float32MatrixBuffer mYs;
+};
+
+template <class FloatType>
+void FloatLeafYs::AddYs(int nodeId, VectorBufferTemplate<FloatType>& ys) const
+{
+    ASSERT_ARG_DIM_1D(mYs.GetN(), ys.GetN())
+    const int row = mLeafRows.Get(nodeId);
+    ASSERT_VALID_RANGE(row, 0, mYs.GetM())
+    const float* leafYs = mYs.GetRowPtrUnsafe(row);
+    for(int y=0; y<ys.GetN(); y++)
+    {
+        ys.Incr(y, static_cast<FloatType>(leafYs[y]));
+    }
+}
+
+// ----------------------------------------------------------------------------
+//
+// Leaf class distributions of a tree quantized to an unsigned integer type
+// (uint8 or uint16) with one scale per leaf.  Only reachable leafs are kept
+// so internal nodes do not cost any storage.  Inference only trees keep them
+// (see Tree::ExportForInference).
+//
+// ----------------------------------------------------------------------------
+template <class QuantizedType>
+class QuantizedLeafYs
+{
+public:
+    QuantizedLeafYs();
+    // Quantize the per node ys of a tree
+    QuantizedLeafYs(const Int32MatrixBuffer& path, const Float32MatrixBuffer& ys);
+    // Restore from the buffers returned by the getters (used by pickling)
+    QuantizedLeafYs(const Int32VectorBuffer& leafRows,
+                    const Int32MatrixBuffer& quantizedYs,
+                    const Float32VectorBuffer& scales);
+
+    int GetNumberOfLeafs() const;
+    int GetYDim() const;
+    float GetY(int nodeId, int y) const;
+
+    Int32VectorBuffer GetLeafRows() const;
+    Int32MatrixBuffer GetQuantizedYs() const;
+    Float32VectorBuffer GetScales() const;
+
+    template <class FloatType>
+    void AddYs(int nodeId, VectorBufferTemplate<FloatType>& ys) const;
+
+private:
+    Int32VectorBuffer mLeafRows;
+    MatrixBufferTemplate<QuantizedType> mYs;
+    Float32VectorBuffer mScales;
+};
+
+template <class QuantizedType>
+QuantizedLeafYs<QuantizedType>::QuantizedLeafYs()
+: mLeafRows(0)
+, mYs(0,0)
+, mScales(0)
+{}
+
+template <class QuantizedType>
+QuantizedLeafYs<QuantizedType>::QuantizedLeafYs(const Int32MatrixBuffer& path, const Float32MatrixBuffer& ys)
+: mLeafRows(path.GetM())
+, mYs(0,0)
+, mScales(0)
+{
+    ASSERT_ARG_DIM_1D(path.GetM(), ys.GetM())
+    const int numberOfLeafs = MapLeafRows(path, mLeafRows);
+    const int yDim = ys.GetN();
+    mYs.Resize(numberOfLeafs, yDim);
+    mScales.Resize(numberOfLeafs);
+
+    const float maxQuantized = static_cast<float>(std::numeric_limits<QuantizedType>::max());
+    for(int nodeId=0; nodeId<mLeafRows.GetN() && yDim > 0; nodeId++)
+    {
+        const int row = mLeafRows.Get(nodeId);
+        if( row == NULL_CHILD )
+        {
+            continue;
+        }
+        const float* nodeYs = ys.GetRowPtrUnsafe(nodeId);
+        const float maxY = *std::max_element(nodeYs, nodeYs + yDim);
+        const float scale = (maxY > 0.0f) ? maxY / maxQuantized : 0.0f;
+        mScales.Set(row, scale);
+        for(int y=0; y<yDim && scale > 0.0f; y++)
+        {
+            const float quantized = std::min(std::floor(nodeYs[y] / scale + 0.5f), maxQuantized);
+            mYs.Set(row, y, static_cast<QuantizedType>(std::max(quantized, 0.0f)));
+        }
+    }
+}
+
+template <class QuantizedType>
+QuantizedLeafYs<QuantizedType>::QuantizedLeafYs(const Int32VectorBuffer& leafRows,
+                                                const Int32MatrixBuffer& quantizedYs,
+                                                const Float32VectorBuffer& scales)
+: mLeafRows(leafRows)
+, mYs(quantizedYs.GetM(), quantizedYs.GetN())
+, mScales(scales)
+{
+    ASSERT_ARG_DIM_1D(mYs.GetM(), mScales.GetN())
+    const int maxQuantized = static_cast<int>(std::numeric_limits<QuantizedType>::max());
+    for(int row=0; row<mYs.GetM(); row++)
+    {
+        for(int y=0; y<mYs.GetN(); y++)
+        {
+            // Checked in all builds so bad pickled data does not wrap silently
+            const int quantized = quantizedYs.Get(row, y);
+            if( quantized < 0 || quantized > maxQuantized )
+            {
+                std::stringstream ss;
+                ss << "QuantizedLeafYs: quantized y " << quantized << " at row " << row
+                   << " is not in the range [0, " << maxQuantized << "] of the quantized type";
+                throw std::out_of_range(ss.str());
+            }
+            mYs.Set(row, y, static_cast<QuantizedType>(quantized));
+        }
+    }
+}
+
+template <class QuantizedType>
+int QuantizedLeafYs<QuantizedType>::GetNumberOfLeafs() const
+{
+    return mYs.GetM();
+}
+
+template <class QuantizedType>
+int QuantizedLeafYs<QuantizedType>::GetYDim() const
+{
+    return mYs.GetN();
+}
+
+template <class QuantizedType>
+float QuantizedLeafYs<QuantizedType>::GetY(int nodeId, int y) const
+{
+    const int row = mLeafRows.Get(nodeId);
+    ASSERT_VALID_RANGE(row, 0, mYs.GetM())
+    return mScales.Get(row) * static_cast<float>(mYs.Get(row, y));
+}
+
+template <class QuantizedType>
+Int32VectorBuffer QuantizedLeafYs<QuantizedType>::GetLeafRows() const
+{
+    return mLeafRows;
+}
+
+template <class QuantizedType>
+Int32MatrixBuffer QuantizedLeafYs<QuantizedType>::GetQuantizedYs() const
+{
+    Int32MatrixBuffer quantizedYs(mYs.GetM(), mYs.GetN());
+    for(int row=0; row<mYs.GetM(); row++)
+    {
+        for(int y=0; y<mYs.GetN(); y++)
+        {
+            quantizedYs.Set(row, y, static_cast<int>(mYs.Get(row, y)));
+        }
+    }
+    return quantizedYs;
+}
+
+template <class QuantizedType>
+Float32VectorBuffer QuantizedLeafYs<QuantizedType>::GetScales() const
+{
+    return mScales;
+}
+
+template <class QuantizedType>
+template <class FloatType>
+void QuantizedLeafYs<QuantizedType>::AddYs(int nodeId, VectorBufferTemplate<FloatType>& ys) const
+{
+    ASSERT_ARG_DIM_1D(mYs.GetN(), ys.GetN())
+    const int row = mLeafRows.Get(nodeId);
+    ASSERT_VALID_RANGE(row, 0, mYs.GetM())
+    const QuantizedType* quantizedYs = mYs.GetRowPtrUnsafe(row);
+    const FloatType scale = static_cast<FloatType>(mScales.Get(row));
+    for(int y=0; y<ys.GetN(); y++)
+    {
+        ys.Incr(y, scale * static_cast<FloatType>(quantizedYs[y]));
+    }
+}
+
+// ----------------------------------------------------------------------------
+//
+// Leaf class distributions of a tree reduced to the k most probable classes
+// of each leaf.  Only reachable leafs are kept.
+//
+// ----------------------------------------------------------------------------
+class TopKLeafYs
+{
+public:
+    TopKLeafYs();
+    TopKLeafYs(const Int32MatrixBuffer& path, const Float32MatrixBuffer& ys, int k);
+    // Restore from the buffers returned by the getters (used by pickling)
+    TopKLeafYs(const Int32VectorBuffer& leafRows,
+               const Int32MatrixBuffer& classes,
+               const Float32MatrixBuffer& leafYs,
+               int yDim);
+
+    int GetNumberOfLeafs() const;
+    int GetYDim() const;
+    int GetK() const;
+    float GetY(int nodeId, int y) const;
+
+    Int32VectorBuffer GetLeafRows() const;
+    Int32MatrixBuffer GetClasses() const;
+    Float32MatrixBuffer GetLeafYs() const;
+
+    template <class FloatType>
+    void AddYs(int nodeId, VectorBufferTemplate<FloatType>& ys) const;
+
+private:
+    Int32VectorBuffer mLeafRows;
+    Int32MatrixBuffer mClasses;
+    Float32MatrixBuffer mYs;
+    int mYDim;
+};
+
+template <class FloatType>
+void TopKLeafYs::AddYs(int nodeId, VectorBufferTemplate<FloatType>& ys) const
+{
+    ASSERT_ARG_DIM_1D(mYDim, ys.GetN())
+    const int row = mLeafRows.Get(nodeId);
+    ASSERT_VALID_RANGE(row, 0, mYs.GetM())
+    const int* classes = mClasses.GetRowPtrUnsafe(row);
+    const float* leafYs = mYs.GetRowPtrUnsafe(row);
+    for(int i=0; i<mYs.GetN(); i++)
+    {
+        ys.Incr(classes[i], static_cast<FloatType>(leafYs[i]));
+    }
+}
@@ -37,11 +37,16 @@ int Forest::GetNumberOfTrees() const
 }
 
 
-Tree Forest::GetTree(const int index) const
+const Tree& Forest::GetTree(const int index) const
 {
     return mTrees[index];
 }
 
+int Forest::GetYDim() const
+{
+    return mTrees.empty() ? 0 : mTrees.front().GetYDim();
+}
+
 ForestStats Forest::GetForestStats() const
 {
     ForestStats stats;
@@ -58,4 +63,14 @@ ForestStats Forest::GetTreeStats(const int tree) const
     ForestStats stats;
     mTrees[tree].GatherStats(stats);
     return stats;
+}
+
+Forest Forest::ExportForInference(int leafYsFormat, int k) const
+{
+    Forest exported(mTrees.size());
+    for(unsigned int i=0; i<mTrees.size(); i++)
+    {
+        exported.mTrees[i] = mTrees[i].ExportForInference(leafYsFormat, k);
+    }
+    return exported;
 }
\ No newline at end of file
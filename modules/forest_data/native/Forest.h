@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 #include "Tree.h"
 
@@ -17,9 +18,16 @@ public:
             int maxYsDim );
 
     int GetNumberOfTrees() const;
-    Tree GetTree(const int index) const;
+    const Tree& GetTree(const int index) const;
+    // Dimension of the leaf ys of the trees (the number of classes)
+    int GetYDim() const;
     ForestStats GetForestStats() const;
     ForestStats GetTreeStats(const int tree) const;
+    Forest ExportForInference(int leafYsFormat=Tree::LEAF_YS_FLOAT, int k=0) const;
 
     std::vector<Tree> mTrees;
-};
\ No newline at end of file
+};
+
+// A learned forest is immutable and can be very large so it is shared by
+// reference counting between learners and predictors instead of copied
+typedef boost::shared_ptr<const Forest> ForestHandle;
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <limits>
+#include <algorithm>
 
 #include <asserts.h>
 #include "Tree.h"
@@ -66,6 +67,10 @@ Tree::Tree()
 , mCounts(0)
 , mDepths(0)
 , mYs(0,0)
+, mFloatLeafYs()
+, mQuantizedU8LeafYs()
+, mQuantizedU16LeafYs()
+, mTopKLeafYs()
 , mLastNodeIndex(0)
 , mValid(false)
 {}
@@ -82,6 +87,10 @@ Tree::Tree( const Int32MatrixBuffer& path,
 , mCounts(counts)
 , mDepths(depths)
 , mYs(ys)
+, mFloatLeafYs()
+, mQuantizedU8LeafYs()
+, mQuantizedU16LeafYs()
+, mTopKLeafYs()
 , mLastNodeIndex(mPath.GetM())
 , mValid(true)
 {
@@ -92,6 +101,52 @@ Tree::Tree( const Int32MatrixBuffer& path,
     ASSERT_ARG_DIM_1D(mPath.GetM(), mYs.GetM())
 }
 
+// Inference only tree without leaf ys (see ExportForInference)
+Tree::Tree( const Int32MatrixBuffer& path,
+            const Int32MatrixBuffer& intFeatureParams,
+            const Float32MatrixBuffer& floatFeatureParams )
+: mPath(path)
+, mIntFeatureParams(intFeatureParams)
+, mFloatFeatureParams(floatFeatureParams)
+, mCounts(0)
+, mDepths(0)
+, mYs(0,0)
+, mFloatLeafYs()
+, mQuantizedU8LeafYs()
+, mQuantizedU16LeafYs()
+, mTopKLeafYs()
+, mLastNodeIndex(mPath.GetM())
+, mValid(true)
+{
+    ASSERT_ARG_DIM_1D(mPath.GetM(), mIntFeatureParams.GetM())
+    ASSERT_ARG_DIM_1D(mPath.GetM(), mFloatFeatureParams.GetM())
+}
+
+// Inference only tree with leaf ys (see ExportForInference)
+Tree::Tree( const Int32MatrixBuffer& path,
+            const Int32MatrixBuffer& intFeatureParams,
+            const Float32MatrixBuffer& floatFeatureParams,
+            const FloatLeafYs& floatLeafYs,
+            const QuantizedLeafYs<unsigned char>& quantizedU8LeafYs,
+            const QuantizedLeafYs<unsigned short>& quantizedU16LeafYs,
+            const TopKLeafYs& topKLeafYs )
+: mPath(path)
+, mIntFeatureParams(intFeatureParams)
+, mFloatFeatureParams(floatFeatureParams)
+, mCounts(0)
+, mDepths(0)
+, mYs(0,0)
+, mFloatLeafYs(floatLeafYs)
+, mQuantizedU8LeafYs(quantizedU8LeafYs)
+, mQuantizedU16LeafYs(quantizedU16LeafYs)
+, mTopKLeafYs(topKLeafYs)
+, mLastNodeIndex(mPath.GetM())
+, mValid(true)
+{
+    ASSERT_ARG_DIM_1D(mPath.GetM(), mIntFeatureParams.GetM())
+    ASSERT_ARG_DIM_1D(mPath.GetM(), mFloatFeatureParams.GetM())
+}
+
 Tree::Tree( int initalNumberNodes, int maxIntParamsDim, int maxFloatParamsDim, int maxYsDim  )
 : mPath(initalNumberNodes, 2, NULL_CHILD)
 , mIntFeatureParams(initalNumberNodes, maxIntParamsDim)
@@ -99,6 +154,10 @@ Tree::Tree( int initalNumberNodes, int maxIntParamsDim, int maxFloatParamsDim, i
 , mCounts(initalNumberNodes)
 , mDepths(initalNumberNodes)
 , mYs(initalNumberNodes, maxYsDim)
+, mFloatLeafYs()
+, mQuantizedU8LeafYs()
+, mQuantizedU16LeafYs()
+, mTopKLeafYs()
 , mLastNodeIndex(1)
 , mValid(true)
 {
@@ -144,10 +203,87 @@ int Tree::NextNodeIndex()
 
 void Tree::Compact()
 {
+    const bool hasTrainingData = HasTrainingData();
     mPath.Resize(mLastNodeIndex, 2, NULL_CHILD);
     mIntFeatureParams.Resize(mLastNodeIndex, mIntFeatureParams.GetN());
     mFloatFeatureParams.Resize(mLastNodeIndex, mFloatFeatureParams.GetN());
-    mCounts.Resize(mLastNodeIndex);
-    mDepths.Resize(mLastNodeIndex);
-    mYs.Resize(mLastNodeIndex, mYs.GetN());
-}
\ No newline at end of file
+    if( hasTrainingData )
+    {
+        mCounts.Resize(mLastNodeIndex);
+        mDepths.Resize(mLastNodeIndex);
+        mYs.Resize(mLastNodeIndex, mYs.GetN());
+    }
+}
+
+Tree Tree::Compacted() const
+{
+    Tree compacted(*this);
+    compacted.Compact();
+    return compacted;
+}
+
+bool Tree::HasTrainingData() const
+{
+    return mYs.GetM() == mPath.GetM();
+}
+
+int Tree::GetYDim() const
+{
+    if( HasTrainingData() )
+    {
+        return mYs.GetN();
+    }
+    // Only the leaf ys of the exported format are filled
+    return std::max( std::max(mFloatLeafYs.GetYDim(), mQuantizedU8LeafYs.GetYDim()),
+                     std::max(mQuantizedU16LeafYs.GetYDim(), mTopKLeafYs.GetYDim()) );
+}
+
+// ----------------------------------------------------------------------------
+//
+// Copy of the tree with only what is needed to walk it.  The per node counts,
+// depths and ys are dropped and the buffers are sized to the used nodes.  The
+// ys of the reachable leafs are kept in the requested format: full precision
+// (LEAF_YS_FLOAT), quantized (LEAF_YS_QUANTIZED_U8/U16) or the k most
+// probable classes (LEAF_YS_TOP_K).
+//
+// ----------------------------------------------------------------------------
+Tree Tree::ExportForInference(int leafYsFormat, int k) const
+{
+    ASSERT(HasTrainingData());
+    Int32VectorBuffer usedNodes(mLastNodeIndex);
+    for(int nodeId=0; nodeId<mLastNodeIndex; nodeId++)
+    {
+        usedNodes.Set(nodeId, nodeId);
+    }
+    const Int32MatrixBuffer path = mPath.Slice(usedNodes);
+    const Float32MatrixBuffer ys = mYs.Slice(usedNodes);
+
+    FloatLeafYs floatLeafYs;
+    QuantizedLeafYs<unsigned char> quantizedU8LeafYs;
+    QuantizedLeafYs<unsigned short> quantizedU16LeafYs;
+    TopKLeafYs topKLeafYs;
+    switch( leafYsFormat )
+    {
+        case LEAF_YS_FLOAT:
+            floatLeafYs = FloatLeafYs(path, ys);
+            break;
+        case LEAF_YS_QUANTIZED_U8:
+            quantizedU8LeafYs = QuantizedLeafYs<unsigned char>(path, ys);
+            break;
+        case LEAF_YS_QUANTIZED_U16:
+            quantizedU16LeafYs = QuantizedLeafYs<unsigned short>(path, ys);
+            break;
+        case LEAF_YS_TOP_K:
+            topKLeafYs = TopKLeafYs(path, ys, k);
+            break;
+        default:
+            ASSERT(false);
+    }
+    return Tree(path,
+                mIntFeatureParams.Slice(usedNodes),
+                mFloatFeatureParams.Slice(usedNodes),
+                floatLeafYs,
+                quantizedU8LeafYs,
+                quantizedU16LeafYs,
+                topKLeafYs);
+}
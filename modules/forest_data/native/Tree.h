@@ -3,7 +3,7 @@
 #include <VectorBuffer.h>
 #include <MatrixBuffer.h>
 
-const int NULL_CHILD = -1;
+#include "CompressedLeafYs.h"
 
 class ForestStats;
 
@@ -17,10 +17,37 @@ public:
             const Int32VectorBuffer& depths,
             const Float32VectorBuffer& counts,
             const Float32MatrixBuffer& ys );
+    Tree(   const Int32MatrixBuffer& path,
+            const Int32MatrixBuffer& intFeatureParams,
+            const Float32MatrixBuffer& floatFeatureParams );
+    Tree(   const Int32MatrixBuffer& path,
+            const Int32MatrixBuffer& intFeatureParams,
+            const Float32MatrixBuffer& floatFeatureParams,
+            const FloatLeafYs& floatLeafYs,
+            const QuantizedLeafYs<unsigned char>& quantizedU8LeafYs,
+            const QuantizedLeafYs<unsigned short>& quantizedU16LeafYs,
+            const TopKLeafYs& topKLeafYs );
     Tree( int initalNumberNodes, int maxIntParamsDim, int maxFloatParamsDim, int maxYsDim );
     void GatherStats(ForestStats& stats) const;
+    // Resizes the buffers when full so callers learning a tree with several
+    // jobs must serialize calls with all other writes to the tree
     int NextNodeIndex();
     void Compact();
+    // Compacted copy for trees that are shared (see ForestHandle)
+    Tree Compacted() const;
+    bool HasTrainingData() const;
+    // Dimension of the per node ys or of the leaf ys of inference only trees
+    int GetYDim() const;
+    Tree ExportForInference(int leafYsFormat=LEAF_YS_FLOAT, int k=0) const;
+
+    // How the leaf ys of an inference only tree are stored
+    enum
+    {
+        LEAF_YS_FLOAT,
+        LEAF_YS_QUANTIZED_U8,
+        LEAF_YS_QUANTIZED_U16,
+        LEAF_YS_TOP_K
+    };
 
     Int32MatrixBuffer mPath;
     Int32MatrixBuffer mIntFeatureParams;
@@ -28,6 +55,11 @@ public:
     Float32VectorBuffer mCounts;
     Int32VectorBuffer mDepths;
     Float32MatrixBuffer mYs;
+    // Leaf ys of inference only trees, only the exported format is filled
+    FloatLeafYs mFloatLeafYs;
+    QuantizedLeafYs<unsigned char> mQuantizedU8LeafYs;
+    QuantizedLeafYs<unsigned short> mQuantizedU16LeafYs;
+    TopKLeafYs mTopKLeafYs;
 private:
     int mLastNodeIndex;
     bool mValid;
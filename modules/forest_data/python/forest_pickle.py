@@ -19,8 +19,7 @@ class PyTree(object):
 def as_pyforest(native_forest):
     pytrees = []
     for tree_id in range(native_forest.GetNumberOfTrees()):
-        native_tree = native_forest.GetTree(tree_id)
-        native_tree.Compact()
+        native_tree = native_forest.GetTree(tree_id).Compacted()
         pytree = PyTree()
         pytree.path = buffers.as_numpy_array(native_tree.mPath)
         pytree.int_features_params = buffers.as_numpy_array(native_tree.mIntFeatureParams)
@@ -1,6 +1,7 @@
 %module forest_data
 %{
     #define SWIG_FILE_WITH_INIT
+    #include "CompressedLeafYs.h"
     #include "Tree.h"
     #include "Forest.h"
 %}
@@ -10,31 +11,118 @@
 %import(module="rftk.buffers") "buffers.i"
 
 %include "std_vector.i"
+%include <boost_shared_ptr.i>
+
+%shared_ptr(Forest)
 
 namespace std {
     %template(TreesVector) std::vector<Tree>;
 }
 
 
+/* GetTree returns a reference into the forest, which a python Tree would
+   outlive once its Forest or ForestHandle is freed, so python gets a copy */
+%ignore Forest::GetTree;
+
+%include "CompressedLeafYs.h"
 %include "Tree.h"
 %include "Forest.h"
 
+%extend Forest {
+    Tree GetTree(const int index) const
+    {
+        return $self->GetTree(index);
+    }
+}
+
+%template(QuantizedLeafYs_u8) QuantizedLeafYs<unsigned char>;
+%template(QuantizedLeafYs_u16) QuantizedLeafYs<unsigned short>;
+
+/* Support pickling of compressed leaf ys */
+%define DECLARE_EXTEND_WRAPPER_FOR_QUANTIZED_LEAF_YS(class_name)
+%extend class_name {
+%insert("python") %{
+
+def __getstate__(self):
+    data_dict = {}
+    data_dict['mLeafRows'] = self.GetLeafRows()
+    data_dict['mYs'] = self.GetQuantizedYs()
+    data_dict['mScales'] = self.GetScales()
+    return data_dict
+
+def __setstate__(self,data_dict):
+    self.__init__(data_dict['mLeafRows'], data_dict['mYs'], data_dict['mScales'])
+%}
+}
+%enddef
+
+DECLARE_EXTEND_WRAPPER_FOR_QUANTIZED_LEAF_YS(QuantizedLeafYs<unsigned char>)
+DECLARE_EXTEND_WRAPPER_FOR_QUANTIZED_LEAF_YS(QuantizedLeafYs<unsigned short>)
+
+%extend FloatLeafYs {
+%insert("python") %{
+
+def __getstate__(self):
+    data_dict = {}
+    data_dict['mLeafRows'] = self.GetLeafRows()
+    data_dict['mYs'] = self.GetLeafYs()
+    return data_dict
+
+def __setstate__(self,data_dict):
+    self.__init__(data_dict['mLeafRows'], data_dict['mYs'])
+%}
+}
+
+%extend TopKLeafYs {
+%insert("python") %{
+
+def __getstate__(self):
+    data_dict = {}
+    data_dict['mLeafRows'] = self.GetLeafRows()
+    data_dict['mClasses'] = self.GetClasses()
+    data_dict['mYs'] = self.GetLeafYs()
+    data_dict['mYDim'] = self.GetYDim()
+    return data_dict
+
+def __setstate__(self,data_dict):
+    self.__init__(data_dict['mLeafRows'], data_dict['mClasses'], data_dict['mYs'], data_dict['mYDim'])
+%}
+}
+
 %extend Tree {
 %insert("python") %{
 
 def __getstate__(self):
-    self.Compact()
+    import rftk.buffers as buffers
+    # The tree may belong to a shared forest so a compacted copy is pickled.
+    # Its buffers are copied out because they are freed with the copy.
+    tree = self.Compacted()
     data_dict = {}
-    data_dict['mPath'] = self.mPath
-    data_dict['mIntFeatureParams'] = self.mIntFeatureParams
-    data_dict['mFloatFeatureParams'] = self.mFloatFeatureParams
-    data_dict['mDepths'] = self.mDepths
-    data_dict['mCounts'] = self.mCounts
-    data_dict['mYs'] = self.mYs
+    for name in ['mPath', 'mIntFeatureParams', 'mFloatFeatureParams', 'mDepths', 'mCounts', 'mYs']:
+        data_dict[name] = buffers.as_buffer(buffers.as_numpy_array(getattr(tree, name)))
+    if not tree.HasTrainingData():
+        # Inference only tree keeps its leaf ys per leaf in the exported format
+        for name in ['mFloatLeafYs', 'mQuantizedU8LeafYs', 'mQuantizedU16LeafYs', 'mTopKLeafYs']:
+            data_dict[name] = getattr(tree, name).__getstate__()
     return data_dict
 
 def __setstate__(self,data_dict):
-    self.__init__(data_dict['mPath'], data_dict['mIntFeatureParams'], data_dict['mFloatFeatureParams'], data_dict['mDepths'], data_dict['mCounts'], data_dict['mYs'])
+    if 'mTopKLeafYs' in data_dict:
+        # Inference only tree with leaf ys (see ExportForInference)
+        float_ys = data_dict['mFloatLeafYs']
+        u8 = data_dict['mQuantizedU8LeafYs']
+        u16 = data_dict['mQuantizedU16LeafYs']
+        top_k = data_dict['mTopKLeafYs']
+        self.__init__(data_dict['mPath'], data_dict['mIntFeatureParams'], data_dict['mFloatFeatureParams'],
+                      FloatLeafYs(float_ys['mLeafRows'], float_ys['mYs']),
+                      QuantizedLeafYs_u8(u8['mLeafRows'], u8['mYs'], u8['mScales']),
+                      QuantizedLeafYs_u16(u16['mLeafRows'], u16['mYs'], u16['mScales']),
+                      TopKLeafYs(top_k['mLeafRows'], top_k['mClasses'], top_k['mYs'], top_k['mYDim']))
+    elif data_dict['mYs'].GetM() != data_dict['mPath'].GetM():
+        # Inference only tree without leaf ys
+        self.__init__(data_dict['mPath'], data_dict['mIntFeatureParams'], data_dict['mFloatFeatureParams'])
+    else:
+        self.__init__(data_dict['mPath'], data_dict['mIntFeatureParams'], data_dict['mFloatFeatureParams'], data_dict['mDepths'], data_dict['mCounts'], data_dict['mYs'])
 %}
 }
 
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "asserts.h"
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "UniqueBufferId.h"
+#include "BoxDepthDeltaFeatureBinding.h"
+
+// ----------------------------------------------------------------------------
+//
+// BoxDepthDeltaFeature is the difference of the mean depths of a pair of
+// boxes.  The box means come from the integral images of
+// IntegralDepthImagesStep so each feature costs eight lookups regardless of
+// the size of the boxes.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class BoxDepthDeltaFeature
+{
+public:
+    BoxDepthDeltaFeature( const BufferId& floatParamsBufferId,
+                          const BufferId& intParamsBufferId,
+                          const BufferId& indicesBufferId,
+                          const BufferId& pixelIndicesBufferId,
+                          const BufferId& depthsDataBufferId,
+                          const BufferId& integralImagesBufferId,
+                          const BufferId& scalesBufferId );
+
+    BoxDepthDeltaFeature( const BufferId& floatParamsBufferId,
+                          const BufferId& intParamsBufferId,
+                          const BufferId& indicesBufferId,
+                          const BufferId& pixelIndicesBufferId,
+                          const BufferId& depthsDataBufferId,
+                          const BufferId& integralImagesBufferId );
+
+    BoxDepthDeltaFeature( const BufferId& indicesBufferId,
+                          const BufferId& pixelIndicesBufferId,
+                          const BufferId& depthsDataBufferId,
+                          const BufferId& integralImagesBufferId );
+
+    ~BoxDepthDeltaFeature();
+
+    BoxDepthDeltaFeatureBinding<FloatType, IntType> Bind(const BufferCollectionStack& readCollection) const;
+
+    typedef FloatType Float;
+    typedef IntType Int;
+    typedef BoxDepthDeltaFeatureBinding<FloatType, IntType> FeatureBinding;
+
+    const BufferId mFloatParamsBufferId;
+    const BufferId mIntParamsBufferId;
+    const BufferId mIndicesBufferId;
+    const BufferId mPixelIndicesBufferId;
+    const BufferId mScalesBufferId;
+    const BufferId mDepthsImgsBufferId;
+    const BufferId mIntegralImgsBufferId;
+};
+
+template <class FloatType, class IntType>
+BoxDepthDeltaFeature<FloatType, IntType>::BoxDepthDeltaFeature( const BufferId& floatParamsBufferId,
+                                                               const BufferId& intParamsBufferId,
+                                                               const BufferId& indicesBufferId,
+                                                               const BufferId& pixelIndicesBufferId,
+                                                               const BufferId& depthsDataBufferId,
+                                                               const BufferId& integralImagesBufferId,
+                                                               const BufferId& scalesBufferId )
+: mFloatParamsBufferId(floatParamsBufferId)
+, mIntParamsBufferId(intParamsBufferId)
+, mIndicesBufferId(indicesBufferId)
+, mPixelIndicesBufferId(pixelIndicesBufferId)
+, mScalesBufferId(scalesBufferId)
+, mDepthsImgsBufferId(depthsDataBufferId)
+, mIntegralImgsBufferId(integralImagesBufferId)
+{}
+
+template <class FloatType, class IntType>
+BoxDepthDeltaFeature<FloatType, IntType>::BoxDepthDeltaFeature( const BufferId& floatParamsBufferId,
+                                                               const BufferId& intParamsBufferId,
+                                                               const BufferId& indicesBufferId,
+                                                               const BufferId& pixelIndicesBufferId,
+                                                               const BufferId& depthsDataBufferId,
+                                                               const BufferId& integralImagesBufferId )
+: mFloatParamsBufferId(floatParamsBufferId)
+, mIntParamsBufferId(intParamsBufferId)
+, mIndicesBufferId(indicesBufferId)
+, mPixelIndicesBufferId(pixelIndicesBufferId)
+, mScalesBufferId(NullKey)
+, mDepthsImgsBufferId(depthsDataBufferId)
+, mIntegralImgsBufferId(integralImagesBufferId)
+{}
+
+template <class FloatType, class IntType>
+BoxDepthDeltaFeature<FloatType, IntType>::BoxDepthDeltaFeature( const BufferId& indicesBufferId,
+                                                               const BufferId& pixelIndicesBufferId,
+                                                               const BufferId& depthsDataBufferId,
+                                                               const BufferId& integralImagesBufferId )
+: mFloatParamsBufferId(GetBufferId("floatParams"))
+, mIntParamsBufferId(GetBufferId("intParams"))
+, mIndicesBufferId(indicesBufferId)
+, mPixelIndicesBufferId(pixelIndicesBufferId)
+, mScalesBufferId(NullKey)
+, mDepthsImgsBufferId(depthsDataBufferId)
+, mIntegralImgsBufferId(integralImagesBufferId)
+{}
+
+template <class FloatType, class IntType>
+BoxDepthDeltaFeature<FloatType, IntType>::~BoxDepthDeltaFeature()
+{}
+
+template <class FloatType, class IntType>
+BoxDepthDeltaFeatureBinding<FloatType, IntType> BoxDepthDeltaFeature<FloatType, IntType>::Bind(const BufferCollectionStack& readCollection) const
+{
+    MatrixBufferTemplate<FloatType> const* floatParams = readCollection.GetBufferPtr< MatrixBufferTemplate<FloatType> >(mFloatParamsBufferId);
+    MatrixBufferTemplate<IntType> const* intParams = readCollection.GetBufferPtr< MatrixBufferTemplate<IntType> >(mIntParamsBufferId);
+    VectorBufferTemplate<IntType> const* indices = readCollection.GetBufferPtr< VectorBufferTemplate<IntType> >(mIndicesBufferId);
+    MatrixBufferTemplate<IntType> const* pixelIndices = readCollection.GetBufferPtr< MatrixBufferTemplate<IntType> >(mPixelIndicesBufferId);
+    Tensor3BufferTemplate<FloatType> const* depthImgs = readCollection.GetBufferPtr< Tensor3BufferTemplate<FloatType> >(mDepthsImgsBufferId);
+    Tensor3BufferTemplate<double> const* integralImgs = readCollection.GetBufferPtr< Tensor3BufferTemplate<double> >(mIntegralImgsBufferId);
+
+    MatrixBufferTemplate<FloatType> const* scales = NULL;
+    if( mScalesBufferId != NullKey )
+    {
+        scales = readCollection.GetBufferPtr< MatrixBufferTemplate<FloatType> >(mScalesBufferId);
+    }
+
+    ASSERT_ARG_DIM_1D(floatParams->GetN(), intParams->GetN());
+    ASSERT_ARG_DIM_1D(floatParams->GetN(), BOX_PAIR_PARAMS_DIM);
+    ASSERT_ARG_DIM_1D(integralImgs->GetM(), depthImgs->GetM()+1);
+    ASSERT_ARG_DIM_1D(integralImgs->GetN(), depthImgs->GetN()+1);
+
+    return BoxDepthDeltaFeatureBinding<FloatType, IntType>(floatParams, intParams, indices, pixelIndices, depthImgs, integralImgs, scales);
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "asserts.h"
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "Constants.h"
+#include "ImageUtils.h"
+#include "BoxPairGaussianOffsetsStep.h"
+
+// ----------------------------------------------------------------------------
+//
+// BoxDepthDeltaFeature is the difference of the mean depths of a pair of
+// boxes specified by offsets and radii that are scaled by the depth of the
+// center pixel
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class BoxDepthDeltaFeatureBinding
+{
+public:
+    BoxDepthDeltaFeatureBinding( MatrixBufferTemplate<FloatType> const* floatParams,
+                                 MatrixBufferTemplate<IntType> const* intParams,
+                                 VectorBufferTemplate<IntType> const* indices,
+                                 MatrixBufferTemplate<IntType> const* pixelIndices,
+                                 Tensor3BufferTemplate<FloatType> const* depthImgs,
+                                 Tensor3BufferTemplate<double> const* integralImgs,
+                                 MatrixBufferTemplate<FloatType> const* scales);
+    BoxDepthDeltaFeatureBinding();
+    ~BoxDepthDeltaFeatureBinding();
+
+    BoxDepthDeltaFeatureBinding(const BoxDepthDeltaFeatureBinding& other);
+    BoxDepthDeltaFeatureBinding & operator=(const BoxDepthDeltaFeatureBinding & other);
+
+    FloatType FeatureValue( const int featureIndex, const int relativeSampleIndex) const;
+
+    IntType GetNumberOfFeatures() const;
+    IntType GetNumberOfDatapoints() const;
+
+private:
+    MatrixBufferTemplate<FloatType> const* mFloatParams;
+    MatrixBufferTemplate<IntType> const* mIntParams;
+    VectorBufferTemplate<IntType> const* mIndices;
+    MatrixBufferTemplate<IntType> const* mPixelIndices;
+    Tensor3BufferTemplate<FloatType> const* mDepthImgs;
+    Tensor3BufferTemplate<double> const* mIntegralImgs;
+    MatrixBufferTemplate<FloatType> const* mScales;
+};
+
+template <class FloatType, class IntType>
+BoxDepthDeltaFeatureBinding<FloatType, IntType>::BoxDepthDeltaFeatureBinding( MatrixBufferTemplate<FloatType> const* floatParams,
+                                                                             MatrixBufferTemplate<IntType> const* intParams,
+                                                                             VectorBufferTemplate<IntType> const* indices,
+                                                                             MatrixBufferTemplate<IntType> const* pixelIndices,
+                                                                             Tensor3BufferTemplate<FloatType> const* depthImgs,
+                                                                             Tensor3BufferTemplate<double> const* integralImgs,
+                                                                             MatrixBufferTemplate<FloatType> const* scales )
+: mFloatParams(floatParams)
+, mIntParams(intParams)
+, mIndices(indices)
+, mPixelIndices(pixelIndices)
+, mDepthImgs(depthImgs)
+, mIntegralImgs(integralImgs)
+, mScales(scales)
+{}
+
+template <class FloatType, class IntType>
+BoxDepthDeltaFeatureBinding<FloatType, IntType>::BoxDepthDeltaFeatureBinding()
+: mFloatParams(NULL)
+, mIntParams(NULL)
+, mIndices(NULL)
+, mPixelIndices(NULL)
+, mDepthImgs(NULL)
+, mIntegralImgs(NULL)
+, mScales(NULL)
+{}
+
+template <class FloatType, class IntType>
+BoxDepthDeltaFeatureBinding<FloatType, IntType>::BoxDepthDeltaFeatureBinding( const BoxDepthDeltaFeatureBinding& other )
+: mFloatParams(other.mFloatParams)
+, mIntParams(other.mIntParams)
+, mIndices(other.mIndices)
+, mPixelIndices(other.mPixelIndices)
+, mDepthImgs(other.mDepthImgs)
+, mIntegralImgs(other.mIntegralImgs)
+, mScales(other.mScales)
+{}
+
+template <class FloatType, class IntType>
+BoxDepthDeltaFeatureBinding<FloatType, IntType>& BoxDepthDeltaFeatureBinding<FloatType, IntType>::operator=(const BoxDepthDeltaFeatureBinding & other)
+{
+    mFloatParams = other.mFloatParams;
+    mIntParams = other.mIntParams;
+    mIndices = other.mIndices;
+    mPixelIndices = other.mPixelIndices;
+    mDepthImgs = other.mDepthImgs;
+    mIntegralImgs = other.mIntegralImgs;
+    mScales = other.mScales;
+    return *this;
+}
+
+template <class FloatType, class IntType>
+BoxDepthDeltaFeatureBinding<FloatType, IntType>::~BoxDepthDeltaFeatureBinding()
+{}
+
+
+template <class FloatType, class IntType>
+FloatType BoxDepthDeltaFeatureBinding<FloatType, IntType>::FeatureValue( const int featureIndex, const int relativeSampleIndex) const
+{
+    const IntType index = mIndices->Get(relativeSampleIndex);
+
+    const IntType imgIndex = mPixelIndices->Get(index, 0);
+    const IntType pixelM = mPixelIndices->Get(index, 1);
+    const IntType pixelN = mPixelIndices->Get(index, 2);
+
+    const FloatType scaleM = (mScales != NULL) ? mScales->Get(index, 0) : FloatType(1.0);
+    const FloatType scaleN = (mScales != NULL) ? mScales->Get(index, 1) : FloatType(1.0);
+    const FloatType scaleByDepth = FloatType(2.0) / mDepthImgs->Get(imgIndex, pixelM, pixelN);
+    const FloatType scaleByDepthM = scaleByDepth * scaleM;
+    const FloatType scaleByDepthN = scaleByDepth * scaleN;
+
+    const IntType uM = pixelM + IntType(scaleByDepthM * mFloatParams->Get(featureIndex, BOX_OFFSET_U_M_INDEX));
+    const IntType uN = pixelN + IntType(scaleByDepthN * mFloatParams->Get(featureIndex, BOX_OFFSET_U_N_INDEX));
+    const IntType vM = pixelM + IntType(scaleByDepthM * mFloatParams->Get(featureIndex, BOX_OFFSET_V_M_INDEX));
+    const IntType vN = pixelN + IntType(scaleByDepthN * mFloatParams->Get(featureIndex, BOX_OFFSET_V_N_INDEX));
+    const IntType uRadiusM = IntType(scaleByDepthM * mFloatParams->Get(featureIndex, BOX_RADIUS_U_M_INDEX));
+    const IntType uRadiusN = IntType(scaleByDepthN * mFloatParams->Get(featureIndex, BOX_RADIUS_U_N_INDEX));
+    const IntType vRadiusM = IntType(scaleByDepthM * mFloatParams->Get(featureIndex, BOX_RADIUS_V_M_INDEX));
+    const IntType vRadiusN = IntType(scaleByDepthN * mFloatParams->Get(featureIndex, BOX_RADIUS_V_N_INDEX));
+
+    const double meanU = BoxMeanDepth<IntType>(*mIntegralImgs, imgIndex, uM, uN, uRadiusM, uRadiusN);
+    const double meanV = BoxMeanDepth<IntType>(*mIntegralImgs, imgIndex, vM, vN, vRadiusM, vRadiusN);
+    return static_cast<FloatType>(meanU - meanV);
+}
+
+template <class FloatType, class IntType>
+IntType BoxDepthDeltaFeatureBinding<FloatType, IntType>::GetNumberOfFeatures() const
+{
+    return mIntParams->GetM();
+}
+
+template <class FloatType, class IntType>
+IntType BoxDepthDeltaFeatureBinding<FloatType, IntType>::GetNumberOfDatapoints() const
+{
+    return mIndices->GetN();
+}
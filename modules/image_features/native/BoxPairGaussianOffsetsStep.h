@@ -0,0 +1,154 @@
+#pragma once
+
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "Constants.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+
+const int BOX_OFFSET_U_M_INDEX = FEATURE_SPECIFIC_PARAMS_START;
+const int BOX_OFFSET_U_N_INDEX = FEATURE_SPECIFIC_PARAMS_START + 1;
+const int BOX_OFFSET_V_M_INDEX = FEATURE_SPECIFIC_PARAMS_START + 2;
+const int BOX_OFFSET_V_N_INDEX = FEATURE_SPECIFIC_PARAMS_START + 3;
+const int BOX_RADIUS_U_M_INDEX = FEATURE_SPECIFIC_PARAMS_START + 4;
+const int BOX_RADIUS_U_N_INDEX = FEATURE_SPECIFIC_PARAMS_START + 5;
+const int BOX_RADIUS_V_M_INDEX = FEATURE_SPECIFIC_PARAMS_START + 6;
+const int BOX_RADIUS_V_N_INDEX = FEATURE_SPECIFIC_PARAMS_START + 7;
+const int BOX_PAIR_PARAMS_DIM = FEATURE_SPECIFIC_PARAMS_START + 8;
+
+// ----------------------------------------------------------------------------
+//
+// BoxPairGaussianOffsetsStep constructs a float_params and int_params matrix
+// for BoxDepthDeltaFeature.  Each feature is a pair of boxes with gaussian
+// offsets (like PixelPairGaussianOffsetsStep) and radii drawn uniformly from
+// [0, maxRadius].  Offsets and radii are in the same units so they are both
+// scaled by depth when the feature is evaluated.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class BoxPairGaussianOffsetsStep: public PipelineStepI
+{
+public:
+    BoxPairGaussianOffsetsStep( const BufferId numberOfFeaturesBufferId,
+                                const FloatType ux,
+                                const FloatType uy,
+                                const FloatType vx,
+                                const FloatType vy,
+                                const FloatType maxRadius );
+    virtual ~BoxPairGaussianOffsetsStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    // Read only output buffers
+    const BufferId FloatParamsBufferId;
+    const BufferId IntParamsBufferId;
+private:
+    void SampleParams(IntType numberOfFeatures,
+                      MatrixBufferTemplate<FloatType>& floatParams,
+                      MatrixBufferTemplate<IntType>& intParams,
+                      boost::mt19937& gen ) const;
+
+    const BufferId mNumberOfFeaturesBufferId;
+    const FloatType mUx;
+    const FloatType mUy;
+    const FloatType mVx;
+    const FloatType mVy;
+    const FloatType mMaxRadius;
+};
+
+
+template <class FloatType, class IntType>
+BoxPairGaussianOffsetsStep<FloatType,IntType>::BoxPairGaussianOffsetsStep( const BufferId numberOfFeaturesBufferId,
+                                                                          const FloatType ux,
+                                                                          const FloatType uy,
+                                                                          const FloatType vx,
+                                                                          const FloatType vy,
+                                                                          const FloatType maxRadius )
+: FloatParamsBufferId(GetBufferId("FloatParams"))
+, IntParamsBufferId(GetBufferId("IntParams"))
+, mNumberOfFeaturesBufferId(numberOfFeaturesBufferId)
+, mUx(ux)
+, mUy(uy)
+, mVx(vx)
+, mVy(vy)
+, mMaxRadius(maxRadius)
+{
+    ASSERT(mMaxRadius >= FloatType(0));
+}
+
+template <class FloatType, class IntType>
+BoxPairGaussianOffsetsStep<FloatType,IntType>::~BoxPairGaussianOffsetsStep()
+{}
+
+template <class FloatType, class IntType>
+PipelineStepI* BoxPairGaussianOffsetsStep<FloatType,IntType>::Clone() const
+{
+    BoxPairGaussianOffsetsStep* clone = new BoxPairGaussianOffsetsStep<FloatType,IntType>(*this);
+    return clone;
+}
+
+template <class FloatType, class IntType>
+void BoxPairGaussianOffsetsStep<FloatType,IntType>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                               BufferCollection& writeCollection,
+                                                               boost::mt19937& gen) const
+{
+    if(!writeCollection.HasBuffer< MatrixBufferTemplate<FloatType> >(FloatParamsBufferId)
+        || !writeCollection.HasBuffer< MatrixBufferTemplate<IntType> >(IntParamsBufferId))
+    {
+        const VectorBufferTemplate<IntType>& numberOfFeaturesBuffer =
+                readCollection.GetBuffer< VectorBufferTemplate<IntType> >(mNumberOfFeaturesBufferId);
+        ASSERT_ARG_DIM_1D(numberOfFeaturesBuffer.GetN(), 1)
+        const IntType numberOfFeatures = numberOfFeaturesBuffer.Get(0);
+
+        MatrixBufferTemplate<FloatType>& floatParams =
+                writeCollection.GetOrAddBuffer< MatrixBufferTemplate<FloatType> >(FloatParamsBufferId);
+
+        MatrixBufferTemplate<IntType>& intParams =
+                writeCollection.GetOrAddBuffer< MatrixBufferTemplate<IntType> >(IntParamsBufferId);
+
+        SampleParams(numberOfFeatures, floatParams, intParams, gen);
+    }
+}
+
+template <class FloatType, class IntType>
+void BoxPairGaussianOffsetsStep<FloatType,IntType>::SampleParams(IntType numberOfFeatures,
+                                                                MatrixBufferTemplate<FloatType>& floatParams,
+                                                                MatrixBufferTemplate<IntType>& intParams,
+                                                                boost::mt19937& gen ) const
+{
+    floatParams.Resize(numberOfFeatures, BOX_PAIR_PARAMS_DIM);
+    intParams.Resize(numberOfFeatures, BOX_PAIR_PARAMS_DIM);
+
+    boost::normal_distribution<> ux_normal(0.0, mUx);
+    boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > var_ux_normal(gen, ux_normal);
+    boost::normal_distribution<> uy_normal(0.0, mUy);
+    boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > var_uy_normal(gen, uy_normal);
+    boost::normal_distribution<> vx_normal(0.0, mVx);
+    boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > var_vx_normal(gen, vx_normal);
+    boost::normal_distribution<> vy_normal(0.0, mVy);
+    boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > var_vy_normal(gen, vy_normal);
+    boost::uniform_real<> radius_uniform(0.0, mMaxRadius);
+    boost::variate_generator<boost::mt19937&, boost::uniform_real<> > var_radius_uniform(gen, radius_uniform);
+
+    for(int i=0; i<numberOfFeatures; i++)
+    {
+        floatParams.Set(i, BOX_OFFSET_U_M_INDEX, var_ux_normal());
+        floatParams.Set(i, BOX_OFFSET_U_N_INDEX, var_uy_normal());
+        floatParams.Set(i, BOX_OFFSET_V_M_INDEX, var_vx_normal());
+        floatParams.Set(i, BOX_OFFSET_V_N_INDEX, var_vy_normal());
+        floatParams.Set(i, BOX_RADIUS_U_M_INDEX, var_radius_uniform());
+        floatParams.Set(i, BOX_RADIUS_U_N_INDEX, var_radius_uniform());
+        floatParams.Set(i, BOX_RADIUS_V_M_INDEX, var_radius_uniform());
+        floatParams.Set(i, BOX_RADIUS_V_N_INDEX, var_radius_uniform());
+    }
+}
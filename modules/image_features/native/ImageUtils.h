@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstdlib>
+#include <algorithm>
+
 #include "Tensor3Buffer.h"
+#include "PaddedDepthImages.h"
+#include "TiledDepthImages.h"
 
 template <class IntType>
 void ClampPixel(const IntType maxM, const IntType maxN, IntType* m, IntType *n)
@@ -39,4 +44,146 @@ FloatType PixelDepthDelta(const Tensor3BufferTemplate<FloatType>& depths, const
 
     FloatType delta = depths.Get(imgId, mU, nU) - depths.Get(imgId, mV, nV);
     return delta;
-}
\ No newline at end of file
+}
+
+// ----------------------------------------------------------------------------
+//
+// PixelDepthDelta for padded depth images.  Probes that stay within the pad
+// read the padded image directly and only probes that leave the pad are
+// clamped.  The result is the same as PixelDepthDelta on the unpadded images.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+FloatType PixelDepthDelta(const PaddedDepthImagesTemplate<FloatType>& depths, const IntType imgId, const IntType pixelM, const IntType pixelN,
+                          const FloatType ux, const FloatType uy, const FloatType vx, const FloatType vy)
+{
+    const FloatType scaleByDepth = FloatType(2.0) / depths.Get(imgId, pixelM, pixelN);
+
+    IntType mU = pixelM + IntType(scaleByDepth * ux);
+    IntType nU = pixelN + IntType(scaleByDepth * uy);
+    IntType mV = pixelM + IntType(scaleByDepth * vx);
+    IntType nV = pixelN + IntType(scaleByDepth * vy);
+
+    const IntType pad = depths.GetPad();
+    const IntType maxDelta = std::max( std::max(std::abs(mU - pixelM), std::abs(nU - pixelN)),
+                                       std::max(std::abs(mV - pixelM), std::abs(nV - pixelN)) );
+    if( maxDelta > pad )
+    {
+        mU += pad; nU += pad; mV += pad; nV += pad;
+        ClampPixel<IntType>(depths.GetM() + 2*pad, depths.GetN() + 2*pad, &mU, &nU);
+        ClampPixel<IntType>(depths.GetM() + 2*pad, depths.GetN() + 2*pad, &mV, &nV);
+        mU -= pad; nU -= pad; mV -= pad; nV -= pad;
+    }
+
+    const FloatType* img = depths.GetOriginPtrUnsafe(imgId);
+    const IntType rowStride = depths.GetRowStride();
+    FloatType delta = img[mU*rowStride + nU] - img[mV*rowStride + nV];
+    return delta;
+}
+
+// ----------------------------------------------------------------------------
+//
+// PixelDepthDelta for tiled depth images
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+FloatType PixelDepthDelta(const TiledDepthImagesTemplate<FloatType>& depths, const IntType imgId, const IntType pixelM, const IntType pixelN,
+                          const FloatType ux, const FloatType uy, const FloatType vx, const FloatType vy)
+{
+    const FloatType scaleByDepth = FloatType(2.0) / depths.Get(imgId, pixelM, pixelN);
+
+    IntType mU = pixelM + IntType(scaleByDepth * ux);
+    IntType nU = pixelN + IntType(scaleByDepth * uy);
+    IntType mV = pixelM + IntType(scaleByDepth * vx);
+    IntType nV = pixelN + IntType(scaleByDepth * vy);
+
+    ClampPixel<IntType>(depths.GetM(), depths.GetN(), &mU, &nU);
+    ClampPixel<IntType>(depths.GetM(), depths.GetN(), &mV, &nV);
+
+    const FloatType* img = depths.GetImagePtrUnsafe(imgId);
+    FloatType delta = img[depths.GetPixelOffset(mU, nU)] - img[depths.GetPixelOffset(mV, nV)];
+    return delta;
+}
+
+// Raw access to the pixels of depth images for batched feature extraction.
+// Pixel (m,n) of image l is DepthImageOriginPtr(depths, l)[DepthImagePixelOffset(depths, m, n)]
+// for m in [-DepthImagePad(depths), M+DepthImagePad(depths)) and similarly for n.
+template <class FloatType>
+const FloatType* DepthImageOriginPtr(const Tensor3BufferTemplate<FloatType>& depths, const int imgId)
+{
+    return depths.GetRowPtrUnsafe(imgId, 0);
+}
+
+template <class FloatType>
+int DepthImagePixelOffset(const Tensor3BufferTemplate<FloatType>& depths, const int m, const int n)
+{
+    return m*depths.GetN() + n;
+}
+
+template <class FloatType>
+int DepthImagePad(const Tensor3BufferTemplate<FloatType>&)
+{
+    return 0;
+}
+
+template <class FloatType>
+const FloatType* DepthImageOriginPtr(const PaddedDepthImagesTemplate<FloatType>& depths, const int imgId)
+{
+    return depths.GetOriginPtrUnsafe(imgId);
+}
+
+template <class FloatType>
+int DepthImagePixelOffset(const PaddedDepthImagesTemplate<FloatType>& depths, const int m, const int n)
+{
+    return m*depths.GetRowStride() + n;
+}
+
+template <class FloatType>
+int DepthImagePad(const PaddedDepthImagesTemplate<FloatType>& depths)
+{
+    return depths.GetPad();
+}
+
+template <class FloatType>
+const FloatType* DepthImageOriginPtr(const TiledDepthImagesTemplate<FloatType>& depths, const int imgId)
+{
+    return depths.GetImagePtrUnsafe(imgId);
+}
+
+template <class FloatType>
+int DepthImagePixelOffset(const TiledDepthImagesTemplate<FloatType>& depths, const int m, const int n)
+{
+    return depths.GetPixelOffset(m, n);
+}
+
+template <class FloatType>
+int DepthImagePad(const TiledDepthImagesTemplate<FloatType>&)
+{
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Mean depth of the box [centerM-radiusM, centerM+radiusM] x
+// [centerN-radiusN, centerN+radiusN] from the integral images of
+// IntegralDepthImagesStep.  The center is clamped to the image and the box is
+// cropped to the image so it always contains at least one pixel.
+//
+// ----------------------------------------------------------------------------
+template <class IntType>
+double BoxMeanDepth(const Tensor3BufferTemplate<double>& integrals, const IntType imgId,
+                    IntType centerM, IntType centerN, const IntType radiusM, const IntType radiusN)
+{
+    const IntType maxM = integrals.GetM() - 1;
+    const IntType maxN = integrals.GetN() - 1;
+    ClampPixel<IntType>(maxM, maxN, &centerM, &centerN);
+
+    const IntType m0 = std::max(IntType(0), IntType(centerM - std::abs(radiusM)));
+    const IntType m1 = std::min(IntType(maxM - 1), IntType(centerM + std::abs(radiusM))) + 1;
+    const IntType n0 = std::max(IntType(0), IntType(centerN - std::abs(radiusN)));
+    const IntType n1 = std::min(IntType(maxN - 1), IntType(centerN + std::abs(radiusN))) + 1;
+
+    const double sum = integrals.GetUnsafe(imgId, m1, n1) - integrals.GetUnsafe(imgId, m0, n1)
+                     - integrals.GetUnsafe(imgId, m1, n0) + integrals.GetUnsafe(imgId, m0, n0);
+    return sum / static_cast<double>((m1 - m0) * (n1 - n0));
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "asserts.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+
+// ----------------------------------------------------------------------------
+//
+// IntegralDepthImagesStep computes the integral image of each depth image so
+// the sum of depths over any box can be computed from four lookups.  The
+// integral images are (M+1) x (N+1) with a leading row and column of zeros
+// and are accumulated in double precision.  They are only built once for
+// each write collection so learners run it as a forest step (see
+// ParallelForestLearner) and predictors as a pre step that runs once per
+// call (see TemplateForestPredictor).
+//
+// ----------------------------------------------------------------------------
+template <class FloatType>
+class IntegralDepthImagesStep: public PipelineStepI
+{
+public:
+    IntegralDepthImagesStep( const BufferId& depthImagesBufferId );
+    virtual ~IntegralDepthImagesStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    // Read only output buffer
+    const BufferId IntegralImagesBufferId;
+private:
+    const BufferId mDepthImagesBufferId;
+};
+
+template <class FloatType>
+IntegralDepthImagesStep<FloatType>::IntegralDepthImagesStep( const BufferId& depthImagesBufferId )
+: IntegralImagesBufferId(GetBufferId("IntegralDepthImages"))
+, mDepthImagesBufferId(depthImagesBufferId)
+{}
+
+template <class FloatType>
+IntegralDepthImagesStep<FloatType>::~IntegralDepthImagesStep()
+{}
+
+template <class FloatType>
+PipelineStepI* IntegralDepthImagesStep<FloatType>::Clone() const
+{
+    IntegralDepthImagesStep* clone = new IntegralDepthImagesStep<FloatType>(*this);
+    return clone;
+}
+
+template <class FloatType>
+void IntegralDepthImagesStep<FloatType>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                     BufferCollection& writeCollection,
+                                                     boost::mt19937& gen) const
+{
+    UNUSED_PARAM(gen);
+    if(!writeCollection.HasBuffer< Tensor3BufferTemplate<double> >(IntegralImagesBufferId))
+    {
+        const Tensor3BufferTemplate<FloatType>& depths =
+                readCollection.GetBuffer< Tensor3BufferTemplate<FloatType> >(mDepthImagesBufferId);
+        Tensor3BufferTemplate<double>& integrals =
+                writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<double> >(IntegralImagesBufferId);
+        integrals.Resize(depths.GetL(), depths.GetM()+1, depths.GetN()+1);
+
+        for(int l=0; l<depths.GetL(); l++)
+        {
+            for(int n=0; n<depths.GetN()+1; n++)
+            {
+                integrals.Set(l, 0, n, 0.0);
+            }
+            for(int m=0; m<depths.GetM(); m++)
+            {
+                double rowSum = 0.0;
+                integrals.Set(l, m+1, 0, 0.0);
+                for(int n=0; n<depths.GetN(); n++)
+                {
+                    rowSum += static_cast<double>(depths.Get(l, m, n));
+                    integrals.Set(l, m+1, n+1, integrals.Get(l, m, n+1) + rowSum);
+                }
+            }
+        }
+    }
+}
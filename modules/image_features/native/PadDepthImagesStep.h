@@ -0,0 +1,73 @@
+#pragma once
+
+#include "asserts.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+#include "PaddedDepthImages.h"
+
+// ----------------------------------------------------------------------------
+//
+// PadDepthImagesStep copies the depth images into a PaddedDepthImagesTemplate
+// with a replicated border of pad pixels.  The padded images are only built
+// once for each write collection so learners run it as a forest step (see
+// ParallelForestLearner) to share one copy between all trees.  A pad of PixelPairGaussianOffsetsStep's
+// GetMaxPixelOffset keeps (almost) all probes of ScaledDepthDeltaFeature
+// away from clamping.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType>
+class PadDepthImagesStep: public PipelineStepI
+{
+public:
+    PadDepthImagesStep( const BufferId& depthImagesBufferId, const int pad );
+    virtual ~PadDepthImagesStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    // Read only output buffer
+    const BufferId PaddedDepthImagesBufferId;
+private:
+    const BufferId mDepthImagesBufferId;
+    const int mPad;
+};
+
+template <class FloatType>
+PadDepthImagesStep<FloatType>::PadDepthImagesStep( const BufferId& depthImagesBufferId, const int pad )
+: PaddedDepthImagesBufferId(GetBufferId("PaddedDepthImages"))
+, mDepthImagesBufferId(depthImagesBufferId)
+, mPad(pad)
+{
+    ASSERT(mPad >= 0);
+}
+
+template <class FloatType>
+PadDepthImagesStep<FloatType>::~PadDepthImagesStep()
+{}
+
+template <class FloatType>
+PipelineStepI* PadDepthImagesStep<FloatType>::Clone() const
+{
+    PadDepthImagesStep* clone = new PadDepthImagesStep<FloatType>(*this);
+    return clone;
+}
+
+template <class FloatType>
+void PadDepthImagesStep<FloatType>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                BufferCollection& writeCollection,
+                                                boost::mt19937& gen) const
+{
+    UNUSED_PARAM(gen);
+    if(!writeCollection.HasBuffer< PaddedDepthImagesTemplate<FloatType> >(PaddedDepthImagesBufferId))
+    {
+        const Tensor3BufferTemplate<FloatType>& depthImages =
+                readCollection.GetBuffer< Tensor3BufferTemplate<FloatType> >(mDepthImagesBufferId);
+        writeCollection.AddBuffer(PaddedDepthImagesBufferId, PaddedDepthImagesTemplate<FloatType>(depthImages, mPad));
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+
+#include "asserts.h"
+#include "Tensor3Buffer.h"
+
+// ----------------------------------------------------------------------------
+//
+// PaddedDepthImagesTemplate stores depth images with a border of pad pixels
+// on every side that replicates the nearest edge pixel.  A probe anywhere in
+// the border reads the same depth as a clamped probe into the unpadded image
+// so probes that stay within the border do not have to be clamped.  Pixels
+// are addressed in the coordinates of the unpadded image so m and n can be
+// anywhere in [-pad, M+pad) and [-pad, N+pad).
+//
+// ----------------------------------------------------------------------------
+template <class FloatType>
+class PaddedDepthImagesTemplate
+{
+public:
+    PaddedDepthImagesTemplate();
+    PaddedDepthImagesTemplate(const Tensor3BufferTemplate<FloatType>& depths, int pad);
+    ~PaddedDepthImagesTemplate();
+
+    int GetL() const;
+    int GetM() const;
+    int GetN() const;
+    int GetPad() const;
+    int GetRowStride() const;
+
+    FloatType Get(int l, int m, int n) const;
+    FloatType GetUnsafe(int l, int m, int n) const;
+
+    // Pointer to pixel (0,0) of image l, pixel (m,n) is at m*GetRowStride()+n
+    const FloatType* GetOriginPtrUnsafe(int l) const;
+
+    const Tensor3BufferTemplate<FloatType>& GetPaddedImages() const;
+
+private:
+    Tensor3BufferTemplate<FloatType> mPaddedImages;
+    int mPad;
+    int mM;
+    int mN;
+};
+
+template <class FloatType>
+PaddedDepthImagesTemplate<FloatType>::PaddedDepthImagesTemplate()
+: mPaddedImages()
+, mPad(0)
+, mM(0)
+, mN(0)
+{}
+
+template <class FloatType>
+PaddedDepthImagesTemplate<FloatType>::PaddedDepthImagesTemplate(const Tensor3BufferTemplate<FloatType>& depths, int pad)
+: mPaddedImages(depths.GetL(), depths.GetM() + 2*pad, depths.GetN() + 2*pad)
+, mPad(pad)
+, mM(depths.GetM())
+, mN(depths.GetN())
+{
+    ASSERT(mPad >= 0);
+    for(int l=0; l<depths.GetL(); l++)
+    {
+        for(int m=-mPad; m<mM+mPad; m++)
+        {
+            const int clampedM = std::max(0, std::min(mM-1, m));
+            for(int n=-mPad; n<mN+mPad; n++)
+            {
+                const int clampedN = std::max(0, std::min(mN-1, n));
+                mPaddedImages.Set(l, m+mPad, n+mPad, depths.Get(l, clampedM, clampedN));
+            }
+        }
+    }
+}
+
+template <class FloatType>
+PaddedDepthImagesTemplate<FloatType>::~PaddedDepthImagesTemplate()
+{}
+
+template <class FloatType>
+int PaddedDepthImagesTemplate<FloatType>::GetL() const
+{
+    return mPaddedImages.GetL();
+}
+
+template <class FloatType>
+int PaddedDepthImagesTemplate<FloatType>::GetM() const
+{
+    return mM;
+}
+
+template <class FloatType>
+int PaddedDepthImagesTemplate<FloatType>::GetN() const
+{
+    return mN;
+}
+
+template <class FloatType>
+int PaddedDepthImagesTemplate<FloatType>::GetPad() const
+{
+    return mPad;
+}
+
+template <class FloatType>
+int PaddedDepthImagesTemplate<FloatType>::GetRowStride() const
+{
+    return mN + 2*mPad;
+}
+
+template <class FloatType>
+FloatType PaddedDepthImagesTemplate<FloatType>::Get(int l, int m, int n) const
+{
+    return mPaddedImages.Get(l, m+mPad, n+mPad);
+}
+
+template <class FloatType>
+FloatType PaddedDepthImagesTemplate<FloatType>::GetUnsafe(int l, int m, int n) const
+{
+    return mPaddedImages.GetUnsafe(l, m+mPad, n+mPad);
+}
+
+template <class FloatType>
+const FloatType* PaddedDepthImagesTemplate<FloatType>::GetOriginPtrUnsafe(int l) const
+{
+    return mPaddedImages.GetRowPtrUnsafe(l, mPad) + mPad;
+}
+
+template <class FloatType>
+const Tensor3BufferTemplate<FloatType>& PaddedDepthImagesTemplate<FloatType>::GetPaddedImages() const
+{
+    return mPaddedImages;
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cmath>
+#include <algorithm>
+
 #include "VectorBuffer.h"
 #include "MatrixBuffer.h"
 #include "BufferCollection.h"
@@ -35,6 +38,13 @@ public:
                                 BufferCollection& writeCollection,
                                 boost::mt19937& gen) const;
 
+    // Largest pixel offset of a probe from a pixel with depth >= minDepth and
+    // offset scales <= maxScale when the sampled offsets are within
+    // numberOfStandardDeviations of zero
+    IntType GetMaxPixelOffset( const FloatType minDepth,
+                               const FloatType maxScale,
+                               const FloatType numberOfStandardDeviations ) const;
+
     // Read only output buffers
     const BufferId FloatParamsBufferId;
     const BufferId IntParamsBufferId;
@@ -104,6 +114,16 @@ void PixelPairGaussianOffsetsStep<FloatType,IntType>::ProcessStep(const BufferCo
     }
 }
 
+template <class FloatType, class IntType>
+IntType PixelPairGaussianOffsetsStep<FloatType,IntType>::GetMaxPixelOffset( const FloatType minDepth,
+                                                                            const FloatType maxScale,
+                                                                            const FloatType numberOfStandardDeviations ) const
+{
+    ASSERT(minDepth > FloatType(0));
+    const FloatType maxStandardDeviation = std::max( std::max(mUx, mUy), std::max(mVx, mVy) );
+    return static_cast<IntType>( std::ceil( FloatType(2.0) / minDepth * maxScale * numberOfStandardDeviations * maxStandardDeviation ) );
+}
+
 
 template <class FloatType, class IntType>
 void PixelPairGaussianOffsetsStep<FloatType,IntType>::SampleParams(IntType numberOfFeatures,
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include "asserts.h"
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+
+// ----------------------------------------------------------------------------
+//
+// PixelSamplesStep samples numberOfPixelsPerImage pixels (with replacement)
+// from each depth image so every tree is trained on its own set of pixels.
+// Pixels with a depth <= 0 or a class < 0 are never sampled.  When
+// classBalanced is set a class is first drawn uniformly from the classes
+// present in the image and then a pixel of that class.
+//
+// Like BootstrapSamplesStep each distinct pixel appears once in the indices
+// buffer and is weighted by the number of times it was drawn.  The sampled
+// pixels (in (image, row, column) order) and their classes are written to
+// the PixelIndices and Classes buffers that the indices refer to.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class PixelSamplesStep: public PipelineStepI
+{
+public:
+    PixelSamplesStep( const BufferId& depthImagesBufferId,
+                      const BufferId& classImagesBufferId,
+                      const IntType numberOfPixelsPerImage,
+                      const bool classBalanced );
+    virtual ~PixelSamplesStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    // Read only output buffers
+    const BufferId PixelIndicesBufferId;
+    const BufferId ClassesBufferId;
+    const BufferId IndicesBufferId;
+    const BufferId WeightsBufferId;
+private:
+    const BufferId mDepthImagesBufferId;
+    const BufferId mClassImagesBufferId;
+    const IntType mNumberOfPixelsPerImage;
+    const bool mClassBalanced;
+};
+
+template <class FloatType, class IntType>
+PixelSamplesStep<FloatType, IntType>::PixelSamplesStep( const BufferId& depthImagesBufferId,
+                                                       const BufferId& classImagesBufferId,
+                                                       const IntType numberOfPixelsPerImage,
+                                                       const bool classBalanced )
+: PixelIndicesBufferId(GetBufferId("SampledPixelIndices"))
+, ClassesBufferId(GetBufferId("SampledPixelClasses"))
+, IndicesBufferId(GetBufferId("IndicesBuffer"))
+, WeightsBufferId(GetBufferId("WeightsBuffer"))
+, mDepthImagesBufferId(depthImagesBufferId)
+, mClassImagesBufferId(classImagesBufferId)
+, mNumberOfPixelsPerImage(numberOfPixelsPerImage)
+, mClassBalanced(classBalanced)
+{
+    ASSERT(mNumberOfPixelsPerImage > 0);
+}
+
+template <class FloatType, class IntType>
+PixelSamplesStep<FloatType, IntType>::~PixelSamplesStep()
+{}
+
+template <class FloatType, class IntType>
+PipelineStepI* PixelSamplesStep<FloatType, IntType>::Clone() const
+{
+    PixelSamplesStep* clone = new PixelSamplesStep<FloatType, IntType>(*this);
+    return clone;
+}
+
+template <class FloatType, class IntType>
+void PixelSamplesStep<FloatType, IntType>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                       BufferCollection& writeCollection,
+                                                       boost::mt19937& gen) const
+{
+    const Tensor3BufferTemplate<FloatType>& depths =
+            readCollection.GetBuffer< Tensor3BufferTemplate<FloatType> >(mDepthImagesBufferId);
+    const Tensor3BufferTemplate<IntType>& classImages =
+            readCollection.GetBuffer< Tensor3BufferTemplate<IntType> >(mClassImagesBufferId);
+    ASSERT_ARG_DIM_3D(classImages.GetL(), classImages.GetM(), classImages.GetN(),
+                      depths.GetL(), depths.GetM(), depths.GetN());
+
+    const IntType numberOfPixels = depths.GetM() * depths.GetN();
+
+    std::vector<IntType> pixelIndices;
+    std::vector<IntType> pixelClasses;
+    std::vector<FloatType> pixelWeights;
+
+    // Candidate pixel offsets of an image grouped by class when balancing
+    std::vector< std::vector<IntType> > candidates;
+    std::vector<IntType> sampled(mNumberOfPixelsPerImage);
+
+    for(IntType l=0; l<depths.GetL(); l++)
+    {
+        for(unsigned int c=0; c<candidates.size(); c++)
+        {
+            candidates[c].clear();
+        }
+        for(IntType p=0; p<numberOfPixels; p++)
+        {
+            const IntType m = p / depths.GetN();
+            const IntType n = p % depths.GetN();
+            const IntType pixelClass = classImages.Get(l, m, n);
+            if(depths.Get(l, m, n) <= FloatType(0) || pixelClass < 0)
+            {
+                continue;
+            }
+            const IntType group = mClassBalanced ? pixelClass : 0;
+            if(group >= static_cast<IntType>(candidates.size()))
+            {
+                candidates.resize(group+1);
+            }
+            candidates[group].push_back(p);
+        }
+
+        std::vector<IntType> groups;
+        for(unsigned int c=0; c<candidates.size(); c++)
+        {
+            if(!candidates[c].empty())
+            {
+                groups.push_back(c);
+            }
+        }
+        if(groups.empty())
+        {
+            continue;
+        }
+
+        boost::uniform_int<> groupRange(0, groups.size()-1);
+        boost::variate_generator<boost::mt19937&, boost::uniform_int<> > varGroup(gen, groupRange);
+        for(IntType s=0; s<mNumberOfPixelsPerImage; s++)
+        {
+            const std::vector<IntType>& groupCandidates = candidates[groups[varGroup()]];
+            boost::uniform_int<> candidateRange(0, groupCandidates.size()-1);
+            boost::variate_generator<boost::mt19937&, boost::uniform_int<> > varCandidate(gen, candidateRange);
+            sampled[s] = groupCandidates[varCandidate()];
+        }
+
+        // Merge repeated draws of a pixel into its weight
+        std::sort(sampled.begin(), sampled.end());
+        for(IntType s=0; s<mNumberOfPixelsPerImage; s++)
+        {
+            if(s > 0 && sampled[s] == sampled[s-1])
+            {
+                pixelWeights.back() += FloatType(1);
+                continue;
+            }
+            const IntType m = sampled[s] / depths.GetN();
+            const IntType n = sampled[s] % depths.GetN();
+            pixelIndices.push_back(l);
+            pixelIndices.push_back(m);
+            pixelIndices.push_back(n);
+            pixelClasses.push_back(classImages.Get(l, m, n));
+            pixelWeights.push_back(FloatType(1));
+        }
+    }
+
+    const IntType numberOfSamples = pixelClasses.size();
+    MatrixBufferTemplate<IntType>& pixelIndicesBuffer =
+            writeCollection.GetOrAddBuffer< MatrixBufferTemplate<IntType> >(PixelIndicesBufferId);
+    VectorBufferTemplate<IntType>& classesBuffer =
+            writeCollection.GetOrAddBuffer< VectorBufferTemplate<IntType> >(ClassesBufferId);
+    VectorBufferTemplate<IntType>& indices =
+            writeCollection.GetOrAddBuffer< VectorBufferTemplate<IntType> >(IndicesBufferId);
+    VectorBufferTemplate<FloatType>& weights =
+            writeCollection.GetOrAddBuffer< VectorBufferTemplate<FloatType> >(WeightsBufferId);
+
+    pixelIndicesBuffer.Resize(numberOfSamples, 3);
+    classesBuffer.Resize(numberOfSamples);
+    indices.Resize(numberOfSamples);
+    weights.Resize(numberOfSamples);
+    for(IntType i=0; i<numberOfSamples; i++)
+    {
+        pixelIndicesBuffer.Set(i, 0, pixelIndices[3*i]);
+        pixelIndicesBuffer.Set(i, 1, pixelIndices[3*i+1]);
+        pixelIndicesBuffer.Set(i, 2, pixelIndices[3*i+2]);
+        classesBuffer.Set(i, pixelClasses[i]);
+        indices.Set(i, i);
+        weights.Set(i, pixelWeights[i]);
+    }
+}
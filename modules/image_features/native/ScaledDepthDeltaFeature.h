@@ -15,7 +15,7 @@
 // ScaledDepthDeltaFeature is the depth delta of a pair of pixels
 //
 // ----------------------------------------------------------------------------
-template <class FloatType, class IntType>
+template <class FloatType, class IntType, class DepthImagesType = Tensor3BufferTemplate<FloatType> >
 class ScaledDepthDeltaFeature
 {
 public:
@@ -38,12 +38,12 @@ public:
 
     ~ScaledDepthDeltaFeature();
 
-    ScaledDepthDeltaFeatureBinding<FloatType, IntType> Bind(const BufferCollectionStack& readCollection) const;
+    ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType> Bind(const BufferCollectionStack& readCollection) const;
 
 
     typedef FloatType Float;
     typedef IntType Int;
-    typedef ScaledDepthDeltaFeatureBinding<FloatType, IntType> FeatureBinding;
+    typedef ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType> FeatureBinding;
 
     const BufferId mFloatParamsBufferId;
     const BufferId mIntParamsBufferId;
@@ -53,8 +53,8 @@ public:
     const BufferId mDepthsImgsBufferId;
 };
 
-template <class FloatType, class IntType>
-ScaledDepthDeltaFeature<FloatType, IntType>::ScaledDepthDeltaFeature( const BufferId& floatParamsBufferId,
+template <class FloatType, class IntType, class DepthImagesType>
+ScaledDepthDeltaFeature<FloatType, IntType, DepthImagesType>::ScaledDepthDeltaFeature( const BufferId& floatParamsBufferId,
                                                                       const BufferId& intParamsBufferId,
                                                                       const BufferId& indicesBufferId,
                                                                       const BufferId& pixelIndicesBufferId,
@@ -68,8 +68,8 @@ ScaledDepthDeltaFeature<FloatType, IntType>::ScaledDepthDeltaFeature( const Buff
 , mDepthsImgsBufferId(depthsDataBufferId)
 {}
 
-template <class FloatType, class IntType>
-ScaledDepthDeltaFeature<FloatType, IntType>::ScaledDepthDeltaFeature( const BufferId& floatParamsBufferId,
+template <class FloatType, class IntType, class DepthImagesType>
+ScaledDepthDeltaFeature<FloatType, IntType, DepthImagesType>::ScaledDepthDeltaFeature( const BufferId& floatParamsBufferId,
                                                                       const BufferId& intParamsBufferId,
                                                                       const BufferId& indicesBufferId,
                                                                       const BufferId& pixelIndicesBufferId,
@@ -83,8 +83,8 @@ ScaledDepthDeltaFeature<FloatType, IntType>::ScaledDepthDeltaFeature( const Buff
 {}
 
 
-template <class FloatType, class IntType>
-ScaledDepthDeltaFeature<FloatType, IntType>::ScaledDepthDeltaFeature( const BufferId& indicesBufferId,
+template <class FloatType, class IntType, class DepthImagesType>
+ScaledDepthDeltaFeature<FloatType, IntType, DepthImagesType>::ScaledDepthDeltaFeature( const BufferId& indicesBufferId,
                                                                       const BufferId& pixelIndicesBufferId,
                                                                       const BufferId& depthsDataBufferId )
 : mFloatParamsBufferId(GetBufferId("floatParams"))
@@ -95,18 +95,18 @@ ScaledDepthDeltaFeature<FloatType, IntType>::ScaledDepthDeltaFeature( const Buff
 , mDepthsImgsBufferId(depthsDataBufferId)
 {}
 
-template <class FloatType, class IntType>
-ScaledDepthDeltaFeature<FloatType, IntType>::~ScaledDepthDeltaFeature()
+template <class FloatType, class IntType, class DepthImagesType>
+ScaledDepthDeltaFeature<FloatType, IntType, DepthImagesType>::~ScaledDepthDeltaFeature()
 {}
 
-template <class FloatType, class IntType>
-ScaledDepthDeltaFeatureBinding<FloatType, IntType> ScaledDepthDeltaFeature<FloatType, IntType>::Bind(const BufferCollectionStack& readCollection) const
+template <class FloatType, class IntType, class DepthImagesType>
+ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType> ScaledDepthDeltaFeature<FloatType, IntType, DepthImagesType>::Bind(const BufferCollectionStack& readCollection) const
 {
     MatrixBufferTemplate<FloatType> const* floatParams = readCollection.GetBufferPtr< MatrixBufferTemplate<FloatType> >(mFloatParamsBufferId);
     MatrixBufferTemplate<IntType> const* intParams = readCollection.GetBufferPtr< MatrixBufferTemplate<IntType> >(mIntParamsBufferId);
     VectorBufferTemplate<IntType> const* indices = readCollection.GetBufferPtr< VectorBufferTemplate<IntType> >(mIndicesBufferId);
     MatrixBufferTemplate<IntType> const* pixelIndices = readCollection.GetBufferPtr< MatrixBufferTemplate<IntType> >(mPixelIndicesBufferId);
-    Tensor3BufferTemplate<FloatType> const* depthImgs = readCollection.GetBufferPtr< Tensor3BufferTemplate<FloatType> >(mDepthsImgsBufferId);
+    DepthImagesType const* depthImgs = readCollection.GetBufferPtr< DepthImagesType >(mDepthsImgsBufferId);
     
     MatrixBufferTemplate<FloatType> const* scales = NULL;
     if( mScalesBufferId != NullKey )
@@ -116,6 +116,6 @@ ScaledDepthDeltaFeatureBinding<FloatType, IntType> ScaledDepthDeltaFeature<Float
 
     ASSERT_ARG_DIM_1D(floatParams->GetN(), intParams->GetN());
 
-    return ScaledDepthDeltaFeatureBinding<FloatType, IntType>(floatParams, intParams, indices, pixelIndices, depthImgs, scales);
+    return ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>(floatParams, intParams, indices, pixelIndices, depthImgs, scales);
 }
 
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <vector>
+#include <algorithm>
+
 #include "asserts.h"
 #include "VectorBuffer.h"
 #include "MatrixBuffer.h"
 #include "Tensor3Buffer.h"
 #include "Constants.h"
 #include "ImageUtils.h"
+#include "FeatureExtractorStep.h"
 
 // ----------------------------------------------------------------------------
 //
@@ -13,7 +17,7 @@
 // offsets
 //
 // ----------------------------------------------------------------------------
-template <class FloatType, class IntType>
+template <class FloatType, class IntType, class DepthImagesType = Tensor3BufferTemplate<FloatType> >
 class ScaledDepthDeltaFeatureBinding
 {
 public:
@@ -21,7 +25,7 @@ public:
                                  MatrixBufferTemplate<IntType> const* intParams,
                                  VectorBufferTemplate<IntType> const* indices,
                                  MatrixBufferTemplate<IntType> const* pixelIndices,
-                                 Tensor3BufferTemplate<FloatType> const* depthImgs,
+                                 DepthImagesType const* depthImgs,
                                  MatrixBufferTemplate<FloatType> const* scales);
     ScaledDepthDeltaFeatureBinding();
     ~ScaledDepthDeltaFeatureBinding();
@@ -30,6 +34,9 @@ public:
     ScaledDepthDeltaFeatureBinding & operator=(const ScaledDepthDeltaFeatureBinding & other);
 
     FloatType FeatureValue( const int featureIndex, const int relativeSampleIndex) const;
+    void FeatureValues( const int sampleStart, const int sampleEnd,
+                        const FeatureValueOrdering ordering,
+                        MatrixBufferTemplate<FloatType>& featureValues ) const;
 
     IntType GetNumberOfFeatures() const;
     IntType GetNumberOfDatapoints() const;
@@ -39,16 +46,16 @@ private:
     MatrixBufferTemplate<IntType> const* mIntParams;
     VectorBufferTemplate<IntType> const* mIndices;
     MatrixBufferTemplate<IntType> const* mPixelIndices;
-    Tensor3BufferTemplate<FloatType> const* mDepthImgs;
+    DepthImagesType const* mDepthImgs;
     MatrixBufferTemplate<FloatType> const* mScales;
 };
 
-template <class FloatType, class IntType>
-ScaledDepthDeltaFeatureBinding<FloatType, IntType>::ScaledDepthDeltaFeatureBinding( MatrixBufferTemplate<FloatType> const* floatParams,
+template <class FloatType, class IntType, class DepthImagesType>
+ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>::ScaledDepthDeltaFeatureBinding( MatrixBufferTemplate<FloatType> const* floatParams,
                                                                                    MatrixBufferTemplate<IntType> const* intParams,
                                                                                    VectorBufferTemplate<IntType> const* indices,
                                                                                    MatrixBufferTemplate<IntType> const* pixelIndices,
-                                                                                   Tensor3BufferTemplate<FloatType> const* depthImgs,
+                                                                                   DepthImagesType const* depthImgs,
                                                                                    MatrixBufferTemplate<FloatType> const* scales )
 : mFloatParams(floatParams)
 , mIntParams(intParams)
@@ -58,8 +65,8 @@ ScaledDepthDeltaFeatureBinding<FloatType, IntType>::ScaledDepthDeltaFeatureBindi
 , mScales(scales)
 {}
 
-template <class FloatType, class IntType>
-ScaledDepthDeltaFeatureBinding<FloatType, IntType>::ScaledDepthDeltaFeatureBinding()
+template <class FloatType, class IntType, class DepthImagesType>
+ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>::ScaledDepthDeltaFeatureBinding()
 : mFloatParams(NULL)
 , mIntParams(NULL)
 , mIndices(NULL)
@@ -68,8 +75,8 @@ ScaledDepthDeltaFeatureBinding<FloatType, IntType>::ScaledDepthDeltaFeatureBindi
 , mScales(NULL)
 {}
 
-template <class FloatType, class IntType>
-ScaledDepthDeltaFeatureBinding<FloatType, IntType>::ScaledDepthDeltaFeatureBinding( const ScaledDepthDeltaFeatureBinding& other )
+template <class FloatType, class IntType, class DepthImagesType>
+ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>::ScaledDepthDeltaFeatureBinding( const ScaledDepthDeltaFeatureBinding& other )
 : mFloatParams(other.mFloatParams)
 , mIntParams(other.mIntParams)
 , mIndices(other.mIndices)
@@ -78,8 +85,8 @@ ScaledDepthDeltaFeatureBinding<FloatType, IntType>::ScaledDepthDeltaFeatureBindi
 , mScales(other.mScales)
 {}
 
-template <class FloatType, class IntType>
-ScaledDepthDeltaFeatureBinding<FloatType, IntType>& ScaledDepthDeltaFeatureBinding<FloatType, IntType>::operator=(const ScaledDepthDeltaFeatureBinding & other)
+template <class FloatType, class IntType, class DepthImagesType>
+ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>& ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>::operator=(const ScaledDepthDeltaFeatureBinding & other)
 {
     mFloatParams = other.mFloatParams;
     mIntParams = other.mIntParams;
@@ -90,13 +97,13 @@ ScaledDepthDeltaFeatureBinding<FloatType, IntType>& ScaledDepthDeltaFeatureBindi
     return *this;
 }
 
-template <class FloatType, class IntType>
-ScaledDepthDeltaFeatureBinding<FloatType, IntType>::~ScaledDepthDeltaFeatureBinding()
+template <class FloatType, class IntType, class DepthImagesType>
+ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>::~ScaledDepthDeltaFeatureBinding()
 {}
 
 
-template <class FloatType, class IntType>
-FloatType ScaledDepthDeltaFeatureBinding<FloatType, IntType>::FeatureValue( const int featureIndex, const int relativeSampleIndex) const
+template <class FloatType, class IntType, class DepthImagesType>
+FloatType ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>::FeatureValue( const int featureIndex, const int relativeSampleIndex) const
 {
     const IntType index = mIndices->Get(relativeSampleIndex);
 
@@ -116,14 +123,97 @@ FloatType ScaledDepthDeltaFeatureBinding<FloatType, IntType>::FeatureValue( cons
     return featureValue;
 }
 
-template <class FloatType, class IntType>
-IntType ScaledDepthDeltaFeatureBinding<FloatType, IntType>::GetNumberOfFeatures() const
+// ----------------------------------------------------------------------------
+//
+// Batched evaluation of all features for the samples [sampleStart, sampleEnd).
+// The offsets are copied out of the params once per call and the depth
+// reciprocal and scales are looked up once per sample.  For each sample the
+// probe offsets of all features are computed and clamped (with min/max instead
+// of branches) into pixel offsets in one loop, and the probes are then
+// gathered from the image in a second loop.  For padded depth images the
+// probes are clamped to the padded image which reads the same depths.  The
+// image layout (row-major, padded or tiled) is hidden behind
+// DepthImagePixelOffset.  The arithmetic is done in the same order as
+// PixelDepthDelta so the values match FeatureValue exactly.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType, class DepthImagesType>
+void ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>::FeatureValues( const int sampleStart, const int sampleEnd,
+                                                                       const FeatureValueOrdering ordering,
+                                                                       MatrixBufferTemplate<FloatType>& featureValues ) const
+{
+    ASSERT_VALID_RANGE(sampleStart, 0, mIndices->GetN()+1)
+    ASSERT_VALID_RANGE(sampleEnd, sampleStart, mIndices->GetN()+1)
+    const IntType numberOfFeatures = mIntParams->GetM();
+    ASSERT_ARG_DIM_2D(featureValues.GetM(), featureValues.GetN(),
+                      (ordering == FEATURES_BY_DATAPOINTS) ? numberOfFeatures : mIndices->GetN(),
+                      (ordering == FEATURES_BY_DATAPOINTS) ? mIndices->GetN() : numberOfFeatures)
+
+    std::vector<FloatType> um(numberOfFeatures);
+    std::vector<FloatType> un(numberOfFeatures);
+    std::vector<FloatType> vm(numberOfFeatures);
+    std::vector<FloatType> vn(numberOfFeatures);
+    for(IntType f=0; f<numberOfFeatures; f++)
+    {
+        um[f] = mFloatParams->Get(f,FEATURE_SPECIFIC_PARAMS_START);
+        un[f] = mFloatParams->Get(f,FEATURE_SPECIFIC_PARAMS_START+1);
+        vm[f] = mFloatParams->Get(f,FEATURE_SPECIFIC_PARAMS_START+2);
+        vn[f] = mFloatParams->Get(f,FEATURE_SPECIFIC_PARAMS_START+3);
+    }
+
+    const IntType pad = DepthImagePad(*mDepthImgs);
+    const IntType minM = -pad;
+    const IntType minN = -pad;
+    const IntType maxM = mDepthImgs->GetM() + pad;
+    const IntType maxN = mDepthImgs->GetN() + pad;
+    std::vector<IntType> probeU(numberOfFeatures);
+    std::vector<IntType> probeV(numberOfFeatures);
+
+    for(IntType s=sampleStart; s<sampleEnd; s++)
+    {
+        const IntType index = mIndices->Get(s);
+        const IntType imgIndex = mPixelIndices->Get(index, 0);
+        const IntType pixelM = mPixelIndices->Get(index, 1);
+        const IntType pixelN = mPixelIndices->Get(index, 2);
+
+        const FloatType scaleM = (mScales != NULL) ? mScales->Get(index, 0) : FloatType(1.0);
+        const FloatType scaleN = (mScales != NULL) ? mScales->Get(index, 1) : FloatType(1.0);
+        const FloatType scaleByDepth = FloatType(2.0) / mDepthImgs->Get(imgIndex, pixelM, pixelN);
+        const FloatType* img = DepthImageOriginPtr(*mDepthImgs, imgIndex);
+
+        for(IntType f=0; f<numberOfFeatures; f++)
+        {
+            const IntType mU = std::max(minM, std::min(IntType(maxM-1), IntType(pixelM + IntType(scaleByDepth * (um[f]*scaleM)))));
+            const IntType nU = std::max(minN, std::min(IntType(maxN-1), IntType(pixelN + IntType(scaleByDepth * (un[f]*scaleN)))));
+            const IntType mV = std::max(minM, std::min(IntType(maxM-1), IntType(pixelM + IntType(scaleByDepth * (vm[f]*scaleM)))));
+            const IntType nV = std::max(minN, std::min(IntType(maxN-1), IntType(pixelN + IntType(scaleByDepth * (vn[f]*scaleN)))));
+            probeU[f] = DepthImagePixelOffset(*mDepthImgs, mU, nU);
+            probeV[f] = DepthImagePixelOffset(*mDepthImgs, mV, nV);
+        }
+
+        for(IntType f=0; f<numberOfFeatures; f++)
+        {
+            const FloatType delta = img[probeU[f]] - img[probeV[f]];
+            if( ordering == FEATURES_BY_DATAPOINTS )
+            {
+                featureValues.SetUnsafe(f, s, delta);
+            }
+            else
+            {
+                featureValues.SetUnsafe(s, f, delta);
+            }
+        }
+    }
+}
+
+template <class FloatType, class IntType, class DepthImagesType>
+IntType ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>::GetNumberOfFeatures() const
 {
     return mIntParams->GetM();
 }
 
-template <class FloatType, class IntType>
-IntType ScaledDepthDeltaFeatureBinding<FloatType, IntType>::GetNumberOfDatapoints() const
+template <class FloatType, class IntType, class DepthImagesType>
+IntType ScaledDepthDeltaFeatureBinding<FloatType, IntType, DepthImagesType>::GetNumberOfDatapoints() const
 {
     return mIndices->GetN();
 }
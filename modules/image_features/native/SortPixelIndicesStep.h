@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "asserts.h"
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+
+// ----------------------------------------------------------------------------
+//
+// SortPixelIndicesStep reorders an indices buffer so the pixels it refers to
+// are in (image, row, column) order.  Feature extraction then walks each
+// depth image from top to bottom instead of jumping between images and rows.
+// Splitting a node keeps the relative order of its indices so sorting once
+// per tree keeps every node sorted.
+//
+// ----------------------------------------------------------------------------
+template <class IntType>
+class SortPixelIndicesStep: public PipelineStepI
+{
+public:
+    SortPixelIndicesStep( const BufferId& indicesBufferId,
+                          const BufferId& pixelIndicesBufferId );
+    virtual ~SortPixelIndicesStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    // Read only output buffer
+    const BufferId IndicesBufferId;
+private:
+    const BufferId mIndicesBufferId;
+    const BufferId mPixelIndicesBufferId;
+};
+
+template <class IntType>
+SortPixelIndicesStep<IntType>::SortPixelIndicesStep( const BufferId& indicesBufferId,
+                                                     const BufferId& pixelIndicesBufferId )
+: IndicesBufferId(GetBufferId("SortedPixelIndices"))
+, mIndicesBufferId(indicesBufferId)
+, mPixelIndicesBufferId(pixelIndicesBufferId)
+{}
+
+template <class IntType>
+SortPixelIndicesStep<IntType>::~SortPixelIndicesStep()
+{}
+
+template <class IntType>
+PipelineStepI* SortPixelIndicesStep<IntType>::Clone() const
+{
+    SortPixelIndicesStep* clone = new SortPixelIndicesStep<IntType>(*this);
+    return clone;
+}
+
+template <class IntType>
+void SortPixelIndicesStep<IntType>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                BufferCollection& writeCollection,
+                                                boost::mt19937& gen) const
+{
+    UNUSED_PARAM(gen);
+
+    const VectorBufferTemplate<IntType>& indices =
+            readCollection.GetBuffer< VectorBufferTemplate<IntType> >(mIndicesBufferId);
+    const MatrixBufferTemplate<IntType>& pixelIndices =
+            readCollection.GetBuffer< MatrixBufferTemplate<IntType> >(mPixelIndicesBufferId);
+    ASSERT_ARG_DIM_1D(pixelIndices.GetN(), 3);
+
+    const IntType numberOfIndices = indices.GetN();
+    IntType maxM = 0;
+    IntType maxN = 0;
+    for(IntType i=0; i<numberOfIndices; i++)
+    {
+        const IntType index = indices.Get(i);
+        maxM = std::max(maxM, pixelIndices.Get(index, 1));
+        maxN = std::max(maxN, pixelIndices.Get(index, 2));
+    }
+
+    // Ties keep the original order so duplicated pixels stay deterministic
+    std::vector< std::pair<long long, IntType> > keyIndices(numberOfIndices);
+    for(IntType i=0; i<numberOfIndices; i++)
+    {
+        const IntType index = indices.Get(i);
+        const long long key = (static_cast<long long>(pixelIndices.Get(index, 0)) * (maxM + 1)
+                                + pixelIndices.Get(index, 1)) * (maxN + 1)
+                                + pixelIndices.Get(index, 2);
+        keyIndices[i] = std::pair<long long, IntType>(key, i);
+    }
+    std::sort(keyIndices.begin(), keyIndices.end());
+
+    VectorBufferTemplate<IntType>& sortedIndices =
+            writeCollection.GetOrAddBuffer< VectorBufferTemplate<IntType> >(IndicesBufferId);
+    sortedIndices.Resize(numberOfIndices);
+    for(IntType i=0; i<numberOfIndices; i++)
+    {
+        sortedIndices.Set(i, indices.Get(keyIndices[i].second));
+    }
+}
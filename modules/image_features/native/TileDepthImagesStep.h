@@ -0,0 +1,68 @@
+#pragma once
+
+#include "asserts.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+#include "TiledDepthImages.h"
+
+// ----------------------------------------------------------------------------
+//
+// TileDepthImagesStep copies the depth images into the tiled layout of
+// TiledDepthImagesTemplate.  The tiled images are only built once for each
+// write collection so learners run it as a forest step (see
+// ParallelForestLearner) and predictors as a pre step that runs once per
+// call (see TemplateForestPredictor).
+//
+// ----------------------------------------------------------------------------
+template <class FloatType>
+class TileDepthImagesStep: public PipelineStepI
+{
+public:
+    TileDepthImagesStep( const BufferId& depthImagesBufferId );
+    virtual ~TileDepthImagesStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    // Read only output buffer
+    const BufferId TiledDepthImagesBufferId;
+private:
+    const BufferId mDepthImagesBufferId;
+};
+
+template <class FloatType>
+TileDepthImagesStep<FloatType>::TileDepthImagesStep( const BufferId& depthImagesBufferId )
+: TiledDepthImagesBufferId(GetBufferId("TiledDepthImages"))
+, mDepthImagesBufferId(depthImagesBufferId)
+{}
+
+template <class FloatType>
+TileDepthImagesStep<FloatType>::~TileDepthImagesStep()
+{}
+
+template <class FloatType>
+PipelineStepI* TileDepthImagesStep<FloatType>::Clone() const
+{
+    TileDepthImagesStep* clone = new TileDepthImagesStep<FloatType>(*this);
+    return clone;
+}
+
+template <class FloatType>
+void TileDepthImagesStep<FloatType>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                 BufferCollection& writeCollection,
+                                                 boost::mt19937& gen) const
+{
+    UNUSED_PARAM(gen);
+    if(!writeCollection.HasBuffer< TiledDepthImagesTemplate<FloatType> >(TiledDepthImagesBufferId))
+    {
+        const Tensor3BufferTemplate<FloatType>& depthImages =
+                readCollection.GetBuffer< Tensor3BufferTemplate<FloatType> >(mDepthImagesBufferId);
+        writeCollection.AddBuffer(TiledDepthImagesBufferId, TiledDepthImagesTemplate<FloatType>(depthImages));
+    }
+}
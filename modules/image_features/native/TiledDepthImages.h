@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+
+#include "asserts.h"
+#include "Tensor3Buffer.h"
+
+// ----------------------------------------------------------------------------
+//
+// TiledDepthImagesTemplate stores depth images as TILE_SIZE x TILE_SIZE tiles
+// with the pixels of a tile in consecutive memory.  Pixel pair probes that
+// land a few rows above or below the center pixel (or of each other) then
+// share cache lines and pages far more often than with the row-major layout
+// of Tensor3BufferTemplate.  Images are padded up to a whole number of tiles
+// by replicating the last row and column.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType>
+class TiledDepthImagesTemplate
+{
+public:
+    enum { TILE_SHIFT = 3, TILE_SIZE = 1 << TILE_SHIFT, TILE_MASK = TILE_SIZE - 1 };
+
+    TiledDepthImagesTemplate();
+    TiledDepthImagesTemplate(const Tensor3BufferTemplate<FloatType>& depths);
+    ~TiledDepthImagesTemplate();
+
+    int GetL() const;
+    int GetM() const;
+    int GetN() const;
+
+    FloatType Get(int l, int m, int n) const;
+    FloatType GetUnsafe(int l, int m, int n) const;
+
+    // Offset of pixel (m,n) from the start of its image
+    int GetPixelOffset(int m, int n) const;
+    const FloatType* GetImagePtrUnsafe(int l) const;
+
+    Tensor3BufferTemplate<FloatType> AsRowMajor() const;
+
+private:
+    std::vector<FloatType> mData;
+    int mL;
+    int mM;
+    int mN;
+    int mTilesPerRow;
+    int mImageSize;
+};
+
+template <class FloatType>
+TiledDepthImagesTemplate<FloatType>::TiledDepthImagesTemplate()
+: mData()
+, mL(0)
+, mM(0)
+, mN(0)
+, mTilesPerRow(0)
+, mImageSize(0)
+{}
+
+template <class FloatType>
+TiledDepthImagesTemplate<FloatType>::TiledDepthImagesTemplate(const Tensor3BufferTemplate<FloatType>& depths)
+: mData()
+, mL(depths.GetL())
+, mM(depths.GetM())
+, mN(depths.GetN())
+, mTilesPerRow((depths.GetN() + TILE_MASK) >> TILE_SHIFT)
+, mImageSize(((depths.GetM() + TILE_MASK) >> TILE_SHIFT) * mTilesPerRow * TILE_SIZE * TILE_SIZE)
+{
+    mData.resize(mL * mImageSize);
+    const int tiledM = (mM + TILE_MASK) & ~TILE_MASK;
+    const int tiledN = (mN + TILE_MASK) & ~TILE_MASK;
+    for(int l=0; l<mL; l++)
+    {
+        for(int m=0; m<tiledM; m++)
+        {
+            for(int n=0; n<tiledN; n++)
+            {
+                const int clampedM = (m < mM) ? m : mM-1;
+                const int clampedN = (n < mN) ? n : mN-1;
+                mData[l*mImageSize + GetPixelOffset(m, n)] = depths.Get(l, clampedM, clampedN);
+            }
+        }
+    }
+}
+
+template <class FloatType>
+TiledDepthImagesTemplate<FloatType>::~TiledDepthImagesTemplate()
+{}
+
+template <class FloatType>
+int TiledDepthImagesTemplate<FloatType>::GetL() const
+{
+    return mL;
+}
+
+template <class FloatType>
+int TiledDepthImagesTemplate<FloatType>::GetM() const
+{
+    return mM;
+}
+
+template <class FloatType>
+int TiledDepthImagesTemplate<FloatType>::GetN() const
+{
+    return mN;
+}
+
+template <class FloatType>
+FloatType TiledDepthImagesTemplate<FloatType>::Get(int l, int m, int n) const
+{
+    ASSERT_VALID_RANGE(l, 0, mL)
+    ASSERT_VALID_RANGE(m, 0, mM)
+    ASSERT_VALID_RANGE(n, 0, mN)
+    return mData[l*mImageSize + GetPixelOffset(m, n)];
+}
+
+template <class FloatType>
+FloatType TiledDepthImagesTemplate<FloatType>::GetUnsafe(int l, int m, int n) const
+{
+    return mData[l*mImageSize + GetPixelOffset(m, n)];
+}
+
+template <class FloatType>
+int TiledDepthImagesTemplate<FloatType>::GetPixelOffset(int m, int n) const
+{
+    const int tile = (m >> TILE_SHIFT) * mTilesPerRow + (n >> TILE_SHIFT);
+    return (tile << (2*TILE_SHIFT)) + ((m & TILE_MASK) << TILE_SHIFT) + (n & TILE_MASK);
+}
+
+template <class FloatType>
+const FloatType* TiledDepthImagesTemplate<FloatType>::GetImagePtrUnsafe(int l) const
+{
+    ASSERT_VALID_RANGE(l, 0, mL)
+    return &mData[l*mImageSize];
+}
+
+template <class FloatType>
+Tensor3BufferTemplate<FloatType> TiledDepthImagesTemplate<FloatType>::AsRowMajor() const
+{
+    Tensor3BufferTemplate<FloatType> depths(mL, mM, mN);
+    for(int l=0; l<mL; l++)
+    {
+        for(int m=0; m<mM; m++)
+        {
+            for(int n=0; n<mN; n++)
+            {
+                depths.Set(l, m, n, Get(l, m, n));
+            }
+        }
+    }
+    return depths;
+}
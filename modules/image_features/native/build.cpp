@@ -1,2 +1,36 @@
+#include "MatrixBuffer.h"
+#include "FeatureExtractorStep.h"
+#include "BatchedFeatureExtractorStep.h"
+#include "PaddedDepthImages.h"
+#include "PadDepthImagesStep.h"
+#include "TiledDepthImages.h"
+#include "TileDepthImagesStep.h"
 #include "PixelPairGaussianOffsetsStep.h"
-#include "ScaledDepthDeltaFeature.h"
\ No newline at end of file
+#include "ScaledDepthDeltaFeature.h"
+#include "IntegralDepthImagesStep.h"
+#include "BoxPairGaussianOffsetsStep.h"
+#include "BoxDepthDeltaFeature.h"
+#include "SortPixelIndicesStep.h"
+#include "PixelSamplesStep.h"
+
+template class ScaledDepthDeltaFeature<float, int>;
+template class FeatureExtractorStep< ScaledDepthDeltaFeature<float, int> >;
+template class BatchedFeatureExtractorStep< ScaledDepthDeltaFeature<float, int> >;
+
+template class PaddedDepthImagesTemplate<float>;
+template class PadDepthImagesStep<float>;
+template class ScaledDepthDeltaFeature<float, int, PaddedDepthImagesTemplate<float> >;
+template class BatchedFeatureExtractorStep< ScaledDepthDeltaFeature<float, int, PaddedDepthImagesTemplate<float> > >;
+
+template class TiledDepthImagesTemplate<float>;
+template class TileDepthImagesStep<float>;
+template class ScaledDepthDeltaFeature<float, int, TiledDepthImagesTemplate<float> >;
+template class BatchedFeatureExtractorStep< ScaledDepthDeltaFeature<float, int, TiledDepthImagesTemplate<float> > >;
+
+template class IntegralDepthImagesStep<float>;
+template class BoxPairGaussianOffsetsStep<float, int>;
+template class BoxDepthDeltaFeature<float, int>;
+template class FeatureExtractorStep< BoxDepthDeltaFeature<float, int> >;
+
+template class SortPixelIndicesStep<int>;
+template class PixelSamplesStep<float, int>;
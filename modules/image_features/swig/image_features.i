@@ -2,6 +2,7 @@
 %{
     #define SWIG_FILE_WITH_INIT
     #include "FeatureExtractorStep.h"
+    #include "BatchedFeatureExtractorStep.h"
 %}
 
 %include <exception.i>
@@ -11,7 +12,27 @@
 %include <image_features_external.i>
 
 %include "FeatureExtractorStep.h"
+%include "BatchedFeatureExtractorStep.h"
 
 %template(PixelPairGaussianOffsetsStep_f32i32) PixelPairGaussianOffsetsStep<float, int>;
 %template(ScaledDepthDeltaFeature_f32i32) ScaledDepthDeltaFeature< float, int >;
-%template(ScaledDepthDeltaFeatureExtractorStep_f32i32) FeatureExtractorStep< ScaledDepthDeltaFeature<float, int> >;
\ No newline at end of file
+%template(ScaledDepthDeltaFeatureExtractorStep_f32i32) FeatureExtractorStep< ScaledDepthDeltaFeature<float, int> >;
+%template(ScaledDepthDeltaBatchedFeatureExtractorStep_f32i32) BatchedFeatureExtractorStep< ScaledDepthDeltaFeature<float, int> >;
+
+%template(PaddedFloat32DepthImages) PaddedDepthImagesTemplate<float>;
+%template(PadDepthImagesStep_f32) PadDepthImagesStep<float>;
+%template(PaddedScaledDepthDeltaFeature_f32i32) ScaledDepthDeltaFeature< float, int, PaddedDepthImagesTemplate<float> >;
+%template(PaddedScaledDepthDeltaBatchedFeatureExtractorStep_f32i32) BatchedFeatureExtractorStep< ScaledDepthDeltaFeature<float, int, PaddedDepthImagesTemplate<float> > >;
+
+%template(TiledFloat32DepthImages) TiledDepthImagesTemplate<float>;
+%template(TileDepthImagesStep_f32) TileDepthImagesStep<float>;
+%template(TiledScaledDepthDeltaFeature_f32i32) ScaledDepthDeltaFeature< float, int, TiledDepthImagesTemplate<float> >;
+%template(TiledScaledDepthDeltaBatchedFeatureExtractorStep_f32i32) BatchedFeatureExtractorStep< ScaledDepthDeltaFeature<float, int, TiledDepthImagesTemplate<float> > >;
+
+%template(IntegralDepthImagesStep_f32) IntegralDepthImagesStep<float>;
+%template(BoxPairGaussianOffsetsStep_f32i32) BoxPairGaussianOffsetsStep<float, int>;
+%template(BoxDepthDeltaFeature_f32i32) BoxDepthDeltaFeature< float, int >;
+%template(BoxDepthDeltaFeatureExtractorStep_f32i32) FeatureExtractorStep< BoxDepthDeltaFeature<float, int> >;
+
+%template(SortPixelIndicesStep_i32) SortPixelIndicesStep<int>;
+%template(PixelSamplesStep_f32i32) PixelSamplesStep<float, int>;
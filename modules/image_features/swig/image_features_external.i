@@ -1,8 +1,17 @@
 %module image_features
 %{
     #define SWIG_FILE_WITH_INIT
+    #include "PaddedDepthImages.h"
+    #include "PadDepthImagesStep.h"
+    #include "TiledDepthImages.h"
+    #include "TileDepthImagesStep.h"
     #include "PixelPairGaussianOffsetsStep.h"
     #include "ScaledDepthDeltaFeature.h"
+    #include "IntegralDepthImagesStep.h"
+    #include "BoxPairGaussianOffsetsStep.h"
+    #include "BoxDepthDeltaFeature.h"
+    #include "SortPixelIndicesStep.h"
+    #include "PixelSamplesStep.h"
 %}
 
 %include <exception.i>
@@ -10,5 +19,14 @@
 %import(module="rftk.buffers") "buffers.i"
 %import(module="rftk.pipeline") "pipeline_external.i"
 
+%include "PaddedDepthImages.h"
+%include "PadDepthImagesStep.h"
+%include "TiledDepthImages.h"
+%include "TileDepthImagesStep.h"
 %include "PixelPairGaussianOffsetsStep.h"
 %include "ScaledDepthDeltaFeature.h"
+%include "IntegralDepthImagesStep.h"
+%include "BoxPairGaussianOffsetsStep.h"
+%include "BoxDepthDeltaFeature.h"
+%include "SortPixelIndicesStep.h"
+%include "PixelSamplesStep.h"
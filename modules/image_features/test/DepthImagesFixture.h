@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+
+// ----------------------------------------------------------------------------
+//
+// Shared fixture for the depth image layout and feature tests.  The depth
+// images vary with image, row and column so a wrong probe reads a different
+// depth, and they are added to a collection on the stack under
+// depth_imgs_key.
+//
+// ----------------------------------------------------------------------------
+struct DepthImagesFixture {
+
+    DepthImagesFixture(int numberOfImages, int numberOfRows, int numberOfColumns)
+    : depth_imgs_key("depth_imgs")
+    , pixel_indices_key("pixel_indices")
+    , indices_key("indices")
+    , float_params_key("float_params")
+    , int_params_key("int_params")
+    , depths(numberOfImages, numberOfRows, numberOfColumns)
+    , collection()
+    , stack()
+    {
+        for(int l=0; l<depths.GetL(); l++)
+        {
+            for(int m=0; m<depths.GetM(); m++)
+            {
+                for(int n=0; n<depths.GetN(); n++)
+                {
+                    depths.Set(l, m, n, 1.0f + static_cast<float>((l*31 + m*7 + n*3) % 11) * 0.25f);
+                }
+            }
+        }
+        collection.AddBuffer(depth_imgs_key, depths);
+        stack.Push(&collection);
+    }
+
+    const BufferCollectionKey_t depth_imgs_key;
+    const BufferCollectionKey_t pixel_indices_key;
+    const BufferCollectionKey_t indices_key;
+    const BufferCollectionKey_t float_params_key;
+    const BufferCollectionKey_t int_params_key;
+
+    Tensor3BufferTemplate<float> depths;
+    BufferCollection collection;
+    BufferCollectionStack stack;
+};
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "ImageUtils.h"
+#include "IntegralDepthImagesStep.h"
+#include "BoxPairGaussianOffsetsStep.h"
+#include "BoxDepthDeltaFeature.h"
+#include "FeatureExtractorStep.h"
+#include "DepthImagesFixture.h"
+
+struct BoxDepthDeltaFeatureFixture : public DepthImagesFixture {
+
+    BoxDepthDeltaFeatureFixture()
+    : DepthImagesFixture(2, 6, 9)
+    , number_of_features_key("number_of_features")
+    {
+    }
+
+    double BruteForceBoxMean(int l, int centerM, int centerN, int radiusM, int radiusN) const
+    {
+        ClampPixel<int>(depths.GetM(), depths.GetN(), &centerM, &centerN);
+        const int m0 = std::max(0, centerM - std::abs(radiusM));
+        const int m1 = std::min(depths.GetM() - 1, centerM + std::abs(radiusM));
+        const int n0 = std::max(0, centerN - std::abs(radiusN));
+        const int n1 = std::min(depths.GetN() - 1, centerN + std::abs(radiusN));
+        double sum = 0.0;
+        for(int m=m0; m<=m1; m++)
+        {
+            for(int n=n0; n<=n1; n++)
+            {
+                sum += depths.Get(l, m, n);
+            }
+        }
+        return sum / static_cast<double>((m1 - m0 + 1) * (n1 - n0 + 1));
+    }
+
+    const BufferCollectionKey_t number_of_features_key;
+};
+
+BOOST_FIXTURE_TEST_SUITE( BoxDepthDeltaFeatureTests,  BoxDepthDeltaFeatureFixture)
+
+BOOST_AUTO_TEST_CASE(test_IntegralDepthImagesStep)
+{
+    const IntegralDepthImagesStep<float> integralStep(depth_imgs_key);
+    boost::mt19937 gen(0);
+    BufferCollection treeCollection;
+    integralStep.ProcessStep(stack, treeCollection, gen);
+    BOOST_CHECK(treeCollection.HasBuffer< Tensor3BufferTemplate<double> >(integralStep.IntegralImagesBufferId));
+
+    const Tensor3BufferTemplate<double>& integrals =
+          treeCollection.GetBuffer< Tensor3BufferTemplate<double> >(integralStep.IntegralImagesBufferId);
+    BOOST_CHECK_EQUAL(integrals.GetL(), 2);
+    BOOST_CHECK_EQUAL(integrals.GetM(), 7);
+    BOOST_CHECK_EQUAL(integrals.GetN(), 10);
+
+    for(int l=0; l<depths.GetL(); l++)
+    {
+        for(int m=0; m<=depths.GetM(); m++)
+        {
+            for(int n=0; n<=depths.GetN(); n++)
+            {
+                double expected = 0.0;
+                for(int i=0; i<m; i++)
+                {
+                    for(int j=0; j<n; j++)
+                    {
+                        expected += depths.Get(l, i, j);
+                    }
+                }
+                BOOST_CHECK_CLOSE(integrals.Get(l, m, n) + 1.0, expected + 1.0, 1e-9);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_BoxMeanDepth)
+{
+    const IntegralDepthImagesStep<float> integralStep(depth_imgs_key);
+    boost::mt19937 gen(0);
+    BufferCollection treeCollection;
+    integralStep.ProcessStep(stack, treeCollection, gen);
+    const Tensor3BufferTemplate<double>& integrals =
+          treeCollection.GetBuffer< Tensor3BufferTemplate<double> >(integralStep.IntegralImagesBufferId);
+
+    const int centers[] = {-3, 0, 2, 5, 8, 12};
+    const int radii[] = {0, 1, 3, -2, 20};
+    for(int cm=0; cm<6; cm++)
+    {
+        for(int cn=0; cn<6; cn++)
+        {
+            for(int r=0; r<5; r++)
+            {
+                BOOST_CHECK_CLOSE(BoxMeanDepth<int>(integrals, 1, centers[cm], centers[cn], radii[r], radii[(r+1)%5]),
+                                  BruteForceBoxMean(1, centers[cm], centers[cn], radii[r], radii[(r+1)%5]), 1e-9);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_BoxPairGaussianOffsetsStep)
+{
+    int number_of_features_data[] = {25};
+    collection.AddBuffer(number_of_features_key, VectorBufferTemplate<int>(&number_of_features_data[0], 1));
+    const BoxPairGaussianOffsetsStep<float, int> paramsStep(number_of_features_key, 5.0f, 5.0f, 5.0f, 5.0f, 2.0f);
+    boost::mt19937 gen(0);
+    BufferCollection nodeCollection;
+    paramsStep.ProcessStep(stack, nodeCollection, gen);
+
+    const MatrixBufferTemplate<float>& floatParams =
+          nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(paramsStep.FloatParamsBufferId);
+    const MatrixBufferTemplate<int>& intParams =
+          nodeCollection.GetBuffer< MatrixBufferTemplate<int> >(paramsStep.IntParamsBufferId);
+    BOOST_CHECK_EQUAL(floatParams.GetM(), 25);
+    BOOST_CHECK_EQUAL(floatParams.GetN(), BOX_PAIR_PARAMS_DIM);
+    BOOST_CHECK_EQUAL(intParams.GetM(), 25);
+    BOOST_CHECK_EQUAL(intParams.GetN(), BOX_PAIR_PARAMS_DIM);
+
+    for(int f=0; f<floatParams.GetM(); f++)
+    {
+        for(int p=BOX_RADIUS_U_M_INDEX; p<=BOX_RADIUS_V_N_INDEX; p++)
+        {
+            BOOST_CHECK(floatParams.Get(f, p) >= 0.0f);
+            BOOST_CHECK(floatParams.Get(f, p) <= 2.0f);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_FeatureValue)
+{
+    const IntegralDepthImagesStep<float> integralStep(depth_imgs_key);
+    boost::mt19937 gen(0);
+    BufferCollection treeCollection;
+    integralStep.ProcessStep(stack, treeCollection, gen);
+    BufferCollectionStack treeStack;
+    treeStack.Push(&collection);
+    treeStack.Push(&treeCollection);
+
+    int pixel_indices_data[] = {0,0,0,
+                                0,5,8,
+                                1,2,3,
+                                1,4,6};
+    collection.AddBuffer(pixel_indices_key, MatrixBufferTemplate<int>(&pixel_indices_data[0], 4, 3));
+    int indices_data[] = {3, 0, 2, 1};
+    collection.AddBuffer(indices_key, VectorBufferTemplate<int>(&indices_data[0], 4));
+    float float_params_data[] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+                                 0.0f, 2.0f, -1.0f, -3.0f, 4.0f, 1.0f, 0.0f, 2.0f, 3.0f,
+                                 0.0f, -9.0f, 15.0f, 6.0f, -2.5f, 8.0f, 2.5f, 0.5f, 20.0f};
+    collection.AddBuffer(float_params_key, MatrixBufferTemplate<float>(&float_params_data[0], 3, BOX_PAIR_PARAMS_DIM));
+    collection.AddBuffer(int_params_key, MatrixBufferTemplate<int>(3, BOX_PAIR_PARAMS_DIM));
+
+    BoxDepthDeltaFeature<float, int> feature(float_params_key, int_params_key,
+                                             indices_key, pixel_indices_key,
+                                             depth_imgs_key, integralStep.IntegralImagesBufferId);
+    BoxDepthDeltaFeatureBinding<float, int> featureBinding = feature.Bind(treeStack);
+    BOOST_CHECK_EQUAL(featureBinding.GetNumberOfFeatures(), 3);
+    BOOST_CHECK_EQUAL(featureBinding.GetNumberOfDatapoints(), 4);
+
+    const MatrixBufferTemplate<float> floatParams(&float_params_data[0], 3, BOX_PAIR_PARAMS_DIM);
+    for(int f=0; f<3; f++)
+    {
+        for(int s=0; s<4; s++)
+        {
+            const int index = indices_data[s];
+            const int l = pixel_indices_data[index*3];
+            const int m = pixel_indices_data[index*3+1];
+            const int n = pixel_indices_data[index*3+2];
+            const float scaleByDepth = 2.0f / depths.Get(l, m, n);
+            const double meanU = BruteForceBoxMean(l,
+                                        m + int(scaleByDepth * floatParams.Get(f, BOX_OFFSET_U_M_INDEX)),
+                                        n + int(scaleByDepth * floatParams.Get(f, BOX_OFFSET_U_N_INDEX)),
+                                        int(scaleByDepth * floatParams.Get(f, BOX_RADIUS_U_M_INDEX)),
+                                        int(scaleByDepth * floatParams.Get(f, BOX_RADIUS_U_N_INDEX)));
+            const double meanV = BruteForceBoxMean(l,
+                                        m + int(scaleByDepth * floatParams.Get(f, BOX_OFFSET_V_M_INDEX)),
+                                        n + int(scaleByDepth * floatParams.Get(f, BOX_OFFSET_V_N_INDEX)),
+                                        int(scaleByDepth * floatParams.Get(f, BOX_RADIUS_V_M_INDEX)),
+                                        int(scaleByDepth * floatParams.Get(f, BOX_RADIUS_V_N_INDEX)));
+            BOOST_CHECK_SMALL(featureBinding.FeatureValue(f, s) - static_cast<float>(meanU - meanV), 1e-5f);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_FeatureExtractorStep)
+{
+    const IntegralDepthImagesStep<float> integralStep(depth_imgs_key);
+    boost::mt19937 gen(0);
+    BufferCollection treeCollection;
+    integralStep.ProcessStep(stack, treeCollection, gen);
+    BufferCollectionStack treeStack;
+    treeStack.Push(&collection);
+    treeStack.Push(&treeCollection);
+
+    int pixel_indices_data[] = {0,1,1,
+                                1,3,7};
+    collection.AddBuffer(pixel_indices_key, MatrixBufferTemplate<int>(&pixel_indices_data[0], 2, 3));
+    int indices_data[] = {0, 1};
+    collection.AddBuffer(indices_key, VectorBufferTemplate<int>(&indices_data[0], 2));
+    int number_of_features_data[] = {10};
+    collection.AddBuffer(number_of_features_key, VectorBufferTemplate<int>(&number_of_features_data[0], 1));
+
+    const BoxPairGaussianOffsetsStep<float, int> paramsStep(number_of_features_key, 3.0f, 3.0f, 3.0f, 3.0f, 2.0f);
+    BufferCollection nodeCollection;
+    paramsStep.ProcessStep(treeStack, nodeCollection, gen);
+    BufferCollectionStack nodeStack;
+    nodeStack.Push(&collection);
+    nodeStack.Push(&treeCollection);
+    nodeStack.Push(&nodeCollection);
+
+    BoxDepthDeltaFeature<float, int> feature(paramsStep.FloatParamsBufferId, paramsStep.IntParamsBufferId,
+                                             indices_key, pixel_indices_key,
+                                             depth_imgs_key, integralStep.IntegralImagesBufferId);
+    const FeatureExtractorStep< BoxDepthDeltaFeature<float, int> > extractor(feature, FEATURES_BY_DATAPOINTS);
+    extractor.ProcessStep(nodeStack, nodeCollection, gen);
+
+    const MatrixBufferTemplate<float>& featureValues =
+          nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(extractor.FeatureValuesBufferId);
+    BOOST_CHECK_EQUAL(featureValues.GetM(), 10);
+    BOOST_CHECK_EQUAL(featureValues.GetN(), 2);
+
+    BoxDepthDeltaFeatureBinding<float, int> featureBinding = feature.Bind(nodeStack);
+    for(int f=0; f<10; f++)
+    {
+        for(int s=0; s<2; s++)
+        {
+            BOOST_CHECK_EQUAL(featureValues.Get(f, s), featureBinding.FeatureValue(f, s));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,138 @@
+#include <boost/test/unit_test.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "ImageUtils.h"
+#include "PaddedDepthImages.h"
+#include "PadDepthImagesStep.h"
+#include "ScaledDepthDeltaFeature.h"
+#include "FeatureExtractorStep.h"
+#include "DepthImagesFixture.h"
+
+struct PaddedDepthImagesFixture : public DepthImagesFixture {
+
+    PaddedDepthImagesFixture()
+    : DepthImagesFixture(2, 5, 7)
+    , padded_depth_imgs_key("padded_depth_imgs")
+    {
+    }
+
+    const BufferCollectionKey_t padded_depth_imgs_key;
+};
+
+BOOST_FIXTURE_TEST_SUITE( PaddedDepthImagesTests,  PaddedDepthImagesFixture)
+
+BOOST_AUTO_TEST_CASE(test_Get_replicates_border)
+{
+    const int pad = 3;
+    const PaddedDepthImagesTemplate<float> padded(depths, pad);
+    BOOST_CHECK_EQUAL(padded.GetL(), 2);
+    BOOST_CHECK_EQUAL(padded.GetM(), 5);
+    BOOST_CHECK_EQUAL(padded.GetN(), 7);
+    BOOST_CHECK_EQUAL(padded.GetPad(), pad);
+    BOOST_CHECK_EQUAL(padded.GetRowStride(), 7 + 2*pad);
+
+    for(int l=0; l<depths.GetL(); l++)
+    {
+        for(int m=-pad; m<depths.GetM()+pad; m++)
+        {
+            for(int n=-pad; n<depths.GetN()+pad; n++)
+            {
+                int clampedM = m;
+                int clampedN = n;
+                ClampPixel<int>(depths.GetM(), depths.GetN(), &clampedM, &clampedN);
+                BOOST_CHECK_EQUAL(padded.Get(l, m, n), depths.Get(l, clampedM, clampedN));
+                BOOST_CHECK_EQUAL(padded.GetOriginPtrUnsafe(l)[m*padded.GetRowStride() + n], depths.Get(l, clampedM, clampedN));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_PixelDepthDelta_matches_unpadded)
+{
+    const PaddedDepthImagesTemplate<float> padded(depths, 2);
+    const float offsets[] = {0.0f, 0.6f, -1.3f, 2.1f, -4.4f, 9.0f, -15.0f};
+    const int numberOfOffsets = sizeof(offsets) / sizeof(offsets[0]);
+
+    for(int m=0; m<depths.GetM(); m++)
+    {
+        for(int n=0; n<depths.GetN(); n++)
+        {
+            for(int u=0; u<numberOfOffsets; u++)
+            {
+                for(int v=0; v<numberOfOffsets; v++)
+                {
+                    const float expected = PixelDepthDelta<float, int>(depths, 1, m, n, offsets[u], offsets[v], offsets[v], -offsets[u]);
+                    const float actual = PixelDepthDelta<float, int>(padded, 1, m, n, offsets[u], offsets[v], offsets[v], -offsets[u]);
+                    BOOST_CHECK_EQUAL(actual, expected);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_PadDepthImagesStep)
+{
+    const PadDepthImagesStep<float> padStep(depth_imgs_key, 4);
+    BOOST_CHECK(!collection.HasBuffer< PaddedDepthImagesTemplate<float> >(padStep.PaddedDepthImagesBufferId));
+
+    boost::mt19937 gen(0);
+    BufferCollection treeCollection;
+    padStep.ProcessStep(stack, treeCollection, gen);
+    BOOST_CHECK(treeCollection.HasBuffer< PaddedDepthImagesTemplate<float> >(padStep.PaddedDepthImagesBufferId));
+
+    const PaddedDepthImagesTemplate<float>& padded =
+          treeCollection.GetBuffer< PaddedDepthImagesTemplate<float> >(padStep.PaddedDepthImagesBufferId);
+    BOOST_CHECK_EQUAL(padded.GetPad(), 4);
+    BOOST_CHECK_EQUAL(padded.Get(1, -4, 10), depths.Get(1, 0, 6));
+}
+
+BOOST_AUTO_TEST_CASE(test_FeatureValues_padded_matches_unpadded)
+{
+    BufferCollection paddedCollection;
+    paddedCollection.AddBuffer(padded_depth_imgs_key, PaddedDepthImagesTemplate<float>(depths, 2));
+    BufferCollectionStack paddedStack;
+    paddedStack.Push(&paddedCollection);
+    paddedStack.Push(&collection);
+
+    int pixel_indices_data[] = {0,0,0,
+                                0,4,6,
+                                1,2,3,
+                                1,0,5,
+                                1,4,1};
+    collection.AddBuffer(pixel_indices_key, MatrixBufferTemplate<int>(&pixel_indices_data[0], 5, 3));
+    int indices_data[] = {4, 0, 3, 1, 2};
+    collection.AddBuffer(indices_key, VectorBufferTemplate<int>(&indices_data[0], 5));
+    float float_params_data[] = {0.0, -0.5, 0.0, 2.0, 0.0,
+                                 0.0, 2.0, 1.0, -2.0, -1.0,
+                                 0.0, 9.0, -7.5, -12.0, 30.0};
+    collection.AddBuffer(float_params_key, MatrixBufferTemplate<float>(&float_params_data[0], 3, 5));
+    collection.AddBuffer(int_params_key, MatrixBufferTemplate<int>(3, 5));
+
+    ScaledDepthDeltaFeature<float, int> feature(float_params_key, int_params_key,
+                                                indices_key, pixel_indices_key,
+                                                depth_imgs_key);
+    ScaledDepthDeltaFeatureBinding<float, int> featureBinding = feature.Bind(stack);
+
+    ScaledDepthDeltaFeature<float, int, PaddedDepthImagesTemplate<float> > paddedFeature(float_params_key, int_params_key,
+                                                                                        indices_key, pixel_indices_key,
+                                                                                        padded_depth_imgs_key);
+    ScaledDepthDeltaFeatureBinding<float, int, PaddedDepthImagesTemplate<float> > paddedFeatureBinding = paddedFeature.Bind(paddedStack);
+
+    MatrixBufferTemplate<float> featureValues(3, 5);
+    paddedFeatureBinding.FeatureValues(0, 5, FEATURES_BY_DATAPOINTS, featureValues);
+
+    for(int f=0; f<3; f++)
+    {
+        for(int s=0; s<5; s++)
+        {
+            BOOST_CHECK_EQUAL(paddedFeatureBinding.FeatureValue(f, s), featureBinding.FeatureValue(f, s));
+            BOOST_CHECK_EQUAL(featureValues.Get(f, s), featureBinding.FeatureValue(f, s));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
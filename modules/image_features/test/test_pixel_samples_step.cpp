@@ -0,0 +1,137 @@
+#include <boost/test/unit_test.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PixelSamplesStep.h"
+
+
+struct PixelSamplesStepFixture {
+
+    PixelSamplesStepFixture()
+    : depth_imgs_key("depth_imgs")
+    , class_imgs_key("class_imgs")
+    , depths(3, 8, 10)
+    , classes(3, 8, 10)
+    , collection()
+    , stack()
+    {
+        for(int l=0; l<depths.GetL(); l++)
+        {
+            for(int m=0; m<depths.GetM(); m++)
+            {
+                for(int n=0; n<depths.GetN(); n++)
+                {
+                    depths.Set(l, m, n, 1.0f + 0.1f * static_cast<float>(m+n));
+                    // A single pixel of class 2 and everything else class 1
+                    classes.Set(l, m, n, (m == 3 && n == 4) ? 2 : 1);
+                }
+            }
+            // Invalid pixels
+            depths.Set(l, 0, 0, 0.0f);
+            classes.Set(l, 0, 1, -1);
+        }
+        // The last image has no valid pixels
+        for(int m=0; m<depths.GetM(); m++)
+        {
+            for(int n=0; n<depths.GetN(); n++)
+            {
+                classes.Set(2, m, n, -1);
+            }
+        }
+        collection.AddBuffer(depth_imgs_key, depths);
+        collection.AddBuffer(class_imgs_key, classes);
+        stack.Push(&collection);
+    }
+
+    ~PixelSamplesStepFixture()
+    {
+    }
+
+    const BufferCollectionKey_t depth_imgs_key;
+    const BufferCollectionKey_t class_imgs_key;
+
+    Tensor3BufferTemplate<float> depths;
+    Tensor3BufferTemplate<int> classes;
+    BufferCollection collection;
+    BufferCollectionStack stack;
+};
+
+BOOST_FIXTURE_TEST_SUITE( PixelSamplesStepTests,  PixelSamplesStepFixture)
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep)
+{
+    const int pixelsPerImage = 50;
+    const PixelSamplesStep<float, int> sampleStep(depth_imgs_key, class_imgs_key, pixelsPerImage, false);
+    boost::mt19937 gen(0);
+    BufferCollection treeCollection;
+    sampleStep.ProcessStep(stack, treeCollection, gen);
+
+    const MatrixBufferTemplate<int>& pixelIndices =
+          treeCollection.GetBuffer< MatrixBufferTemplate<int> >(sampleStep.PixelIndicesBufferId);
+    const VectorBufferTemplate<int>& sampledClasses =
+          treeCollection.GetBuffer< VectorBufferTemplate<int> >(sampleStep.ClassesBufferId);
+    const VectorBufferTemplate<int>& indices =
+          treeCollection.GetBuffer< VectorBufferTemplate<int> >(sampleStep.IndicesBufferId);
+    const VectorBufferTemplate<float>& weights =
+          treeCollection.GetBuffer< VectorBufferTemplate<float> >(sampleStep.WeightsBufferId);
+
+    const int numberOfSamples = indices.GetN();
+    BOOST_CHECK_EQUAL(pixelIndices.GetM(), numberOfSamples);
+    BOOST_CHECK_EQUAL(pixelIndices.GetN(), 3);
+    BOOST_CHECK_EQUAL(sampledClasses.GetN(), numberOfSamples);
+    BOOST_CHECK_EQUAL(weights.GetN(), numberOfSamples);
+
+    float totalWeight[3] = {0.0f, 0.0f, 0.0f};
+    for(int i=0; i<numberOfSamples; i++)
+    {
+        BOOST_CHECK_EQUAL(indices.Get(i), i);
+        const int l = pixelIndices.Get(i, 0);
+        const int m = pixelIndices.Get(i, 1);
+        const int n = pixelIndices.Get(i, 2);
+        BOOST_CHECK(depths.Get(l, m, n) > 0.0f);
+        BOOST_CHECK(classes.Get(l, m, n) >= 0);
+        BOOST_CHECK_EQUAL(sampledClasses.Get(i), classes.Get(l, m, n));
+        BOOST_CHECK(weights.Get(i) >= 1.0f);
+        totalWeight[l] += weights.Get(i);
+
+        // Distinct pixels in (image, row, column) order
+        if(i > 0)
+        {
+            const int previous = (pixelIndices.Get(i-1, 0)*depths.GetM() + pixelIndices.Get(i-1, 1))*depths.GetN() + pixelIndices.Get(i-1, 2);
+            BOOST_CHECK(previous < (l*depths.GetM() + m)*depths.GetN() + n);
+        }
+    }
+    BOOST_CHECK_EQUAL(totalWeight[0], pixelsPerImage);
+    BOOST_CHECK_EQUAL(totalWeight[1], pixelsPerImage);
+    BOOST_CHECK_EQUAL(totalWeight[2], 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_class_balanced)
+{
+    const int pixelsPerImage = 400;
+    const PixelSamplesStep<float, int> sampleStep(depth_imgs_key, class_imgs_key, pixelsPerImage, true);
+    boost::mt19937 gen(0);
+    BufferCollection treeCollection;
+    sampleStep.ProcessStep(stack, treeCollection, gen);
+
+    const VectorBufferTemplate<int>& sampledClasses =
+          treeCollection.GetBuffer< VectorBufferTemplate<int> >(sampleStep.ClassesBufferId);
+    const VectorBufferTemplate<float>& weights =
+          treeCollection.GetBuffer< VectorBufferTemplate<float> >(sampleStep.WeightsBufferId);
+
+    // The single class 2 pixel gets about half of the draws of each image
+    float classWeight[3] = {0.0f, 0.0f, 0.0f};
+    for(int i=0; i<sampledClasses.GetN(); i++)
+    {
+        classWeight[sampledClasses.Get(i)] += weights.Get(i);
+    }
+    BOOST_CHECK_EQUAL(classWeight[0], 0.0f);
+    BOOST_CHECK_EQUAL(classWeight[1] + classWeight[2], 2.0f * pixelsPerImage);
+    BOOST_CHECK(classWeight[2] > 0.4f * 2.0f * pixelsPerImage);
+    BOOST_CHECK(classWeight[2] < 0.6f * 2.0f * pixelsPerImage);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,7 @@
 #include "BufferCollection.h"
 #include "BufferCollectionStack.h"
 #include "ScaledDepthDeltaFeature.h"
+#include "FeatureExtractorStep.h"
 
 
 struct ScaledDepthDeltaFeatureFixture {
@@ -131,4 +132,41 @@ BOOST_AUTO_TEST_CASE(test_FeatureValue_scales)
 }
 
 
+BOOST_AUTO_TEST_CASE(test_FeatureValues_batched)
+{
+    float scales_data[] = {0.5, 2.0,
+                          0.5, 2.0,
+                          1.0, 1.0,
+                          0.5, 2.0};
+    collection.AddBuffer(scales_key, MatrixBufferTemplate<float>(&scales_data[0], 4, 2));
+    float float_params_data[] = {0.0, -0.5, 0.0, 2.0, 0.0,
+                                 0.0, 2.0, 1.0, -2.0, -1.0,
+                                 0.0, 9.0, -7.5, -12.0, 30.0};
+    collection.AddBuffer(float_params_key, MatrixBufferTemplate<float>(&float_params_data[0], 3, 5));
+    int int_params_data[] = {-1,-1,-1,-1,-1,
+                             -1,-1,-1,-1,-1,
+                             -1,-1,-1,-1,-1};
+    collection.AddBuffer(int_params_key, MatrixBufferTemplate<int>(&int_params_data[0], 3, 5));
+
+    ScaledDepthDeltaFeature_t feature(  float_params_key, int_params_key,
+                                        indices_key, pixel_indices_key,
+                                        depth_imgs_key, scales_key);
+    ScaledDepthDeltaFeatureBinding_t featureBinding = feature.Bind(stack);
+
+    MatrixBufferTemplate<float> featuresByDatapoints(3, 4);
+    featureBinding.FeatureValues(0, 4, FEATURES_BY_DATAPOINTS, featuresByDatapoints);
+    MatrixBufferTemplate<float> datapointsByFeatures(4, 3);
+    featureBinding.FeatureValues(0, 4, DATAPOINTS_BY_FEATURES, datapointsByFeatures);
+
+    for(int f=0; f<3; f++)
+    {
+        for(int s=0; s<4; s++)
+        {
+            BOOST_CHECK_EQUAL(featuresByDatapoints.Get(f, s), featureBinding.FeatureValue(f, s));
+            BOOST_CHECK_EQUAL(datapointsByFeatures.Get(s, f), featureBinding.FeatureValue(f, s));
+        }
+    }
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,44 @@
+#include <boost/test/unit_test.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "SortPixelIndicesStep.h"
+
+BOOST_AUTO_TEST_SUITE( SortPixelIndicesStepTests )
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep)
+{
+    const BufferCollectionKey_t pixel_indices_key("pixel_indices");
+    const BufferCollectionKey_t indices_key("indices");
+
+    int pixel_indices_data[] = {1,0,5,
+                                0,4,6,
+                                1,2,3,
+                                0,0,7,
+                                1,0,2,
+                                0,4,6};
+    int indices_data[] = {0, 5, 2, 1, 3, 4, 2};
+    int expected_data[] = {3, 5, 1, 4, 0, 2, 2};
+
+    BufferCollection collection;
+    collection.AddBuffer(pixel_indices_key, MatrixBufferTemplate<int>(&pixel_indices_data[0], 6, 3));
+    collection.AddBuffer(indices_key, VectorBufferTemplate<int>(&indices_data[0], 7));
+    BufferCollectionStack stack;
+    stack.Push(&collection);
+
+    const SortPixelIndicesStep<int> sortStep(indices_key, pixel_indices_key);
+    boost::mt19937 gen(0);
+    BufferCollection treeCollection;
+    sortStep.ProcessStep(stack, treeCollection, gen);
+
+    const VectorBufferTemplate<int>& sortedIndices =
+          treeCollection.GetBuffer< VectorBufferTemplate<int> >(sortStep.IndicesBufferId);
+    BOOST_CHECK(sortedIndices == VectorBufferTemplate<int>(&expected_data[0], 7));
+
+    // The input indices are not modified
+    BOOST_CHECK(collection.GetBuffer< VectorBufferTemplate<int> >(indices_key) == VectorBufferTemplate<int>(&indices_data[0], 7));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
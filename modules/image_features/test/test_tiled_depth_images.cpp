@@ -0,0 +1,142 @@
+#include <boost/test/unit_test.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "ImageUtils.h"
+#include "TiledDepthImages.h"
+#include "TileDepthImagesStep.h"
+#include "ScaledDepthDeltaFeature.h"
+#include "FeatureExtractorStep.h"
+#include "DepthImagesFixture.h"
+
+struct TiledDepthImagesFixture : public DepthImagesFixture {
+
+    TiledDepthImagesFixture()
+    : DepthImagesFixture(2, 11, 19)
+    , tiled_depth_imgs_key("tiled_depth_imgs")
+    {
+    }
+
+    const BufferCollectionKey_t tiled_depth_imgs_key;
+};
+
+BOOST_FIXTURE_TEST_SUITE( TiledDepthImagesTests,  TiledDepthImagesFixture)
+
+BOOST_AUTO_TEST_CASE(test_Get)
+{
+    const TiledDepthImagesTemplate<float> tiled(depths);
+    BOOST_CHECK_EQUAL(tiled.GetL(), 2);
+    BOOST_CHECK_EQUAL(tiled.GetM(), 11);
+    BOOST_CHECK_EQUAL(tiled.GetN(), 19);
+
+    for(int l=0; l<depths.GetL(); l++)
+    {
+        for(int m=0; m<depths.GetM(); m++)
+        {
+            for(int n=0; n<depths.GetN(); n++)
+            {
+                BOOST_CHECK_EQUAL(tiled.Get(l, m, n), depths.Get(l, m, n));
+                BOOST_CHECK_EQUAL(tiled.GetImagePtrUnsafe(l)[tiled.GetPixelOffset(m, n)], depths.Get(l, m, n));
+            }
+        }
+    }
+    BOOST_CHECK(tiled.AsRowMajor() == depths);
+}
+
+BOOST_AUTO_TEST_CASE(test_GetPixelOffset_tiles)
+{
+    const TiledDepthImagesTemplate<float> tiled(depths);
+    const int tileSize = TiledDepthImagesTemplate<float>::TILE_SIZE;
+    // pixels of a tile are consecutive and tiles are stored row by row
+    BOOST_CHECK_EQUAL(tiled.GetPixelOffset(0, 1), 1);
+    BOOST_CHECK_EQUAL(tiled.GetPixelOffset(1, 0), tileSize);
+    BOOST_CHECK_EQUAL(tiled.GetPixelOffset(0, tileSize), tileSize*tileSize);
+    BOOST_CHECK_EQUAL(tiled.GetPixelOffset(tileSize, 0), 3*tileSize*tileSize);
+}
+
+BOOST_AUTO_TEST_CASE(test_PixelDepthDelta_matches_row_major)
+{
+    const TiledDepthImagesTemplate<float> tiled(depths);
+    const float offsets[] = {0.0f, 0.6f, -1.3f, 2.1f, -4.4f, 9.0f, -15.0f};
+    const int numberOfOffsets = sizeof(offsets) / sizeof(offsets[0]);
+
+    for(int m=0; m<depths.GetM(); m++)
+    {
+        for(int n=0; n<depths.GetN(); n++)
+        {
+            for(int u=0; u<numberOfOffsets; u++)
+            {
+                for(int v=0; v<numberOfOffsets; v++)
+                {
+                    const float expected = PixelDepthDelta<float, int>(depths, 1, m, n, offsets[u], offsets[v], offsets[v], -offsets[u]);
+                    const float actual = PixelDepthDelta<float, int>(tiled, 1, m, n, offsets[u], offsets[v], offsets[v], -offsets[u]);
+                    BOOST_CHECK_EQUAL(actual, expected);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_TileDepthImagesStep)
+{
+    const TileDepthImagesStep<float> tileStep(depth_imgs_key);
+
+    boost::mt19937 gen(0);
+    BufferCollection treeCollection;
+    tileStep.ProcessStep(stack, treeCollection, gen);
+    BOOST_CHECK(treeCollection.HasBuffer< TiledDepthImagesTemplate<float> >(tileStep.TiledDepthImagesBufferId));
+
+    const TiledDepthImagesTemplate<float>& tiled =
+          treeCollection.GetBuffer< TiledDepthImagesTemplate<float> >(tileStep.TiledDepthImagesBufferId);
+    BOOST_CHECK(tiled.AsRowMajor() == depths);
+}
+
+BOOST_AUTO_TEST_CASE(test_FeatureValues_tiled_matches_row_major)
+{
+    BufferCollection tiledCollection;
+    tiledCollection.AddBuffer(tiled_depth_imgs_key, TiledDepthImagesTemplate<float>(depths));
+    BufferCollectionStack tiledStack;
+    tiledStack.Push(&tiledCollection);
+    tiledStack.Push(&collection);
+
+    int pixel_indices_data[] = {0,0,0,
+                                0,10,18,
+                                1,8,9,
+                                1,0,16,
+                                1,7,1};
+    collection.AddBuffer(pixel_indices_key, MatrixBufferTemplate<int>(&pixel_indices_data[0], 5, 3));
+    int indices_data[] = {4, 0, 3, 1, 2};
+    collection.AddBuffer(indices_key, VectorBufferTemplate<int>(&indices_data[0], 5));
+    float float_params_data[] = {0.0, -0.5, 0.0, 2.0, 0.0,
+                                 0.0, 2.0, 1.0, -2.0, -1.0,
+                                 0.0, 9.0, -7.5, -12.0, 30.0};
+    collection.AddBuffer(float_params_key, MatrixBufferTemplate<float>(&float_params_data[0], 3, 5));
+    collection.AddBuffer(int_params_key, MatrixBufferTemplate<int>(3, 5));
+
+    ScaledDepthDeltaFeature<float, int> feature(float_params_key, int_params_key,
+                                                indices_key, pixel_indices_key,
+                                                depth_imgs_key);
+    ScaledDepthDeltaFeatureBinding<float, int> featureBinding = feature.Bind(stack);
+
+    ScaledDepthDeltaFeature<float, int, TiledDepthImagesTemplate<float> > tiledFeature(float_params_key, int_params_key,
+                                                                                      indices_key, pixel_indices_key,
+                                                                                      tiled_depth_imgs_key);
+    ScaledDepthDeltaFeatureBinding<float, int, TiledDepthImagesTemplate<float> > tiledFeatureBinding = tiledFeature.Bind(tiledStack);
+
+    MatrixBufferTemplate<float> featureValues(3, 5);
+    tiledFeatureBinding.FeatureValues(0, 5, FEATURES_BY_DATAPOINTS, featureValues);
+
+    for(int f=0; f<3; f++)
+    {
+        for(int s=0; s<5; s++)
+        {
+            BOOST_CHECK_EQUAL(tiledFeatureBinding.FeatureValue(f, s), featureBinding.FeatureValue(f, s));
+            BOOST_CHECK_EQUAL(featureValues.Get(f, s), featureBinding.FeatureValue(f, s));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,15 @@
 #include <boost/random/mersenne_twister.hpp>
 
 #include <limits>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#if USE_BOOST_THREAD
+#include <boost/thread.hpp>
+#include <boost/ref.hpp>
+#include <boost/make_shared.hpp>
+#endif
 
 #include "VectorBuffer.h"
 #include "MatrixBuffer.h"
@@ -14,8 +23,24 @@
 #include "PipelineStepI.h"
 #include "SplitSelectorI.h"
 #include "TreeLearnerI.h"
+#include "SubtreeQueue.h"
+#include "TreeIndices.h"
+#include "NodeHistograms.h"
+#include "PresortedIndices.h"
+#include "RunningJobs.h"
 
 
+// ----------------------------------------------------------------------------
+//
+// DepthFirstTreeLearner grows a tree by processing nodes and pushing the
+// children of each split as subtree tasks.  With numberOfSubtreeJobs > 1 the
+// tasks are shared by that many jobs so a single tree can use several cores.
+// Every node draws from its own random stream seeded by its parent so the
+// learned tree does not depend on the number of jobs (only the order node
+// indices are allocated in does).  The samples of all nodes are ranges of
+// one permutation per tree (see TreeIndices).
+//
+// ----------------------------------------------------------------------------
 template <class FloatType, class IntType>
 class DepthFirstTreeLearner: public TreeLearnerI
 {
@@ -23,37 +48,46 @@ public:
     DepthFirstTreeLearner( const TrySplitCriteriaI* trySplitCriteria,
                             const PipelineStepI* treeSteps,
                             const PipelineStepI* nodeSteps,
-                            const SplitSelectorI<FloatType, IntType>* splitSelector);
+                            const SplitSelectorI<FloatType, IntType>* splitSelector,
+                            int numberOfSubtreeJobs=1 );
     DepthFirstTreeLearner(const DepthFirstTreeLearner<FloatType, IntType> & other);
 
     virtual ~DepthFirstTreeLearner();
 
     virtual TreeLearnerI* Clone() const;
-    virtual void Learn( const BufferCollection& data, Tree& tree, unsigned int seed ) const;
+    using TreeLearnerI::Learn;
+    virtual void Learn( const BufferCollectionStack& data, Tree& tree, unsigned int seed ) const;
 
 private:
-    void ProcessNode( boost::mt19937& gen,
+    void ProcessSubtrees( const BufferCollectionStack& treeStack,
+                          Tree& tree,
+                          TreeIndices<IntType>* treeIndices,
+                          SubtreeQueue<FloatType, IntType>* queue ) const;
+
+    void ProcessNode( const SubtreeTask<FloatType, IntType>& task,
                       Tree& tree,
+                      TreeIndices<IntType>* treeIndices,
                       BufferCollectionStack& stack,
-                      IntType nodeIndex,
-                      IntType depth,
-                      FloatType nodeSize ) const;
+                      SubtreeQueue<FloatType, IntType>* queue ) const;
 
     const TrySplitCriteriaI* mTrySplitCriteria;
     const PipelineStepI* mTreeSteps;
     const PipelineStepI* mNodeSteps;
     const SplitSelectorI<FloatType, IntType>* mSplitSelector;
+    const int mNumberOfSubtreeJobs;
 };
 
 template <class FloatType, class IntType>
 DepthFirstTreeLearner<FloatType, IntType>::DepthFirstTreeLearner( const TrySplitCriteriaI* trySplitCriteria,
                                                                   const PipelineStepI* treeSteps,
                                                                   const PipelineStepI* nodeSteps,
-                                                                  const SplitSelectorI<FloatType, IntType>* splitSelector)
+                                                                  const SplitSelectorI<FloatType, IntType>* splitSelector,
+                                                                  int numberOfSubtreeJobs )
 : mTrySplitCriteria( trySplitCriteria->Clone() )
 , mTreeSteps( treeSteps->Clone() )
 , mNodeSteps( nodeSteps->Clone() )
 , mSplitSelector( splitSelector->Clone() )
+, mNumberOfSubtreeJobs( numberOfSubtreeJobs )
 {}
 
 template <class FloatType, class IntType>
@@ -62,6 +96,7 @@ DepthFirstTreeLearner<FloatType, IntType>::DepthFirstTreeLearner(const DepthFirs
 , mTreeSteps( other.mTreeSteps->Clone() )
 , mNodeSteps( other.mNodeSteps->Clone() )
 , mSplitSelector( other.mSplitSelector->Clone() )
+, mNumberOfSubtreeJobs( other.mNumberOfSubtreeJobs )
 {
 }
 
@@ -83,42 +118,101 @@ TreeLearnerI* DepthFirstTreeLearner<FloatType, IntType>::Clone() const
 
 
 template <class FloatType, class IntType>
-void DepthFirstTreeLearner<FloatType, IntType>::Learn( const BufferCollection& data, Tree& tree, unsigned int seed ) const
+void DepthFirstTreeLearner<FloatType, IntType>::Learn( const BufferCollectionStack& data, Tree& tree, unsigned int seed ) const
 {
     boost::mt19937 gen;
     gen.seed(seed);
 
-    BufferCollectionStack stack;
-    stack.Push(&data);
+    BufferCollectionStack treeStack(data);
     BufferCollection treeData;
-    stack.Push(&treeData);
-    mTreeSteps->ProcessStep(stack, treeData, gen);
-
-    //emptyIndicesCollection is pushed so subsequent leftIndicesBufCol and rightIndicesBufCol
-    //can be popped before adding the next layer down
-    BufferCollection emptyIndicesCollection;
-    stack.Push(&emptyIndicesCollection);
-    ProcessNode(gen, tree, stack, 0, 0, std::numeric_limits<FloatType>::max());
+    treeStack.Push(&treeData);
+    mTreeSteps->ProcessStep(treeStack, treeData, gen);
+
+    // The root reads the indices written by the tree steps and inherits no
+    // buffers
+    TreeIndices<IntType> treeIndices;
+    SubtreeQueue<FloatType, IntType> queue;
+    queue.Push( SubtreeTask<FloatType, IntType>(0, 0, std::numeric_limits<FloatType>::max(), gen(), 0, 0,
+                                                boost::shared_ptr<BufferCollection>()) );
+
+#if USE_BOOST_THREAD
+    if( mNumberOfSubtreeJobs > 1 )
+    {
+        AddRunningJobs(mNumberOfSubtreeJobs - 1);
+        std::vector< boost::shared_ptr< boost::thread > > threadVec;
+        for(int job=0; job<mNumberOfSubtreeJobs; job++)
+        {
+            threadVec.push_back( boost::make_shared<boost::thread>(&DepthFirstTreeLearner<FloatType, IntType>::ProcessSubtrees, this,
+                                                                   boost::cref(treeStack), boost::ref(tree),
+                                                                   &treeIndices, &queue) );
+        }
+        for(int job=0; job<mNumberOfSubtreeJobs; job++)
+        {
+            threadVec[job]->join();
+        }
+        RemoveRunningJobs(mNumberOfSubtreeJobs - 1);
+        return;
+    }
+#endif
+    ProcessSubtrees(treeStack, tree, &treeIndices, &queue);
 }
 
 template <class FloatType, class IntType>
-void DepthFirstTreeLearner<FloatType, IntType>::ProcessNode( boost::mt19937& gen,
-                                                              Tree& tree, BufferCollectionStack& stack,
-                                                              IntType nodeIndex,
-                                                              IntType depth,
-                                                              FloatType nodeSize ) const
+void DepthFirstTreeLearner<FloatType, IntType>::ProcessSubtrees( const BufferCollectionStack& treeStack,
+                                                                  Tree& tree,
+                                                                  TreeIndices<IntType>* treeIndices,
+                                                                  SubtreeQueue<FloatType, IntType>* queue ) const
 {
-    if(mTrySplitCriteria->TrySplit(depth, nodeSize))
+    // Every node this job processes copies its indices into the same buffer
+    BufferCollection nodeIndices;
+    SubtreeTask<FloatType, IntType> task;
+    while(queue->Pop(task))
     {
+        BufferCollectionStack stack(treeStack);
+        if( task.mInherited )
+        {
+            stack.Push(task.mInherited.get());
+        }
+        // The root reads the indices written by the tree steps
+        if( task.mNodeIndex != 0 )
+        {
+            treeIndices->SetNodeIndices(nodeIndices, task.mBegin, task.mEnd);
+            stack.Push(&nodeIndices);
+        }
+        ProcessNode(task, tree, treeIndices, stack, queue);
+
+        // Release the inherited buffers before waiting on the next task
+        task = SubtreeTask<FloatType, IntType>();
+        queue->Done();
+    }
+}
+
+template <class FloatType, class IntType>
+void DepthFirstTreeLearner<FloatType, IntType>::ProcessNode( const SubtreeTask<FloatType, IntType>& task,
+                                                              Tree& tree,
+                                                              TreeIndices<IntType>* treeIndices,
+                                                              BufferCollectionStack& stack,
+                                                              SubtreeQueue<FloatType, IntType>* queue ) const
+{
+    const IntType nodeIndex = task.mNodeIndex;
+    const IntType depth = task.mDepth;
+    if(mTrySplitCriteria->TrySplit(depth, task.mNodeSize))
+    {
+        boost::mt19937 gen;
+        gen.seed(task.mSeed);
+
         bool doSplit = false;
-        BufferCollection leftIndicesBufCol;
-        BufferCollection rightIndicesBufCol;
+        boost::shared_ptr<BufferCollection> leftInherited;
+        boost::shared_ptr<BufferCollection> rightInherited;
         FloatType leftSize = std::numeric_limits<FloatType>::min();
         FloatType rightSize = std::numeric_limits<FloatType>::min();
         IntType leftNodeIndex = -1;
         IntType rightNodeIndex = -1;
+        IntType split = task.mBegin;
+        IntType end = task.mBegin;
+        bool inheritedHistograms = false;
 
-        // Using a nested block so memory is freed before recursing
+        // Using a nested block so memory is freed before pushing the children
         {
             BufferCollection nodeData;
             stack.Push(&nodeData);
@@ -127,31 +221,59 @@ void DepthFirstTreeLearner<FloatType, IntType>::ProcessNode( boost::mt19937& gen
             doSplit = selectorInfo.ValidSplit();
             if(doSplit)
             {
-                leftNodeIndex = tree.NextNodeIndex();
-                rightNodeIndex = tree.NextNodeIndex();
+                {
+#if USE_BOOST_THREAD
+                    boost::mutex::scoped_lock lock(queue->GetTreeMutex());
+#endif
+                    leftNodeIndex = tree.NextNodeIndex();
+                    rightNodeIndex = tree.NextNodeIndex();
 
-                selectorInfo.WriteToTree( nodeIndex, leftNodeIndex, rightNodeIndex,
-                                          tree.mCounts, tree.mDepths, tree.mFloatFeatureParams, tree.mIntFeatureParams, tree.mYs);
+                    selectorInfo.WriteToTree( nodeIndex, leftNodeIndex, rightNodeIndex,
+                                              tree.mCounts, tree.mDepths, tree.mFloatFeatureParams, tree.mIntFeatureParams, tree.mYs);
 
-                tree.mPath.Set(nodeIndex, 0, leftNodeIndex);
-                tree.mPath.Set(nodeIndex, 1, rightNodeIndex);
+                    tree.mPath.Set(nodeIndex, 0, leftNodeIndex);
+                    tree.mPath.Set(nodeIndex, 1, rightNodeIndex);
+                }
 
-                selectorInfo.SplitIndices(leftIndicesBufCol, rightIndicesBufCol, leftSize, rightSize);
+                if( nodeIndex == 0 )
+                {
+                    treeIndices->SetIndicesBufferId(selectorInfo.GetIndicesBufferId());
+                }
+                selectorInfo.PartitionIndices(treeIndices->GetPermutation(), task.mBegin, split, end, leftSize, rightSize);
+                // Children only get collections when there is something to inherit
+                if( nodeData.HasBuffer(NODE_HISTOGRAMS) || nodeData.HasBuffer(PRESORTED_INDICES) )
+                {
+                    leftInherited.reset(new BufferCollection());
+                    rightInherited.reset(new BufferCollection());
+                    inheritedHistograms = InheritNodeHistograms<FloatType, IntType>(nodeData, *leftInherited, *rightInherited);
+                    InheritPresortedIndices<IntType>(nodeData, treeIndices->GetPermutation(), task.mBegin, split, end,
+                                                     *leftInherited, *rightInherited);
+                }
             }
             stack.Pop(); //stack.Push(nodeData);
         }
 
         if( doSplit )
         {
-            stack.Pop(); //stack.Push(&emptyIndicesCollection); or stack.Push(&leftIndicesBufCol); or stack.Push(&rightIndicesBufCol);
-
-            stack.Push(&leftIndicesBufCol);
-            ProcessNode(gen, tree, stack, leftNodeIndex, depth+1, leftSize);
+            const unsigned int leftSeed = gen();
+            const unsigned int rightSeed = gen();
 
-            stack.Pop(); //stack.Push(&emptyIndicesCollection); or stack.Push(&leftIndicesBufCol); or stack.Push(&rightIndicesBufCol);
+            SubtreeTask<FloatType, IntType> leftTask(leftNodeIndex, depth+1, leftSize, leftSeed, task.mBegin, split, leftInherited);
+            SubtreeTask<FloatType, IntType> rightTask(rightNodeIndex, depth+1, rightSize, rightSeed, split, end, rightInherited);
 
-            stack.Push(&rightIndicesBufCol);
-            ProcessNode(gen, tree, stack, rightNodeIndex, depth+1, rightSize);
+            // Right is pushed first so the left subtree is popped first unless
+            // the children inherit histograms, then the smaller child is
+            // popped first so the larger one derives its histograms
+            if( inheritedHistograms && rightSize < leftSize )
+            {
+                queue->Push(leftTask);
+                queue->Push(rightTask);
+            }
+            else
+            {
+                queue->Push(rightTask);
+                queue->Push(leftTask);
+            }
         }
     }
-}
\ No newline at end of file
+}
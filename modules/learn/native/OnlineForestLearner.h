@@ -49,8 +49,8 @@ public:
                         const EstimatorUpdater& estimatorParamsUpdater );
     ~OnlineForestLearner();
 
-    Forest Learn(const BufferCollection& data);
-    Forest GetForest() const;
+    ForestHandle Learn(const BufferCollection& data);
+    ForestHandle GetForest() const;
 
 private:
     OnlineForestLearner(const OnlineForestLearner<Feature, EstimatorUpdater, ProbabilityOfError,FloatType, IntType>& rhs);
@@ -130,7 +130,7 @@ OnlineForestLearner<Feature, EstimatorUpdater, ProbabilityOfError, FloatType, In
 }
 
 template <class Feature, class EstimatorUpdater, class ProbabilityOfError,  class FloatType, class IntType>
-Forest OnlineForestLearner<Feature, EstimatorUpdater, ProbabilityOfError, FloatType, IntType>
+ForestHandle OnlineForestLearner<Feature, EstimatorUpdater, ProbabilityOfError, FloatType, IntType>
 ::Learn( const BufferCollection& data )
 {
     boost::mt19937 gen;
@@ -249,14 +249,16 @@ Forest OnlineForestLearner<Feature, EstimatorUpdater, ProbabilityOfError, FloatT
             }
         }
     }
-    return mForest;
+    return GetForest();
 }
 
+// mForest keeps growing with each call to Learn so callers get an immutable
+// snapshot that can be shared with predictors
 template <class Feature, class EstimatorUpdater, class ProbabilityOfError,  class FloatType, class IntType>
-Forest OnlineForestLearner<Feature, EstimatorUpdater, ProbabilityOfError, FloatType, IntType>
+ForestHandle OnlineForestLearner<Feature, EstimatorUpdater, ProbabilityOfError, FloatType, IntType>
 ::GetForest() const
 {
-    return mForest;
+    return ForestHandle( new Forest(mForest) );
 }
 
 template <class Feature, class EstimatorUpdater, class ProbabilityOfError,  class FloatType, class IntType>
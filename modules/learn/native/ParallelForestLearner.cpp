@@ -1,58 +1,159 @@
 #include <ctime>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/random/mersenne_twister.hpp>
 
 #include "BufferCollectionStack.h"
 #include "Forest.h"
 #include "TreeLearnerI.h"
 #include "ParallelForestLearner.h"
+#include "RunningJobs.h"
 
 #if USE_BOOST_THREAD
 #include <boost/thread.hpp>
+#include <boost/ref.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 #endif
 
+// ----------------------------------------------------------------------------
+//
+// Hands out tree indices to jobs one at a time so a job that finishes early
+// picks up the next tree instead of idling while another job works through
+// its share
+//
+// ----------------------------------------------------------------------------
+class TreeQueue
+{
+public:
+    TreeQueue(int numberOfTrees)
+    : mNextTree(0)
+    , mNumberOfTrees(numberOfTrees)
+#if USE_BOOST_THREAD
+    , mMutex()
+#endif
+    {}
+
+    bool Pop(int& treeIndex)
+    {
+#if USE_BOOST_THREAD
+        boost::mutex::scoped_lock lock(mMutex);
+#endif
+        if(mNextTree >= mNumberOfTrees)
+        {
+            return false;
+        }
+        treeIndex = mNextTree++;
+        return true;
+    }
+
+private:
+    int mNextTree;
+    const int mNumberOfTrees;
+#if USE_BOOST_THREAD
+    boost::mutex mMutex;
+#endif
+};
+
 void TrainTrees(    const TreeLearnerI* treeLearner,
-                    const BufferCollection& data,
-                    int treeStartIndex,
-                    int treeStride,
-                    int numberOfTrees,
-                    Forest* forestOut )
+                    const BufferCollectionStack& data,
+                    TreeQueue* treeQueue,
+                    Forest* forestOut,
+                    int* treeCountOut,
+                    double* busySecondsOut )
 {
-    for(int i=treeStartIndex; i<numberOfTrees; i+=treeStride)
+    int i = 0;
+    while(treeQueue->Pop(i))
     {
+        const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
         treeLearner->Learn(data, forestOut->mTrees[i], i + static_cast<unsigned int>(std::time(NULL)) );
+        const boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - start;
+        *busySecondsOut += static_cast<double>(elapsed.total_microseconds()) * 1.0e-6;
+        *treeCountOut += 1;
     }
 }
 
-ParallelForestLearner::ParallelForestLearner( const TreeLearnerI* treeLearner, int numberOfTrees, int maxIntParamsDim, int maxFloatParamsDim, int maxYsDim, int numberOfJobs )
-: mForest( new Forest(numberOfTrees, 1, maxIntParamsDim, maxFloatParamsDim, maxYsDim) )
-, mTreeLearner( treeLearner->Clone() )
+ParallelForestLearner::ParallelForestLearner( const TreeLearnerI* treeLearner, int numberOfTrees, int maxIntParamsDim, int maxFloatParamsDim, int maxYsDim, int numberOfJobs,
+                                              const PipelineStepI* forestSteps )
+: mTreeLearner( treeLearner->Clone() )
+, mForestSteps( (forestSteps != NULL) ? forestSteps->Clone() : NULL )
 , mNumberOfTrees(numberOfTrees)
+, mMaxIntParamsDim(maxIntParamsDim)
+, mMaxFloatParamsDim(maxFloatParamsDim)
+, mMaxEstimatorParamsDim(maxYsDim)
 , mNumberOfJobs(numberOfJobs)
 {}
 
 ParallelForestLearner::~ParallelForestLearner()
 {
-    delete mForest;
     delete mTreeLearner;
+    delete mForestSteps;
+}
+
+ForestLearnerJobStats::ForestLearnerJobStats()
+: mJobTreeCounts(0)
+, mJobUtilization(0)
+{}
+
+ForestHandle ParallelForestLearner::Learn( const BufferCollection& data ) const
+{
+    ForestLearnerJobStats jobStats;
+    return Learn(data, jobStats);
 }
 
-Forest ParallelForestLearner::Learn( const BufferCollection& data )
+ForestHandle ParallelForestLearner::Learn( const BufferCollection& data, ForestLearnerJobStats& jobStatsOut ) const
 {
+    // Each call learns a new forest. Multiple threads write to it so it lives
+    // on the heap and ownership is handed to the caller without a copy.
+    boost::shared_ptr<Forest> forest( new Forest(mNumberOfTrees, 1, mMaxIntParamsDim, mMaxFloatParamsDim, mMaxEstimatorParamsDim) );
+
+    // Buffers that do not depend on the tree are built once for all trees
+    BufferCollectionStack forestStack;
+    forestStack.Push(&data);
+    BufferCollection forestData;
+    if( mForestSteps != NULL )
+    {
+        boost::mt19937 gen;
+        gen.seed(0);
+        mForestSteps->ProcessStep(forestStack, forestData, gen);
+    }
+    forestStack.Push(&forestData);
+
+    TreeQueue treeQueue(mNumberOfTrees);
+    std::vector<int> treeCounts(mNumberOfJobs, 0);
+    std::vector<double> busySeconds(mNumberOfJobs, 0.0);
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
 #if USE_BOOST_THREAD
+    // boost::thread copies its arguments so the data is passed with
+    // boost::cref for all jobs to share it read only instead of each getting
+    // a copy
+    AddRunningJobs(mNumberOfJobs - 1);
     std::vector< boost::shared_ptr< boost::thread > > threadVec;
     for(int job=0; job<mNumberOfJobs; job++)
     {
-        threadVec.push_back( boost::make_shared<boost::thread>(TrainTrees, mTreeLearner, data, job, mNumberOfJobs, mNumberOfTrees, mForest) );
+        threadVec.push_back( boost::make_shared<boost::thread>(TrainTrees, mTreeLearner, boost::cref(forestStack), &treeQueue, forest.get(),
+                                                               &treeCounts[job], &busySeconds[job]) );
     }
     for(int job=0; job<mNumberOfJobs; job++)
     {
         threadVec[job]->join();
     }
+    RemoveRunningJobs(mNumberOfJobs - 1);
 #else
-    TrainTrees(mTreeLearner, data, 0, 1, mNumberOfTrees, mForest);
+    TrainTrees(mTreeLearner, forestStack, &treeQueue, forest.get(), &treeCounts[0], &busySeconds[0]);
 #endif
-    return *mForest;
-}
-
+    const boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - start;
+    const double wallSeconds = static_cast<double>(elapsed.total_microseconds()) * 1.0e-6;
 
+    // The stats are returned to the caller so concurrent calls do not share
+    // any state
+    jobStatsOut.mJobTreeCounts.Resize(mNumberOfJobs);
+    jobStatsOut.mJobUtilization.Resize(mNumberOfJobs);
+    for(int job=0; job<mNumberOfJobs; job++)
+    {
+        jobStatsOut.mJobTreeCounts.Set(job, treeCounts[job]);
+        jobStatsOut.mJobUtilization.Set(job, (wallSeconds > 0.0) ? static_cast<float>(busySeconds[job] / wallSeconds) : 0.0f);
+    }
+    return forest;
+}
@@ -1,9 +1,30 @@
 #pragma once
 
+#include "VectorBuffer.h"
 #include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
 #include "TreeLearnerI.h"
 #include "Forest.h"
 
+// Trees learned by each job of a Learn call and the fraction of the wall
+// clock time of the call that each job spent learning trees
+class ForestLearnerJobStats
+{
+public:
+    ForestLearnerJobStats();
+
+    VectorBufferTemplate<int> mJobTreeCounts;
+    VectorBufferTemplate<float> mJobUtilization;
+};
+
+// ----------------------------------------------------------------------------
+//
+// ParallelForestLearner learns the trees of a forest with numberOfJobs jobs.
+// The optional forest steps run once per Learn call before any tree is
+// learned and their outputs are shared read only by all trees (for example
+// padded, tiled or integral depth images that do not depend on the tree).
+//
+// ----------------------------------------------------------------------------
 class ParallelForestLearner
 {
 public:
@@ -12,17 +33,22 @@ public:
                             int maxIntParamsDim, 
                             int maxFloatParamsDim, 
                             int maxEstimatorParamsDim, 
-                            int numberOfJobs );
+                            int numberOfJobs,
+                            const PipelineStepI* forestSteps=NULL );
     ~ParallelForestLearner();
 
-    Forest Learn( const BufferCollection& data );
+    ForestHandle Learn( const BufferCollection& data ) const;
+    ForestHandle Learn( const BufferCollection& data, ForestLearnerJobStats& jobStatsOut ) const;
 private:
     ParallelForestLearner( const ParallelForestLearner& other );
     ParallelForestLearner& operator=( const ParallelForestLearner& rhs );
-    
-    Forest* mForest;  // because multiple threads write to mForest, it must be on the heap
+
     const TreeLearnerI* mTreeLearner;
+    const PipelineStepI* mForestSteps;
     const int mNumberOfTrees;
+    const int mMaxIntParamsDim;
+    const int mMaxFloatParamsDim;
+    const int mMaxEstimatorParamsDim;
     const int mNumberOfJobs;
 };
 
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "BufferCollection.h"
+
+#if USE_BOOST_THREAD
+#include <boost/thread.hpp>
+#endif
+
+// ----------------------------------------------------------------------------
+//
+// A subtree still to be learned.  Each task carries the range of its
+// datapoints in the tree's permutation (see TreeIndices), the buffers it
+// inherits from its parent (NULL when the parent passed none) and its own
+// seed so the subtree is learned the same way no matter which job picks it
+// up.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class SubtreeTask
+{
+public:
+    SubtreeTask()
+    : mNodeIndex(0)
+    , mDepth(0)
+    , mNodeSize(0)
+    , mSeed(0)
+    , mBegin(0)
+    , mEnd(0)
+    , mInherited()
+    {}
+
+    SubtreeTask( IntType nodeIndex,
+                 IntType depth,
+                 FloatType nodeSize,
+                 unsigned int seed,
+                 IntType begin,
+                 IntType end,
+                 const boost::shared_ptr<BufferCollection>& inherited )
+    : mNodeIndex(nodeIndex)
+    , mDepth(depth)
+    , mNodeSize(nodeSize)
+    , mSeed(seed)
+    , mBegin(begin)
+    , mEnd(end)
+    , mInherited(inherited)
+    {}
+
+    IntType mNodeIndex;
+    IntType mDepth;
+    FloatType mNodeSize;
+    unsigned int mSeed;
+    IntType mBegin;
+    IntType mEnd;
+    boost::shared_ptr<BufferCollection> mInherited;
+};
+
+// ----------------------------------------------------------------------------
+//
+// SubtreeQueue is shared by the jobs learning one tree.  Tasks are popped
+// last in first out so a single job grows the tree depth first.  Pop blocks
+// while other jobs are still processing nodes that may push children and
+// returns false once every task has been processed.
+//
+// The tree is resized when new nodes are allocated, so node allocation and
+// writes to the tree are serialized with the tree mutex.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class SubtreeQueue
+{
+public:
+    SubtreeQueue()
+    : mTasks()
+    , mNumberOfPendingTasks(0)
+#if USE_BOOST_THREAD
+    , mMutex()
+    , mTreeMutex()
+    , mCondition()
+#endif
+    {}
+
+    void Push(const SubtreeTask<FloatType, IntType>& task)
+    {
+#if USE_BOOST_THREAD
+        boost::mutex::scoped_lock lock(mMutex);
+#endif
+        mTasks.push_back(task);
+        mNumberOfPendingTasks++;
+#if USE_BOOST_THREAD
+        mCondition.notify_one();
+#endif
+    }
+
+    bool Pop(SubtreeTask<FloatType, IntType>& task)
+    {
+#if USE_BOOST_THREAD
+        boost::mutex::scoped_lock lock(mMutex);
+        while(mTasks.empty() && mNumberOfPendingTasks > 0)
+        {
+            mCondition.wait(lock);
+        }
+#endif
+        if(mTasks.empty())
+        {
+            return false;
+        }
+        task = mTasks.back();
+        mTasks.pop_back();
+        return true;
+    }
+
+    // Called once a popped task is processed and its children are pushed
+    void Done()
+    {
+#if USE_BOOST_THREAD
+        boost::mutex::scoped_lock lock(mMutex);
+#endif
+        mNumberOfPendingTasks--;
+#if USE_BOOST_THREAD
+        if(mNumberOfPendingTasks == 0)
+        {
+            mCondition.notify_all();
+        }
+#endif
+    }
+
+#if USE_BOOST_THREAD
+    boost::mutex& GetTreeMutex()
+    {
+        return mTreeMutex;
+    }
+#endif
+
+private:
+    SubtreeQueue(const SubtreeQueue& other);
+    SubtreeQueue& operator=(const SubtreeQueue& rhs);
+
+    std::vector< SubtreeTask<FloatType, IntType> > mTasks;
+    int mNumberOfPendingTasks;
+#if USE_BOOST_THREAD
+    boost::mutex mMutex;
+    boost::mutex mTreeMutex;
+    boost::condition_variable mCondition;
+#endif
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+#include "VectorBuffer.h"
+#include "BufferCollection.h"
+#include "UniqueBufferId.h"
+
+// ----------------------------------------------------------------------------
+//
+// TreeIndices is the single permutation of sample indices shared by all nodes
+// of a tree.  Each node owns a [begin, end) range that a split partitions in
+// place (see SplitSelectorInfo::PartitionIndices) so the children own
+// adjacent ranges and no indices are allocated per node.  The root reads the
+// indices written by the tree steps and sizes the permutation when it splits.
+//
+// Node steps read the indices as a buffer so each job copies the range of
+// the node it processes into one scratch indices buffer that it reuses for
+// all of its nodes.  VectorBuffer::Resize keeps its storage so the copy only
+// allocates while the scratch buffer grows.  Nodes being processed at the
+// same time own disjoint ranges so jobs do not need to lock it.
+//
+// ----------------------------------------------------------------------------
+template <class IntType>
+class TreeIndices
+{
+public:
+    TreeIndices()
+    : mIndicesBufferId()
+    , mPermutation()
+    {}
+
+    // Called by the root before any child is pushed
+    void SetIndicesBufferId(const BufferId& indicesBufferId)
+    {
+        mIndicesBufferId = indicesBufferId;
+    }
+
+    std::vector<IntType>& GetPermutation()
+    {
+        return mPermutation;
+    }
+
+    const std::vector<IntType>& GetPermutation() const
+    {
+        return mPermutation;
+    }
+
+    void SetNodeIndices(BufferCollection& scratchCollection, IntType begin, IntType end) const
+    {
+        VectorBufferTemplate<IntType>& indices =
+              scratchCollection.GetOrAddBuffer< VectorBufferTemplate<IntType> >(mIndicesBufferId);
+        indices.Resize(end - begin);
+        for(IntType i=begin; i<end; i++)
+        {
+            indices.SetUnsafe(i - begin, mPermutation[i]);
+        }
+    }
+
+private:
+    BufferId mIndicesBufferId;
+    std::vector<IntType> mPermutation;
+};
@@ -8,5 +8,14 @@ class TreeLearnerI
 public:
     virtual ~TreeLearnerI() {}
     virtual TreeLearnerI* Clone() const=0;
-    virtual void Learn( const BufferCollection& data, Tree& tree, unsigned int seed) const=0;
+    // The data is a stack so buffers built once for a forest (see the forest
+    // steps of ParallelForestLearner) are shared by all of its trees
+    virtual void Learn( const BufferCollectionStack& data, Tree& tree, unsigned int seed) const=0;
+
+    void Learn( const BufferCollection& data, Tree& tree, unsigned int seed) const
+    {
+        BufferCollectionStack stack;
+        stack.Push(&data);
+        Learn(stack, tree, seed);
+    }
 };
\ No newline at end of file
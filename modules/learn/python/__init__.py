@@ -1,5 +1,6 @@
 from learn import *
 from wrappers import *
 from split_criteria import *
+from tree_learner import *
 from matrix_learner import *
 from depth_delta_learner import *
\ No newline at end of file
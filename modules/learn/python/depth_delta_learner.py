@@ -10,12 +10,16 @@ import rftk.predict as predict
 import learn
 from wrappers import *
 from split_criteria import *
+from tree_learner import *
 
 
 def depth_delta_classification_data_prepare(**kwargs):
     bufferCollection = buffers.BufferCollection()
     bufferCollection.AddBuffer(buffers.DEPTH_IMAGES, kwargs['depth_images'])
-    bufferCollection.AddBuffer(buffers.PIXEL_INDICES, kwargs['pixel_indices'])
+    if 'pixel_indices' in kwargs:
+        bufferCollection.AddBuffer(buffers.PIXEL_INDICES, kwargs['pixel_indices'])
+    if 'class_images' in kwargs:
+        bufferCollection.AddBuffer(buffers.CLASS_IMAGES, kwargs['class_images'])
     if 'offset_scales' in kwargs:
         bufferCollection.AddBuffer(buffers.OFFSET_SCALES, kwargs['offset_scales'])    
     if 'classes' in kwargs:
@@ -23,7 +27,7 @@ def depth_delta_classification_data_prepare(**kwargs):
     return bufferCollection
 
 def create_depth_delta_predictor_32f(forest, **kwargs):
-    number_of_classes = forest.GetTree(0).mYs.GetN()
+    number_of_classes = forest.GetYDim()
     all_samples_step = pipeline.AllSamplesStep_i32f32i32(buffers.PIXEL_INDICES)
     combiner = classification.ClassProbabilityCombiner_f32(number_of_classes)
     depth_delta_feature = image_features.ScaledDepthDeltaFeature_f32i32(all_samples_step.IndicesBufferId,
@@ -32,12 +36,157 @@ def create_depth_delta_predictor_32f(forest, **kwargs):
     forest_predicter = predict.ScaledDepthDeltaClassificationPredictin_f32i32(forest, depth_delta_feature, combiner, all_samples_step)
     return PredictorWrapper_32f(forest_predicter, depth_delta_classification_data_prepare)
 
+def create_tiled_depth_delta_predictor_32f(forest, **kwargs):
+    number_of_classes = forest.GetYDim()
+    all_samples_step = pipeline.AllSamplesStep_i32f32i32(buffers.PIXEL_INDICES)
+    tile_depth_images_step = image_features.TileDepthImagesStep_f32(buffers.DEPTH_IMAGES)
+    combiner = classification.ClassProbabilityCombiner_f32(number_of_classes)
+    depth_delta_feature = image_features.TiledScaledDepthDeltaFeature_f32i32(all_samples_step.IndicesBufferId,
+                                                                             buffers.PIXEL_INDICES,
+                                                                             tile_depth_images_step.TiledDepthImagesBufferId)
+    pre_steps = pipeline.Pipeline([all_samples_step, tile_depth_images_step])
+    forest_predicter = predict.TiledScaledDepthDeltaClassificationPredictin_f32i32(forest, depth_delta_feature, combiner, pre_steps)
+    return PredictorWrapper_32f(forest_predicter, depth_delta_classification_data_prepare)
+
+def create_box_depth_delta_predictor_32f(forest, **kwargs):
+    number_of_classes = forest.GetYDim()
+    all_samples_step = pipeline.AllSamplesStep_i32f32i32(buffers.PIXEL_INDICES)
+    integral_depth_images_step = image_features.IntegralDepthImagesStep_f32(buffers.DEPTH_IMAGES)
+    combiner = classification.ClassProbabilityCombiner_f32(number_of_classes)
+    box_depth_delta_feature = image_features.BoxDepthDeltaFeature_f32i32(all_samples_step.IndicesBufferId,
+                                                                         buffers.PIXEL_INDICES,
+                                                                         buffers.DEPTH_IMAGES,
+                                                                         integral_depth_images_step.IntegralImagesBufferId)
+    pre_steps = pipeline.Pipeline([all_samples_step, integral_depth_images_step])
+    forest_predicter = predict.BoxDepthDeltaClassificationPredictin_f32i32(forest, box_depth_delta_feature, combiner, pre_steps)
+    return PredictorWrapper_32f(forest_predicter, depth_delta_classification_data_prepare)
+
 def create_scaled_depth_delta_learner_32f(**kwargs):
     ux = float( kwargs.get('ux') )
     uy = float( kwargs.get('uy') )
     vx = float( kwargs.get('vx') )
     vy = float( kwargs.get('vy') )
 
+    number_of_trees = int( kwargs.get('number_of_trees', 10) )
+    number_of_features = int( kwargs.get('number_of_features', 1) )
+    feature_ordering = int( kwargs.get('feature_ordering', pipeline.FEATURES_BY_DATAPOINTS) )
+    number_of_jobs = int( kwargs.get('number_of_jobs', 1) )
+    if 'classes' in kwargs:
+        number_of_classes = int( kwargs['classes'].GetMax() + 1 )
+    else:
+        number_of_classes = int( buffers.as_numpy_array(kwargs['class_images']).max() + 1 )
+    padding = kwargs.get('padding')
+    depth_layout = kwargs.get('depth_layout', 'row_major')
+    sort_pixels = bool( kwargs.get('sort_pixels', False) )
+
+    try_split_criteria = create_try_split_criteria(**kwargs)
+
+    pixel_indices_buffer_id = buffers.PIXEL_INDICES
+    classes_buffer_id = buffers.CLASS_LABELS
+    if 'pixels_per_image' in kwargs:
+        # Sample new pixels for each tree from the depth and class images
+        sample_data_step = image_features.PixelSamplesStep_f32i32(buffers.DEPTH_IMAGES, buffers.CLASS_IMAGES,
+                                                                  int(kwargs.get('pixels_per_image')),
+                                                                  bool(kwargs.get('class_balanced', False)))
+        pixel_indices_buffer_id = sample_data_step.PixelIndicesBufferId
+        classes_buffer_id = sample_data_step.ClassesBufferId
+    elif 'bootstrap' in kwargs and kwargs.get('bootstrap'):
+        sample_data_step = pipeline.BootstrapSamplesStep_i32f32i32(buffers.PIXEL_INDICES)
+    else:
+        sample_data_step = pipeline.AllSamplesStep_i32f32i32(buffers.PIXEL_INDICES)
+    tree_steps = [sample_data_step]
+    indices_buffer_id = sample_data_step.IndicesBufferId
+
+    # Walk the depth images in (image, row, column) order during feature extraction
+    if sort_pixels:
+        sort_pixel_indices_step = image_features.SortPixelIndicesStep_i32(sample_data_step.IndicesBufferId, pixel_indices_buffer_id)
+        tree_steps.append(sort_pixel_indices_step)
+        indices_buffer_id = sort_pixel_indices_step.IndicesBufferId
+
+    number_of_features_buffer = buffers.as_vector_buffer(np.array([number_of_features], dtype=np.int32))
+    set_number_features_step = pipeline.SetInt32VectorBufferStep(number_of_features_buffer, pipeline.WHEN_NEW)
+    tree_steps.append(set_number_features_step)
+    feature_params_step = image_features.PixelPairGaussianOffsetsStep_f32i32(set_number_features_step.OutputBufferId, ux, uy, vx, vy )
+
+    if padding is None and 'min_depth' in kwargs:
+        padding = feature_params_step.GetMaxPixelOffset(float(kwargs['min_depth']), float(kwargs.get('max_offset_scale', 1.0)), 3.0)
+
+    # Steps that do not depend on the tree run once per forest
+    forest_steps = []
+    if padding is not None:
+        pad_depth_images_step = image_features.PadDepthImagesStep_f32(buffers.DEPTH_IMAGES, int(padding))
+        forest_steps.append(pad_depth_images_step)
+        tree_steps_pipeline = pipeline.Pipeline(tree_steps)
+        depth_delta_feature = image_features.PaddedScaledDepthDeltaFeature_f32i32(feature_params_step.FloatParamsBufferId,
+                                                                                  feature_params_step.IntParamsBufferId,
+                                                                                  indices_buffer_id,
+                                                                                  pixel_indices_buffer_id,
+                                                                                  pad_depth_images_step.PaddedDepthImagesBufferId,
+                                                                                  buffers.OFFSET_SCALES)
+        depth_delta_feature_extractor_step = image_features.PaddedScaledDepthDeltaBatchedFeatureExtractorStep_f32i32(depth_delta_feature, feature_ordering,
+                                                                                                                     classification.ClassInfoGainBestSplitpointsWalkingSortedStep_f32i32.GetPreferredFeatureValueOrdering())
+    elif depth_layout == 'tiled':
+        tile_depth_images_step = image_features.TileDepthImagesStep_f32(buffers.DEPTH_IMAGES)
+        forest_steps.append(tile_depth_images_step)
+        tree_steps_pipeline = pipeline.Pipeline(tree_steps)
+        depth_delta_feature = image_features.TiledScaledDepthDeltaFeature_f32i32(feature_params_step.FloatParamsBufferId,
+                                                                                 feature_params_step.IntParamsBufferId,
+                                                                                 indices_buffer_id,
+                                                                                 pixel_indices_buffer_id,
+                                                                                 tile_depth_images_step.TiledDepthImagesBufferId,
+                                                                                 buffers.OFFSET_SCALES)
+        depth_delta_feature_extractor_step = image_features.TiledScaledDepthDeltaBatchedFeatureExtractorStep_f32i32(depth_delta_feature, feature_ordering,
+                                                                                                                    classification.ClassInfoGainBestSplitpointsWalkingSortedStep_f32i32.GetPreferredFeatureValueOrdering())
+    else:
+        tree_steps_pipeline = pipeline.Pipeline(tree_steps)
+        depth_delta_feature = image_features.ScaledDepthDeltaFeature_f32i32(feature_params_step.FloatParamsBufferId,
+                                                                          feature_params_step.IntParamsBufferId,
+                                                                          indices_buffer_id,
+                                                                          pixel_indices_buffer_id,
+                                                                          buffers.DEPTH_IMAGES,
+                                                                          buffers.OFFSET_SCALES)
+        depth_delta_feature_extractor_step = image_features.ScaledDepthDeltaBatchedFeatureExtractorStep_f32i32(depth_delta_feature, feature_ordering,
+                                                                                                               classification.ClassInfoGainBestSplitpointsWalkingSortedStep_f32i32.GetPreferredFeatureValueOrdering())
+    slice_classes_step = pipeline.SliceInt32VectorBufferStep_i32(classes_buffer_id, indices_buffer_id)
+    slice_weights_step = pipeline.SliceFloat32VectorBufferStep_i32(sample_data_step.WeightsBufferId, indices_buffer_id)
+    class_infogain_walker = classification.ClassInfoGainWalker_f32i32(slice_weights_step.SlicedBufferId,
+                                                                      slice_classes_step.SlicedBufferId,
+                                                                      number_of_classes)
+    best_splitpint_step = classification.ClassInfoGainBestSplitpointsWalkingSortedStep_f32i32(class_infogain_walker,
+                                                                        depth_delta_feature_extractor_step.FeatureValuesBufferId,
+                                                                        feature_ordering)
+    node_steps_pipeline = pipeline.Pipeline([feature_params_step, depth_delta_feature_extractor_step,
+                                            slice_classes_step, slice_weights_step, best_splitpint_step])
+
+    split_buffers = splitpoints.SplitSelectorBuffers(best_splitpint_step.ImpurityBufferId,
+                                                          best_splitpint_step.SplitpointBufferId,
+                                                          best_splitpint_step.SplitpointCountsBufferId,
+                                                          best_splitpint_step.ChildCountsBufferId,
+                                                          best_splitpint_step.LeftYsBufferId,
+                                                          best_splitpint_step.RightYsBufferId,
+                                                          feature_params_step.FloatParamsBufferId,
+                                                          feature_params_step.IntParamsBufferId,
+                                                          depth_delta_feature_extractor_step.FeatureValuesBufferId,
+                                                          feature_ordering,
+                                                          indices_buffer_id)
+    should_split_criteria = create_should_split_criteria(**kwargs)
+    finalizer = classification.ClassEstimatorFinalizer_f32()
+    split_selector = splitpoints.SplitSelector_f32i32([split_buffers], should_split_criteria, finalizer )
+
+    tree_learner = create_tree_learner(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector, **kwargs)
+    forest_steps_pipeline = pipeline.Pipeline(forest_steps)
+    forest_learner = learn.ParallelForestLearner(tree_learner, number_of_trees, 5, 5, number_of_classes, number_of_jobs,
+                                                 forest_steps_pipeline)
+    return forest_learner
+
+
+def create_box_depth_delta_learner_32f(**kwargs):
+    ux = float( kwargs.get('ux') )
+    uy = float( kwargs.get('uy') )
+    vx = float( kwargs.get('vx') )
+    vy = float( kwargs.get('vy') )
+    max_radius = float( kwargs.get('max_radius', 0.5*max(ux, uy, vx, vy)) )
+
     number_of_trees = int( kwargs.get('number_of_trees', 10) )
     number_of_features = int( kwargs.get('number_of_features', 1) )
     feature_ordering = int( kwargs.get('feature_ordering', pipeline.FEATURES_BY_DATAPOINTS) )
@@ -53,25 +202,30 @@ def create_scaled_depth_delta_learner_32f(**kwargs):
 
     number_of_features_buffer = buffers.as_vector_buffer(np.array([number_of_features], dtype=np.int32))
     set_number_features_step = pipeline.SetInt32VectorBufferStep(number_of_features_buffer, pipeline.WHEN_NEW)
+    # The integral images do not depend on the tree so they are built once per forest
+    integral_depth_images_step = image_features.IntegralDepthImagesStep_f32(buffers.DEPTH_IMAGES)
+    forest_steps_pipeline = pipeline.Pipeline([integral_depth_images_step])
     tree_steps_pipeline = pipeline.Pipeline([sample_data_step, set_number_features_step])
 
-    feature_params_step = image_features.PixelPairGaussianOffsetsStep_f32i32(set_number_features_step.OutputBufferId, ux, uy, vx, vy )
-    depth_delta_feature = image_features.ScaledDepthDeltaFeature_f32i32(feature_params_step.FloatParamsBufferId,
-                                                                      feature_params_step.IntParamsBufferId,
-                                                                      sample_data_step.IndicesBufferId,
-                                                                      buffers.PIXEL_INDICES,
-                                                                      buffers.DEPTH_IMAGES,
-                                                                      buffers.OFFSET_SCALES)
-    depth_delta_feature_extractor_step = image_features.ScaledDepthDeltaFeatureExtractorStep_f32i32(depth_delta_feature, feature_ordering)
+    feature_params_step = image_features.BoxPairGaussianOffsetsStep_f32i32(set_number_features_step.OutputBufferId, ux, uy, vx, vy, max_radius )
+    box_depth_delta_feature = image_features.BoxDepthDeltaFeature_f32i32(feature_params_step.FloatParamsBufferId,
+                                                                         feature_params_step.IntParamsBufferId,
+                                                                         sample_data_step.IndicesBufferId,
+                                                                         buffers.PIXEL_INDICES,
+                                                                         buffers.DEPTH_IMAGES,
+                                                                         integral_depth_images_step.IntegralImagesBufferId,
+                                                                         buffers.OFFSET_SCALES)
+    box_depth_delta_feature_extractor_step = image_features.BoxDepthDeltaFeatureExtractorStep_f32i32(box_depth_delta_feature, feature_ordering,
+                                                                                                     classification.ClassInfoGainBestSplitpointsWalkingSortedStep_f32i32.GetPreferredFeatureValueOrdering())
     slice_classes_step = pipeline.SliceInt32VectorBufferStep_i32(buffers.CLASS_LABELS, sample_data_step.IndicesBufferId)
     slice_weights_step = pipeline.SliceFloat32VectorBufferStep_i32(sample_data_step.WeightsBufferId, sample_data_step.IndicesBufferId)
     class_infogain_walker = classification.ClassInfoGainWalker_f32i32(slice_weights_step.SlicedBufferId,
                                                                       slice_classes_step.SlicedBufferId,
                                                                       number_of_classes)
     best_splitpint_step = classification.ClassInfoGainBestSplitpointsWalkingSortedStep_f32i32(class_infogain_walker,
-                                                                        depth_delta_feature_extractor_step.FeatureValuesBufferId,
+                                                                        box_depth_delta_feature_extractor_step.FeatureValuesBufferId,
                                                                         feature_ordering)
-    node_steps_pipeline = pipeline.Pipeline([feature_params_step, depth_delta_feature_extractor_step,
+    node_steps_pipeline = pipeline.Pipeline([feature_params_step, box_depth_delta_feature_extractor_step,
                                             slice_classes_step, slice_weights_step, best_splitpint_step])
 
     split_buffers = splitpoints.SplitSelectorBuffers(best_splitpint_step.ImpurityBufferId,
@@ -82,15 +236,17 @@ def create_scaled_depth_delta_learner_32f(**kwargs):
                                                           best_splitpint_step.RightYsBufferId,
                                                           feature_params_step.FloatParamsBufferId,
                                                           feature_params_step.IntParamsBufferId,
-                                                          depth_delta_feature_extractor_step.FeatureValuesBufferId,
+                                                          box_depth_delta_feature_extractor_step.FeatureValuesBufferId,
                                                           feature_ordering,
                                                           sample_data_step.IndicesBufferId)
     should_split_criteria = create_should_split_criteria(**kwargs)
     finalizer = classification.ClassEstimatorFinalizer_f32()
     split_selector = splitpoints.SplitSelector_f32i32([split_buffers], should_split_criteria, finalizer )
 
-    tree_learner = learn.DepthFirstTreeLearner_f32i32(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector)
-    forest_learner = learn.ParallelForestLearner(tree_learner, number_of_trees, 5, 5, number_of_classes, number_of_jobs)
+    tree_learner = create_tree_learner(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector, **kwargs)
+    forest_learner = learn.ParallelForestLearner(tree_learner, number_of_trees,
+                                                 image_features.BOX_PAIR_PARAMS_DIM, image_features.BOX_PAIR_PARAMS_DIM,
+                                                 number_of_classes, number_of_jobs, forest_steps_pipeline)
     return forest_learner
 
 
@@ -131,7 +287,8 @@ def create_online_scaled_depth_delta_one_stream_learner_32f(**kwargs):
                                                                       buffers.PIXEL_INDICES,
                                                                       buffers.DEPTH_IMAGES,
                                                                       buffers.OFFSET_SCALES)
-    depth_delta_feature_extractor_step = image_features.ScaledDepthDeltaFeatureExtractorStep_f32i32(depth_delta_feature, feature_ordering)
+    depth_delta_feature_extractor_step = image_features.ScaledDepthDeltaBatchedFeatureExtractorStep_f32i32(depth_delta_feature, feature_ordering,
+                                                                                                           classification.ClassStatsUpdaterOneStreamStep_f32i32.GetPreferredFeatureValueOrdering())
     slice_classes_step = pipeline.SliceInt32VectorBufferStep_i32(buffers.CLASS_LABELS, sample_data_step.IndicesBufferId)
     slice_weights_step = pipeline.SliceFloat32VectorBufferStep_i32(sample_data_step.WeightsBufferId, sample_data_step.IndicesBufferId)
     random_splitpoint_selection_step = splitpoints.RandomSplitpointsStep_f32i32(depth_delta_feature_extractor_step.FeatureValuesBufferId,
@@ -228,7 +385,8 @@ def create_online_scaled_depth_delta_two_stream_consistent_learner_32f(**kwargs)
                                                                       buffers.PIXEL_INDICES,
                                                                       buffers.DEPTH_IMAGES,
                                                                       buffers.OFFSET_SCALES)
-    depth_delta_feature_extractor_step = image_features.ScaledDepthDeltaFeatureExtractorStep_f32i32(depth_delta_feature, feature_ordering)
+    depth_delta_feature_extractor_step = image_features.ScaledDepthDeltaBatchedFeatureExtractorStep_f32i32(depth_delta_feature, feature_ordering,
+                                                                                                           classification.ClassStatsUpdaterTwoStreamStep_f32i32.GetPreferredFeatureValueOrdering())
     slice_classes_step = pipeline.SliceInt32VectorBufferStep_i32(buffers.CLASS_LABELS, sample_data_step.IndicesBufferId)
     slice_weights_step = pipeline.SliceFloat32VectorBufferStep_i32(sample_data_step.WeightsBufferId, sample_data_step.IndicesBufferId)
     slice_assign_stream_step = pipeline.SliceInt32VectorBufferStep_i32(assign_stream_step.StreamTypeBufferId, sample_data_step.IndicesBufferId)
@@ -311,4 +469,10 @@ def create_online_two_stream_consistent_depth_delta_classifier(**kwargs):
     return LearnerWrapper(  depth_delta_classification_data_prepare,
                             create_online_scaled_depth_delta_two_stream_consistent_learner_32f,
                             create_depth_delta_predictor_32f,
-                            kwargs)
\ No newline at end of file
+                            kwargs)
+
+def create_box_depth_delta_classifier(**kwargs):
+    return LearnerWrapper(  depth_delta_classification_data_prepare,
+                            create_box_depth_delta_learner_32f,
+                            create_box_depth_delta_predictor_32f,
+                            kwargs)
@@ -10,6 +10,7 @@ import rftk.predict as predict
 import learn
 from wrappers import *
 from split_criteria import *
+from tree_learner import *
 
 def matrix_classification_data_prepare(**kwargs):
     bufferCollection = buffers.BufferCollection()
@@ -19,7 +20,7 @@ def matrix_classification_data_prepare(**kwargs):
     return bufferCollection
 
 def create_matrix_predictor_32f(forest, **kwargs):
-    number_of_classes = forest.GetTree(0).mYs.GetN()
+    number_of_classes = forest.GetYDim()
     all_samples_step = pipeline.AllSamplesStep_f32f32i32(buffers.X_FLOAT_DATA)
     combiner = classification.ClassProbabilityCombiner_f32(number_of_classes)
     matrix_feature = matrix_features.LinearFloat32MatrixFeature_f32i32(all_samples_step.IndicesBufferId,
@@ -27,6 +28,15 @@ def create_matrix_predictor_32f(forest, **kwargs):
     forest_predicter = predict.LinearMatrixClassificationPredictin_f32i32(forest, matrix_feature, combiner, all_samples_step)
     return PredictorWrapper_32f(forest_predicter, matrix_classification_data_prepare)
 
+def create_axis_aligned_matrix_predictor_32f(forest, **kwargs):
+    number_of_classes = forest.GetYDim()
+    all_samples_step = pipeline.AllSamplesStep_f32f32i32(buffers.X_FLOAT_DATA)
+    combiner = classification.ClassProbabilityCombiner_f32(number_of_classes)
+    matrix_feature = matrix_features.AxisAlignedFloat32MatrixFeature_f32i32(all_samples_step.IndicesBufferId,
+                                                                            buffers.X_FLOAT_DATA)
+    forest_predicter = predict.AxisAlignedMatrixClassificationPredictin_f32i32(forest, matrix_feature, combiner, all_samples_step)
+    return PredictorWrapper_32f(forest_predicter, matrix_classification_data_prepare)
+
 def create_axis_aligned_matrix_walking_learner_32f(**kwargs):
     number_of_trees = int( kwargs.get('number_of_trees', 10) )
     number_of_features = int( kwargs.get('number_of_features', np.sqrt(kwargs['x'].shape[1])) )
@@ -36,6 +46,95 @@ def create_axis_aligned_matrix_walking_learner_32f(**kwargs):
 
     try_split_criteria = create_try_split_criteria(**kwargs)
 
+    if 'bootstrap' in kwargs and kwargs.get('bootstrap'):
+        sample_data_step = pipeline.BootstrapSamplesStep_f32f32i32(buffers.X_FLOAT_DATA)
+    else:
+        sample_data_step = pipeline.AllSamplesStep_f32f32i32(buffers.X_FLOAT_DATA)
+
+    number_of_features_buffer = buffers.as_vector_buffer(np.array([number_of_features], dtype=np.int32))
+    set_number_features_step = pipeline.SetInt32VectorBufferStep(number_of_features_buffer, pipeline.WHEN_NEW)
+    tree_steps = [sample_data_step, set_number_features_step]
+    forest_steps = []
+    feature_params_step = matrix_features.AxisAlignedParamsStep_f32i32(set_number_features_step.OutputBufferId, buffers.X_FLOAT_DATA)
+    node_steps = [feature_params_step]
+    if 'number_of_bins' in kwargs:
+        bin_features_step = matrix_features.BinFeaturesStep_f32i32(buffers.X_FLOAT_DATA, int(kwargs.get('number_of_bins')))
+        forest_steps.append(bin_features_step)
+        # Features are drawn once per tree so every node has histograms of the
+        # same dimensions and the larger child derives all of them
+        tree_steps.append(feature_params_step)
+        node_steps = []
+    elif kwargs.get('presort', False):
+        presort_features_step = matrix_features.PresortFeaturesStep_f32i32(buffers.X_FLOAT_DATA)
+        tree_steps.append(presort_features_step)
+    tree_steps_pipeline = pipeline.Pipeline(tree_steps)
+
+    matrix_feature = matrix_features.AxisAlignedFloat32MatrixFeature_f32i32(feature_params_step.FloatParamsBufferId,
+                                                                            feature_params_step.IntParamsBufferId,
+                                                                            sample_data_step.IndicesBufferId,
+                                                                            buffers.X_FLOAT_DATA)
+    matrix_feature_extractor_step = matrix_features.AxisAlignedFloat32MatrixFeatureExtractorStep_f32i32(matrix_feature, feature_ordering,
+                                                                                                        classification.ClassInfoGainBestSplitpointsWalkingSortedStep_f32i32.GetPreferredFeatureValueOrdering())
+    slice_classes_step = pipeline.SliceInt32VectorBufferStep_i32(buffers.CLASS_LABELS, sample_data_step.IndicesBufferId)
+    slice_weights_step = pipeline.SliceFloat32VectorBufferStep_i32(sample_data_step.WeightsBufferId, sample_data_step.IndicesBufferId)
+    class_infogain_walker = classification.ClassInfoGainWalker_f32i32(slice_weights_step.SlicedBufferId,
+                                                                      slice_classes_step.SlicedBufferId,
+                                                                      number_of_classes)
+    if 'number_of_bins' in kwargs:
+        best_splitpint_step = learn.ClassInfoGainBestSplitpointsHistogramStep_f32i32(class_infogain_walker,
+                                                                        bin_features_step.BinnedFeaturesBufferId,
+                                                                        bin_features_step.BinEdgesBufferId,
+                                                                        bin_features_step.NumberOfBinsBufferId,
+                                                                        feature_params_step.FloatParamsBufferId,
+                                                                        feature_params_step.IntParamsBufferId,
+                                                                        sample_data_step.IndicesBufferId)
+    elif kwargs.get('presort', False):
+        best_splitpint_step = learn.ClassInfoGainBestSplitpointsPresortedStep_f32i32(class_infogain_walker,
+                                                                        presort_features_step.SortedIndicesBufferId,
+                                                                        buffers.X_FLOAT_DATA,
+                                                                        feature_params_step.FloatParamsBufferId,
+                                                                        feature_params_step.IntParamsBufferId,
+                                                                        sample_data_step.IndicesBufferId)
+    else:
+        best_splitpint_step = classification.ClassInfoGainBestSplitpointsWalkingSortedStep_f32i32(class_infogain_walker,
+                                                                        matrix_feature_extractor_step.FeatureValuesBufferId,
+                                                                        feature_ordering,
+                                                                        int(kwargs.get('number_of_sort_jobs', 1)))
+    node_steps_pipeline = pipeline.Pipeline(node_steps + [matrix_feature_extractor_step,
+                                            slice_classes_step, slice_weights_step, best_splitpint_step])
+
+    split_buffers = splitpoints.SplitSelectorBuffers(best_splitpint_step.ImpurityBufferId,
+                                                          best_splitpint_step.SplitpointBufferId,
+                                                          best_splitpint_step.SplitpointCountsBufferId,
+                                                          best_splitpint_step.ChildCountsBufferId,
+                                                          best_splitpint_step.LeftYsBufferId,
+                                                          best_splitpint_step.RightYsBufferId,
+                                                          feature_params_step.FloatParamsBufferId,
+                                                          feature_params_step.IntParamsBufferId,
+                                                          matrix_feature_extractor_step.FeatureValuesBufferId,
+                                                          feature_ordering,
+                                                          sample_data_step.IndicesBufferId)
+    should_split_criteria = create_should_split_criteria(**kwargs)
+    finalizer = classification.ClassEstimatorFinalizer_f32()
+    split_selector = splitpoints.SplitSelector_f32i32([split_buffers], should_split_criteria, finalizer )
+
+    tree_learner = create_tree_learner(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector, **kwargs)
+    forest_steps_pipeline = pipeline.Pipeline(forest_steps)
+    forest_learner = learn.ParallelForestLearner(tree_learner, number_of_trees, 5, 5, number_of_classes, number_of_jobs,
+                                                 forest_steps_pipeline)
+    return forest_learner
+
+
+def create_oblique_matrix_walking_learner_32f(**kwargs):
+    number_of_trees = int( kwargs.get('number_of_trees', 10) )
+    number_of_features = int( kwargs.get('number_of_features', np.sqrt(kwargs['x'].shape[1])) )
+    feature_ordering = int( kwargs.get('feature_ordering', pipeline.FEATURES_BY_DATAPOINTS) )
+    number_of_jobs = int( kwargs.get('number_of_jobs', 1) )
+    density = float( kwargs.get('density', 1.0 / np.sqrt(kwargs['x'].shape[1])) )
+    number_of_classes = int( np.max(kwargs['classes']) + 1 )
+
+    try_split_criteria = create_try_split_criteria(**kwargs)
+
     if 'bootstrap' in kwargs and kwargs.get('bootstrap'):
         sample_data_step = pipeline.BootstrapSamplesStep_f32f32i32(buffers.X_FLOAT_DATA)
     else:
@@ -45,12 +144,14 @@ def create_axis_aligned_matrix_walking_learner_32f(**kwargs):
     set_number_features_step = pipeline.SetInt32VectorBufferStep(number_of_features_buffer, pipeline.WHEN_NEW)
     tree_steps_pipeline = pipeline.Pipeline([sample_data_step, set_number_features_step])
 
-    feature_params_step = matrix_features.AxisAlignedParamsStep_f32i32(set_number_features_step.OutputBufferId, buffers.X_FLOAT_DATA)
+    feature_params_step = matrix_features.SparseRandomProjectionParamsStep_f32i32(set_number_features_step.OutputBufferId, buffers.X_FLOAT_DATA, density)
+    max_params_dim = 2 + feature_params_step.GetNumberOfCombinedDimensions(kwargs['x'].shape[1])
     matrix_feature = matrix_features.LinearFloat32MatrixFeature_f32i32(feature_params_step.FloatParamsBufferId,
-                                                                      feature_params_step.IntParamsBufferId,
-                                                                      sample_data_step.IndicesBufferId,
-                                                                      buffers.X_FLOAT_DATA)
-    matrix_feature_extractor_step = matrix_features.LinearFloat32MatrixFeatureExtractorStep_f32i32(matrix_feature, feature_ordering)
+                                                                       feature_params_step.IntParamsBufferId,
+                                                                       sample_data_step.IndicesBufferId,
+                                                                       buffers.X_FLOAT_DATA)
+    matrix_feature_extractor_step = matrix_features.LinearFloat32MatrixBatchedFeatureExtractorStep_f32i32(matrix_feature, feature_ordering,
+                                                                                                          classification.ClassInfoGainBestSplitpointsWalkingSortedStep_f32i32.GetPreferredFeatureValueOrdering())
     slice_classes_step = pipeline.SliceInt32VectorBufferStep_i32(buffers.CLASS_LABELS, sample_data_step.IndicesBufferId)
     slice_weights_step = pipeline.SliceFloat32VectorBufferStep_i32(sample_data_step.WeightsBufferId, sample_data_step.IndicesBufferId)
     class_infogain_walker = classification.ClassInfoGainWalker_f32i32(slice_weights_step.SlicedBufferId,
@@ -77,8 +178,8 @@ def create_axis_aligned_matrix_walking_learner_32f(**kwargs):
     finalizer = classification.ClassEstimatorFinalizer_f32()
     split_selector = splitpoints.SplitSelector_f32i32([split_buffers], should_split_criteria, finalizer )
 
-    tree_learner = learn.DepthFirstTreeLearner_f32i32(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector)
-    forest_learner = learn.ParallelForestLearner(tree_learner, number_of_trees, 5, 5, number_of_classes, number_of_jobs)
+    tree_learner = create_tree_learner(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector, **kwargs)
+    forest_learner = learn.ParallelForestLearner(tree_learner, number_of_trees, max_params_dim, max_params_dim, number_of_classes, number_of_jobs)
     return forest_learner
 
 
@@ -102,11 +203,12 @@ def create_axis_aligned_matrix_one_stream_learner_32f(**kwargs):
     tree_steps_pipeline = pipeline.Pipeline([sample_data_step, set_number_features_step])
 
     feature_params_step = matrix_features.AxisAlignedParamsStep_f32i32(set_number_features_step.OutputBufferId, buffers.X_FLOAT_DATA)
-    matrix_feature = matrix_features.LinearFloat32MatrixFeature_f32i32(feature_params_step.FloatParamsBufferId,
-                                                                      feature_params_step.IntParamsBufferId,
-                                                                      sample_data_step.IndicesBufferId,
-                                                                      buffers.X_FLOAT_DATA)
-    matrix_feature_extractor_step = matrix_features.LinearFloat32MatrixFeatureExtractorStep_f32i32(matrix_feature, feature_ordering)
+    matrix_feature = matrix_features.AxisAlignedFloat32MatrixFeature_f32i32(feature_params_step.FloatParamsBufferId,
+                                                                            feature_params_step.IntParamsBufferId,
+                                                                            sample_data_step.IndicesBufferId,
+                                                                            buffers.X_FLOAT_DATA)
+    matrix_feature_extractor_step = matrix_features.AxisAlignedFloat32MatrixFeatureExtractorStep_f32i32(matrix_feature, feature_ordering,
+                                                                                                        classification.ClassStatsUpdaterOneStreamStep_f32i32.GetPreferredFeatureValueOrdering())
     slice_classes_step = pipeline.SliceInt32VectorBufferStep_i32(buffers.CLASS_LABELS, sample_data_step.IndicesBufferId)
     slice_weights_step = pipeline.SliceFloat32VectorBufferStep_i32(sample_data_step.WeightsBufferId, sample_data_step.IndicesBufferId)
 
@@ -149,7 +251,7 @@ def create_axis_aligned_matrix_one_stream_learner_32f(**kwargs):
     finalizer = classification.ClassEstimatorFinalizer_f32()
     split_selector = splitpoints.SplitSelector_f32i32([split_buffers], should_split_criteria, finalizer )
 
-    tree_learner = learn.DepthFirstTreeLearner_f32i32(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector)
+    tree_learner = create_tree_learner(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector, **kwargs)
     forest_learner = learn.ParallelForestLearner(tree_learner, number_of_trees, 5, 5, number_of_classes, number_of_jobs)
     return forest_learner
 
@@ -176,11 +278,12 @@ def create_axis_aligned_matrix_two_stream_learner_32f(**kwargs):
     tree_steps_pipeline = pipeline.Pipeline([sample_data_step, set_number_features_step, assign_stream_step])
 
     feature_params_step = matrix_features.AxisAlignedParamsStep_f32i32(set_number_features_step.OutputBufferId, buffers.X_FLOAT_DATA)
-    matrix_feature = matrix_features.LinearFloat32MatrixFeature_f32i32(feature_params_step.FloatParamsBufferId,
-                                                                      feature_params_step.IntParamsBufferId,
-                                                                      sample_data_step.IndicesBufferId,
-                                                                      buffers.X_FLOAT_DATA)
-    matrix_feature_extractor_step = matrix_features.LinearFloat32MatrixFeatureExtractorStep_f32i32(matrix_feature, feature_ordering)
+    matrix_feature = matrix_features.AxisAlignedFloat32MatrixFeature_f32i32(feature_params_step.FloatParamsBufferId,
+                                                                            feature_params_step.IntParamsBufferId,
+                                                                            sample_data_step.IndicesBufferId,
+                                                                            buffers.X_FLOAT_DATA)
+    matrix_feature_extractor_step = matrix_features.AxisAlignedFloat32MatrixFeatureExtractorStep_f32i32(matrix_feature, feature_ordering,
+                                                                                                        classification.ClassStatsUpdaterTwoStreamStep_f32i32.GetPreferredFeatureValueOrdering())
     slice_classes_step = pipeline.SliceInt32VectorBufferStep_i32(buffers.CLASS_LABELS, sample_data_step.IndicesBufferId)
     slice_weights_step = pipeline.SliceFloat32VectorBufferStep_i32(sample_data_step.WeightsBufferId, sample_data_step.IndicesBufferId)
 
@@ -224,26 +327,32 @@ def create_axis_aligned_matrix_two_stream_learner_32f(**kwargs):
     finalizer = classification.ClassEstimatorFinalizer_f32()
     split_selector = splitpoints.SplitSelector_f32i32([split_buffers], should_split_criteria, finalizer )
 
-    tree_learner = learn.DepthFirstTreeLearner_f32i32(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector)
+    tree_learner = create_tree_learner(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector, **kwargs)
     forest_learner = learn.ParallelForestLearner(tree_learner, number_of_trees, 5, 5, number_of_classes, number_of_jobs)
     return forest_learner
 
 def create_vanilia_classifier(**kwargs):
     return LearnerWrapper(  matrix_classification_data_prepare,
                             create_axis_aligned_matrix_walking_learner_32f,
+                            create_axis_aligned_matrix_predictor_32f,
+                            kwargs)
+
+def create_oblique_classifier(**kwargs):
+    return LearnerWrapper(  matrix_classification_data_prepare,
+                            create_oblique_matrix_walking_learner_32f,
                             create_matrix_predictor_32f,
                             kwargs)
 
 def create_one_stream_classifier(**kwargs):
     return LearnerWrapper(  matrix_classification_data_prepare,
                             create_axis_aligned_matrix_one_stream_learner_32f,
-                            create_matrix_predictor_32f,
+                            create_axis_aligned_matrix_predictor_32f,
                             kwargs)
 
 def create_two_stream_classifier(**kwargs):
     return LearnerWrapper(  matrix_classification_data_prepare,
                             create_axis_aligned_matrix_two_stream_learner_32f,
-                            create_matrix_predictor_32f,
+                            create_axis_aligned_matrix_predictor_32f,
                             kwargs)
 
 def create_online_axis_aligned_matrix_one_stream_learner_32f(**kwargs):
@@ -275,7 +384,8 @@ def create_online_axis_aligned_matrix_one_stream_learner_32f(**kwargs):
                                                                       feature_params_step.IntParamsBufferId,
                                                                       sample_data_step.IndicesBufferId,
                                                                       buffers.X_FLOAT_DATA)
-    matrix_feature_extractor_step = matrix_features.LinearFloat32MatrixFeatureExtractorStep_f32i32(matrix_feature, feature_ordering)
+    matrix_feature_extractor_step = matrix_features.LinearFloat32MatrixFeatureExtractorStep_f32i32(matrix_feature, feature_ordering,
+                                                                                                   classification.ClassStatsUpdaterOneStreamStep_f32i32.GetPreferredFeatureValueOrdering())
     slice_classes_step = pipeline.SliceInt32VectorBufferStep_i32(buffers.CLASS_LABELS, sample_data_step.IndicesBufferId)
     slice_weights_step = pipeline.SliceFloat32VectorBufferStep_i32(sample_data_step.WeightsBufferId, sample_data_step.IndicesBufferId)
 
@@ -339,7 +449,7 @@ def create_online_axis_aligned_matrix_one_stream_learner_32f(**kwargs):
 def create_online_one_stream_classifier(**kwargs):
     return LearnerWrapper(  matrix_classification_data_prepare,
                             create_online_axis_aligned_matrix_one_stream_learner_32f,
-                            create_matrix_predictor_32f,
+                            create_axis_aligned_matrix_predictor_32f,
                             kwargs)
 
 
@@ -376,7 +486,8 @@ def create_online_axis_aligned_matrix_two_stream_consistent_learner_32f(**kwargs
                                                                       feature_params_step.IntParamsBufferId,
                                                                       sample_data_step.IndicesBufferId,
                                                                       buffers.X_FLOAT_DATA)
-    matrix_feature_extractor_step = matrix_features.LinearFloat32MatrixFeatureExtractorStep_f32i32(matrix_feature, feature_ordering)
+    matrix_feature_extractor_step = matrix_features.LinearFloat32MatrixFeatureExtractorStep_f32i32(matrix_feature, feature_ordering,
+                                                                                                   classification.ClassStatsUpdaterTwoStreamStep_f32i32.GetPreferredFeatureValueOrdering())
     slice_classes_step = pipeline.SliceInt32VectorBufferStep_i32(buffers.CLASS_LABELS, sample_data_step.IndicesBufferId)
     slice_weights_step = pipeline.SliceFloat32VectorBufferStep_i32(sample_data_step.WeightsBufferId, sample_data_step.IndicesBufferId)
     slice_assign_stream_step = pipeline.SliceInt32VectorBufferStep_i32(assign_stream_step.StreamTypeBufferId, sample_data_step.IndicesBufferId)
@@ -445,5 +556,5 @@ def create_online_axis_aligned_matrix_two_stream_consistent_learner_32f(**kwargs
 def create_online_two_stream_consistent_classifier(**kwargs):
     return LearnerWrapper(  matrix_classification_data_prepare,
                             create_online_axis_aligned_matrix_two_stream_consistent_learner_32f,
-                            create_matrix_predictor_32f,
+                            create_axis_aligned_matrix_predictor_32f,
                             kwargs)
\ No newline at end of file
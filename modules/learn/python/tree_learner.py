@@ -0,0 +1,6 @@
+import learn
+
+
+def create_tree_learner(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector, **kwargs):
+    number_of_subtree_jobs = int( kwargs.get('number_of_subtree_jobs', 1) )
+    return learn.DepthFirstTreeLearner_f32i32(try_split_criteria, tree_steps_pipeline, node_steps_pipeline, split_selector, number_of_subtree_jobs)
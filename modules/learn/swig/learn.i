@@ -7,6 +7,9 @@
     #include "OnlineForestLearner.h"
 
     #include "LinearMatrixFeature.h"
+    #include "BestSplitpointsHistogramStep.h"
+    #include "BestSplitpointsPresortedStep.h"
+    #include "ClassInfoGainWalker.h"
     #include "ScaledDepthDeltaFeature.h"
     #include "ClassEstimatorUpdater.h"
     #include "ClassProbabilityOfError.h"
@@ -17,6 +20,7 @@
 %include <exception.i>
 %import(module="rftk.asserts") "asserts.i"
 %import(module="rftk.buffers") "buffers.i"
+%import(module="rftk.forest_data") "forest_data.i"
 %import(module="rftk.pipeline") "pipeline_external.i"
 
 %import(module="rftk.matrix_features") "matrix_features_external.i"
@@ -36,6 +40,9 @@
 
 %template(DepthFirstTreeLearner_f32i32) DepthFirstTreeLearner<float, int>;
 
+%template(ClassInfoGainBestSplitpointsHistogramStep_f32i32) BestSplitpointsHistogramStep< ClassInfoGainWalker<float, int> >;
+%template(ClassInfoGainBestSplitpointsPresortedStep_f32i32) BestSplitpointsPresortedStep< ClassInfoGainWalker<float, int> >;
+
 %template(OnlineForestMatrixClassLearner_f32i32)  OnlineForestLearner< LinearMatrixFeature< MatrixBufferTemplate<float>, float, int >, ClassEstimatorUpdater< float, int >, ClassProbabilityOfError, float, int >;
 
 %template(OnlineForestScaledDepthDeltaClassLearner_f32i32)  OnlineForestLearner< ScaledDepthDeltaFeature< float, int >, ClassEstimatorUpdater< float, int >, ClassProbabilityOfError, float, int >;
\ No newline at end of file
@@ -1,10 +1,14 @@
 #include "CreateDepthFirstLearner.h"
 
+// With presortFeatures the split points are walked from presorted indices
+// instead of sorting the feature values
 DepthFirstTreeLearner<float, int> CreateDepthFirstLearner( BufferCollectionKey_t xs_key, 
                                                           BufferCollectionKey_t classes_key, 
                                                           int numberOfClasses, 
                                                           FeatureValueOrdering featureOrdering, 
-                                                          double minNodeSize)
+                                                          double minNodeSize,
+                                                          int numberOfSubtreeJobs,
+                                                          bool presortFeatures)
 {
     // Don't try split if size is above a minimum
     MinNodeSizeCriteria trySplitCriteria(minNodeSize);
@@ -16,6 +20,11 @@ DepthFirstTreeLearner<float, int> CreateDepthFirstLearner( BufferCollectionKey_t
     VectorBufferTemplate<int> numberOfFeaturesBuffer = CreateVector1<int>(2);
     SetBufferStep< VectorBufferTemplate<int> > numberOfFeatures( numberOfFeaturesBuffer, WHEN_NEW );
     treeSteps.push_back(&numberOfFeatures);
+    PresortFeaturesStep<float, int> presortFeaturesStep(xs_key);
+    if( presortFeatures )
+    {
+        treeSteps.push_back(&presortFeaturesStep);
+    }
     Pipeline treeStepsPipeline(treeSteps);
 
     // Node steps
@@ -37,17 +46,30 @@ DepthFirstTreeLearner<float, int> CreateDepthFirstLearner( BufferCollectionKey_t
     BestSplitpointsWalkingSortedStep< ClassInfoGainWalker<float, int> > bestSplitpointStep(classInfoGainWalker, 
                                                                                             featureExtractor.FeatureValuesBufferId,
                                                                                             featureOrdering);
-    nodeSteps.push_back(&bestSplitpointStep); 
+    BestSplitpointsPresortedStep< ClassInfoGainWalker<float, int> > presortedSplitpointStep(classInfoGainWalker,
+                                                                                            presortFeaturesStep.SortedIndicesBufferId,
+                                                                                            xs_key,
+                                                                                            featureParams.FloatParamsBufferId,
+                                                                                            featureParams.IntParamsBufferId,
+                                                                                            allSamplesStep.IndicesBufferId);
+    if( presortFeatures )
+    {
+        nodeSteps.push_back(&presortedSplitpointStep);
+    }
+    else
+    {
+        nodeSteps.push_back(&bestSplitpointStep);
+    }
     Pipeline nodeStepsPipeline(nodeSteps);
 
     //Split Selector
     std::vector<SplitSelectorBuffers> splitBuffers;
-    splitBuffers.push_back(SplitSelectorBuffers(bestSplitpointStep.ImpurityBufferId,
-                                                bestSplitpointStep.SplitpointBufferId,
-                                                bestSplitpointStep.SplitpointCountsBufferId,
-                                                bestSplitpointStep.ChildCountsBufferId,
-                                                bestSplitpointStep.LeftYsBufferId,
-                                                bestSplitpointStep.RightYsBufferId,
+    splitBuffers.push_back(SplitSelectorBuffers(presortFeatures ? presortedSplitpointStep.ImpurityBufferId : bestSplitpointStep.ImpurityBufferId,
+                                                presortFeatures ? presortedSplitpointStep.SplitpointBufferId : bestSplitpointStep.SplitpointBufferId,
+                                                presortFeatures ? presortedSplitpointStep.SplitpointCountsBufferId : bestSplitpointStep.SplitpointCountsBufferId,
+                                                presortFeatures ? presortedSplitpointStep.ChildCountsBufferId : bestSplitpointStep.ChildCountsBufferId,
+                                                presortFeatures ? presortedSplitpointStep.LeftYsBufferId : bestSplitpointStep.LeftYsBufferId,
+                                                presortFeatures ? presortedSplitpointStep.RightYsBufferId : bestSplitpointStep.RightYsBufferId,
                                                 featureParams.FloatParamsBufferId,
                                                 featureParams.IntParamsBufferId,
                                                 featureExtractor.FeatureValuesBufferId,
@@ -57,5 +79,33 @@ DepthFirstTreeLearner<float, int> CreateDepthFirstLearner( BufferCollectionKey_t
     ClassEstimatorFinalizer<float> classFinalizer;
     SplitSelector<float, int> splitSelector(splitBuffers, &noCriteria, &classFinalizer);
     
-    return DepthFirstTreeLearner<float, int>(&trySplitCriteria, &treeStepsPipeline, &nodeStepsPipeline, &splitSelector);
+    return DepthFirstTreeLearner<float, int>(&trySplitCriteria, &treeStepsPipeline, &nodeStepsPipeline, &splitSelector, numberOfSubtreeJobs);
+}
+
+// Node indices depend on the order nodes are split in so trees are compared
+// by walking both from the root
+bool SameSubtree(const Tree& tree, int nodeIndex, const Tree& otherTree, int otherNodeIndex)
+{
+    if( !(tree.mIntFeatureParams.SliceRow(nodeIndex) == otherTree.mIntFeatureParams.SliceRow(otherNodeIndex))
+        || !(tree.mFloatFeatureParams.SliceRow(nodeIndex) == otherTree.mFloatFeatureParams.SliceRow(otherNodeIndex))
+        || tree.mCounts.Get(nodeIndex) != otherTree.mCounts.Get(otherNodeIndex)
+        || tree.mDepths.Get(nodeIndex) != otherTree.mDepths.Get(otherNodeIndex)
+        || !(tree.mYs.SliceRow(nodeIndex) == otherTree.mYs.SliceRow(otherNodeIndex)) )
+    {
+        return false;
+    }
+    for(int child=0; child<2; child++)
+    {
+        const int childIndex = tree.mPath.Get(nodeIndex, child);
+        const int otherChildIndex = otherTree.mPath.Get(otherNodeIndex, child);
+        if( (childIndex == NULL_CHILD) != (otherChildIndex == NULL_CHILD) )
+        {
+            return false;
+        }
+        if( childIndex != NULL_CHILD && !SameSubtree(tree, childIndex, otherTree, otherChildIndex) )
+        {
+            return false;
+        }
+    }
+    return true;
 }
\ No newline at end of file
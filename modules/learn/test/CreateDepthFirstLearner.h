@@ -19,6 +19,8 @@
 #include "FeatureExtractorStep.h"
 #include "ClassInfoGainWalker.h"
 #include "BestSplitpointsWalkingSortedStep.h"
+#include "PresortFeaturesStep.h"
+#include "BestSplitpointsPresortedStep.h"
 #include "Pipeline.h"
 
 #include "ShouldSplitNoCriteria.h"
@@ -86,4 +88,9 @@ DepthFirstTreeLearner<float, int> CreateDepthFirstLearner( BufferCollectionKey_t
                                                           BufferCollectionKey_t classes_key, 
                                                           int numberOfClasses, 
                                                           FeatureValueOrdering featureOrdering, 
-                                                          double minNodeSize);
\ No newline at end of file
+                                                          double minNodeSize,
+                                                          int numberOfSubtreeJobs=1,
+                                                          bool presortFeatures=false);
+
+// True when the subtrees rooted at nodeIndex and otherNodeIndex are the same
+bool SameSubtree(const Tree& tree, int nodeIndex, const Tree& otherTree, int otherNodeIndex);
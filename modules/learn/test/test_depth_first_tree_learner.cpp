@@ -129,6 +129,66 @@ BOOST_AUTO_TEST_CASE(test_Learn_DATAPOINTS_BY_FEATURES)
     BOOST_CHECK_CLOSE( tree.mYs.Get(6,3), 1.0, 0.1 );
 }
 
+BOOST_AUTO_TEST_CASE(test_Learn_AUTOMATIC_ORDERING)
+{
+    const int numberOfClasses = 4;
+    const double minNodeSize = 1.0;
+
+    DepthFirstTreeLearner<float, int> fixedOrderingLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, FEATURES_BY_DATAPOINTS, minNodeSize);
+    Tree expectedTree(1, 4, 3, numberOfClasses );
+    fixedOrderingLearner.Learn(collection, expectedTree, 0);
+
+    DepthFirstTreeLearner<float, int> automaticOrderingLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, AUTOMATIC_ORDERING, minNodeSize);
+    Tree tree(1, 4, 3, numberOfClasses );
+    automaticOrderingLearner.Learn(collection, tree, 0);
+
+    BOOST_CHECK( tree.mPath == expectedTree.mPath );
+    BOOST_CHECK( tree.mIntFeatureParams == expectedTree.mIntFeatureParams );
+    BOOST_CHECK( tree.mFloatFeatureParams == expectedTree.mFloatFeatureParams );
+    BOOST_CHECK( tree.mCounts == expectedTree.mCounts );
+    BOOST_CHECK( tree.mDepths == expectedTree.mDepths );
+    BOOST_CHECK( tree.mYs == expectedTree.mYs );
+}
+
+BOOST_AUTO_TEST_CASE(test_Learn_subtree_jobs)
+{
+    const int numberOfClasses = 4;
+    const double minNodeSize = 1.0;
+    FeatureValueOrdering featureOrdering = FEATURES_BY_DATAPOINTS;
+
+    DepthFirstTreeLearner<float, int> serialLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize);
+    Tree expectedTree(1, 3, 3, numberOfClasses );
+    serialLearner.Learn(collection, expectedTree, 0);
+
+    DepthFirstTreeLearner<float, int> subtreeJobsLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize, 4);
+    for(int i=0; i<10; i++)
+    {
+        Tree tree(1, 3, 3, numberOfClasses );
+        subtreeJobsLearner.Learn(collection, tree, 0);
+        BOOST_CHECK_EQUAL( tree.mPath.GetM(), expectedTree.mPath.GetM() );
+        BOOST_CHECK( SameSubtree(tree, 0, expectedTree, 0) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_Learn_presorted)
+{
+    const int numberOfClasses = 4;
+    const double minNodeSize = 1.0;
+    FeatureValueOrdering featureOrdering = FEATURES_BY_DATAPOINTS;
+
+    DepthFirstTreeLearner<float, int> sortingLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize);
+    DepthFirstTreeLearner<float, int> presortedLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize, 1, true);
+    for(unsigned int seed=0; seed<10; seed++)
+    {
+        Tree expectedTree(1, 3, 3, numberOfClasses );
+        sortingLearner.Learn(collection, expectedTree, seed);
+        Tree tree(1, 3, 3, numberOfClasses );
+        presortedLearner.Learn(collection, tree, seed);
+        BOOST_CHECK( tree.mPath == expectedTree.mPath );
+        BOOST_CHECK( SameSubtree(tree, 0, expectedTree, 0) );
+    }
+}
+
 BOOST_AUTO_TEST_CASE(test_Learn_minsize)
 {
     // Constants
@@ -179,4 +239,31 @@ BOOST_AUTO_TEST_CASE(test_Learn_minsize)
     BOOST_CHECK_CLOSE( tree.mYs.Get(2,3), 0.2, 0.1 );
 }
 
+BOOST_AUTO_TEST_CASE(test_Learn_reads_forest_data_from_stack)
+{
+    const int numberOfClasses = 4;
+    const double minNodeSize = 1.0;
+    FeatureValueOrdering featureOrdering = FEATURES_BY_DATAPOINTS;
+
+    DepthFirstTreeLearner<float, int> depthFirstTreeLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize);
+    Tree expectedTree(1, 3, 3, numberOfClasses );
+    depthFirstTreeLearner.Learn(collection, expectedTree, 0);
+
+    // The xs live in a collection above the data like the outputs of forest
+    // steps (see ParallelForestLearner)
+    BufferCollection data;
+    data.AddBuffer(classes_key, classes);
+    BufferCollection forestData;
+    forestData.AddBuffer(xs_key, xs);
+    BufferCollectionStack stack;
+    stack.Push(&data);
+    stack.Push(&forestData);
+    Tree tree(1, 3, 3, numberOfClasses );
+    depthFirstTreeLearner.Learn(stack, tree, 0);
+
+    BOOST_CHECK( tree.mPath == expectedTree.mPath );
+    BOOST_CHECK( tree.mFloatFeatureParams == expectedTree.mFloatFeatureParams );
+    BOOST_CHECK( tree.mYs == expectedTree.mYs );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
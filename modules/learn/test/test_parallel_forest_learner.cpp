@@ -1,8 +1,66 @@
+#include <fstream>
+#include <string>
 #include <boost/test/unit_test.hpp>
 
 #include "CreateDepthFirstLearner.h"
 #include "ParallelForestLearner.h"
 
+// Counts how many times the training data is copied
+struct CopyCountingBuffer
+{
+    CopyCountingBuffer() {}
+    CopyCountingBuffer(const CopyCountingBuffer&) { ++sNumberOfCopies; }
+    CopyCountingBuffer& operator=(const CopyCountingBuffer&) { ++sNumberOfCopies; return *this; }
+
+    static int sNumberOfCopies;
+};
+int CopyCountingBuffer::sNumberOfCopies = 0;
+
+// Counts how many times it is processed
+class CountingStep: public PipelineStepI
+{
+public:
+    virtual PipelineStepI* Clone() const { return new CountingStep(*this); }
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const
+    {
+        UNUSED_PARAM(readCollection);
+        UNUSED_PARAM(gen);
+        writeCollection.AddBuffer("forest_data", VectorBufferTemplate<int>(1));
+        ++sNumberOfProcessCalls;
+    }
+
+    static int sNumberOfProcessCalls;
+};
+int CountingStep::sNumberOfProcessCalls = 0;
+
+// Peak resident set size of the process in kB (0 where /proc is not available)
+long PeakResidentSetSizeKb()
+{
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    long value = 0;
+    while(status >> key)
+    {
+        if(key == "VmHWM:")
+        {
+            status >> value;
+            return value;
+        }
+    }
+    return 0;
+}
+
+// Resets the peak resident set size to the current one (Linux 4.0 and later)
+bool ResetPeakResidentSetSize()
+{
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.close();
+    return !clearRefs.fail();
+}
+
 
 BOOST_FIXTURE_TEST_SUITE( ParallelForestLearnerTest,  DepthFirstTreeLearnerFixture )
 
@@ -16,8 +74,8 @@ BOOST_AUTO_TEST_CASE(test_Learn)
     DepthFirstTreeLearner<float, int> depthFirstTreeLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize);
 
     ParallelForestLearner parallelForestLearner(&depthFirstTreeLearner, 100, 3, 3, numberOfClasses, 10);
-    Forest forest = parallelForestLearner.Learn(collection);
-    Tree tree = forest.mTrees[99];
+    ForestHandle forest = parallelForestLearner.Learn(collection);
+    const Tree& tree = forest->GetTree(99);
 
     int expected_path_data[] = { 1,2,
                         -1,-1,
@@ -71,4 +129,137 @@ BOOST_AUTO_TEST_CASE(test_Learn)
     BOOST_CHECK_CLOSE( tree.mYs.Get(6,3), 1.0, 0.1 );
 }
 
+BOOST_AUTO_TEST_CASE(test_Learn_job_utilization)
+{
+    const int numberOfClasses = 4;
+    const int numberOfTrees = 7;
+    const int numberOfJobs = 3;
+    FeatureValueOrdering featureOrdering = FEATURES_BY_DATAPOINTS;
+    const double minNodeSize = 1.0;
+
+    DepthFirstTreeLearner<float, int> depthFirstTreeLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize);
+
+    ParallelForestLearner parallelForestLearner(&depthFirstTreeLearner, numberOfTrees, 3, 3, numberOfClasses, numberOfJobs);
+    ForestLearnerJobStats jobStats;
+    ForestHandle forest = parallelForestLearner.Learn(collection, jobStats);
+
+    // Every tree is learned exactly once whichever job picks it up
+    for(int t=0; t<numberOfTrees; t++)
+    {
+        BOOST_CHECK_EQUAL( forest->GetTree(t).mDepths.Get(1), 1 );
+    }
+
+    const VectorBufferTemplate<int>& treeCounts = jobStats.mJobTreeCounts;
+    const VectorBufferTemplate<float>& utilization = jobStats.mJobUtilization;
+    BOOST_CHECK_EQUAL( treeCounts.GetN(), numberOfJobs );
+    BOOST_CHECK_EQUAL( utilization.GetN(), numberOfJobs );
+
+    int totalTrees = 0;
+    for(int job=0; job<numberOfJobs; job++)
+    {
+        totalTrees += treeCounts.Get(job);
+        BOOST_CHECK( utilization.Get(job) >= 0.0f );
+        BOOST_CHECK( utilization.Get(job) <= 1.01f );
+    }
+    BOOST_CHECK_EQUAL( totalTrees, numberOfTrees );
+}
+
+BOOST_AUTO_TEST_CASE(test_Compacted_leaves_shared_tree_unchanged)
+{
+    const int numberOfClasses = 4;
+    FeatureValueOrdering featureOrdering = FEATURES_BY_DATAPOINTS;
+    const double minNodeSize = 1.0;
+
+    DepthFirstTreeLearner<float, int> depthFirstTreeLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize);
+
+    ParallelForestLearner parallelForestLearner(&depthFirstTreeLearner, 2, 3, 3, numberOfClasses, 1);
+    ForestHandle forest = parallelForestLearner.Learn(collection);
+    const Tree& tree = forest->GetTree(0);
+    const int numberOfAllocatedNodes = tree.mPath.GetM();
+
+    // Every node but the root is the child of another node after compacting
+    const Tree compacted = tree.Compacted();
+    int numberOfChildren = 0;
+    for(int nodeId=0; nodeId<compacted.mPath.GetM(); nodeId++)
+    {
+        numberOfChildren += (compacted.mPath.Get(nodeId, 0) != NULL_CHILD) ? 2 : 0;
+    }
+    BOOST_CHECK_EQUAL( numberOfChildren + 1, compacted.mPath.GetM() );
+    BOOST_CHECK_EQUAL( compacted.mYs.GetM(), compacted.mPath.GetM() );
+    BOOST_CHECK_EQUAL( tree.mPath.GetM(), numberOfAllocatedNodes );
+    BOOST_CHECK( compacted.mPath.GetM() < numberOfAllocatedNodes );
+}
+
+#if USE_BOOST_THREAD
+BOOST_AUTO_TEST_CASE(test_Learn_does_not_copy_data)
+{
+    const int numberOfClasses = 4;
+    FeatureValueOrdering featureOrdering = FEATURES_BY_DATAPOINTS;
+    const double minNodeSize = 1.0;
+
+    DepthFirstTreeLearner<float, int> depthFirstTreeLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize);
+
+    collection.AddBuffer("copy_counting", CopyCountingBuffer());
+    CopyCountingBuffer::sNumberOfCopies = 0;
+
+    ParallelForestLearner parallelForestLearner(&depthFirstTreeLearner, 8, 3, 3, numberOfClasses, 4);
+    ForestHandle forest = parallelForestLearner.Learn(collection);
+    BOOST_CHECK_EQUAL( CopyCountingBuffer::sNumberOfCopies, 0 );
+}
+
+BOOST_AUTO_TEST_CASE(test_Learn_peak_memory_does_not_scale_with_jobs)
+{
+    const int numberOfClasses = 4;
+    FeatureValueOrdering featureOrdering = FEATURES_BY_DATAPOINTS;
+    const double minNodeSize = 1.0;
+    const int numberOfJobs = 8;
+
+    DepthFirstTreeLearner<float, int> depthFirstTreeLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize);
+
+    // 64MB of unused training data
+    const int ballastRows = 4096;
+    const int ballastColumns = 4096;
+    collection.AddBuffer("ballast", MatrixBufferTemplate<float>(ballastRows, ballastColumns));
+    const long ballastKb = static_cast<long>(ballastRows) * ballastColumns * sizeof(float) / 1024;
+
+    // The peak of each run is measured from the resident set size before it
+    // so memory from earlier tests does not count
+    if( !ResetPeakResidentSetSize() )
+    {
+        BOOST_TEST_MESSAGE("Skipped: the peak resident set size can not be reset");
+        return;
+    }
+    const long beforeOneJobKb = PeakResidentSetSizeKb();
+    ParallelForestLearner oneJobForestLearner(&depthFirstTreeLearner, 2*numberOfJobs, 3, 3, numberOfClasses, 1);
+    ForestHandle oneJobForest = oneJobForestLearner.Learn(collection);
+    const long oneJobKb = PeakResidentSetSizeKb() - beforeOneJobKb;
+
+    ResetPeakResidentSetSize();
+    const long beforeJobsKb = PeakResidentSetSizeKb();
+    ParallelForestLearner parallelForestLearner(&depthFirstTreeLearner, 2*numberOfJobs, 3, 3, numberOfClasses, numberOfJobs);
+    ForestHandle forest = parallelForestLearner.Learn(collection);
+    const long jobsKb = PeakResidentSetSizeKb() - beforeJobsKb;
+
+    // A copy per job would add (numberOfJobs-1) * ballastKb over one job
+    BOOST_CHECK_LT( jobsKb - oneJobKb, ballastKb );
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(test_Learn_forest_steps_run_once)
+{
+    const int numberOfClasses = 4;
+    FeatureValueOrdering featureOrdering = FEATURES_BY_DATAPOINTS;
+    const double minNodeSize = 1.0;
+
+    DepthFirstTreeLearner<float, int> depthFirstTreeLearner = CreateDepthFirstLearner(xs_key, classes_key, numberOfClasses, featureOrdering, minNodeSize);
+
+    CountingStep::sNumberOfProcessCalls = 0;
+    CountingStep countingStep;
+    ParallelForestLearner parallelForestLearner(&depthFirstTreeLearner, 20, 3, 3, numberOfClasses, 4, &countingStep);
+    ForestHandle forest = parallelForestLearner.Learn(collection);
+    BOOST_CHECK_EQUAL( CountingStep::sNumberOfProcessCalls, 1 );
+    BOOST_CHECK_EQUAL( forest->GetNumberOfTrees(), 20 );
+    BOOST_CHECK( !collection.HasBuffer("forest_data") );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "asserts.h"
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "UniqueBufferId.h"
+#include "LinearMatrixFeature.h"
+#include "AxisAlignedMatrixFeatureBinding.h"
+
+// ----------------------------------------------------------------------------
+//
+// AxisAlignedMatrixFeature is a single dimension (column) of each sample
+// (row).  It uses the same params as LinearMatrixFeature so it can replace it
+// (for learning and prediction) when the params come from
+// AxisAlignedParamsStep.
+//
+// ----------------------------------------------------------------------------
+template <class DataMatrixType, class FloatType, class IntType>
+class AxisAlignedMatrixFeature
+{
+public:
+    AxisAlignedMatrixFeature( const BufferId& floatParamsBufferId,
+                              const BufferId& intParamsBufferId,
+                              const BufferId& indicesBufferId,
+                              const BufferId& matrixDataBufferId );
+
+    AxisAlignedMatrixFeature( const BufferId& indicesBufferId,
+                              const BufferId& matrixDataBufferId );
+
+    ~AxisAlignedMatrixFeature();
+
+    AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType> Bind(const BufferCollectionStack& readCollection) const;
+
+
+    typedef FloatType Float;
+    typedef IntType Int;
+    typedef AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType> FeatureBinding;
+
+    const BufferId mFloatParamsBufferId;
+    const BufferId mIntParamsBufferId;
+    const BufferId mIndicesBufferId;
+    const BufferId mDataMatrixBufferId;
+};
+
+template <class DataMatrixType, class FloatType, class IntType>
+AxisAlignedMatrixFeature<DataMatrixType, FloatType, IntType>::AxisAlignedMatrixFeature( const BufferId& floatParamsBufferId,
+                                                                                      const BufferId& intParamsBufferId,
+                                                                                      const BufferId& indicesBufferId,
+                                                                                      const BufferId& matrixDataBufferId )
+: mFloatParamsBufferId(floatParamsBufferId)
+, mIntParamsBufferId(intParamsBufferId)
+, mIndicesBufferId(indicesBufferId)
+, mDataMatrixBufferId(matrixDataBufferId)
+{}
+
+template <class DataMatrixType, class FloatType, class IntType>
+AxisAlignedMatrixFeature<DataMatrixType, FloatType, IntType>::AxisAlignedMatrixFeature( const BufferId& indicesBufferId,
+                                                                                      const BufferId& matrixDataBufferId )
+: mFloatParamsBufferId(GetBufferId("floatParams"))
+, mIntParamsBufferId(GetBufferId("intParams"))
+, mIndicesBufferId(indicesBufferId)
+, mDataMatrixBufferId(matrixDataBufferId)
+{}
+
+template <class DataMatrixType, class FloatType, class IntType>
+AxisAlignedMatrixFeature<DataMatrixType, FloatType, IntType>::~AxisAlignedMatrixFeature()
+{}
+
+template <class DataMatrixType, class FloatType, class IntType>
+AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType> AxisAlignedMatrixFeature<DataMatrixType, FloatType, IntType>::Bind(const BufferCollectionStack& readCollection) const
+{
+    MatrixBufferTemplate<IntType> const* intParams = readCollection.GetBufferPtr< MatrixBufferTemplate<IntType> >(mIntParamsBufferId);
+    VectorBufferTemplate<IntType> const* indices = readCollection.GetBufferPtr< VectorBufferTemplate<IntType> >(mIndicesBufferId);
+    DataMatrixType const* dataMatrix = readCollection.GetBufferPtr< DataMatrixType >(mDataMatrixBufferId);
+
+    ASSERT(intParams->GetN() > PARAM_START_INDEX);
+
+    return AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType>(intParams, indices, dataMatrix);
+}
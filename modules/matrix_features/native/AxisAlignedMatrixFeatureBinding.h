@@ -0,0 +1,99 @@
+#pragma once
+
+#include "asserts.h"
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Constants.h"
+#include "LinearMatrixFeatureBinding.h"
+
+// ----------------------------------------------------------------------------
+//
+// AxisAlignedMatrixFeature is a single dimension (column) of each sample
+// (row).  It reads the params written by AxisAlignedParamsStep (one dimension
+// with a weight of 1.0) and returns x[index][dimension] directly instead of
+// looping over the dimensions like LinearMatrixFeatureBinding.
+//
+// ----------------------------------------------------------------------------
+template <class DataMatrixType, class FloatType, class IntType>
+class AxisAlignedMatrixFeatureBinding
+{
+public:
+    AxisAlignedMatrixFeatureBinding( MatrixBufferTemplate<IntType> const* intParams,
+                                     VectorBufferTemplate<IntType> const* indices,
+                                     DataMatrixType const* dataMatrix);
+    AxisAlignedMatrixFeatureBinding();
+    ~AxisAlignedMatrixFeatureBinding();
+
+    AxisAlignedMatrixFeatureBinding(const AxisAlignedMatrixFeatureBinding& other);
+    AxisAlignedMatrixFeatureBinding & operator=(const AxisAlignedMatrixFeatureBinding & other);
+
+    FloatType FeatureValue( const int featureIndex, const int relativeSampleIndex) const;
+
+    IntType GetNumberOfFeatures() const;
+    IntType GetNumberOfDatapoints() const;
+
+private:
+    MatrixBufferTemplate<IntType> const* mIntParams;
+    VectorBufferTemplate<IntType> const* mIndices;
+    DataMatrixType const* mDataMatrix;
+};
+
+template <class DataMatrixType, class FloatType, class IntType>
+AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::AxisAlignedMatrixFeatureBinding( MatrixBufferTemplate<IntType> const* intParams,
+                                                                                                   VectorBufferTemplate<IntType> const* indices,
+                                                                                                   DataMatrixType const* dataMatrix )
+: mIntParams(intParams)
+, mIndices(indices)
+, mDataMatrix(dataMatrix)
+{}
+
+template <class DataMatrixType, class FloatType, class IntType>
+AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::AxisAlignedMatrixFeatureBinding()
+: mIntParams(NULL)
+, mIndices(NULL)
+, mDataMatrix(NULL)
+{}
+
+template <class DataMatrixType, class FloatType, class IntType>
+AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::AxisAlignedMatrixFeatureBinding( const AxisAlignedMatrixFeatureBinding& other )
+: mIntParams(other.mIntParams)
+, mIndices(other.mIndices)
+, mDataMatrix(other.mDataMatrix)
+{}
+
+template <class DataMatrixType, class FloatType, class IntType>
+AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType>& AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::operator=(const AxisAlignedMatrixFeatureBinding & other)
+{
+    mIntParams = other.mIntParams;
+    mIndices = other.mIndices;
+    mDataMatrix = other.mDataMatrix;
+    return *this;
+}
+
+template <class DataMatrixType, class FloatType, class IntType>
+AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::~AxisAlignedMatrixFeatureBinding()
+{}
+
+template <class DataMatrixType, class FloatType, class IntType>
+FloatType AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::FeatureValue( const int featureIndex, const int relativeSampleIndex) const
+{
+    ASSERT_VALID_RANGE(featureIndex, 0, mIntParams->GetM())
+    ASSERT_VALID_RANGE(relativeSampleIndex, 0, mIndices->GetN())
+    const IntType dimension = mIntParams->GetUnsafe(featureIndex, PARAM_START_INDEX);
+    const IntType matrixIndex = mIndices->GetUnsafe(relativeSampleIndex);
+    ASSERT_VALID_RANGE(matrixIndex, 0, mDataMatrix->GetM())
+    ASSERT_VALID_RANGE(dimension, 0, mDataMatrix->GetN())
+    return static_cast<FloatType>(mDataMatrix->GetUnsafe(matrixIndex, dimension));
+}
+
+template <class DataMatrixType, class FloatType, class IntType>
+IntType AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::GetNumberOfFeatures() const
+{
+    return mIntParams->GetM();
+}
+
+template <class DataMatrixType, class FloatType, class IntType>
+IntType AxisAlignedMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::GetNumberOfDatapoints() const
+{
+    return mIndices->GetN();
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "asserts.h"
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+#include "LinearMatrixFeatureBinding.h"
+#include "NodeHistograms.h"
+
+// ----------------------------------------------------------------------------
+//
+// Finds the split point with the highest impurity for each axis aligned
+// matrix feature from the features binned by BinFeaturesStep.  Each feature
+// builds a histogram of ys per bin in one pass over the samples of the node
+// and the bins are then walked from low to high with the impurity walker.
+// This replaces the sort of BestSplitpointsWalkingSortedStep with a linear
+// pass and writes the same output buffers so it plugs into
+// SplitSelectorBuffers.  The split points are bin edges so splitting the
+// (unbinned) feature values with the split point reproduces the bins.
+//
+// The histograms of each dimension are written to the node collection under
+// NODE_HISTOGRAMS.  When the tree learner passes the parent's histograms down
+// (PARENT_HISTOGRAMS) the child processed first also builds the histograms of
+// the parent's other dimensions, and its sibling derives any dimension both
+// have as parent minus sibling without visiting its samples.  Only dimensions
+// of the parent can be derived so the features should be drawn once per tree
+// (AxisAlignedParamsStep as a tree step) to keep the same dimensions at every
+// node.  Features drawn per node rarely share dimensions with the parent and
+// most histograms are built from the samples again.
+//
+// The walker must implement AddToYsHistogram and MoveYsHistogramLeftToRight
+// (see ClassInfoGainWalker).
+//
+// ----------------------------------------------------------------------------
+template <class ImpurityWalker>
+class BestSplitpointsHistogramStep : public PipelineStepI
+{
+public:
+    BestSplitpointsHistogramStep (const ImpurityWalker& impurityWalker,
+                                  const BufferId& binnedFeatures,
+                                  const BufferId& binEdges,
+                                  const BufferId& numberOfBins,
+                                  const BufferId& floatParams,
+                                  const BufferId& intParams,
+                                  const BufferId& indices );
+    virtual ~BestSplitpointsHistogramStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    // Read only output buffer
+    const BufferId ImpurityBufferId;
+    const BufferId SplitpointBufferId;
+    const BufferId SplitpointCountsBufferId;
+    const BufferId ChildCountsBufferId;
+    const BufferId LeftYsBufferId;
+    const BufferId RightYsBufferId;
+private:
+    typedef typename ImpurityWalker::Float FloatType;
+    typedef typename ImpurityWalker::Int IntType;
+
+    void BuildHistogram( const ImpurityWalker& impurityWalker,
+                         const MatrixBufferTemplate<unsigned char>& binnedFeatures,
+                         const VectorBufferTemplate<IntType>& indices,
+                         const IntType dimension,
+                         const IntType bins,
+                         std::vector<FloatType>& ysHistograms,
+                         std::vector<IntType>& binCounts ) const;
+
+    const ImpurityWalker mImpurityWalker;
+    const BufferId mBinnedFeaturesBufferId;
+    const BufferId mBinEdgesBufferId;
+    const BufferId mNumberOfBinsBufferId;
+    const BufferId mFloatParamsBufferId;
+    const BufferId mIntParamsBufferId;
+    const BufferId mIndicesBufferId;
+};
+
+
+template <class ImpurityWalker>
+BestSplitpointsHistogramStep<ImpurityWalker>::BestSplitpointsHistogramStep(const ImpurityWalker& impurityWalker,
+                                                                           const BufferId& binnedFeatures,
+                                                                           const BufferId& binEdges,
+                                                                           const BufferId& numberOfBins,
+                                                                           const BufferId& floatParams,
+                                                                           const BufferId& intParams,
+                                                                           const BufferId& indices )
+: ImpurityBufferId( GetBufferId("Impurity") )
+, SplitpointBufferId( GetBufferId("Splitpoints") )
+, SplitpointCountsBufferId( GetBufferId("SplitpointsCounts") )
+, ChildCountsBufferId( GetBufferId("ChildCounts") )
+, LeftYsBufferId( GetBufferId("LeftYs") )
+, RightYsBufferId( GetBufferId("RightYs") )
+, mImpurityWalker(impurityWalker)
+, mBinnedFeaturesBufferId(binnedFeatures)
+, mBinEdgesBufferId(binEdges)
+, mNumberOfBinsBufferId(numberOfBins)
+, mFloatParamsBufferId(floatParams)
+, mIntParamsBufferId(intParams)
+, mIndicesBufferId(indices)
+{}
+
+template <class ImpurityWalker>
+BestSplitpointsHistogramStep<ImpurityWalker>::~BestSplitpointsHistogramStep()
+{}
+
+template <class ImpurityWalker>
+PipelineStepI* BestSplitpointsHistogramStep<ImpurityWalker>::Clone() const
+{
+    BestSplitpointsHistogramStep* clone = new BestSplitpointsHistogramStep<ImpurityWalker>(*this);
+    return clone;
+}
+
+template <class ImpurityWalker>
+void BestSplitpointsHistogramStep<ImpurityWalker>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                               BufferCollection& writeCollection,
+                                                               boost::mt19937& gen) const
+{
+    UNUSED_PARAM(gen);
+
+    // Bind input buffers
+    const MatrixBufferTemplate<unsigned char>& binnedFeatures
+           = readCollection.GetBuffer< MatrixBufferTemplate<unsigned char> >(mBinnedFeaturesBufferId);
+    const MatrixBufferTemplate<FloatType>& binEdges
+           = readCollection.GetBuffer< MatrixBufferTemplate<FloatType> >(mBinEdgesBufferId);
+    const VectorBufferTemplate<IntType>& numberOfBins
+           = readCollection.GetBuffer< VectorBufferTemplate<IntType> >(mNumberOfBinsBufferId);
+    const MatrixBufferTemplate<FloatType>& floatParams
+           = readCollection.GetBuffer< MatrixBufferTemplate<FloatType> >(mFloatParamsBufferId);
+    const MatrixBufferTemplate<IntType>& intParams
+           = readCollection.GetBuffer< MatrixBufferTemplate<IntType> >(mIntParamsBufferId);
+    const VectorBufferTemplate<IntType>& indices
+           = readCollection.GetBuffer< VectorBufferTemplate<IntType> >(mIndicesBufferId);
+
+    // Make a local non-const walker and bind it
+    ImpurityWalker impurityWalker = mImpurityWalker;
+    impurityWalker.Bind(readCollection);
+    const IntType numberOfFeatures = intParams.GetM();
+    const IntType numberOfSamples = indices.GetN();
+    const IntType yDim = impurityWalker.GetYDim();
+
+    // Bind output buffers
+    MatrixBufferTemplate<FloatType>& impurities
+           = writeCollection.GetOrAddBuffer< MatrixBufferTemplate<FloatType> >(ImpurityBufferId);
+    impurities.Resize(numberOfFeatures,1);
+
+    MatrixBufferTemplate<FloatType>& thresholds
+           = writeCollection.GetOrAddBuffer< MatrixBufferTemplate<FloatType> >(SplitpointBufferId);
+    thresholds.Resize(numberOfFeatures,1);
+
+    VectorBufferTemplate<IntType>& thresholdCounts
+           = writeCollection.GetOrAddBuffer< VectorBufferTemplate<IntType> >(SplitpointCountsBufferId);
+    thresholdCounts.Resize(numberOfFeatures);
+
+    Tensor3BufferTemplate<FloatType>& childCounts
+           = writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<FloatType> >(ChildCountsBufferId);
+    childCounts.Resize(numberOfFeatures, 1, 2);
+
+    Tensor3BufferTemplate<FloatType>& leftYs
+           = writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<FloatType> >(LeftYsBufferId);
+    leftYs.Resize(numberOfFeatures, 1, yDim);
+
+    Tensor3BufferTemplate<FloatType>& rightYs
+           = writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<FloatType> >(RightYsBufferId);
+    rightYs.Resize(numberOfFeatures, 1, yDim);
+
+    // Histograms of the parent and of the sibling processed first
+    typedef boost::shared_ptr< SiblingHistograms<FloatType, IntType> > SiblingHistogramsPtr;
+    SiblingHistograms<FloatType, IntType>* siblingHistograms =
+          readCollection.HasBuffer<SiblingHistogramsPtr>(PARENT_HISTOGRAMS)
+          ? readCollection.GetBuffer<SiblingHistogramsPtr>(PARENT_HISTOGRAMS).get()
+          : NULL;
+    boost::shared_ptr< NodeHistograms<FloatType, IntType> > nodeHistograms(new NodeHistograms<FloatType, IntType>());
+    std::vector<FloatType> ysHistograms;
+    std::vector<IntType> binCounts;
+
+    for(IntType f=0; f<numberOfFeatures; f++)
+    {
+        ASSERT_ARG_DIM_1D(intParams.Get(f, NUMBER_OF_DIMENSIONS_INDEX), 1)
+        const IntType dimension = intParams.Get(f, PARAM_START_INDEX);
+        const FloatType weight = floatParams.Get(f, PARAM_START_INDEX);
+        ASSERT(weight > FloatType(0))
+        const IntType bins = numberOfBins.Get(dimension);
+
+        if( !nodeHistograms->Has(dimension) )
+        {
+            if( siblingHistograms == NULL || !siblingHistograms->Subtract(dimension, ysHistograms, binCounts) )
+            {
+                BuildHistogram(impurityWalker, binnedFeatures, indices, dimension, bins, ysHistograms, binCounts);
+            }
+            nodeHistograms->Set(dimension, ysHistograms, binCounts);
+        }
+        const std::vector<FloatType>& ys = nodeHistograms->GetYs(dimension);
+        const std::vector<IntType>& counts = nodeHistograms->GetCounts(dimension);
+
+        impurityWalker.Reset();
+
+        FloatType bestImpurity = std::numeric_limits<FloatType>::min();
+        FloatType bestThreshold = std::numeric_limits<FloatType>::min();
+        FloatType bestLeftChildCounts = FloatType(0);
+        FloatType bestRightChildCounts = FloatType(0);
+        VectorBufferTemplate<FloatType> bestLeftYs(yDim);
+        VectorBufferTemplate<FloatType> bestRightYs(yDim);
+
+        // Splitting at edge k sends bins > k left so the split points are
+        // between populated bins and have samples on both sides
+        IntType samplesMovedRight = 0;
+        for(IntType k=0; k<bins-1 && samplesMovedRight<numberOfSamples; k++)
+        {
+            if(counts[k] == 0)
+            {
+                continue;
+            }
+            impurityWalker.MoveYsHistogramLeftToRight(&ys[k * yDim]);
+            samplesMovedRight += counts[k];
+
+            if(samplesMovedRight < numberOfSamples && impurityWalker.Impurity() > bestImpurity)
+            {
+                bestImpurity = impurityWalker.Impurity();
+                bestThreshold = weight * binEdges.Get(dimension, k);
+                bestLeftChildCounts = impurityWalker.GetLeftChildCounts();
+                bestRightChildCounts = impurityWalker.GetRightChildCounts();
+                bestLeftYs = impurityWalker.GetLeftYs();
+                bestRightYs = impurityWalker.GetRightYs();
+            }
+        }
+
+        impurities.Set(f, 0, bestImpurity);
+        thresholds.Set(f, 0, bestThreshold);
+        thresholdCounts.Set(f, 1);
+        childCounts.Set(f, 0, 0, bestLeftChildCounts);
+        childCounts.Set(f, 0, 1, bestRightChildCounts);
+        leftYs.SetRow(f, 0, bestLeftYs );
+        rightYs.SetRow(f, 0, bestRightYs );
+    }
+
+    // The first child of a split also builds the parent's other dimensions so
+    // its (larger) sibling can derive them
+    if( siblingHistograms != NULL && !siblingHistograms->HasFirstChild() )
+    {
+        const NodeHistograms<FloatType, IntType>& parentHistograms = siblingHistograms->GetParent();
+        std::vector<IntType> parentDimensions;
+        parentHistograms.GetDimensions(parentDimensions);
+        for(size_t i=0; i<parentDimensions.size(); i++)
+        {
+            const IntType dimension = parentDimensions[i];
+            if( !nodeHistograms->Has(dimension) )
+            {
+                BuildHistogram(impurityWalker, binnedFeatures, indices, dimension, numberOfBins.Get(dimension), ysHistograms, binCounts);
+                nodeHistograms->Set(dimension, ysHistograms, binCounts);
+            }
+        }
+    }
+    if( siblingHistograms != NULL )
+    {
+        siblingHistograms->SetFirstChild(nodeHistograms);
+    }
+    writeCollection.AddBuffer(NODE_HISTOGRAMS, nodeHistograms);
+}
+
+template <class ImpurityWalker>
+void BestSplitpointsHistogramStep<ImpurityWalker>::BuildHistogram( const ImpurityWalker& impurityWalker,
+                                                                   const MatrixBufferTemplate<unsigned char>& binnedFeatures,
+                                                                   const VectorBufferTemplate<IntType>& indices,
+                                                                   const IntType dimension,
+                                                                   const IntType bins,
+                                                                   std::vector<FloatType>& ysHistograms,
+                                                                   std::vector<IntType>& binCounts ) const
+{
+    const IntType numberOfSamples = indices.GetN();
+    const IntType yDim = impurityWalker.GetYDim();
+    ysHistograms.assign(bins * yDim, FloatType(0));
+    binCounts.assign(bins, 0);
+    for(IntType i=0; i<numberOfSamples; i++)
+    {
+        const IntType bin = static_cast<IntType>(binnedFeatures.Get(indices.Get(i), dimension));
+        impurityWalker.AddToYsHistogram(i, &ysHistograms[bin * yDim]);
+        binCounts[bin]++;
+    }
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "asserts.h"
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+#include "LinearMatrixFeatureBinding.h"
+#include "PresortedIndices.h"
+
+// ----------------------------------------------------------------------------
+//
+// Finds the split point with the highest impurity for each axis aligned
+// matrix feature by walking the samples of the node in the order kept by
+// PresortedIndices, so no node sorts its feature values.  The root builds its
+// sorted positions from the per tree order of PresortFeaturesStep and writes
+// them to the node collection under PRESORTED_INDICES; the tree learner then
+// stable partitions them into the children on the chosen split.  The split
+// points and output buffers are the same as BestSplitpointsWalkingSortedStep.
+//
+// ----------------------------------------------------------------------------
+template <class ImpurityWalker>
+class BestSplitpointsPresortedStep : public PipelineStepI
+{
+public:
+    BestSplitpointsPresortedStep (const ImpurityWalker& impurityWalker,
+                                  const BufferId& sortedIndices,
+                                  const BufferId& matrixData,
+                                  const BufferId& floatParams,
+                                  const BufferId& intParams,
+                                  const BufferId& indices );
+    virtual ~BestSplitpointsPresortedStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    // Read only output buffer
+    const BufferId ImpurityBufferId;
+    const BufferId SplitpointBufferId;
+    const BufferId SplitpointCountsBufferId;
+    const BufferId ChildCountsBufferId;
+    const BufferId LeftYsBufferId;
+    const BufferId RightYsBufferId;
+private:
+    typedef typename ImpurityWalker::Float FloatType;
+    typedef typename ImpurityWalker::Int IntType;
+
+    boost::shared_ptr< PresortedIndices<IntType> > SortRoot( const MatrixBufferTemplate<IntType>& sortedIndices,
+                                                             const VectorBufferTemplate<IntType>& indices ) const;
+
+    const ImpurityWalker mImpurityWalker;
+    const BufferId mSortedIndicesBufferId;
+    const BufferId mMatrixDataBufferId;
+    const BufferId mFloatParamsBufferId;
+    const BufferId mIntParamsBufferId;
+    const BufferId mIndicesBufferId;
+};
+
+
+template <class ImpurityWalker>
+BestSplitpointsPresortedStep<ImpurityWalker>::BestSplitpointsPresortedStep(const ImpurityWalker& impurityWalker,
+                                                                           const BufferId& sortedIndices,
+                                                                           const BufferId& matrixData,
+                                                                           const BufferId& floatParams,
+                                                                           const BufferId& intParams,
+                                                                           const BufferId& indices )
+: ImpurityBufferId( GetBufferId("Impurity") )
+, SplitpointBufferId( GetBufferId("Splitpoints") )
+, SplitpointCountsBufferId( GetBufferId("SplitpointsCounts") )
+, ChildCountsBufferId( GetBufferId("ChildCounts") )
+, LeftYsBufferId( GetBufferId("LeftYs") )
+, RightYsBufferId( GetBufferId("RightYs") )
+, mImpurityWalker(impurityWalker)
+, mSortedIndicesBufferId(sortedIndices)
+, mMatrixDataBufferId(matrixData)
+, mFloatParamsBufferId(floatParams)
+, mIntParamsBufferId(intParams)
+, mIndicesBufferId(indices)
+{}
+
+template <class ImpurityWalker>
+BestSplitpointsPresortedStep<ImpurityWalker>::~BestSplitpointsPresortedStep()
+{}
+
+template <class ImpurityWalker>
+PipelineStepI* BestSplitpointsPresortedStep<ImpurityWalker>::Clone() const
+{
+    BestSplitpointsPresortedStep* clone = new BestSplitpointsPresortedStep<ImpurityWalker>(*this);
+    return clone;
+}
+
+template <class ImpurityWalker>
+void BestSplitpointsPresortedStep<ImpurityWalker>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                               BufferCollection& writeCollection,
+                                                               boost::mt19937& gen) const
+{
+    UNUSED_PARAM(gen);
+
+    // Bind input buffers
+    const MatrixBufferTemplate<FloatType>& data
+           = readCollection.GetBuffer< MatrixBufferTemplate<FloatType> >(mMatrixDataBufferId);
+    const MatrixBufferTemplate<FloatType>& floatParams
+           = readCollection.GetBuffer< MatrixBufferTemplate<FloatType> >(mFloatParamsBufferId);
+    const MatrixBufferTemplate<IntType>& intParams
+           = readCollection.GetBuffer< MatrixBufferTemplate<IntType> >(mIntParamsBufferId);
+    const VectorBufferTemplate<IntType>& indices
+           = readCollection.GetBuffer< VectorBufferTemplate<IntType> >(mIndicesBufferId);
+
+    // Children get their sorted positions from the split of their parent
+    typedef boost::shared_ptr< PresortedIndices<IntType> > PresortedIndicesPtr;
+    const PresortedIndicesPtr presortedIndices = readCollection.HasBuffer<PresortedIndicesPtr>(PRESORTED_INDICES)
+                                                 ? readCollection.GetBuffer<PresortedIndicesPtr>(PRESORTED_INDICES)
+                                                 : SortRoot(readCollection.GetBuffer< MatrixBufferTemplate<IntType> >(mSortedIndicesBufferId), indices);
+    const MatrixBufferTemplate<IntType>& sortedPositions = presortedIndices->GetSortedPositions();
+    ASSERT_ARG_DIM_1D(sortedPositions.GetN(), indices.GetN())
+
+    // Make a local non-const walker and bind it
+    ImpurityWalker impurityWalker = mImpurityWalker;
+    impurityWalker.Bind(readCollection);
+    const IntType numberOfFeatures = intParams.GetM();
+    const IntType numberOfSamples = indices.GetN();
+    const IntType yDim = impurityWalker.GetYDim();
+
+    // Bind output buffers
+    MatrixBufferTemplate<FloatType>& impurities
+           = writeCollection.GetOrAddBuffer< MatrixBufferTemplate<FloatType> >(ImpurityBufferId);
+    impurities.Resize(numberOfFeatures,1);
+
+    MatrixBufferTemplate<FloatType>& thresholds
+           = writeCollection.GetOrAddBuffer< MatrixBufferTemplate<FloatType> >(SplitpointBufferId);
+    thresholds.Resize(numberOfFeatures,1);
+
+    VectorBufferTemplate<IntType>& thresholdCounts
+           = writeCollection.GetOrAddBuffer< VectorBufferTemplate<IntType> >(SplitpointCountsBufferId);
+    thresholdCounts.Resize(numberOfFeatures);
+
+    Tensor3BufferTemplate<FloatType>& childCounts
+           = writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<FloatType> >(ChildCountsBufferId);
+    childCounts.Resize(numberOfFeatures, 1, 2);
+
+    Tensor3BufferTemplate<FloatType>& leftYs
+           = writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<FloatType> >(LeftYsBufferId);
+    leftYs.Resize(numberOfFeatures, 1, yDim);
+
+    Tensor3BufferTemplate<FloatType>& rightYs
+           = writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<FloatType> >(RightYsBufferId);
+    rightYs.Resize(numberOfFeatures, 1, yDim);
+
+    for(IntType f=0; f<numberOfFeatures; f++)
+    {
+        ASSERT_ARG_DIM_1D(intParams.Get(f, NUMBER_OF_DIMENSIONS_INDEX), 1)
+        const IntType dimension = intParams.Get(f, PARAM_START_INDEX);
+        const FloatType weight = floatParams.Get(f, PARAM_START_INDEX);
+        ASSERT(weight > FloatType(0))
+
+        impurityWalker.Reset();
+
+        FloatType bestImpurity = std::numeric_limits<FloatType>::min();
+        FloatType bestThreshold = std::numeric_limits<FloatType>::min();
+        FloatType bestLeftChildCounts = FloatType(0);
+        FloatType bestRightChildCounts = FloatType(0);
+        VectorBufferTemplate<FloatType> bestLeftYs(yDim);
+        VectorBufferTemplate<FloatType> bestRightYs(yDim);
+
+        for(IntType sortedIndex=0; sortedIndex<numberOfSamples-1; sortedIndex++)
+        {
+            const IntType i = sortedPositions.Get(dimension, sortedIndex);
+            const IntType next = sortedPositions.Get(dimension, sortedIndex+1);
+
+            impurityWalker.MoveLeftToRight(i);
+
+            const FloatType featureValue = weight * data.Get(indices.Get(i), dimension);
+            const FloatType consecutiveFeatureDelta = weight * data.Get(indices.Get(next), dimension) - featureValue;
+            if((std::abs(consecutiveFeatureDelta) > std::numeric_limits<FloatType>::epsilon())
+              && impurityWalker.Impurity() > bestImpurity)
+            {
+                bestImpurity = impurityWalker.Impurity();
+                bestThreshold = featureValue + 0.5*consecutiveFeatureDelta;
+                bestLeftChildCounts = impurityWalker.GetLeftChildCounts();
+                bestRightChildCounts = impurityWalker.GetRightChildCounts();
+                bestLeftYs = impurityWalker.GetLeftYs();
+                bestRightYs = impurityWalker.GetRightYs();
+            }
+        }
+
+        impurities.Set(f, 0, bestImpurity);
+        thresholds.Set(f, 0, bestThreshold);
+        thresholdCounts.Set(f, 1);
+        childCounts.Set(f, 0, 0, bestLeftChildCounts);
+        childCounts.Set(f, 0, 1, bestRightChildCounts);
+        leftYs.SetRow(f, 0, bestLeftYs );
+        rightYs.SetRow(f, 0, bestRightYs );
+    }
+
+    writeCollection.AddBuffer(PRESORTED_INDICES, presortedIndices);
+}
+
+template <class ImpurityWalker>
+boost::shared_ptr< PresortedIndices<typename ImpurityWalker::Int> >
+BestSplitpointsPresortedStep<ImpurityWalker>::SortRoot( const MatrixBufferTemplate<IntType>& sortedIndices,
+                                                        const VectorBufferTemplate<IntType>& indices ) const
+{
+    // Group the positions of each sample index (bootstrapping repeats them)
+    const IntType numberOfDataSamples = sortedIndices.GetN();
+    const IntType numberOfSamples = indices.GetN();
+    std::vector<IntType> firstPosition(numberOfDataSamples+1, 0);
+    for(IntType i=0; i<numberOfSamples; i++)
+    {
+        firstPosition[indices.Get(i)+1]++;
+    }
+    for(IntType s=0; s<numberOfDataSamples; s++)
+    {
+        firstPosition[s+1] += firstPosition[s];
+    }
+    std::vector<IntType> positions(numberOfSamples);
+    std::vector<IntType> nextPosition(firstPosition.begin(), firstPosition.end()-1);
+    for(IntType i=0; i<numberOfSamples; i++)
+    {
+        positions[nextPosition[indices.Get(i)]++] = i;
+    }
+
+    const IntType numberOfDimensions = sortedIndices.GetM();
+    MatrixBufferTemplate<IntType> sortedPositions(numberOfDimensions, numberOfSamples);
+    for(IntType d=0; d<numberOfDimensions; d++)
+    {
+        IntType sortedIndex = 0;
+        for(IntType s=0; s<numberOfDataSamples; s++)
+        {
+            const IntType index = sortedIndices.Get(d, s);
+            for(IntType p=firstPosition[index]; p<firstPosition[index+1]; p++)
+            {
+                sortedPositions.Set(d, sortedIndex++, positions[p]);
+            }
+        }
+    }
+    return boost::shared_ptr< PresortedIndices<IntType> >(
+                new PresortedIndices<IntType>(mIndicesBufferId, indices, sortedPositions));
+}
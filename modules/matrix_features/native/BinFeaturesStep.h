@@ -0,0 +1,179 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "asserts.h"
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+
+// ----------------------------------------------------------------------------
+//
+// BinFeaturesStep quantizes each column of a dense data matrix into at most
+// maxNumberOfBins (<= 256) bins so histogram split finding can walk bins
+// instead of sorting feature values at every node.  It is meant to be a forest
+// step of ParallelForestLearner so the data is quantized once per forest and
+// shared by all trees rather than once per tree or node.
+//
+// Column d has NumberOfBins[d]-1 increasing bin edges and a value x falls in
+// bin b when exactly b edges are below it.  Splitting with x > edge[k] then
+// sends bins > k left and bins <= k right.  Columns with at most
+// maxNumberOfBins distinct values get an edge halfway between each pair of
+// consecutive values so no split point is lost, otherwise the edges are
+// placed at quantiles weighted by the number of samples of each value.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class BinFeaturesStep: public PipelineStepI
+{
+public:
+    BinFeaturesStep( const BufferId& matrixDataBufferId,
+                     const IntType maxNumberOfBins );
+    virtual ~BinFeaturesStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    enum { MAX_NUMBER_OF_BINS = 256 };
+
+    // Read only output buffers
+    const BufferId BinnedFeaturesBufferId;
+    const BufferId BinEdgesBufferId;
+    const BufferId NumberOfBinsBufferId;
+private:
+    void BinColumn( const MatrixBufferTemplate<FloatType>& data,
+                    const IntType column,
+                    std::vector<FloatType>& values,
+                    MatrixBufferTemplate<unsigned char>& binnedFeatures,
+                    MatrixBufferTemplate<FloatType>& binEdges,
+                    VectorBufferTemplate<IntType>& numberOfBins ) const;
+
+    const BufferId mMatrixDataBufferId;
+    const IntType mMaxNumberOfBins;
+};
+
+
+template <class FloatType, class IntType>
+BinFeaturesStep<FloatType,IntType>::BinFeaturesStep( const BufferId& matrixDataBufferId,
+                                                     const IntType maxNumberOfBins )
+: BinnedFeaturesBufferId(GetBufferId("BinnedFeatures"))
+, BinEdgesBufferId(GetBufferId("BinEdges"))
+, NumberOfBinsBufferId(GetBufferId("NumberOfBins"))
+, mMatrixDataBufferId(matrixDataBufferId)
+, mMaxNumberOfBins(maxNumberOfBins)
+{
+    ASSERT_VALID_RANGE(maxNumberOfBins, 2, MAX_NUMBER_OF_BINS+1)
+}
+
+template <class FloatType, class IntType>
+BinFeaturesStep<FloatType,IntType>::~BinFeaturesStep()
+{}
+
+template <class FloatType, class IntType>
+PipelineStepI* BinFeaturesStep<FloatType,IntType>::Clone() const
+{
+    BinFeaturesStep* clone = new BinFeaturesStep<FloatType,IntType>(*this);
+    return clone;
+}
+
+template <class FloatType, class IntType>
+void BinFeaturesStep<FloatType,IntType>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                     BufferCollection& writeCollection,
+                                                     boost::mt19937& gen) const
+{
+    UNUSED_PARAM(gen);
+
+    const MatrixBufferTemplate<FloatType>& data =
+          readCollection.GetBuffer< MatrixBufferTemplate<FloatType> >(mMatrixDataBufferId);
+
+    MatrixBufferTemplate<unsigned char>& binnedFeatures =
+          writeCollection.GetOrAddBuffer< MatrixBufferTemplate<unsigned char> >(BinnedFeaturesBufferId);
+    binnedFeatures.Resize(data.GetM(), data.GetN());
+
+    MatrixBufferTemplate<FloatType>& binEdges =
+          writeCollection.GetOrAddBuffer< MatrixBufferTemplate<FloatType> >(BinEdgesBufferId);
+    binEdges.Resize(data.GetN(), mMaxNumberOfBins-1);
+
+    VectorBufferTemplate<IntType>& numberOfBins =
+          writeCollection.GetOrAddBuffer< VectorBufferTemplate<IntType> >(NumberOfBinsBufferId);
+    numberOfBins.Resize(data.GetN());
+
+    std::vector<FloatType> values(data.GetM());
+    for(IntType d=0; d<data.GetN(); d++)
+    {
+        BinColumn(data, d, values, binnedFeatures, binEdges, numberOfBins);
+    }
+}
+
+template <class FloatType, class IntType>
+void BinFeaturesStep<FloatType,IntType>::BinColumn( const MatrixBufferTemplate<FloatType>& data,
+                                                    const IntType column,
+                                                    std::vector<FloatType>& values,
+                                                    MatrixBufferTemplate<unsigned char>& binnedFeatures,
+                                                    MatrixBufferTemplate<FloatType>& binEdges,
+                                                    VectorBufferTemplate<IntType>& numberOfBins ) const
+{
+    const IntType numberOfSamples = data.GetM();
+    for(IntType i=0; i<numberOfSamples; i++)
+    {
+        values[i] = data.Get(i, column);
+    }
+    std::sort(values.begin(), values.end());
+    IntType numberOfDistinctValues = (numberOfSamples > 0) ? 1 : 0;
+    for(IntType i=1; i<numberOfSamples; i++)
+    {
+        numberOfDistinctValues += (values[i-1] < values[i]) ? 1 : 0;
+    }
+
+    // Bin edges are halfway between distinct values.  With too many distinct
+    // values the edges are placed at the quantiles of the samples so a value
+    // shared by many samples takes up as many quantiles as it has samples.
+    // Quantiles that fall inside the same run of equal values give the same
+    // edge and are only kept once.
+    std::vector<FloatType> edges;
+    if(numberOfDistinctValues <= mMaxNumberOfBins)
+    {
+        for(IntType i=1; i<numberOfSamples; i++)
+        {
+            if(values[i-1] < values[i])
+            {
+                edges.push_back(values[i-1] + FloatType(0.5) * (values[i] - values[i-1]));
+            }
+        }
+    }
+    else
+    {
+        for(IntType b=1; b<mMaxNumberOfBins; b++)
+        {
+            const IntType rank = static_cast<IntType>((static_cast<long long>(b) * numberOfSamples) / mMaxNumberOfBins);
+            const IntType upper = static_cast<IntType>(std::upper_bound(values.begin(), values.end(), values[rank-1]) - values.begin());
+            if(upper == numberOfSamples)
+            {
+                break;
+            }
+            const FloatType edge = values[upper-1] + FloatType(0.5) * (values[upper] - values[upper-1]);
+            if(edges.empty() || edges.back() < edge)
+            {
+                edges.push_back(edge);
+            }
+        }
+    }
+
+    numberOfBins.Set(column, static_cast<IntType>(edges.size()) + 1);
+    for(IntType k=0; k<static_cast<IntType>(edges.size()); k++)
+    {
+        binEdges.Set(column, k, edges[k]);
+    }
+    for(IntType i=0; i<numberOfSamples; i++)
+    {
+        const IntType bin = static_cast<IntType>(std::lower_bound(edges.begin(), edges.end(), data.Get(i, column)) - edges.begin());
+        binnedFeatures.Set(i, column, static_cast<unsigned char>(bin));
+    }
+}
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <vector>
+#include <algorithm>
+
 #include "asserts.h"
 #include "VectorBuffer.h"
 #include "MatrixBuffer.h"
 #include "Constants.h"
+#include "FeatureExtractorStep.h"
 
 const int NUMBER_OF_DIMENSIONS_INDEX = FEATURE_TYPE_INDEX + 1;
 const int PARAM_START_INDEX = NUMBER_OF_DIMENSIONS_INDEX + 1;  // Move this to a more soucefile
@@ -29,11 +33,16 @@ public:
     LinearMatrixFeatureBinding & operator=(const LinearMatrixFeatureBinding & other);
 
     FloatType FeatureValue( const int featureIndex, const int relativeSampleIndex) const;
+    void FeatureValues( const int sampleStart, const int sampleEnd,
+                        const FeatureValueOrdering ordering,
+                        MatrixBufferTemplate<FloatType>& featureValues ) const;
 
     IntType GetNumberOfFeatures() const;
     IntType GetNumberOfDatapoints() const;
 
 private:
+    enum { SAMPLE_BLOCK_SIZE = 64 };
+
     MatrixBufferTemplate<FloatType> const* mFloatParams;
     MatrixBufferTemplate<IntType> const* mIntParams;
     VectorBufferTemplate<IntType> const* mIndices;
@@ -97,6 +106,102 @@ FloatType LinearMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::Featur
     return featureValue;
 }
 
+// ----------------------------------------------------------------------------
+//
+// Batched evaluation of all features for the samples [sampleStart, sampleEnd).
+// Samples are processed in blocks.  The dimensions used by any feature are
+// gathered once per block into contiguous columns so each projection is a
+// sequence of multiply-adds over contiguous arrays (vectorized as FMA by the
+// compiler) instead of one bounds checked dot product per (feature, sample).
+//
+// ----------------------------------------------------------------------------
+template <class DataMatrixType, class FloatType, class IntType>
+void LinearMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::FeatureValues( const int sampleStart, const int sampleEnd,
+                                                                                   const FeatureValueOrdering ordering,
+                                                                                   MatrixBufferTemplate<FloatType>& featureValues ) const
+{
+    ASSERT_VALID_RANGE(sampleStart, 0, mIndices->GetN()+1)
+    ASSERT_VALID_RANGE(sampleEnd, sampleStart, mIndices->GetN()+1)
+    const IntType numberOfFeatures = mIntParams->GetM();
+    ASSERT_ARG_DIM_2D(featureValues.GetM(), featureValues.GetN(),
+                      (ordering == FEATURES_BY_DATAPOINTS) ? numberOfFeatures : mIndices->GetN(),
+                      (ordering == FEATURES_BY_DATAPOINTS) ? mIndices->GetN() : numberOfFeatures)
+
+    // Map each (feature, component) to a gathered column
+    std::vector<IntType> usedDimensions;
+    for(IntType f=0; f<numberOfFeatures; f++)
+    {
+        const IntType numberOfDimensions = mIntParams->Get(f, NUMBER_OF_DIMENSIONS_INDEX);
+        for(IntType i=PARAM_START_INDEX; i<numberOfDimensions + PARAM_START_INDEX; i++)
+        {
+            usedDimensions.push_back(mIntParams->Get(f, i));
+        }
+    }
+    std::sort(usedDimensions.begin(), usedDimensions.end());
+    usedDimensions.erase(std::unique(usedDimensions.begin(), usedDimensions.end()), usedDimensions.end());
+
+    std::vector<IntType> featureStarts(numberOfFeatures+1, 0);
+    std::vector<IntType> componentColumns;
+    std::vector<FloatType> componentWeights;
+    for(IntType f=0; f<numberOfFeatures; f++)
+    {
+        const IntType numberOfDimensions = mIntParams->Get(f, NUMBER_OF_DIMENSIONS_INDEX);
+        for(IntType i=PARAM_START_INDEX; i<numberOfDimensions + PARAM_START_INDEX; i++)
+        {
+            const IntType column = std::lower_bound(usedDimensions.begin(), usedDimensions.end(), mIntParams->Get(f, i))
+                                    - usedDimensions.begin();
+            componentColumns.push_back(column);
+            componentWeights.push_back(mFloatParams->Get(f, i));
+        }
+        featureStarts[f+1] = componentColumns.size();
+    }
+
+    const IntType numberOfUsedDimensions = usedDimensions.size();
+    std::vector<FloatType> gathered(numberOfUsedDimensions * SAMPLE_BLOCK_SIZE);
+    std::vector<FloatType> projection(SAMPLE_BLOCK_SIZE);
+
+    for(IntType blockStart=sampleStart; blockStart<sampleEnd; blockStart+=SAMPLE_BLOCK_SIZE)
+    {
+        const IntType blockSize = std::min(IntType(SAMPLE_BLOCK_SIZE), IntType(sampleEnd - blockStart));
+        for(IntType b=0; b<blockSize; b++)
+        {
+            const IntType matrixIndex = mIndices->Get(blockStart + b);
+            for(IntType c=0; c<numberOfUsedDimensions; c++)
+            {
+                gathered[c*SAMPLE_BLOCK_SIZE + b] = mDataMatrix->Get(matrixIndex, usedDimensions[c]);
+            }
+        }
+
+        for(IntType f=0; f<numberOfFeatures; f++)
+        {
+            FloatType* projectionPtr = &projection[0];
+            std::fill(projectionPtr, projectionPtr + blockSize, FloatType(0));
+            for(IntType component=featureStarts[f]; component<featureStarts[f+1]; component++)
+            {
+                const FloatType weight = componentWeights[component];
+                const FloatType* column = &gathered[componentColumns[component]*SAMPLE_BLOCK_SIZE];
+                for(IntType b=0; b<blockSize; b++)
+                {
+                    projectionPtr[b] += weight * column[b];
+                }
+            }
+
+            for(IntType b=0; b<blockSize; b++)
+            {
+                const IntType s = blockStart + b;
+                if( ordering == FEATURES_BY_DATAPOINTS )
+                {
+                    featureValues.SetUnsafe(f, s, projectionPtr[b]);
+                }
+                else
+                {
+                    featureValues.SetUnsafe(s, f, projectionPtr[b]);
+                }
+            }
+        }
+    }
+}
+
 template <class DataMatrixType, class FloatType, class IntType>
 IntType LinearMatrixFeatureBinding<DataMatrixType, FloatType, IntType>::GetNumberOfFeatures() const
 {
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "asserts.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+
+// ----------------------------------------------------------------------------
+//
+// PresortFeaturesStep sorts each column of a dense data matrix once so
+// BestSplitpointsPresortedStep can walk axis aligned features in order
+// without sorting at every node.  Row d of the output holds the sample
+// indices ordered by increasing value of column d.  It is meant to be a tree
+// step (or to be run once on the data shared by a forest).
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class PresortFeaturesStep: public PipelineStepI
+{
+public:
+    PresortFeaturesStep( const BufferId& matrixDataBufferId );
+    virtual ~PresortFeaturesStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    // Read only output buffer
+    const BufferId SortedIndicesBufferId;
+private:
+    const BufferId mMatrixDataBufferId;
+};
+
+
+template <class FloatType, class IntType>
+PresortFeaturesStep<FloatType,IntType>::PresortFeaturesStep( const BufferId& matrixDataBufferId )
+: SortedIndicesBufferId(GetBufferId("SortedIndices"))
+, mMatrixDataBufferId(matrixDataBufferId)
+{}
+
+template <class FloatType, class IntType>
+PresortFeaturesStep<FloatType,IntType>::~PresortFeaturesStep()
+{}
+
+template <class FloatType, class IntType>
+PipelineStepI* PresortFeaturesStep<FloatType,IntType>::Clone() const
+{
+    PresortFeaturesStep* clone = new PresortFeaturesStep<FloatType,IntType>(*this);
+    return clone;
+}
+
+template <class FloatType, class IntType>
+void PresortFeaturesStep<FloatType,IntType>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                         BufferCollection& writeCollection,
+                                                         boost::mt19937& gen) const
+{
+    UNUSED_PARAM(gen);
+
+    const MatrixBufferTemplate<FloatType>& data =
+          readCollection.GetBuffer< MatrixBufferTemplate<FloatType> >(mMatrixDataBufferId);
+    const IntType numberOfSamples = data.GetM();
+    const IntType numberOfDimensions = data.GetN();
+
+    MatrixBufferTemplate<IntType>& sortedIndices =
+          writeCollection.GetOrAddBuffer< MatrixBufferTemplate<IntType> >(SortedIndicesBufferId);
+    sortedIndices.Resize(numberOfDimensions, numberOfSamples);
+
+    std::vector< std::pair<FloatType, IntType> > valueIndices(numberOfSamples);
+    for(IntType d=0; d<numberOfDimensions; d++)
+    {
+        for(IntType i=0; i<numberOfSamples; i++)
+        {
+            valueIndices[i] = std::pair<FloatType, IntType>(data.Get(i, d), i);
+        }
+        std::sort(valueIndices.begin(), valueIndices.end());
+        for(IntType s=0; s<numberOfSamples; s++)
+        {
+            sortedIndices.Set(d, s, valueIndices[s].second);
+        }
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "Constants.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+#include "LinearMatrixFeature.h"
+
+// ----------------------------------------------------------------------------
+//
+// SparseRandomProjectionParamsStep constructs a float_params and int_params
+// matrix of oblique LinearMatrixFeature params.  Each feature is a sparse
+// random projection that combines max(1, ceil(density * #dimensions))
+// dimensions choosen uniformly without replacement with weights of +1 or -1.
+// The params are PARAM_START_INDEX + #combined dimensions wide so the forest
+// learner has to be given at least that many int and float params.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType, class IntType>
+class SparseRandomProjectionParamsStep: public PipelineStepI
+{
+public:
+    SparseRandomProjectionParamsStep( const BufferId numberOfFeaturesBufferId,
+                                      const BufferId matrixDataBufferId,
+                                      const FloatType density );
+    virtual ~SparseRandomProjectionParamsStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    IntType GetNumberOfCombinedDimensions(IntType numberOfDimensions) const;
+
+    // Read only output buffers
+    const BufferId FloatParamsBufferId;
+    const BufferId IntParamsBufferId;
+private:
+    void SampleParams(IntType numberOfFeatures,
+                      IntType numberOfDimensions,
+                      MatrixBufferTemplate<FloatType>& floatParams,
+                      MatrixBufferTemplate<IntType>& intParams,
+                      boost::mt19937& gen ) const;
+
+    const BufferId mNumberOfFeaturesBufferId;
+    const BufferId mMatrixDataBufferId;
+    const FloatType mDensity;
+};
+
+
+template <class FloatType, class IntType>
+SparseRandomProjectionParamsStep<FloatType,IntType>::SparseRandomProjectionParamsStep( const BufferId numberOfFeaturesBufferId,
+                                                                                      const BufferId matrixDataBufferId,
+                                                                                      const FloatType density )
+: FloatParamsBufferId(GetBufferId("FloatParams"))
+, IntParamsBufferId(GetBufferId("IntParams"))
+, mNumberOfFeaturesBufferId(numberOfFeaturesBufferId)
+, mMatrixDataBufferId(matrixDataBufferId)
+, mDensity(density)
+{
+    ASSERT(mDensity > FloatType(0) && mDensity <= FloatType(1));
+}
+
+template <class FloatType, class IntType>
+SparseRandomProjectionParamsStep<FloatType,IntType>::~SparseRandomProjectionParamsStep()
+{}
+
+template <class FloatType, class IntType>
+PipelineStepI* SparseRandomProjectionParamsStep<FloatType,IntType>::Clone() const
+{
+    SparseRandomProjectionParamsStep* clone = new SparseRandomProjectionParamsStep<FloatType,IntType>(*this);
+    return clone;
+}
+
+template <class FloatType, class IntType>
+IntType SparseRandomProjectionParamsStep<FloatType,IntType>::GetNumberOfCombinedDimensions(IntType numberOfDimensions) const
+{
+    const IntType numberOfCombinedDimensions = static_cast<IntType>(std::ceil(mDensity * static_cast<FloatType>(numberOfDimensions)));
+    return std::max(IntType(1), std::min(numberOfCombinedDimensions, numberOfDimensions));
+}
+
+template <class FloatType, class IntType>
+void SparseRandomProjectionParamsStep<FloatType,IntType>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                                     BufferCollection& writeCollection,
+                                                                     boost::mt19937& gen) const
+{
+    if(!writeCollection.HasBuffer< MatrixBufferTemplate<FloatType> >(FloatParamsBufferId)
+        || !writeCollection.HasBuffer< MatrixBufferTemplate<IntType> >(IntParamsBufferId))
+    {
+        const MatrixBufferTemplate<FloatType>& matrixBuffer =
+                readCollection.GetBuffer< MatrixBufferTemplate<FloatType> >(mMatrixDataBufferId);
+        const IntType numberOfDimensions = matrixBuffer.GetN();
+
+        const VectorBufferTemplate<IntType>& numberOfFeaturesBuffer =
+                readCollection.GetBuffer< VectorBufferTemplate<IntType> >(mNumberOfFeaturesBufferId);
+        ASSERT_ARG_DIM_1D(numberOfFeaturesBuffer.GetN(), 1)
+        const IntType numberOfFeatures = numberOfFeaturesBuffer.Get(0);
+
+        MatrixBufferTemplate<FloatType>& floatParams =
+                writeCollection.GetOrAddBuffer< MatrixBufferTemplate<FloatType> >(FloatParamsBufferId);
+        MatrixBufferTemplate<IntType>& intParams =
+                writeCollection.GetOrAddBuffer< MatrixBufferTemplate<IntType> >(IntParamsBufferId);
+
+        SampleParams(numberOfFeatures, numberOfDimensions, floatParams, intParams, gen);
+    }
+}
+
+template <class FloatType, class IntType>
+void SparseRandomProjectionParamsStep<FloatType,IntType>::SampleParams(IntType numberOfFeatures,
+                                                                      IntType numberOfDimensions,
+                                                                      MatrixBufferTemplate<FloatType>& floatParams,
+                                                                      MatrixBufferTemplate<IntType>& intParams,
+                                                                      boost::mt19937& gen ) const
+{
+    const IntType numberOfCombinedDimensions = GetNumberOfCombinedDimensions(numberOfDimensions);
+    floatParams.Resize(numberOfFeatures, PARAM_START_INDEX + numberOfCombinedDimensions);
+    intParams.Resize(numberOfFeatures, PARAM_START_INDEX + numberOfCombinedDimensions);
+
+    boost::uniform_int<> signDistribution(0, 1);
+    boost::variate_generator<boost::mt19937&, boost::uniform_int<> > var_sign(gen, signDistribution);
+
+    std::vector<IntType> candidateDimensions(numberOfDimensions);
+    for(int i=0; i<numberOfFeatures; i++)
+    {
+        // Partial Fisher-Yates shuffle so a dimension is not choosen multiple times
+        for(int d=0; d<numberOfDimensions; d++)
+        {
+            candidateDimensions[d] = d;
+        }
+        for(int d=0; d<numberOfCombinedDimensions; d++)
+        {
+            boost::uniform_int<> swapDistribution(d, numberOfDimensions-1);
+            boost::variate_generator<boost::mt19937&, boost::uniform_int<> > var_swap(gen, swapDistribution);
+            std::swap(candidateDimensions[d], candidateDimensions[var_swap()]);
+        }
+
+        intParams.Set(i, FEATURE_TYPE_INDEX, MATRIX_FEATURES); // feature type
+        intParams.Set(i, NUMBER_OF_DIMENSIONS_INDEX, numberOfCombinedDimensions); // how many dimensions in projection
+        for(int d=0; d<numberOfCombinedDimensions; d++)
+        {
+            intParams.Set(i, PARAM_START_INDEX + d, candidateDimensions[d]);
+            floatParams.Set(i, PARAM_START_INDEX + d, var_sign() ? FloatType(1) : FloatType(-1));
+        }
+    }
+}
@@ -1,10 +1,24 @@
 #include "VectorBuffer.h"
 #include "MatrixBuffer.h"
 #include "FeatureExtractorStep.h"
+#include "BatchedFeatureExtractorStep.h"
 #include "AxisAlignedParamsStep.h"
+#include "SparseRandomProjectionParamsStep.h"
 #include "LinearMatrixFeature.h"
 #include "LinearMatrixFeatureBinding.h"
+#include "AxisAlignedMatrixFeature.h"
+#include "AxisAlignedMatrixFeatureBinding.h"
+#include "BinFeaturesStep.h"
+#include "BestSplitpointsHistogramStep.h"
+#include "PresortFeaturesStep.h"
+#include "BestSplitpointsPresortedStep.h"
 
 template class AxisAlignedParamsStep<float, int>;
+template class SparseRandomProjectionParamsStep<float, int>;
 template class LinearMatrixFeature< MatrixBufferTemplate<float>, float, int >;
-template class FeatureExtractorStep< LinearMatrixFeature<MatrixBufferTemplate<float>, float, int> >;
\ No newline at end of file
+template class FeatureExtractorStep< LinearMatrixFeature<MatrixBufferTemplate<float>, float, int> >;
+template class BatchedFeatureExtractorStep< LinearMatrixFeature<MatrixBufferTemplate<float>, float, int> >;
+template class AxisAlignedMatrixFeature< MatrixBufferTemplate<float>, float, int >;
+template class FeatureExtractorStep< AxisAlignedMatrixFeature<MatrixBufferTemplate<float>, float, int> >;
+template class BinFeaturesStep<float, int>;
+template class PresortFeaturesStep<float, int>;
\ No newline at end of file
@@ -2,6 +2,7 @@
 %{
     #define SWIG_FILE_WITH_INIT
     #include "FeatureExtractorStep.h"
+    #include "BatchedFeatureExtractorStep.h"
 %}
 
 %include <exception.i>
@@ -11,7 +12,14 @@
 %include <matrix_features_external.i>
 
 %include "FeatureExtractorStep.h"
+%include "BatchedFeatureExtractorStep.h"
 
 %template(AxisAlignedParamsStep_f32i32) AxisAlignedParamsStep<float, int>;
 %template(LinearFloat32MatrixFeature_f32i32) LinearMatrixFeature< MatrixBufferTemplate<float>, float, int >;
+%template(SparseRandomProjectionParamsStep_f32i32) SparseRandomProjectionParamsStep<float, int>;
 %template(LinearFloat32MatrixFeatureExtractorStep_f32i32) FeatureExtractorStep< LinearMatrixFeature<MatrixBufferTemplate<float>, float, int> >;
+%template(LinearFloat32MatrixBatchedFeatureExtractorStep_f32i32) BatchedFeatureExtractorStep< LinearMatrixFeature<MatrixBufferTemplate<float>, float, int> >;
+%template(AxisAlignedFloat32MatrixFeature_f32i32) AxisAlignedMatrixFeature< MatrixBufferTemplate<float>, float, int >;
+%template(AxisAlignedFloat32MatrixFeatureExtractorStep_f32i32) FeatureExtractorStep< AxisAlignedMatrixFeature<MatrixBufferTemplate<float>, float, int> >;
+%template(BinFeaturesStep_f32i32) BinFeaturesStep<float, int>;
+%template(PresortFeaturesStep_f32i32) PresortFeaturesStep<float, int>;
@@ -2,7 +2,13 @@
 %{
     #define SWIG_FILE_WITH_INIT
     #include "AxisAlignedParamsStep.h"
+    #include "SparseRandomProjectionParamsStep.h"
     #include "LinearMatrixFeature.h"
+    #include "AxisAlignedMatrixFeature.h"
+    #include "BinFeaturesStep.h"
+    #include "BestSplitpointsHistogramStep.h"
+    #include "PresortFeaturesStep.h"
+    #include "BestSplitpointsPresortedStep.h"
 %}
 
 %include <exception.i>
@@ -11,5 +17,11 @@
 %import(module="rftk.pipeline") "pipeline_external.i"
 
 %include "AxisAlignedParamsStep.h"
+%include "SparseRandomProjectionParamsStep.h"
 %include "LinearMatrixFeature.h"
+%include "AxisAlignedMatrixFeature.h"
+%include "BinFeaturesStep.h"
+%include "BestSplitpointsHistogramStep.h"
+%include "PresortFeaturesStep.h"
+%include "BestSplitpointsPresortedStep.h"
 
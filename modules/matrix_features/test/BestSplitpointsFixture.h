@@ -0,0 +1,91 @@
+#pragma once
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "LinearMatrixFeature.h"
+
+// ----------------------------------------------------------------------------
+//
+// Shared fixture for the best splitpoints step tests.  Ten samples of two
+// dimensions with four classes and one axis aligned feature per dimension.
+// AddNodeBuffers adds the indices, classes, weights and feature values of a
+// node so a step can be checked against BestSplitpointsWalkingSortedStep.
+//
+// ----------------------------------------------------------------------------
+struct BestSplitpointsFixture {
+    BestSplitpointsFixture()
+    : xs_key("xs")
+    , classes_key("classes")
+    , weights_key("weights")
+    , indices_key("indices")
+    , float_params_key("float_params")
+    , int_params_key("int_params")
+    , feature_values_key("feature_values")
+    , collection()
+    , stack()
+    {
+        float xs_data[] = {5,-3,
+                           5,-3,
+                           5,2,
+                           5,2,
+                           5,0,
+                           -1,-3,
+                           -1,-3,
+                           -1,2,
+                           -1,2,
+                           -1,0};
+        collection.AddBuffer(xs_key, MatrixBufferTemplate<float>(&xs_data[0], 10, 2));
+
+        float float_params_data[] = {0, 0, 1,
+                                     0, 0, 1};
+        collection.AddBuffer(float_params_key, MatrixBufferTemplate<float>(&float_params_data[0], 2, 3));
+        int int_params_data[] = {MATRIX_FEATURES, 1, 0,
+                                 MATRIX_FEATURES, 1, 1};
+        collection.AddBuffer(int_params_key, MatrixBufferTemplate<int>(&int_params_data[0], 2, 3));
+        stack.Push(&collection);
+    }
+
+    ~BestSplitpointsFixture()
+    {
+    }
+
+    // Classes, weights and feature values of the samples in indices
+    void AddNodeBuffers(const int* indices, int numberOfSamples)
+    {
+        AddNodeBuffers(indices, numberOfSamples, collection);
+    }
+
+    void AddNodeBuffers(const int* indices, int numberOfSamples, BufferCollection& nodeCollection)
+    {
+        const int classes[] = {0,0,0,0,0,1,1,2,2,3};
+        const MatrixBufferTemplate<float>& xs = collection.GetBuffer< MatrixBufferTemplate<float> >(xs_key);
+        VectorBufferTemplate<int> nodeIndices(numberOfSamples);
+        VectorBufferTemplate<int> nodeClasses(numberOfSamples);
+        VectorBufferTemplate<float> nodeWeights(numberOfSamples);
+        MatrixBufferTemplate<float> featureValues(2, numberOfSamples);
+        for(int i=0; i<numberOfSamples; i++)
+        {
+            nodeIndices.Set(i, indices[i]);
+            nodeClasses.Set(i, classes[indices[i]]);
+            nodeWeights.Set(i, 1.0f);
+            featureValues.Set(0, i, xs.Get(indices[i], 0));
+            featureValues.Set(1, i, xs.Get(indices[i], 1));
+        }
+        nodeCollection.AddBuffer(indices_key, nodeIndices);
+        nodeCollection.AddBuffer(classes_key, nodeClasses);
+        nodeCollection.AddBuffer(weights_key, nodeWeights);
+        nodeCollection.AddBuffer(feature_values_key, featureValues);
+    }
+
+    const BufferCollectionKey_t xs_key;
+    const BufferCollectionKey_t classes_key;
+    const BufferCollectionKey_t weights_key;
+    const BufferCollectionKey_t indices_key;
+    const BufferCollectionKey_t float_params_key;
+    const BufferCollectionKey_t int_params_key;
+    const BufferCollectionKey_t feature_values_key;
+    BufferCollection collection;
+    BufferCollectionStack stack;
+};
@@ -0,0 +1,96 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "LinearMatrixFeature.h"
+#include "AxisAlignedMatrixFeature.h"
+#include "AxisAlignedParamsStep.h"
+#include "FeatureExtractorStep.h"
+
+struct AxisAlignedMatrixFeatureFixture {
+
+    AxisAlignedMatrixFeatureFixture()
+    : float_params_key("float_params")
+    , int_params_key("int_params")
+    , xs_key("xs")
+    , indices_key("indices")
+    , collection()
+    , stack()
+    {
+        float xs_data[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+        collection.AddBuffer(xs_key, MatrixBufferTemplate<float>(&xs_data[0], 4, 5));
+        int indices_data[] = {3, 0, 2};
+        collection.AddBuffer(indices_key, VectorBufferTemplate<int>(&indices_data[0], 3));
+        stack.Push(&collection);
+    }
+
+    const BufferCollectionKey_t float_params_key;
+    const BufferCollectionKey_t int_params_key;
+    const BufferCollectionKey_t xs_key;
+    const BufferCollectionKey_t indices_key;
+    BufferCollection collection;
+    BufferCollectionStack stack;
+
+    typedef AxisAlignedMatrixFeature<MatrixBufferTemplate<float>, float, int> AxisAlignedMatrixFeature_t;
+    typedef AxisAlignedMatrixFeatureBinding<MatrixBufferTemplate<float>, float, int> AxisAlignedMatrixFeatureBinding_t;
+    typedef LinearMatrixFeature<MatrixBufferTemplate<float>, float, int> LinearMatrixFeature_t;
+};
+
+BOOST_FIXTURE_TEST_SUITE( AxisAlignedMatrixFeatureTests, AxisAlignedMatrixFeatureFixture )
+
+BOOST_AUTO_TEST_CASE(test_FeatureValue)
+{
+    float float_params_data[] = {0, 0, 1,
+                                 0, 0, 1};
+    collection.AddBuffer(float_params_key, MatrixBufferTemplate<float>(&float_params_data[0], 2, 3));
+    int int_params_data[] = {MATRIX_FEATURES, 1, 0,
+                             MATRIX_FEATURES, 1, 3};
+    collection.AddBuffer(int_params_key, MatrixBufferTemplate<int>(&int_params_data[0], 2, 3));
+
+    AxisAlignedMatrixFeature_t feature(float_params_key, int_params_key, indices_key, xs_key);
+    AxisAlignedMatrixFeatureBinding_t featureBinding = feature.Bind(stack);
+    BOOST_CHECK_EQUAL(featureBinding.GetNumberOfFeatures(), 2);
+    BOOST_CHECK_EQUAL(featureBinding.GetNumberOfDatapoints(), 3);
+    BOOST_CHECK_EQUAL(featureBinding.FeatureValue(0, 0), 15);
+    BOOST_CHECK_EQUAL(featureBinding.FeatureValue(0, 1), 0);
+    BOOST_CHECK_EQUAL(featureBinding.FeatureValue(0, 2), 10);
+    BOOST_CHECK_EQUAL(featureBinding.FeatureValue(1, 0), 18);
+    BOOST_CHECK_EQUAL(featureBinding.FeatureValue(1, 1), 3);
+    BOOST_CHECK_EQUAL(featureBinding.FeatureValue(1, 2), 13);
+}
+
+BOOST_AUTO_TEST_CASE(test_FeatureExtractor_matches_linear_matrix_feature)
+{
+    VectorBufferTemplate<int> numberOfFeatures(1);
+    numberOfFeatures.Set(0, 4);
+    BufferCollectionKey_t number_of_features_key("number_of_features");
+    collection.AddBuffer(number_of_features_key, numberOfFeatures);
+
+    AxisAlignedParamsStep<float, int> paramsStep(number_of_features_key, xs_key);
+    boost::mt19937 gen;
+    BufferCollection paramsCollection;
+    paramsStep.ProcessStep(stack, paramsCollection, gen);
+    stack.Push(&paramsCollection);
+
+    AxisAlignedMatrixFeature_t axisAlignedFeature(paramsStep.FloatParamsBufferId, paramsStep.IntParamsBufferId, indices_key, xs_key);
+    LinearMatrixFeature_t linearFeature(paramsStep.FloatParamsBufferId, paramsStep.IntParamsBufferId, indices_key, xs_key);
+
+    FeatureValueOrdering orderings[] = {FEATURES_BY_DATAPOINTS, DATAPOINTS_BY_FEATURES};
+    for(int i=0; i<2; i++)
+    {
+        FeatureExtractorStep<AxisAlignedMatrixFeature_t> axisAlignedExtractor(axisAlignedFeature, orderings[i]);
+        FeatureExtractorStep<LinearMatrixFeature_t> linearExtractor(linearFeature, orderings[i]);
+        BufferCollection axisAlignedCollection;
+        BufferCollection linearCollection;
+        axisAlignedExtractor.ProcessStep(stack, axisAlignedCollection, gen);
+        linearExtractor.ProcessStep(stack, linearCollection, gen);
+
+        BOOST_CHECK( axisAlignedCollection.GetBuffer< MatrixBufferTemplate<float> >(axisAlignedExtractor.FeatureValuesBufferId)
+                    == linearCollection.GetBuffer< MatrixBufferTemplate<float> >(linearExtractor.FeatureValuesBufferId) );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,363 @@
+#include <boost/test/unit_test.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "LinearMatrixFeature.h"
+#include "AxisAlignedParamsStep.h"
+#include "BinFeaturesStep.h"
+#include "BestSplitpointsHistogramStep.h"
+#include "BestSplitpointsWalkingSortedStep.h"
+#include "ClassInfoGainWalker.h"
+#include "NodeHistograms.h"
+#include "BestSplitpointsFixture.h"
+
+// Counts the samples added to histograms so the histograms built from samples
+// can be told apart from the ones derived from the parent
+class HistogramCountingWalker : public ClassInfoGainWalker<float, int>
+{
+public:
+    HistogramCountingWalker(const BufferId& weights, const BufferId& classes, int numberOfClasses)
+    : ClassInfoGainWalker<float, int>(weights, classes, numberOfClasses)
+    {}
+
+    void AddToYsHistogram(int sampleIndex, float* ysHistogram) const
+    {
+        ++sNumberOfAddedSamples;
+        ClassInfoGainWalker<float, int>::AddToYsHistogram(sampleIndex, ysHistogram);
+    }
+
+    static int sNumberOfAddedSamples;
+};
+int HistogramCountingWalker::sNumberOfAddedSamples = 0;
+
+// Adds the indices, classes and weights of samples [begin, end)
+void AddRangeNodeBuffers(int begin, int end, int numberOfClasses,
+                         const BufferId& indicesKey, const BufferId& classesKey, const BufferId& weightsKey,
+                         BufferCollection& nodeCollection)
+{
+    VectorBufferTemplate<int> nodeIndices(end - begin);
+    VectorBufferTemplate<int> nodeClasses(end - begin);
+    VectorBufferTemplate<float> nodeWeights(end - begin);
+    for(int i=begin; i<end; i++)
+    {
+        nodeIndices.Set(i - begin, i);
+        nodeClasses.Set(i - begin, i % numberOfClasses);
+        nodeWeights.Set(i - begin, 1.0f);
+    }
+    nodeCollection.AddBuffer(indicesKey, nodeIndices);
+    nodeCollection.AddBuffer(classesKey, nodeClasses);
+    nodeCollection.AddBuffer(weightsKey, nodeWeights);
+}
+
+BOOST_FIXTURE_TEST_SUITE( BestSplitpointsHistogramStepTests,  BestSplitpointsFixture)
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_matches_walking_sorted)
+{
+    const int indices[] = {0,1,2,3,4,5,6,7,8,9};
+    AddNodeBuffers(&indices[0], 10);
+
+    boost::mt19937 gen(0);
+    BinFeaturesStep<float, int> binStep(xs_key, 256);
+    BufferCollection treeCollection;
+    binStep.ProcessStep(stack, treeCollection, gen);
+    stack.Push(&treeCollection);
+
+    ClassInfoGainWalker<float, int> walker(weights_key, classes_key, 4);
+    BestSplitpointsHistogramStep< ClassInfoGainWalker<float, int> > histogramStep(walker,
+                                                                                 binStep.BinnedFeaturesBufferId,
+                                                                                 binStep.BinEdgesBufferId,
+                                                                                 binStep.NumberOfBinsBufferId,
+                                                                                 float_params_key,
+                                                                                 int_params_key,
+                                                                                 indices_key);
+    BestSplitpointsWalkingSortedStep< ClassInfoGainWalker<float, int> > walkingStep(walker, feature_values_key, FEATURES_BY_DATAPOINTS);
+
+    BufferCollection nodeCollection;
+    histogramStep.ProcessStep(stack, nodeCollection, gen);
+    walkingStep.ProcessStep(stack, nodeCollection, gen);
+
+    const MatrixBufferTemplate<float>& impurities = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(histogramStep.ImpurityBufferId);
+    const MatrixBufferTemplate<float>& expectedImpurities = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(walkingStep.ImpurityBufferId);
+    const MatrixBufferTemplate<float>& thresholds = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(histogramStep.SplitpointBufferId);
+    const MatrixBufferTemplate<float>& expectedThresholds = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(walkingStep.SplitpointBufferId);
+    const Tensor3BufferTemplate<float>& childCounts = nodeCollection.GetBuffer< Tensor3BufferTemplate<float> >(histogramStep.ChildCountsBufferId);
+    const Tensor3BufferTemplate<float>& expectedChildCounts = nodeCollection.GetBuffer< Tensor3BufferTemplate<float> >(walkingStep.ChildCountsBufferId);
+    const Tensor3BufferTemplate<float>& leftYs = nodeCollection.GetBuffer< Tensor3BufferTemplate<float> >(histogramStep.LeftYsBufferId);
+    const Tensor3BufferTemplate<float>& expectedLeftYs = nodeCollection.GetBuffer< Tensor3BufferTemplate<float> >(walkingStep.LeftYsBufferId);
+
+    for(int f=0; f<2; f++)
+    {
+        BOOST_CHECK_CLOSE(impurities.Get(f, 0), expectedImpurities.Get(f, 0), 0.001);
+        BOOST_CHECK_CLOSE(thresholds.Get(f, 0), expectedThresholds.Get(f, 0), 0.001);
+        BOOST_CHECK_EQUAL(childCounts.Get(f, 0, 0), expectedChildCounts.Get(f, 0, 0));
+        BOOST_CHECK_EQUAL(childCounts.Get(f, 0, 1), expectedChildCounts.Get(f, 0, 1));
+        for(int c=0; c<4; c++)
+        {
+            BOOST_CHECK_CLOSE(leftYs.Get(f, 0, c), expectedLeftYs.Get(f, 0, c), 0.001);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_node_subset)
+{
+    const int indices[] = {7,2,9,5,3};
+    AddNodeBuffers(&indices[0], 5);
+
+    boost::mt19937 gen(0);
+    BinFeaturesStep<float, int> binStep(xs_key, 256);
+    BufferCollection treeCollection;
+    binStep.ProcessStep(stack, treeCollection, gen);
+    stack.Push(&treeCollection);
+
+    ClassInfoGainWalker<float, int> walker(weights_key, classes_key, 4);
+    BestSplitpointsHistogramStep< ClassInfoGainWalker<float, int> > histogramStep(walker,
+                                                                                 binStep.BinnedFeaturesBufferId,
+                                                                                 binStep.BinEdgesBufferId,
+                                                                                 binStep.NumberOfBinsBufferId,
+                                                                                 float_params_key,
+                                                                                 int_params_key,
+                                                                                 indices_key);
+    BestSplitpointsWalkingSortedStep< ClassInfoGainWalker<float, int> > walkingStep(walker, feature_values_key, FEATURES_BY_DATAPOINTS);
+
+    BufferCollection nodeCollection;
+    histogramStep.ProcessStep(stack, nodeCollection, gen);
+    walkingStep.ProcessStep(stack, nodeCollection, gen);
+
+    const MatrixBufferTemplate<float>& impurities = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(histogramStep.ImpurityBufferId);
+    const MatrixBufferTemplate<float>& expectedImpurities = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(walkingStep.ImpurityBufferId);
+    const MatrixBufferTemplate<float>& thresholds = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(histogramStep.SplitpointBufferId);
+    const Tensor3BufferTemplate<float>& childCounts = nodeCollection.GetBuffer< Tensor3BufferTemplate<float> >(histogramStep.ChildCountsBufferId);
+    const MatrixBufferTemplate<float>& featureValues = collection.GetBuffer< MatrixBufferTemplate<float> >(feature_values_key);
+
+    for(int f=0; f<2; f++)
+    {
+        BOOST_CHECK_CLOSE(impurities.Get(f, 0), expectedImpurities.Get(f, 0), 0.001);
+
+        // The bin edge splits the feature values into the child counts
+        int left = 0;
+        for(int i=0; i<5; i++)
+        {
+            left += (featureValues.Get(f, i) > thresholds.Get(f, 0)) ? 1 : 0;
+        }
+        BOOST_CHECK_EQUAL(childCounts.Get(f, 0, 0), static_cast<float>(left));
+        BOOST_CHECK_EQUAL(childCounts.Get(f, 0, 1), static_cast<float>(5 - left));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_sibling_derived_from_parent)
+{
+    typedef boost::shared_ptr< NodeHistograms<float, int> > NodeHistogramsPtr;
+
+    boost::mt19937 gen(0);
+    BinFeaturesStep<float, int> binStep(xs_key, 256);
+    BufferCollection treeCollection;
+    binStep.ProcessStep(stack, treeCollection, gen);
+    stack.Push(&treeCollection);
+
+    ClassInfoGainWalker<float, int> walker(weights_key, classes_key, 4);
+    BestSplitpointsHistogramStep< ClassInfoGainWalker<float, int> > histogramStep(walker,
+                                                                                 binStep.BinnedFeaturesBufferId,
+                                                                                 binStep.BinEdgesBufferId,
+                                                                                 binStep.NumberOfBinsBufferId,
+                                                                                 float_params_key,
+                                                                                 int_params_key,
+                                                                                 indices_key);
+
+    const int parentIndices[] = {0,1,2,3,4,5,6,7,8,9};
+    BufferCollection parentIndicesCollection;
+    AddNodeBuffers(&parentIndices[0], 10, parentIndicesCollection);
+    stack.Push(&parentIndicesCollection);
+    BufferCollection parentCollection;
+    histogramStep.ProcessStep(stack, parentCollection, gen);
+    stack.Pop();
+    BOOST_CHECK(parentCollection.HasBuffer<NodeHistogramsPtr>(NODE_HISTOGRAMS));
+
+    // The smaller child is processed first and the larger one derives its
+    // histograms from the parent
+    const int smallIndices[] = {7,2,9};
+    const int largeIndices[] = {0,1,3,4,5,6,8};
+    BufferCollection smallIndicesCollection;
+    BufferCollection largeIndicesCollection;
+    const bool inherited = InheritNodeHistograms<float, int>(parentCollection, smallIndicesCollection, largeIndicesCollection);
+    BOOST_CHECK(inherited);
+    AddNodeBuffers(&smallIndices[0], 3, smallIndicesCollection);
+    AddNodeBuffers(&largeIndices[0], 7, largeIndicesCollection);
+
+    stack.Push(&smallIndicesCollection);
+    BufferCollection smallCollection;
+    histogramStep.ProcessStep(stack, smallCollection, gen);
+    stack.Pop();
+
+    stack.Push(&largeIndicesCollection);
+    BufferCollection largeCollection;
+    histogramStep.ProcessStep(stack, largeCollection, gen);
+    stack.Pop();
+
+    // The same child without a parent builds its histograms from its samples
+    BufferCollection explicitIndicesCollection;
+    AddNodeBuffers(&largeIndices[0], 7, explicitIndicesCollection);
+    stack.Push(&explicitIndicesCollection);
+    BufferCollection explicitCollection;
+    histogramStep.ProcessStep(stack, explicitCollection, gen);
+    stack.Pop();
+
+    const NodeHistograms<float, int>& derived = *largeCollection.GetBuffer<NodeHistogramsPtr>(NODE_HISTOGRAMS);
+    const NodeHistograms<float, int>& expected = *explicitCollection.GetBuffer<NodeHistogramsPtr>(NODE_HISTOGRAMS);
+    for(int d=0; d<2; d++)
+    {
+        BOOST_CHECK(derived.Has(d));
+        BOOST_CHECK(derived.GetYs(d) == expected.GetYs(d));
+        BOOST_CHECK(derived.GetCounts(d) == expected.GetCounts(d));
+    }
+
+    const MatrixBufferTemplate<float>& impurities = largeCollection.GetBuffer< MatrixBufferTemplate<float> >(histogramStep.ImpurityBufferId);
+    const MatrixBufferTemplate<float>& expectedImpurities = explicitCollection.GetBuffer< MatrixBufferTemplate<float> >(histogramStep.ImpurityBufferId);
+    const MatrixBufferTemplate<float>& thresholds = largeCollection.GetBuffer< MatrixBufferTemplate<float> >(histogramStep.SplitpointBufferId);
+    const MatrixBufferTemplate<float>& expectedThresholds = explicitCollection.GetBuffer< MatrixBufferTemplate<float> >(histogramStep.SplitpointBufferId);
+    for(int f=0; f<2; f++)
+    {
+        BOOST_CHECK_EQUAL(impurities.Get(f, 0), expectedImpurities.Get(f, 0));
+        BOOST_CHECK_EQUAL(thresholds.Get(f, 0), expectedThresholds.Get(f, 0));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_first_child_builds_parent_dimensions)
+{
+    typedef boost::shared_ptr< NodeHistograms<float, int> > NodeHistogramsPtr;
+
+    boost::mt19937 gen(0);
+    BinFeaturesStep<float, int> binStep(xs_key, 256);
+    BufferCollection treeCollection;
+    binStep.ProcessStep(stack, treeCollection, gen);
+    stack.Push(&treeCollection);
+
+    // The parent has histograms for both dimensions
+    const int bins[] = {2, 3};
+    NodeHistogramsPtr parentHistograms(new NodeHistograms<float, int>());
+    for(int d=0; d<2; d++)
+    {
+        parentHistograms->Set(d, std::vector<float>(bins[d]*4, 1.0f), std::vector<int>(bins[d], 1));
+    }
+    BufferCollection parentCollection;
+    parentCollection.AddBuffer(NODE_HISTOGRAMS, parentHistograms);
+    BufferCollection childIndicesCollection;
+    BufferCollection siblingIndicesCollection;
+    InheritNodeHistograms<float, int>(parentCollection, childIndicesCollection, siblingIndicesCollection);
+    const int indices[] = {7,2,9};
+    AddNodeBuffers(&indices[0], 3, childIndicesCollection);
+    stack.Push(&childIndicesCollection);
+
+    // The child only splits on dimension 1
+    float float_params_data[] = {0, 0, 1};
+    childIndicesCollection.AddBuffer(float_params_key, MatrixBufferTemplate<float>(&float_params_data[0], 1, 3));
+    int int_params_data[] = {MATRIX_FEATURES, 1, 1};
+    childIndicesCollection.AddBuffer(int_params_key, MatrixBufferTemplate<int>(&int_params_data[0], 1, 3));
+
+    ClassInfoGainWalker<float, int> walker(weights_key, classes_key, 4);
+    BestSplitpointsHistogramStep< ClassInfoGainWalker<float, int> > histogramStep(walker,
+                                                                                 binStep.BinnedFeaturesBufferId,
+                                                                                 binStep.BinEdgesBufferId,
+                                                                                 binStep.NumberOfBinsBufferId,
+                                                                                 float_params_key,
+                                                                                 int_params_key,
+                                                                                 indices_key);
+    BufferCollection childCollection;
+    histogramStep.ProcessStep(stack, childCollection, gen);
+
+    const NodeHistograms<float, int>& childHistograms = *childCollection.GetBuffer<NodeHistogramsPtr>(NODE_HISTOGRAMS);
+    BOOST_CHECK(childHistograms.Has(0));
+    BOOST_CHECK(childHistograms.Has(1));
+    typedef boost::shared_ptr< SiblingHistograms<float, int> > SiblingHistogramsPtr;
+    BOOST_CHECK(siblingIndicesCollection.GetBuffer<SiblingHistogramsPtr>(PARENT_HISTOGRAMS)->HasFirstChild());
+
+    // Samples 7, 2 and 9 fall in bins 0, 1 and 0 of dimension 0
+    std::vector<int> expectedCounts(2, 0);
+    expectedCounts[0] = 2;
+    expectedCounts[1] = 1;
+    BOOST_CHECK(childHistograms.GetCounts(0) == expectedCounts);
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_random_dimensions_drawn_per_tree_are_derived)
+{
+    const int numberOfSamples = 40;
+    const int numberOfDimensions = 32;
+    const int numberOfFeatures = 4;
+    const int numberOfSmallerChildSamples = 10;
+    const int numberOfClasses = 3;
+
+    BufferCollection dataCollection;
+    MatrixBufferTemplate<float> xs(numberOfSamples, numberOfDimensions);
+    for(int i=0; i<numberOfSamples; i++)
+    {
+        for(int d=0; d<numberOfDimensions; d++)
+        {
+            xs.Set(i, d, static_cast<float>((i*7 + d*13) % 17));
+        }
+    }
+    dataCollection.AddBuffer(xs_key, xs);
+    const BufferCollectionKey_t number_of_features_key("number_of_features");
+    VectorBufferTemplate<int> numberOfFeaturesBuffer(1);
+    numberOfFeaturesBuffer.Set(0, numberOfFeatures);
+    dataCollection.AddBuffer(number_of_features_key, numberOfFeaturesBuffer);
+
+    boost::mt19937 gen(0);
+    BinFeaturesStep<float, int> binStep(xs_key, 256);
+    AxisAlignedParamsStep<float, int> paramsStep(number_of_features_key, xs_key);
+    HistogramCountingWalker walker(weights_key, classes_key, numberOfClasses);
+    BestSplitpointsHistogramStep<HistogramCountingWalker> histogramStep(walker,
+                                                                        binStep.BinnedFeaturesBufferId,
+                                                                        binStep.BinEdgesBufferId,
+                                                                        binStep.NumberOfBinsBufferId,
+                                                                        paramsStep.FloatParamsBufferId,
+                                                                        paramsStep.IntParamsBufferId,
+                                                                        indices_key);
+
+    // Split the samples into a smaller and a larger child with the features
+    // drawn per node and then drawn once per tree
+    int numberOfBuiltHistograms[2];
+    for(int drawnPerTree=0; drawnPerTree<2; drawnPerTree++)
+    {
+        BufferCollectionStack treeStack;
+        treeStack.Push(&dataCollection);
+        BufferCollection treeCollection;
+        binStep.ProcessStep(treeStack, treeCollection, gen);
+        if(drawnPerTree)
+        {
+            paramsStep.ProcessStep(treeStack, treeCollection, gen);
+        }
+        treeStack.Push(&treeCollection);
+
+        const int begins[] = {0, 0, numberOfSmallerChildSamples};
+        const int ends[] = {numberOfSamples, numberOfSmallerChildSamples, numberOfSamples};
+        BufferCollection nodeCollections[3];
+        BufferCollection childIndicesCollections[2];
+        for(int node=0; node<3; node++)
+        {
+            BufferCollection& indicesCollection = (node == 0) ? nodeCollections[0] : childIndicesCollections[node-1];
+            AddRangeNodeBuffers(begins[node], ends[node], numberOfClasses, indices_key, classes_key, weights_key, indicesCollection);
+            treeStack.Push(&indicesCollection);
+            if(!drawnPerTree)
+            {
+                paramsStep.ProcessStep(treeStack, indicesCollection, gen);
+            }
+            HistogramCountingWalker::sNumberOfAddedSamples = 0;
+            histogramStep.ProcessStep(treeStack, nodeCollections[node], gen);
+            treeStack.Pop();
+            if(node == 0)
+            {
+                InheritNodeHistograms<float, int>(nodeCollections[0], childIndicesCollections[0], childIndicesCollections[1]);
+            }
+        }
+        numberOfBuiltHistograms[drawnPerTree] = HistogramCountingWalker::sNumberOfAddedSamples / (numberOfSamples - numberOfSmallerChildSamples);
+    }
+
+    // Features drawn per node mostly have dimensions the parent did not build
+    BOOST_CHECK_GT(numberOfBuiltHistograms[0], 0);
+    // Features drawn per tree are all derived by the larger child
+    BOOST_CHECK_EQUAL(numberOfBuiltHistograms[1], 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "LinearMatrixFeature.h"
+#include "PresortFeaturesStep.h"
+#include "BestSplitpointsPresortedStep.h"
+#include "BestSplitpointsWalkingSortedStep.h"
+#include "ClassInfoGainWalker.h"
+#include "PresortedIndices.h"
+#include "BestSplitpointsFixture.h"
+
+BOOST_FIXTURE_TEST_SUITE( BestSplitpointsPresortedStepTests,  BestSplitpointsFixture)
+
+// Checks the presorted step against sorting the feature values of the node
+void CheckMatchesWalkingSorted(const BufferCollectionStack& stack,
+                               const BestSplitpointsPresortedStep< ClassInfoGainWalker<float, int> >& presortedStep,
+                               const BestSplitpointsWalkingSortedStep< ClassInfoGainWalker<float, int> >& walkingStep)
+{
+    boost::mt19937 gen(0);
+    BufferCollection nodeCollection;
+    presortedStep.ProcessStep(stack, nodeCollection, gen);
+    walkingStep.ProcessStep(stack, nodeCollection, gen);
+
+    const MatrixBufferTemplate<float>& impurities = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(presortedStep.ImpurityBufferId);
+    const MatrixBufferTemplate<float>& expectedImpurities = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(walkingStep.ImpurityBufferId);
+    const MatrixBufferTemplate<float>& thresholds = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(presortedStep.SplitpointBufferId);
+    const MatrixBufferTemplate<float>& expectedThresholds = nodeCollection.GetBuffer< MatrixBufferTemplate<float> >(walkingStep.SplitpointBufferId);
+    const Tensor3BufferTemplate<float>& childCounts = nodeCollection.GetBuffer< Tensor3BufferTemplate<float> >(presortedStep.ChildCountsBufferId);
+    const Tensor3BufferTemplate<float>& expectedChildCounts = nodeCollection.GetBuffer< Tensor3BufferTemplate<float> >(walkingStep.ChildCountsBufferId);
+    for(int f=0; f<2; f++)
+    {
+        BOOST_CHECK_EQUAL(impurities.Get(f, 0), expectedImpurities.Get(f, 0));
+        BOOST_CHECK_EQUAL(thresholds.Get(f, 0), expectedThresholds.Get(f, 0));
+        BOOST_CHECK_EQUAL(childCounts.Get(f, 0, 0), expectedChildCounts.Get(f, 0, 0));
+        BOOST_CHECK_EQUAL(childCounts.Get(f, 0, 1), expectedChildCounts.Get(f, 0, 1));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_PresortFeaturesStep)
+{
+    boost::mt19937 gen(0);
+    PresortFeaturesStep<float, int> presortStep(xs_key);
+    BufferCollection treeCollection;
+    presortStep.ProcessStep(stack, treeCollection, gen);
+
+    const MatrixBufferTemplate<int>& sortedIndices = treeCollection.GetBuffer< MatrixBufferTemplate<int> >(presortStep.SortedIndicesBufferId);
+    BOOST_CHECK_EQUAL(sortedIndices.GetM(), 2);
+    BOOST_CHECK_EQUAL(sortedIndices.GetN(), 10);
+    const MatrixBufferTemplate<float>& xs = collection.GetBuffer< MatrixBufferTemplate<float> >(xs_key);
+    for(int d=0; d<2; d++)
+    {
+        for(int s=0; s<9; s++)
+        {
+            BOOST_CHECK(xs.Get(sortedIndices.Get(d, s), d) <= xs.Get(sortedIndices.Get(d, s+1), d));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_root_with_repeated_indices)
+{
+    boost::mt19937 gen(0);
+    PresortFeaturesStep<float, int> presortStep(xs_key);
+    BufferCollection treeCollection;
+    presortStep.ProcessStep(stack, treeCollection, gen);
+    stack.Push(&treeCollection);
+
+    const int indices[] = {9,2,2,7,0,5,5,5,3};
+    BufferCollection indicesCollection;
+    AddNodeBuffers(&indices[0], 9, indicesCollection);
+    stack.Push(&indicesCollection);
+
+    ClassInfoGainWalker<float, int> walker(weights_key, classes_key, 4);
+    BestSplitpointsPresortedStep< ClassInfoGainWalker<float, int> > presortedStep(walker,
+                                                                                 presortStep.SortedIndicesBufferId,
+                                                                                 xs_key,
+                                                                                 float_params_key,
+                                                                                 int_params_key,
+                                                                                 indices_key);
+    BestSplitpointsWalkingSortedStep< ClassInfoGainWalker<float, int> > walkingStep(walker, feature_values_key, FEATURES_BY_DATAPOINTS);
+    CheckMatchesWalkingSorted(stack, presortedStep, walkingStep);
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_children_inherit_sort_order)
+{
+    typedef boost::shared_ptr< PresortedIndices<int> > PresortedIndicesPtr;
+
+    boost::mt19937 gen(0);
+    PresortFeaturesStep<float, int> presortStep(xs_key);
+    BufferCollection treeCollection;
+    presortStep.ProcessStep(stack, treeCollection, gen);
+    stack.Push(&treeCollection);
+
+    ClassInfoGainWalker<float, int> walker(weights_key, classes_key, 4);
+    BestSplitpointsPresortedStep< ClassInfoGainWalker<float, int> > presortedStep(walker,
+                                                                                 presortStep.SortedIndicesBufferId,
+                                                                                 xs_key,
+                                                                                 float_params_key,
+                                                                                 int_params_key,
+                                                                                 indices_key);
+    BestSplitpointsWalkingSortedStep< ClassInfoGainWalker<float, int> > walkingStep(walker, feature_values_key, FEATURES_BY_DATAPOINTS);
+
+    const int parentIndices[] = {9,2,2,7,0,5,5,8,3,1};
+    BufferCollection parentIndicesCollection;
+    AddNodeBuffers(&parentIndices[0], 10, parentIndicesCollection);
+    stack.Push(&parentIndicesCollection);
+    BufferCollection parentCollection;
+    presortedStep.ProcessStep(stack, parentCollection, gen);
+    stack.Pop();
+    BOOST_CHECK(parentCollection.HasBuffer<PresortedIndicesPtr>(PRESORTED_INDICES));
+
+    // Split on the second column (> 1 goes left) keeping the parent order
+    const int partitionedIndices[] = {2,2,7,8,3,9,0,5,5,1};
+    const std::vector<int> permutation(&partitionedIndices[0], &partitionedIndices[0]+10);
+    BufferCollection leftIndicesCollection;
+    BufferCollection rightIndicesCollection;
+    AddNodeBuffers(&partitionedIndices[0], 5, leftIndicesCollection);
+    AddNodeBuffers(&partitionedIndices[5], 5, rightIndicesCollection);
+    const bool inherited = InheritPresortedIndices<int>(parentCollection, permutation, 0, 5, 10,
+                                                        leftIndicesCollection, rightIndicesCollection);
+    BOOST_CHECK(inherited);
+    BOOST_CHECK(leftIndicesCollection.HasBuffer<PresortedIndicesPtr>(PRESORTED_INDICES));
+    BOOST_CHECK(rightIndicesCollection.HasBuffer<PresortedIndicesPtr>(PRESORTED_INDICES));
+
+    stack.Push(&leftIndicesCollection);
+    CheckMatchesWalkingSorted(stack, presortedStep, walkingStep);
+    stack.Pop();
+
+    stack.Push(&rightIndicesCollection);
+    CheckMatchesWalkingSorted(stack, presortedStep, walkingStep);
+    stack.Pop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,154 @@
+#include <boost/test/unit_test.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "BinFeaturesStep.h"
+
+
+struct BinFeaturesStepFixture {
+    BinFeaturesStepFixture()
+    : xs_key("xs")
+    , collection()
+    , stack()
+    {
+        stack.Push(&collection);
+    }
+
+    ~BinFeaturesStepFixture()
+    {
+    }
+
+    const BufferCollectionKey_t xs_key;
+    BufferCollection collection;
+    BufferCollectionStack stack;
+};
+
+BOOST_FIXTURE_TEST_SUITE( BinFeaturesStepTests,  BinFeaturesStepFixture)
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_distinct_values)
+{
+    float data[] = {5, 0,
+                    5, 0,
+                    5, 1,
+                    -1, 1,
+                    -1, 0,
+                    2, 1};
+    collection.AddBuffer(xs_key, MatrixBufferTemplate<float>(&data[0], 6, 2));
+
+    BinFeaturesStep<float, int> binStep(xs_key, 256);
+    BufferCollection treeCollection;
+    boost::mt19937 gen(0);
+    binStep.ProcessStep(stack, treeCollection, gen);
+
+    const MatrixBufferTemplate<unsigned char>& binned =
+          treeCollection.GetBuffer< MatrixBufferTemplate<unsigned char> >(binStep.BinnedFeaturesBufferId);
+    const MatrixBufferTemplate<float>& edges =
+          treeCollection.GetBuffer< MatrixBufferTemplate<float> >(binStep.BinEdgesBufferId);
+    const VectorBufferTemplate<int>& numberOfBins =
+          treeCollection.GetBuffer< VectorBufferTemplate<int> >(binStep.NumberOfBinsBufferId);
+
+    BOOST_CHECK_EQUAL(numberOfBins.Get(0), 3);
+    BOOST_CHECK_EQUAL(numberOfBins.Get(1), 2);
+    BOOST_CHECK_CLOSE(edges.Get(0, 0), 0.5f, 0.001);
+    BOOST_CHECK_CLOSE(edges.Get(0, 1), 3.5f, 0.001);
+    BOOST_CHECK_CLOSE(edges.Get(1, 0), 0.5f, 0.001);
+
+    int expected_bins[] = {2, 0,
+                           2, 0,
+                           2, 1,
+                           0, 1,
+                           0, 0,
+                           1, 1};
+    for(int i=0; i<6; i++)
+    {
+        BOOST_CHECK_EQUAL(static_cast<int>(binned.Get(i, 0)), expected_bins[2*i]);
+        BOOST_CHECK_EQUAL(static_cast<int>(binned.Get(i, 1)), expected_bins[2*i+1]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_quantiles)
+{
+    const int numberOfSamples = 100;
+    const int maxNumberOfBins = 4;
+    MatrixBufferTemplate<float> xs(numberOfSamples, 1);
+    for(int i=0; i<numberOfSamples; i++)
+    {
+        xs.Set(i, 0, static_cast<float>((i * 37) % numberOfSamples));
+    }
+    collection.AddBuffer(xs_key, xs);
+
+    BinFeaturesStep<float, int> binStep(xs_key, maxNumberOfBins);
+    BufferCollection treeCollection;
+    boost::mt19937 gen(0);
+    binStep.ProcessStep(stack, treeCollection, gen);
+
+    const MatrixBufferTemplate<unsigned char>& binned =
+          treeCollection.GetBuffer< MatrixBufferTemplate<unsigned char> >(binStep.BinnedFeaturesBufferId);
+    const MatrixBufferTemplate<float>& edges =
+          treeCollection.GetBuffer< MatrixBufferTemplate<float> >(binStep.BinEdgesBufferId);
+    const VectorBufferTemplate<int>& numberOfBins =
+          treeCollection.GetBuffer< VectorBufferTemplate<int> >(binStep.NumberOfBinsBufferId);
+    BOOST_CHECK_EQUAL(numberOfBins.Get(0), maxNumberOfBins);
+
+    std::vector<int> binCounts(maxNumberOfBins, 0);
+    for(int i=0; i<numberOfSamples; i++)
+    {
+        const int bin = binned.Get(i, 0);
+        binCounts[bin]++;
+        for(int k=0; k<numberOfBins.Get(0)-1; k++)
+        {
+            BOOST_CHECK_EQUAL(xs.Get(i, 0) > edges.Get(0, k), bin > k);
+        }
+    }
+    for(int b=0; b<maxNumberOfBins; b++)
+    {
+        BOOST_CHECK_EQUAL(binCounts[b], numberOfSamples / maxNumberOfBins);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_quantiles_weighted_by_sample_count)
+{
+    // 70 samples share the value 0 and 30 samples have the distinct values
+    // 1..30 so quantiles of the distinct values would put 75 samples in the
+    // first bin
+    const int numberOfSamples = 100;
+    const int numberOfRepeatedSamples = 70;
+    const int maxNumberOfBins = 4;
+    MatrixBufferTemplate<float> xs(numberOfSamples, 1);
+    for(int i=0; i<numberOfSamples; i++)
+    {
+        const int value = (i < numberOfRepeatedSamples) ? 0 : i - numberOfRepeatedSamples + 1;
+        xs.Set(i, 0, static_cast<float>(value));
+    }
+    collection.AddBuffer(xs_key, xs);
+
+    BinFeaturesStep<float, int> binStep(xs_key, maxNumberOfBins);
+    BufferCollection treeCollection;
+    boost::mt19937 gen(0);
+    binStep.ProcessStep(stack, treeCollection, gen);
+
+    const MatrixBufferTemplate<unsigned char>& binned =
+          treeCollection.GetBuffer< MatrixBufferTemplate<unsigned char> >(binStep.BinnedFeaturesBufferId);
+    const MatrixBufferTemplate<float>& edges =
+          treeCollection.GetBuffer< MatrixBufferTemplate<float> >(binStep.BinEdgesBufferId);
+    const VectorBufferTemplate<int>& numberOfBins =
+          treeCollection.GetBuffer< VectorBufferTemplate<int> >(binStep.NumberOfBinsBufferId);
+
+    // The quantiles at 25 and 50 samples both fall in the run of zeros
+    BOOST_CHECK_EQUAL(numberOfBins.Get(0), 3);
+    BOOST_CHECK_CLOSE(edges.Get(0, 0), 0.5f, 0.001);
+    BOOST_CHECK_CLOSE(edges.Get(0, 1), 5.5f, 0.001);
+
+    std::vector<int> binCounts(numberOfBins.Get(0), 0);
+    for(int i=0; i<numberOfSamples; i++)
+    {
+        binCounts[binned.Get(i, 0)]++;
+    }
+    BOOST_CHECK_EQUAL(binCounts[0], numberOfRepeatedSamples);
+    BOOST_CHECK_EQUAL(binCounts[1], 5);
+    BOOST_CHECK_EQUAL(binCounts[2], 25);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,149 @@
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "SparseRandomProjectionParamsStep.h"
+#include "LinearMatrixFeature.h"
+#include "FeatureExtractorStep.h"
+#include "BatchedFeatureExtractorStep.h"
+
+
+struct SparseRandomProjectionParamsStepFixture {
+    SparseRandomProjectionParamsStepFixture()
+    : xs_key("xs")
+    , indices_key("indices")
+    , number_of_features_key("#features")
+    , xs(150,7)
+    , indices(150)
+    , numberOfFeaturesBuffers(1)
+    , collection()
+    , stack()
+    {
+        for(int i=0; i<xs.GetM(); i++)
+        {
+            indices.Set(i, xs.GetM()-1-i);
+            for(int d=0; d<xs.GetN(); d++)
+            {
+                xs.Set(i, d, static_cast<double>((i*7 + d*13) % 23) - 11.0);
+            }
+        }
+        collection.AddBuffer(xs_key, xs);
+        collection.AddBuffer(indices_key, indices);
+        collection.AddBuffer(number_of_features_key, numberOfFeaturesBuffers);
+        stack.Push(&collection);
+    }
+
+    ~SparseRandomProjectionParamsStepFixture()
+    {
+    }
+
+    const BufferCollectionKey_t xs_key;
+    const BufferCollectionKey_t indices_key;
+    const BufferCollectionKey_t number_of_features_key;
+    MatrixBufferTemplate<double> xs;
+    VectorBufferTemplate<int> indices;
+    const VectorBufferTemplate<int> numberOfFeaturesBuffers;
+    BufferCollection collection;
+    BufferCollectionStack stack;
+
+    typedef LinearMatrixFeature<MatrixBufferTemplate<double>, double, int> LinearMatrixFeature_t;
+};
+
+BOOST_FIXTURE_TEST_SUITE( SparseRandomProjectionParamsStepTests,  SparseRandomProjectionParamsStepFixture)
+
+BOOST_AUTO_TEST_CASE(test_GetNumberOfCombinedDimensions)
+{
+    const SparseRandomProjectionParamsStep<double, int> sparseStep(number_of_features_key, xs_key, 0.3);
+    BOOST_CHECK_EQUAL(sparseStep.GetNumberOfCombinedDimensions(7), 3);
+    BOOST_CHECK_EQUAL(sparseStep.GetNumberOfCombinedDimensions(2), 1);
+    BOOST_CHECK_EQUAL(sparseStep.GetNumberOfCombinedDimensions(1), 1);
+
+    const SparseRandomProjectionParamsStep<double, int> denseStep(number_of_features_key, xs_key, 1.0);
+    BOOST_CHECK_EQUAL(denseStep.GetNumberOfCombinedDimensions(7), 7);
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep)
+{
+    const int numberOfFeatures = 20;
+    VectorBufferTemplate<int>& numberFeaturesBuffer =
+          collection.GetBuffer< VectorBufferTemplate<int> >(number_of_features_key);
+    numberFeaturesBuffer.Set(0, numberOfFeatures);
+
+    const SparseRandomProjectionParamsStep<double, int> sparseStep(number_of_features_key, xs_key, 0.3);
+
+    BOOST_CHECK(!collection.HasBuffer< MatrixBufferTemplate<double> >(sparseStep.FloatParamsBufferId));
+    BOOST_CHECK(!collection.HasBuffer< MatrixBufferTemplate<int> >(sparseStep.IntParamsBufferId));
+
+    boost::mt19937 gen(0);
+    sparseStep.ProcessStep(stack, collection, gen);
+
+    const MatrixBufferTemplate<double>& floatParams =
+            collection.GetBuffer< MatrixBufferTemplate<double> >(sparseStep.FloatParamsBufferId);
+    BOOST_CHECK_EQUAL(floatParams.GetM(), numberOfFeatures);
+    BOOST_CHECK_EQUAL(floatParams.GetN(), 5);
+
+    const MatrixBufferTemplate<int>& intParams =
+            collection.GetBuffer< MatrixBufferTemplate<int> >(sparseStep.IntParamsBufferId);
+    BOOST_CHECK_EQUAL(intParams.GetM(), numberOfFeatures);
+    BOOST_CHECK_EQUAL(intParams.GetN(), 5);
+
+    for(int i=0; i<numberOfFeatures; i++)
+    {
+        BOOST_CHECK(intParams.Get(i,0) == MATRIX_FEATURES);
+        BOOST_CHECK_EQUAL(intParams.Get(i,1), 3);
+
+        std::vector<bool> dimensionsUsed(xs.GetN());
+        for(int d=2; d<5; d++)
+        {
+            const int dimension = intParams.Get(i,d);
+            BOOST_CHECK(dimension >=0 && dimension < xs.GetN());
+            BOOST_CHECK(!dimensionsUsed[dimension]);
+            dimensionsUsed[dimension] = true;
+
+            const double weight = floatParams.Get(i,d);
+            BOOST_CHECK(weight == 1.0 || weight == -1.0);
+        }
+    }
+
+    // Params are only sampled once per write collection
+    const MatrixBufferTemplate<int> intParamsCopy = intParams;
+    sparseStep.ProcessStep(stack, collection, gen);
+    BOOST_CHECK(intParamsCopy == collection.GetBuffer< MatrixBufferTemplate<int> >(sparseStep.IntParamsBufferId));
+}
+
+BOOST_AUTO_TEST_CASE(test_BatchedFeatureExtractorStep_matches_FeatureExtractorStep)
+{
+    VectorBufferTemplate<int>& numberFeaturesBuffer =
+          collection.GetBuffer< VectorBufferTemplate<int> >(number_of_features_key);
+    numberFeaturesBuffer.Set(0, 11);
+
+    const SparseRandomProjectionParamsStep<double, int> sparseStep(number_of_features_key, xs_key, 0.5);
+    boost::mt19937 gen(1);
+    sparseStep.ProcessStep(stack, collection, gen);
+
+    const LinearMatrixFeature_t feature(sparseStep.FloatParamsBufferId, sparseStep.IntParamsBufferId, indices_key, xs_key);
+
+    const FeatureValueOrdering orderings[] = {FEATURES_BY_DATAPOINTS, DATAPOINTS_BY_FEATURES};
+    for(int o=0; o<2; o++)
+    {
+        BufferCollection expectedCollection;
+        BufferCollection batchedCollection;
+
+        const FeatureExtractorStep<LinearMatrixFeature_t> featureExtractor(feature, orderings[o]);
+        featureExtractor.ProcessStep(stack, expectedCollection, gen);
+        const BatchedFeatureExtractorStep<LinearMatrixFeature_t> batchedFeatureExtractor(feature, orderings[o]);
+        batchedFeatureExtractor.ProcessStep(stack, batchedCollection, gen);
+
+        const MatrixBufferTemplate<double>& expected =
+              expectedCollection.GetBuffer< MatrixBufferTemplate<double> >(featureExtractor.FeatureValuesBufferId);
+        const MatrixBufferTemplate<double>& batched =
+              batchedCollection.GetBuffer< MatrixBufferTemplate<double> >(batchedFeatureExtractor.FeatureValuesBufferId);
+        BOOST_CHECK(expected == batched);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "BufferCollectionStack.h"
+#include "PipelineStepI.h"
+#include "UniqueBufferId.h"
+#include "FeatureExtractorStep.h"
+
+// ----------------------------------------------------------------------------
+//
+// BatchedFeatureExtractorStep extracts features for all float/int params for
+// all datapoints with a single call to FeatureValues of the feature binding.
+// It produces the same FeatureValues buffer as FeatureExtractorStep for
+// features whose binding implements
+//
+//   void FeatureValues(sampleStart, sampleEnd, ordering, featureValues) const
+//
+// ----------------------------------------------------------------------------
+template <class FeatureType>
+class BatchedFeatureExtractorStep: public PipelineStepI
+{
+public:
+    BatchedFeatureExtractorStep(const FeatureType& feature, FeatureValueOrdering ordering,
+                                FeatureValueOrdering preferredOrdering=FEATURES_BY_DATAPOINTS);
+    virtual ~BatchedFeatureExtractorStep();
+
+    virtual PipelineStepI* Clone() const;
+
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const;
+
+    // Read only output buffer
+    const BufferId FeatureValuesBufferId;
+private:
+    const FeatureType mFeature;
+    FeatureValueOrdering mOrdering;
+    FeatureValueOrdering mPreferredOrdering;
+};
+
+template <class FeatureType>
+BatchedFeatureExtractorStep<FeatureType>::BatchedFeatureExtractorStep(const FeatureType& feature, FeatureValueOrdering ordering,
+                                                                      FeatureValueOrdering preferredOrdering)
+: FeatureValuesBufferId(GetBufferId("FeatureValues"))
+, mFeature(feature)
+, mOrdering(ordering)
+, mPreferredOrdering(preferredOrdering)
+{}
+
+template <class FeatureType>
+BatchedFeatureExtractorStep<FeatureType>::~BatchedFeatureExtractorStep()
+{}
+
+template <class FeatureType>
+PipelineStepI* BatchedFeatureExtractorStep<FeatureType>::Clone() const
+{
+    BatchedFeatureExtractorStep* clone = new BatchedFeatureExtractorStep<FeatureType>(*this);
+    return clone;
+}
+
+template <class FeatureType>
+void BatchedFeatureExtractorStep<FeatureType>::ProcessStep(const BufferCollectionStack& readCollection,
+                                                           BufferCollection& writeCollection,
+                                                           boost::mt19937& gen) const
+{
+    UNUSED_PARAM(gen);
+    typename FeatureType::FeatureBinding featureBinding = mFeature.Bind(readCollection);
+
+    typename FeatureType::Int numberOfFeatures = featureBinding.GetNumberOfFeatures();
+    typename FeatureType::Int numberOfDatapoints = featureBinding.GetNumberOfDatapoints();
+
+    FeatureValueOrdering ordering = mOrdering;
+    if(mOrdering == AUTOMATIC_ORDERING)
+    {
+        ordering = SelectFeatureValueOrdering(numberOfFeatures, numberOfDatapoints, mPreferredOrdering);
+        VectorBufferTemplate<int>& orderingBuffer =
+                writeCollection.GetOrAddBuffer< VectorBufferTemplate<int> >(FeatureValueOrderingBufferId(FeatureValuesBufferId));
+        orderingBuffer.Resize(1);
+        orderingBuffer.Set(0, ordering);
+    }
+
+    typename FeatureType::Int m = (ordering == FEATURES_BY_DATAPOINTS) ? numberOfFeatures : numberOfDatapoints;
+    typename FeatureType::Int n = (ordering == FEATURES_BY_DATAPOINTS) ? numberOfDatapoints : numberOfFeatures;
+
+    MatrixBufferTemplate<typename FeatureType::Float>& featureValues =
+            writeCollection.GetOrAddBuffer< MatrixBufferTemplate<typename FeatureType::Float> >(FeatureValuesBufferId);
+    featureValues.Resize(m,n);
+
+    featureBinding.FeatureValues(0, numberOfDatapoints, ordering, featureValues);
+}
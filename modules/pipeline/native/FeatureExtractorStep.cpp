@@ -1 +1,29 @@
-#include "FeatureExtractorStep.h"
\ No newline at end of file
+#include "FeatureExtractorStep.h"
+#include "BatchedFeatureExtractorStep.h"
+FeatureValueOrdering SelectFeatureValueOrdering(int numberOfFeatures, int numberOfDatapoints,
+                                                FeatureValueOrdering preferredOrdering)
+{
+    if(numberOfFeatures * numberOfDatapoints <= AUTOMATIC_ORDERING_L1_VALUES)
+    {
+        return DATAPOINTS_BY_FEATURES;
+    }
+    return preferredOrdering;
+}
+
+BufferId FeatureValueOrderingBufferId(const BufferId& featureValuesBufferId)
+{
+    return featureValuesBufferId + "Ordering";
+}
+
+FeatureValueOrdering ResolveFeatureValueOrdering(FeatureValueOrdering ordering,
+                                                 const BufferCollectionStack& readCollection,
+                                                 const BufferId& featureValuesBufferId)
+{
+    if(ordering != AUTOMATIC_ORDERING)
+    {
+        return ordering;
+    }
+    const VectorBufferTemplate<int>& orderingBuffer =
+            readCollection.GetBuffer< VectorBufferTemplate<int> >(FeatureValueOrderingBufferId(featureValuesBufferId));
+    return static_cast<FeatureValueOrdering>(orderingBuffer.Get(0));
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "VectorBuffer.h"
 #include "MatrixBuffer.h"
 #include "BufferCollection.h"
@@ -10,20 +12,57 @@
 enum FeatureValueOrdering
 {
     FEATURES_BY_DATAPOINTS,
-    DATAPOINTS_BY_FEATURES
+    DATAPOINTS_BY_FEATURES,
+    AUTOMATIC_ORDERING
 };
 
+// ----------------------------------------------------------------------------
+//
+// With AUTOMATIC_ORDERING the feature extractor picks the ordering of each
+// node with SelectFeatureValueOrdering and writes it to the buffer named by
+// FeatureValueOrderingBufferId(featureValuesBufferId).  Steps that read the
+// feature values call ResolveFeatureValueOrdering to find the ordering that
+// was used.
+//
+// The consumer of the feature values states the ordering it reads along with
+// GetPreferredFeatureValueOrdering (a walker sorts the values of a feature so
+// it prefers FEATURES_BY_DATAPOINTS, a stats step applies each datapoint's y
+// to all features so it prefers DATAPOINTS_BY_FEATURES) and the extractor is
+// given it as a hint.  Reading against the preferred ordering strides through
+// the whole node so the hint is used once the values of a node do not fit in
+// L1.  Below that strided reads are cheap and DATAPOINTS_BY_FEATURES is used so
+// each datapoint's values are written together.
+//
+// ----------------------------------------------------------------------------
+const int AUTOMATIC_ORDERING_L1_VALUES = 4096;
+
+FeatureValueOrdering SelectFeatureValueOrdering(int numberOfFeatures, int numberOfDatapoints,
+                                                FeatureValueOrdering preferredOrdering);
+
+BufferId FeatureValueOrderingBufferId(const BufferId& featureValuesBufferId);
+
+FeatureValueOrdering ResolveFeatureValueOrdering(FeatureValueOrdering ordering,
+                                                 const BufferCollectionStack& readCollection,
+                                                 const BufferId& featureValuesBufferId);
+
 // ----------------------------------------------------------------------------
 //
 // FeatureExtractorStep extracts features for all float/int params for all
 // datapoints
 //
+// Values are extracted in blocks of SAMPLE_BLOCK_SIZE datapoints by
+// FEATURE_BLOCK_SIZE features.  Within a block the inner loop runs along the
+// rows of the output so every write is to consecutive memory, and the data
+// of a block of datapoints (or the params of a block of features) stays in
+// cache while it is reused.
+//
 // ----------------------------------------------------------------------------
 template <class FeatureType>
 class FeatureExtractorStep: public PipelineStepI
 {
 public:
-    FeatureExtractorStep(const FeatureType& feature, FeatureValueOrdering ordering);
+    FeatureExtractorStep(const FeatureType& feature, FeatureValueOrdering ordering,
+                         FeatureValueOrdering preferredOrdering=FEATURES_BY_DATAPOINTS);
     virtual ~FeatureExtractorStep();
 
     virtual PipelineStepI* Clone() const;
@@ -35,15 +74,20 @@ public:
     // Read only output buffer
     const BufferId FeatureValuesBufferId;
 private:
+    enum { SAMPLE_BLOCK_SIZE = 64, FEATURE_BLOCK_SIZE = 16 };
+
     const FeatureType mFeature;
     FeatureValueOrdering mOrdering;
+    FeatureValueOrdering mPreferredOrdering;
 };
 
 template <class FeatureType>
-FeatureExtractorStep<FeatureType>::FeatureExtractorStep(const FeatureType& feature, FeatureValueOrdering ordering)
+FeatureExtractorStep<FeatureType>::FeatureExtractorStep(const FeatureType& feature, FeatureValueOrdering ordering,
+                                                        FeatureValueOrdering preferredOrdering)
 : FeatureValuesBufferId(GetBufferId("FeatureValues"))
 , mFeature(feature)
 , mOrdering(ordering)
+, mPreferredOrdering(preferredOrdering)
 {}
 
 template <class FeatureType>
@@ -63,26 +107,57 @@ void FeatureExtractorStep<FeatureType>::ProcessStep(const BufferCollectionStack&
                                                 boost::mt19937& gen) const
 {
     UNUSED_PARAM(gen);
+    typedef typename FeatureType::Float FloatType;
     typename FeatureType::FeatureBinding featureBinding = mFeature.Bind(readCollection);
 
-    typename FeatureType::Int numberOfFeatures = featureBinding.GetNumberOfFeatures();
-    typename FeatureType::Int numberOfDatapoints = featureBinding.GetNumberOfDatapoints();
+    const int numberOfFeatures = featureBinding.GetNumberOfFeatures();
+    const int numberOfDatapoints = featureBinding.GetNumberOfDatapoints();
+
+    FeatureValueOrdering ordering = mOrdering;
+    if(mOrdering == AUTOMATIC_ORDERING)
+    {
+        ordering = SelectFeatureValueOrdering(numberOfFeatures, numberOfDatapoints, mPreferredOrdering);
+        VectorBufferTemplate<int>& orderingBuffer =
+                writeCollection.GetOrAddBuffer< VectorBufferTemplate<int> >(FeatureValueOrderingBufferId(FeatureValuesBufferId));
+        orderingBuffer.Resize(1);
+        orderingBuffer.Set(0, ordering);
+    }
 
-    typename FeatureType::Int m = (mOrdering == FEATURES_BY_DATAPOINTS) ? numberOfFeatures : numberOfDatapoints;
-    typename FeatureType::Int n = (mOrdering == FEATURES_BY_DATAPOINTS) ? numberOfDatapoints : numberOfFeatures;
+    const int m = (ordering == FEATURES_BY_DATAPOINTS) ? numberOfFeatures : numberOfDatapoints;
+    const int n = (ordering == FEATURES_BY_DATAPOINTS) ? numberOfDatapoints : numberOfFeatures;
 
-    MatrixBufferTemplate<typename FeatureType::Float>& featureValues =
-            writeCollection.GetOrAddBuffer< MatrixBufferTemplate<typename FeatureType::Float> >(FeatureValuesBufferId);
+    MatrixBufferTemplate<FloatType>& featureValues =
+            writeCollection.GetOrAddBuffer< MatrixBufferTemplate<FloatType> >(FeatureValuesBufferId);
     featureValues.Resize(m,n);
 
-    for(int s=0; s<numberOfDatapoints; s++)
+    for(int sampleStart=0; sampleStart<numberOfDatapoints; sampleStart+=SAMPLE_BLOCK_SIZE)
     {
-        for(int f=0; f<numberOfFeatures; f++)
+        const int sampleEnd = std::min(sampleStart + int(SAMPLE_BLOCK_SIZE), numberOfDatapoints);
+        for(int featureStart=0; featureStart<numberOfFeatures; featureStart+=FEATURE_BLOCK_SIZE)
         {
-            typename FeatureType::Float value = featureBinding.FeatureValue(f, s);
-            typename FeatureType::Int r = (mOrdering == FEATURES_BY_DATAPOINTS) ? f : s;
-            typename FeatureType::Int c = (mOrdering == FEATURES_BY_DATAPOINTS) ? s : f;
-            featureValues.Set(r,c, value);
+            const int featureEnd = std::min(featureStart + int(FEATURE_BLOCK_SIZE), numberOfFeatures);
+            if(ordering == FEATURES_BY_DATAPOINTS)
+            {
+                for(int f=featureStart; f<featureEnd; f++)
+                {
+                    FloatType* row = featureValues.GetRowPtrUnsafe(f);
+                    for(int s=sampleStart; s<sampleEnd; s++)
+                    {
+                        row[s] = featureBinding.FeatureValue(f, s);
+                    }
+                }
+            }
+            else
+            {
+                for(int s=sampleStart; s<sampleEnd; s++)
+                {
+                    FloatType* row = featureValues.GetRowPtrUnsafe(s);
+                    for(int f=featureStart; f<featureEnd; f++)
+                    {
+                        row[f] = featureBinding.FeatureValue(f, s);
+                    }
+                }
+            }
         }
     }
 }
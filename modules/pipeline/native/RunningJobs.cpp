@@ -0,0 +1,51 @@
+#include <algorithm>
+
+#if USE_BOOST_THREAD
+#include <boost/thread.hpp>
+#endif
+
+#include "RunningJobs.h"
+
+
+int globalNumberOfRunningJobs = 1;
+
+#if USE_BOOST_THREAD
+boost::mutex globalRunningJobsMutex;
+#endif
+
+void AddRunningJobs(int numberOfJobs)
+{
+#if USE_BOOST_THREAD
+    boost::mutex::scoped_lock lock(globalRunningJobsMutex);
+#endif
+    globalNumberOfRunningJobs += numberOfJobs;
+}
+
+void RemoveRunningJobs(int numberOfJobs)
+{
+#if USE_BOOST_THREAD
+    boost::mutex::scoped_lock lock(globalRunningJobsMutex);
+#endif
+    globalNumberOfRunningJobs -= numberOfJobs;
+}
+
+int GetNumberOfRunningJobs()
+{
+#if USE_BOOST_THREAD
+    boost::mutex::scoped_lock lock(globalRunningJobsMutex);
+#endif
+    return globalNumberOfRunningJobs;
+}
+
+int ReserveRunningJobs(int numberOfJobs)
+{
+#if USE_BOOST_THREAD
+    boost::mutex::scoped_lock lock(globalRunningJobsMutex);
+    const int numberOfCores = std::max(1, static_cast<int>(boost::thread::hardware_concurrency()));
+#else
+    const int numberOfCores = 1;
+#endif
+    const int reserved = std::max(0, std::min(numberOfJobs, numberOfCores - globalNumberOfRunningJobs));
+    globalNumberOfRunningJobs += reserved;
+    return reserved;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+//
+// Count of the jobs running in the nested parallel loops of a forest learner
+// (tree jobs, subtree jobs and sort jobs).  The calling thread counts as one
+// job.  A loop that starts jobs and waits for them adds the jobs it starts
+// beyond the waiting thread and removes them once they are joined.  Loops
+// that are only worth running in parallel while cores are idle (sort jobs)
+// reserve their jobs instead so the running jobs do not go past the number
+// of cores.
+//
+// ----------------------------------------------------------------------------
+
+void AddRunningJobs(int numberOfJobs);
+void RemoveRunningJobs(int numberOfJobs);
+int GetNumberOfRunningJobs();
+
+// Adds up to numberOfJobs jobs without going past the number of cores and
+// returns how many were added (removed again with RemoveRunningJobs)
+int ReserveRunningJobs(int numberOfJobs);
@@ -11,6 +11,7 @@
     #include "SetBufferStep.h"
     #include "SliceBufferStep.h"
     #include "FeatureExtractorStep.h"
+    #include "BatchedFeatureExtractorStep.h"
 %}
 
 %include <exception.i>
@@ -34,6 +35,7 @@ namespace std {
 %include "SetBufferStep.h"
 %include "SliceBufferStep.h"
 %include "FeatureExtractorStep.h"
+%include "BatchedFeatureExtractorStep.h"
 
 %template(AllSamplesStep_f32f32i32) AllSamplesStep< MatrixBufferTemplate<float>, float, int >;
 %template(AllSamplesStep_i32f32i32) AllSamplesStep< MatrixBufferTemplate<int>, float, int >;
@@ -9,7 +9,9 @@ template <class FloatType, class IntType>
 class TestFeatureBinding
 {
 public:
-    TestFeatureBinding()
+    TestFeatureBinding(IntType numberOfFeatures=3, IntType numberOfDatapoints=5)
+    : mNumberOfFeatures(numberOfFeatures)
+    , mNumberOfDatapoints(numberOfDatapoints)
     {}
     ~TestFeatureBinding()
     {}
@@ -21,13 +23,17 @@ public:
 
     IntType GetNumberOfFeatures() const
     {
-        return 3;
+        return mNumberOfFeatures;
     }
 
     IntType GetNumberOfDatapoints() const
     {
-        return 5;
+        return mNumberOfDatapoints;
     }
+
+private:
+    IntType mNumberOfFeatures;
+    IntType mNumberOfDatapoints;
 };
 
 
@@ -35,7 +41,9 @@ template <class FloatType, class IntType>
 class TestFeature
 {
 public:
-    TestFeature()
+    TestFeature(IntType numberOfFeatures=3, IntType numberOfDatapoints=5)
+    : mNumberOfFeatures(numberOfFeatures)
+    , mNumberOfDatapoints(numberOfDatapoints)
     {}
     ~TestFeature()
     {}
@@ -43,13 +51,17 @@ public:
     TestFeatureBinding<FloatType, IntType> Bind(const BufferCollectionStack& readCollection) const
     {
         UNUSED_PARAM(readCollection);
-        TestFeatureBinding<FloatType, IntType> result;
+        TestFeatureBinding<FloatType, IntType> result(mNumberOfFeatures, mNumberOfDatapoints);
         return result;
     }
 
     typedef FloatType Float;
     typedef IntType Int;
     typedef TestFeatureBinding<FloatType,IntType> FeatureBinding;
+
+private:
+    IntType mNumberOfFeatures;
+    IntType mNumberOfDatapoints;
 };
 
 BOOST_AUTO_TEST_SUITE( FeatureExtractorTests )
@@ -108,4 +120,92 @@ BOOST_AUTO_TEST_CASE(test_ProcessStep_datapoints_by_features)
     BOOST_CHECK(feature_values == expect_transpose_feature_values.Transpose());
 }
 
+BOOST_AUTO_TEST_CASE(test_ProcessStep_multiple_blocks)
+{
+    const int numberOfFeatures = 37;
+    const int numberOfDatapoints = 150;
+    TestFeature<double,int> test_feature(numberOfFeatures, numberOfDatapoints);
+    FeatureExtractorStep< TestFeature<double,int> > features_by_datapoints_extractor(test_feature, FEATURES_BY_DATAPOINTS);
+    FeatureExtractorStep< TestFeature<double,int> > datapoints_by_features_extractor(test_feature, DATAPOINTS_BY_FEATURES);
+
+    BufferCollection collection;
+    BufferCollectionStack stack;
+    boost::mt19937 gen(0);
+    features_by_datapoints_extractor.ProcessStep(stack, collection, gen);
+    datapoints_by_features_extractor.ProcessStep(stack, collection, gen);
+
+    const MatrixBufferTemplate<double>& features_by_datapoints =
+              collection.GetBuffer< MatrixBufferTemplate<double> >(features_by_datapoints_extractor.FeatureValuesBufferId);
+    const MatrixBufferTemplate<double>& datapoints_by_features =
+              collection.GetBuffer< MatrixBufferTemplate<double> >(datapoints_by_features_extractor.FeatureValuesBufferId);
+
+    BOOST_CHECK_EQUAL(features_by_datapoints.GetM(), numberOfFeatures);
+    BOOST_CHECK_EQUAL(features_by_datapoints.GetN(), numberOfDatapoints);
+    BOOST_CHECK_EQUAL(datapoints_by_features.GetM(), numberOfDatapoints);
+    BOOST_CHECK_EQUAL(datapoints_by_features.GetN(), numberOfFeatures);
+
+    for(int f=0; f<numberOfFeatures; f++)
+    {
+        for(int s=0; s<numberOfDatapoints; s++)
+        {
+            BOOST_CHECK_EQUAL(features_by_datapoints.Get(f, s), static_cast<double>(f * numberOfDatapoints + s));
+            BOOST_CHECK_EQUAL(datapoints_by_features.Get(s, f), static_cast<double>(f * numberOfDatapoints + s));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_automatic_ordering)
+{
+    TestFeature<double,int> small_feature(3, 5);
+    TestFeature<double,int> large_feature(37, 150);
+    FeatureExtractorStep< TestFeature<double,int> > small_extractor(small_feature, AUTOMATIC_ORDERING);
+    FeatureExtractorStep< TestFeature<double,int> > large_extractor(large_feature, AUTOMATIC_ORDERING);
+
+    BufferCollection collection;
+    BufferCollectionStack stack;
+    stack.Push(&collection);
+    boost::mt19937 gen(0);
+    small_extractor.ProcessStep(stack, collection, gen);
+    large_extractor.ProcessStep(stack, collection, gen);
+
+    BOOST_CHECK_EQUAL(ResolveFeatureValueOrdering(AUTOMATIC_ORDERING, stack, small_extractor.FeatureValuesBufferId), DATAPOINTS_BY_FEATURES);
+    BOOST_CHECK_EQUAL(ResolveFeatureValueOrdering(AUTOMATIC_ORDERING, stack, large_extractor.FeatureValuesBufferId), FEATURES_BY_DATAPOINTS);
+    BOOST_CHECK_EQUAL(ResolveFeatureValueOrdering(FEATURES_BY_DATAPOINTS, stack, small_extractor.FeatureValuesBufferId), FEATURES_BY_DATAPOINTS);
+
+    const MatrixBufferTemplate<double>& small_values =
+              collection.GetBuffer< MatrixBufferTemplate<double> >(small_extractor.FeatureValuesBufferId);
+    const MatrixBufferTemplate<double>& large_values =
+              collection.GetBuffer< MatrixBufferTemplate<double> >(large_extractor.FeatureValuesBufferId);
+    BOOST_CHECK_EQUAL(small_values.GetM(), 5);
+    BOOST_CHECK_EQUAL(small_values.GetN(), 3);
+    BOOST_CHECK_EQUAL(large_values.GetM(), 37);
+    BOOST_CHECK_EQUAL(large_values.GetN(), 150);
+}
+
+BOOST_AUTO_TEST_CASE(test_ProcessStep_automatic_ordering_preferred_by_consumer)
+{
+    TestFeature<double,int> small_feature(3, 5);
+    TestFeature<double,int> large_feature(37, 150);
+    FeatureExtractorStep< TestFeature<double,int> > small_extractor(small_feature, AUTOMATIC_ORDERING, FEATURES_BY_DATAPOINTS);
+    FeatureExtractorStep< TestFeature<double,int> > walker_extractor(large_feature, AUTOMATIC_ORDERING, FEATURES_BY_DATAPOINTS);
+    FeatureExtractorStep< TestFeature<double,int> > stats_extractor(large_feature, AUTOMATIC_ORDERING, DATAPOINTS_BY_FEATURES);
+
+    BufferCollection collection;
+    BufferCollectionStack stack;
+    stack.Push(&collection);
+    boost::mt19937 gen(0);
+    small_extractor.ProcessStep(stack, collection, gen);
+    walker_extractor.ProcessStep(stack, collection, gen);
+    stats_extractor.ProcessStep(stack, collection, gen);
+
+    BOOST_CHECK_EQUAL(ResolveFeatureValueOrdering(AUTOMATIC_ORDERING, stack, small_extractor.FeatureValuesBufferId), DATAPOINTS_BY_FEATURES);
+    BOOST_CHECK_EQUAL(ResolveFeatureValueOrdering(AUTOMATIC_ORDERING, stack, walker_extractor.FeatureValuesBufferId), FEATURES_BY_DATAPOINTS);
+    BOOST_CHECK_EQUAL(ResolveFeatureValueOrdering(AUTOMATIC_ORDERING, stack, stats_extractor.FeatureValuesBufferId), DATAPOINTS_BY_FEATURES);
+
+    const MatrixBufferTemplate<double>& stats_values =
+              collection.GetBuffer< MatrixBufferTemplate<double> >(stats_extractor.FeatureValuesBufferId);
+    BOOST_CHECK_EQUAL(stats_values.GetM(), 150);
+    BOOST_CHECK_EQUAL(stats_values.GetN(), 37);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+
+#if USE_BOOST_THREAD
+#include <boost/thread.hpp>
+#endif
+
+#include "RunningJobs.h"
+
+BOOST_AUTO_TEST_SUITE( RunningJobsTests )
+
+BOOST_AUTO_TEST_CASE(test_AddRunningJobs)
+{
+    const int numberOfRunningJobs = GetNumberOfRunningJobs();
+    AddRunningJobs(3);
+    BOOST_CHECK_EQUAL( GetNumberOfRunningJobs(), numberOfRunningJobs + 3 );
+    RemoveRunningJobs(3);
+    BOOST_CHECK_EQUAL( GetNumberOfRunningJobs(), numberOfRunningJobs );
+}
+
+BOOST_AUTO_TEST_CASE(test_ReserveRunningJobs_capped_by_cores)
+{
+#if USE_BOOST_THREAD
+    const int numberOfCores = std::max(1, static_cast<int>(boost::thread::hardware_concurrency()));
+#else
+    const int numberOfCores = 1;
+#endif
+    const int numberOfRunningJobs = GetNumberOfRunningJobs();
+    const int numberOfReservedJobs = ReserveRunningJobs(numberOfCores + 10);
+    BOOST_CHECK_EQUAL( numberOfReservedJobs, std::max(0, numberOfCores - numberOfRunningJobs) );
+    BOOST_CHECK_EQUAL( GetNumberOfRunningJobs(), std::max(numberOfCores, numberOfRunningJobs) );
+
+    // Nothing is left to reserve once all cores are running jobs
+    BOOST_CHECK_EQUAL( ReserveRunningJobs(1), 0 );
+    RemoveRunningJobs(numberOfReservedJobs);
+    BOOST_CHECK_EQUAL( GetNumberOfRunningJobs(), numberOfRunningJobs );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
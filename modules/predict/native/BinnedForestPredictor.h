@@ -0,0 +1,263 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+
+#include <asserts.h>
+#include <VectorBuffer.h>
+#include <MatrixBuffer.h>
+#include <Forest.h>
+#include <Constants.h>
+#include <LinearMatrixFeatureBinding.h>
+
+// Node record of a binned tree
+template <class IntType, class BinType>
+struct BinnedNode
+{
+    IntType mLeftChild;
+    IntType mRightChild;
+    IntType mBinnedColumn;
+    BinType mThresholdBin;
+};
+
+// ----------------------------------------------------------------------------
+//
+// BinnedForestPredictor predicts with an axis aligned forest (one dimension
+// per node with a positive weight, see AxisAlignedParamsStep) using integer
+// thresholds.  The thresholds of each dimension are gathered from the forest
+// into a sorted bin table and every node stores the id of its threshold in
+// that table.  Each row is binned once into BinType (uint8 or uint16) codes
+// and walking a tree only compares integers.  A dimension can not have more
+// thresholds than the largest value of BinType, the constructor throws
+// std::overflow_error otherwise (use a wider BinType).  Forests with other
+// splits throw std::invalid_argument.
+//
+// ----------------------------------------------------------------------------
+template <class Combiner, class FloatType, class IntType, class BinType>
+class BinnedForestPredictor
+{
+public:
+    BinnedForestPredictor( const ForestHandle& forest, const Combiner& combiner );
+
+    void BinRows(const MatrixBufferTemplate<FloatType>& xs, MatrixBufferTemplate<BinType>& binsOut) const;
+    void PredictLeafs(const MatrixBufferTemplate<FloatType>& xs, MatrixBufferTemplate<IntType>& leafsOut) const;
+    void PredictYs(const MatrixBufferTemplate<FloatType>& xs, MatrixBufferTemplate<FloatType>& ysOut) const;
+
+    IntType GetNumberOfBinnedDimensions() const;
+    IntType GetBinnedDimension(IntType binnedColumn) const;
+    IntType GetNumberOfThresholds(IntType binnedColumn) const;
+    ForestHandle GetForest() const;
+
+private:
+    IntType WalkTree(IntType treeId, const BinType* rowBins) const;
+
+    const ForestHandle mForest;
+    const Combiner mCombiner;
+    std::vector<IntType> mDimensions;
+    std::vector< std::vector<FloatType> > mThresholds;
+    std::vector< BinnedNode<IntType, BinType> > mNodes;
+    std::vector<IntType> mTreeOffsets;
+};
+
+template <class Combiner, class FloatType, class IntType, class BinType>
+BinnedForestPredictor<Combiner, FloatType, IntType, BinType>::BinnedForestPredictor( const ForestHandle& forest, const Combiner& combiner )
+: mForest(forest)
+, mCombiner(combiner)
+, mDimensions()
+, mThresholds()
+, mNodes()
+, mTreeOffsets()
+{
+    // Gather the thresholds of each dimension (in the space of the input
+    // column so the weight is folded into the threshold)
+    typedef std::map< IntType, std::vector<FloatType> > ThresholdsMap;
+    ThresholdsMap thresholdsOfDimension;
+    for(unsigned int treeId=0; treeId<mForest->mTrees.size(); treeId++)
+    {
+        const Tree& tree = mForest->mTrees[treeId];
+        for(int nodeId=0; nodeId<tree.mPath.GetM(); nodeId++)
+        {
+            if( tree.mPath.Get(nodeId, LEFT_CHILD) == NULL_CHILD )
+            {
+                continue;
+            }
+            // Checked in all builds because other forests would be binned on
+            // their first dimension and predict silently wrong
+            const IntType numberOfDimensions = tree.mIntFeatureParams.Get(nodeId, NUMBER_OF_DIMENSIONS_INDEX);
+            const FloatType weight = tree.mFloatFeatureParams.Get(nodeId, PARAM_START_INDEX);
+            if( numberOfDimensions != 1 || !(weight > FloatType(0)) )
+            {
+                std::stringstream ss;
+                ss << "BinnedForestPredictor: node " << nodeId << " of tree " << treeId
+                   << " is not axis aligned with a positive weight (" << numberOfDimensions
+                   << " dimensions, weight " << weight << ")";
+                throw std::invalid_argument(ss.str());
+            }
+            const IntType dimension = tree.mIntFeatureParams.Get(nodeId, PARAM_START_INDEX);
+            const FloatType threshold = tree.mFloatFeatureParams.Get(nodeId, SPLIT_POINT_INDEX) / weight;
+            thresholdsOfDimension[dimension].push_back(threshold);
+        }
+    }
+
+    std::map<IntType, IntType> binnedColumnOfDimension;
+    for(typename ThresholdsMap::iterator it=thresholdsOfDimension.begin(); it!=thresholdsOfDimension.end(); ++it)
+    {
+        std::vector<FloatType>& thresholds = it->second;
+        std::sort(thresholds.begin(), thresholds.end());
+        thresholds.erase(std::unique(thresholds.begin(), thresholds.end()), thresholds.end());
+        // Checked in all builds because the codes would silently wrap
+        if( thresholds.size() > static_cast<size_t>(std::numeric_limits<BinType>::max()) )
+        {
+            std::stringstream ss;
+            ss << "BinnedForestPredictor: dimension " << it->first << " has "
+               << thresholds.size() << " thresholds which do not fit in a bin type with maximum "
+               << static_cast<unsigned int>(std::numeric_limits<BinType>::max());
+            throw std::overflow_error(ss.str());
+        }
+
+        binnedColumnOfDimension[it->first] = mDimensions.size();
+        mDimensions.push_back(it->first);
+        mThresholds.push_back(thresholds);
+    }
+
+    // Node records indexed like the nodes of the tree so leaf ids can be
+    // passed to the combiner unchanged
+    for(unsigned int treeId=0; treeId<mForest->mTrees.size(); treeId++)
+    {
+        const Tree& tree = mForest->mTrees[treeId];
+        mTreeOffsets.push_back(mNodes.size());
+        for(int nodeId=0; nodeId<tree.mPath.GetM(); nodeId++)
+        {
+            BinnedNode<IntType, BinType> node;
+            node.mLeftChild = tree.mPath.Get(nodeId, LEFT_CHILD);
+            node.mRightChild = tree.mPath.Get(nodeId, RIGHT_CHILD);
+            node.mBinnedColumn = 0;
+            node.mThresholdBin = 0;
+            if( node.mLeftChild != NULL_CHILD )
+            {
+                const IntType dimension = tree.mIntFeatureParams.Get(nodeId, PARAM_START_INDEX);
+                const FloatType threshold = tree.mFloatFeatureParams.Get(nodeId, SPLIT_POINT_INDEX)
+                                            / tree.mFloatFeatureParams.Get(nodeId, PARAM_START_INDEX);
+                node.mBinnedColumn = binnedColumnOfDimension[dimension];
+                const std::vector<FloatType>& thresholds = mThresholds[node.mBinnedColumn];
+                node.mThresholdBin = static_cast<BinType>(
+                        std::lower_bound(thresholds.begin(), thresholds.end(), threshold) - thresholds.begin());
+            }
+            mNodes.push_back(node);
+        }
+    }
+}
+
+// The code of a value is the number of thresholds below it so
+// value > thresholds[bin] if and only if code > bin
+template <class Combiner, class FloatType, class IntType, class BinType>
+void BinnedForestPredictor<Combiner, FloatType, IntType, BinType>::BinRows( const MatrixBufferTemplate<FloatType>& xs,
+                                                                            MatrixBufferTemplate<BinType>& binsOut ) const
+{
+    const IntType numberOfBinnedDimensions = mDimensions.size();
+    binsOut.Resize(xs.GetM(), numberOfBinnedDimensions);
+    for(IntType column=0; column<numberOfBinnedDimensions; column++)
+    {
+        ASSERT_VALID_RANGE(mDimensions[column], 0, xs.GetN())
+        const std::vector<FloatType>& thresholds = mThresholds[column];
+        for(IntType row=0; row<xs.GetM(); row++)
+        {
+            const FloatType value = xs.GetUnsafe(row, mDimensions[column]);
+            const BinType code = static_cast<BinType>(
+                    std::lower_bound(thresholds.begin(), thresholds.end(), value) - thresholds.begin());
+            binsOut.SetUnsafe(row, column, code);
+        }
+    }
+}
+
+template <class Combiner, class FloatType, class IntType, class BinType>
+IntType BinnedForestPredictor<Combiner, FloatType, IntType, BinType>::WalkTree( IntType treeId, const BinType* rowBins ) const
+{
+    const BinnedNode<IntType, BinType>* nodes = &mNodes[mTreeOffsets[treeId]];
+    IntType nodeId = 0;
+    while( nodes[nodeId].mLeftChild != NULL_CHILD )
+    {
+        const BinnedNode<IntType, BinType>& node = nodes[nodeId];
+        const IntType childNodeId = (rowBins[node.mBinnedColumn] > node.mThresholdBin) ? node.mLeftChild : node.mRightChild;
+        if( childNodeId == NULL_CHILD )
+        {
+            break;
+        }
+        nodeId = childNodeId;
+    }
+    return nodeId;
+}
+
+template <class Combiner, class FloatType, class IntType, class BinType>
+void BinnedForestPredictor<Combiner, FloatType, IntType, BinType>::PredictLeafs( const MatrixBufferTemplate<FloatType>& xs,
+                                                                                 MatrixBufferTemplate<IntType>& leafsOut ) const
+{
+    MatrixBufferTemplate<BinType> bins;
+    BinRows(xs, bins);
+
+    const IntType numberOfTreesInForest = mForest->mTrees.size();
+    leafsOut.Resize(xs.GetM(), numberOfTreesInForest);
+    for(IntType i=0; i<xs.GetM(); i++)
+    {
+        const BinType* rowBins = bins.GetRowPtrUnsafe(i);
+        for(IntType treeId=0; treeId<numberOfTreesInForest; treeId++)
+        {
+            leafsOut.Set(i, treeId, WalkTree(treeId, rowBins));
+        }
+    }
+}
+
+template <class Combiner, class FloatType, class IntType, class BinType>
+void BinnedForestPredictor<Combiner, FloatType, IntType, BinType>::PredictYs( const MatrixBufferTemplate<FloatType>& xs,
+                                                                              MatrixBufferTemplate<FloatType>& ysOut ) const
+{
+    MatrixBufferTemplate<BinType> bins;
+    BinRows(xs, bins);
+
+    const Forest& forest = *mForest;
+    const IntType numberOfTreesInForest = forest.mTrees.size();
+    ysOut.Resize(xs.GetM(), mCombiner.GetResultDim());
+
+    // Make a local non-const combiner so its accumulator is per call
+    Combiner combiner = mCombiner;
+    for(IntType i=0; i<xs.GetM(); i++)
+    {
+        const BinType* rowBins = bins.GetRowPtrUnsafe(i);
+        combiner.Reset();
+        for(IntType treeId=0; treeId<numberOfTreesInForest; treeId++)
+        {
+            combiner.Combine(WalkTree(treeId, rowBins), forest.mTrees[treeId]);
+        }
+        combiner.WriteResult(i, ysOut);
+    }
+}
+
+template <class Combiner, class FloatType, class IntType, class BinType>
+IntType BinnedForestPredictor<Combiner, FloatType, IntType, BinType>::GetNumberOfBinnedDimensions() const
+{
+    return mDimensions.size();
+}
+
+template <class Combiner, class FloatType, class IntType, class BinType>
+IntType BinnedForestPredictor<Combiner, FloatType, IntType, BinType>::GetBinnedDimension(IntType binnedColumn) const
+{
+    ASSERT_VALID_RANGE(binnedColumn, 0, static_cast<IntType>(mDimensions.size()))
+    return mDimensions[binnedColumn];
+}
+
+template <class Combiner, class FloatType, class IntType, class BinType>
+IntType BinnedForestPredictor<Combiner, FloatType, IntType, BinType>::GetNumberOfThresholds(IntType binnedColumn) const
+{
+    ASSERT_VALID_RANGE(binnedColumn, 0, static_cast<IntType>(mThresholds.size()))
+    return mThresholds[binnedColumn].size();
+}
+
+template <class Combiner, class FloatType, class IntType, class BinType>
+ForestHandle BinnedForestPredictor<Combiner, FloatType, IntType, BinType>::GetForest() const
+{
+    return mForest;
+}
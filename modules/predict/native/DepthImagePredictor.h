@@ -0,0 +1,319 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#if USE_BOOST_THREAD
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#endif
+
+#include <asserts.h>
+#include <MatrixBuffer.h>
+#include <Tensor3Buffer.h>
+#include <Forest.h>
+#include <Constants.h>
+#include <ImageUtils.h>
+
+// Node record of a depth delta tree
+template <class FloatType, class IntType>
+struct DepthDeltaNode
+{
+    FloatType mSplitpoint;
+    FloatType mUm;
+    FloatType mUn;
+    FloatType mVm;
+    FloatType mVn;
+    IntType mLeftChild;
+    IntType mRightChild;
+};
+
+// ----------------------------------------------------------------------------
+//
+// DepthImagePredictor predicts every pixel (or every pixel of a mask) of a
+// depth image with a ScaledDepthDeltaFeature forest.  It gives the same
+// result as TemplateForestPredictor with a pixel index for each pixel but
+// works on tiles of the image.  Offset scales (OFFSET_SCALES) are given per
+// image as a row (scaleM, scaleN) for each image, all pixels of an image
+// share them.  Scales that change within an image need
+// TemplateForestPredictor.  The offsets of each node are flattened into
+// node records, 2/depth is computed once per pixel and the pixels of a tile
+// are walked down one tree at a time so the image tile and the tree stay in
+// cache.  Tiles are split between threads.  The probability of each class is
+// written to an image of ysOut (class, m, n).
+//
+// ----------------------------------------------------------------------------
+template <class Combiner, class FloatType, class IntType>
+class DepthImagePredictor
+{
+public:
+    DepthImagePredictor( const ForestHandle& forest, const Combiner& combiner, IntType tileSize, IntType numberOfThreads );
+
+    void PredictYs( const Tensor3BufferTemplate<FloatType>& depthImgs,
+                    IntType imgIndex,
+                    Tensor3BufferTemplate<FloatType>& ysOut ) const;
+    void PredictYs( const Tensor3BufferTemplate<FloatType>& depthImgs,
+                    const MatrixBufferTemplate<FloatType>& offsetScales,
+                    IntType imgIndex,
+                    Tensor3BufferTemplate<FloatType>& ysOut ) const;
+    void PredictYsMasked( const Tensor3BufferTemplate<FloatType>& depthImgs,
+                          IntType imgIndex,
+                          const MatrixBufferTemplate<IntType>& mask,
+                          Tensor3BufferTemplate<FloatType>& ysOut ) const;
+    void PredictYsMasked( const Tensor3BufferTemplate<FloatType>& depthImgs,
+                          const MatrixBufferTemplate<FloatType>& offsetScales,
+                          IntType imgIndex,
+                          const MatrixBufferTemplate<IntType>& mask,
+                          Tensor3BufferTemplate<FloatType>& ysOut ) const;
+
+    ForestHandle GetForest() const;
+
+private:
+    void PredictImage( const Tensor3BufferTemplate<FloatType>& depthImgs,
+                       const MatrixBufferTemplate<FloatType>* offsetScales,
+                       IntType imgIndex,
+                       const MatrixBufferTemplate<IntType>* mask,
+                       Tensor3BufferTemplate<FloatType>& ysOut ) const;
+    void PredictTiles( const Tensor3BufferTemplate<FloatType>* depthImgs,
+                       const MatrixBufferTemplate<FloatType>* offsetScales,
+                       IntType imgIndex,
+                       const MatrixBufferTemplate<IntType>* mask,
+                       IntType firstTile,
+                       IntType tileStride,
+                       Tensor3BufferTemplate<FloatType>* ysOut ) const;
+    IntType WalkTree( IntType treeId, const FloatType* depthImg, IntType numberOfRows, IntType numberOfColumns,
+                      IntType m, IntType n, FloatType scaleByDepth, FloatType scaleM, FloatType scaleN ) const;
+
+    const ForestHandle mForest;
+    const Combiner mCombiner;
+    const IntType mTileSize;
+    const IntType mNumberOfThreads;
+    std::vector< DepthDeltaNode<FloatType, IntType> > mNodes;
+    std::vector<IntType> mTreeOffsets;
+};
+
+template <class Combiner, class FloatType, class IntType>
+DepthImagePredictor<Combiner, FloatType, IntType>::DepthImagePredictor( const ForestHandle& forest,
+                                                                         const Combiner& combiner,
+                                                                         IntType tileSize,
+                                                                         IntType numberOfThreads )
+: mForest(forest)
+, mCombiner(combiner)
+, mTileSize(tileSize)
+, mNumberOfThreads(numberOfThreads)
+, mNodes()
+, mTreeOffsets()
+{
+    ASSERT(mTileSize > 0);
+    ASSERT(mNumberOfThreads > 0);
+    for(unsigned int treeId=0; treeId<mForest->mTrees.size(); treeId++)
+    {
+        const Tree& tree = mForest->mTrees[treeId];
+        mTreeOffsets.push_back(mNodes.size());
+        for(int nodeId=0; nodeId<tree.mPath.GetM(); nodeId++)
+        {
+            DepthDeltaNode<FloatType, IntType> node;
+            node.mSplitpoint = tree.mFloatFeatureParams.Get(nodeId, SPLIT_POINT_INDEX);
+            node.mUm = tree.mFloatFeatureParams.Get(nodeId, FEATURE_SPECIFIC_PARAMS_START);
+            node.mUn = tree.mFloatFeatureParams.Get(nodeId, FEATURE_SPECIFIC_PARAMS_START+1);
+            node.mVm = tree.mFloatFeatureParams.Get(nodeId, FEATURE_SPECIFIC_PARAMS_START+2);
+            node.mVn = tree.mFloatFeatureParams.Get(nodeId, FEATURE_SPECIFIC_PARAMS_START+3);
+            node.mLeftChild = tree.mPath.Get(nodeId, LEFT_CHILD);
+            node.mRightChild = tree.mPath.Get(nodeId, RIGHT_CHILD);
+            mNodes.push_back(node);
+        }
+    }
+}
+
+template <class Combiner, class FloatType, class IntType>
+void DepthImagePredictor<Combiner, FloatType, IntType>::PredictYs( const Tensor3BufferTemplate<FloatType>& depthImgs,
+                                                                   IntType imgIndex,
+                                                                   Tensor3BufferTemplate<FloatType>& ysOut ) const
+{
+    PredictImage(depthImgs, NULL, imgIndex, NULL, ysOut);
+}
+
+template <class Combiner, class FloatType, class IntType>
+void DepthImagePredictor<Combiner, FloatType, IntType>::PredictYs( const Tensor3BufferTemplate<FloatType>& depthImgs,
+                                                                   const MatrixBufferTemplate<FloatType>& offsetScales,
+                                                                   IntType imgIndex,
+                                                                   Tensor3BufferTemplate<FloatType>& ysOut ) const
+{
+    PredictImage(depthImgs, &offsetScales, imgIndex, NULL, ysOut);
+}
+
+template <class Combiner, class FloatType, class IntType>
+void DepthImagePredictor<Combiner, FloatType, IntType>::PredictYsMasked( const Tensor3BufferTemplate<FloatType>& depthImgs,
+                                                                         IntType imgIndex,
+                                                                         const MatrixBufferTemplate<IntType>& mask,
+                                                                         Tensor3BufferTemplate<FloatType>& ysOut ) const
+{
+    ASSERT_ARG_DIM_2D(mask.GetM(), mask.GetN(), depthImgs.GetM(), depthImgs.GetN())
+    PredictImage(depthImgs, NULL, imgIndex, &mask, ysOut);
+}
+
+template <class Combiner, class FloatType, class IntType>
+void DepthImagePredictor<Combiner, FloatType, IntType>::PredictYsMasked( const Tensor3BufferTemplate<FloatType>& depthImgs,
+                                                                         const MatrixBufferTemplate<FloatType>& offsetScales,
+                                                                         IntType imgIndex,
+                                                                         const MatrixBufferTemplate<IntType>& mask,
+                                                                         Tensor3BufferTemplate<FloatType>& ysOut ) const
+{
+    ASSERT_ARG_DIM_2D(mask.GetM(), mask.GetN(), depthImgs.GetM(), depthImgs.GetN())
+    PredictImage(depthImgs, &offsetScales, imgIndex, &mask, ysOut);
+}
+
+template <class Combiner, class FloatType, class IntType>
+void DepthImagePredictor<Combiner, FloatType, IntType>::PredictImage( const Tensor3BufferTemplate<FloatType>& depthImgs,
+                                                                      const MatrixBufferTemplate<FloatType>* offsetScales,
+                                                                      IntType imgIndex,
+                                                                      const MatrixBufferTemplate<IntType>* mask,
+                                                                      Tensor3BufferTemplate<FloatType>& ysOut ) const
+{
+    ASSERT_VALID_RANGE(imgIndex, 0, depthImgs.GetL())
+    ysOut.Resize(mCombiner.GetResultDim(), depthImgs.GetM(), depthImgs.GetN());
+
+    if( offsetScales != NULL )
+    {
+        ASSERT_ARG_DIM_2D(offsetScales->GetM(), offsetScales->GetN(), depthImgs.GetL(), 2)
+    }
+
+#if USE_BOOST_THREAD
+    std::vector< boost::shared_ptr< boost::thread > > threadVec;
+    for(IntType job=0; job<mNumberOfThreads; job++)
+    {
+        threadVec.push_back( boost::make_shared<boost::thread>(&DepthImagePredictor<Combiner, FloatType, IntType>::PredictTiles,
+                                                               this, &depthImgs, offsetScales, imgIndex, mask, job, mNumberOfThreads, &ysOut) );
+    }
+    for(IntType job=0; job<mNumberOfThreads; job++)
+    {
+        threadVec[job]->join();
+    }
+#else
+    PredictTiles(&depthImgs, offsetScales, imgIndex, mask, 0, 1, &ysOut);
+#endif
+}
+
+template <class Combiner, class FloatType, class IntType>
+void DepthImagePredictor<Combiner, FloatType, IntType>::PredictTiles( const Tensor3BufferTemplate<FloatType>* depthImgs,
+                                                                      const MatrixBufferTemplate<FloatType>* offsetScales,
+                                                                      IntType imgIndex,
+                                                                      const MatrixBufferTemplate<IntType>* mask,
+                                                                      IntType firstTile,
+                                                                      IntType tileStride,
+                                                                      Tensor3BufferTemplate<FloatType>* ysOut ) const
+{
+    const Forest& forest = *mForest;
+    const IntType numberOfTreesInForest = forest.mTrees.size();
+    const IntType numberOfRows = depthImgs->GetM();
+    const IntType numberOfColumns = depthImgs->GetN();
+    const IntType numberOfTileRows = (numberOfRows + mTileSize - 1) / mTileSize;
+    const IntType numberOfTileColumns = (numberOfColumns + mTileSize - 1) / mTileSize;
+    const FloatType* depthImg = depthImgs->GetRowPtrUnsafe(imgIndex, 0);
+    const FloatType scaleM = (offsetScales != NULL) ? offsetScales->Get(imgIndex, 0) : FloatType(1.0);
+    const FloatType scaleN = (offsetScales != NULL) ? offsetScales->Get(imgIndex, 1) : FloatType(1.0);
+
+    // Per tile working state is local so each thread has its own
+    const IntType maxPixelsPerTile = mTileSize * mTileSize;
+    std::vector<FloatType> scaleByDepth(maxPixelsPerTile);
+    std::vector<IntType> isActive(maxPixelsPerTile);
+    std::vector<IntType> leafs(maxPixelsPerTile * numberOfTreesInForest);
+    MatrixBufferTemplate<FloatType> tileYs(maxPixelsPerTile, mCombiner.GetResultDim());
+    Combiner combiner = mCombiner;
+
+    for(IntType tile=firstTile; tile<numberOfTileRows*numberOfTileColumns; tile+=tileStride)
+    {
+        const IntType startM = (tile / numberOfTileColumns) * mTileSize;
+        const IntType startN = (tile % numberOfTileColumns) * mTileSize;
+        const IntType endM = std::min(startM + mTileSize, numberOfRows);
+        const IntType endN = std::min(startN + mTileSize, numberOfColumns);
+        const IntType tileColumns = endN - startN;
+        const IntType numberOfPixels = (endM - startM) * tileColumns;
+
+        for(IntType p=0; p<numberOfPixels; p++)
+        {
+            const IntType m = startM + p / tileColumns;
+            const IntType n = startN + p % tileColumns;
+            isActive[p] = (mask == NULL || mask->GetUnsafe(m, n) != 0) ? 1 : 0;
+            scaleByDepth[p] = isActive[p] ? FloatType(2.0) / depthImg[m*numberOfColumns + n] : FloatType(0);
+        }
+
+        for(IntType treeId=0; treeId<numberOfTreesInForest; treeId++)
+        {
+            for(IntType p=0; p<numberOfPixels; p++)
+            {
+                if( isActive[p] )
+                {
+                    const IntType m = startM + p / tileColumns;
+                    const IntType n = startN + p % tileColumns;
+                    leafs[p*numberOfTreesInForest + treeId] = WalkTree(treeId, depthImg, numberOfRows, numberOfColumns,
+                                                                       m, n, scaleByDepth[p], scaleM, scaleN);
+                }
+            }
+        }
+
+        for(IntType p=0; p<numberOfPixels; p++)
+        {
+            combiner.Reset();
+            if( isActive[p] )
+            {
+                for(IntType treeId=0; treeId<numberOfTreesInForest; treeId++)
+                {
+                    combiner.Combine(leafs[p*numberOfTreesInForest + treeId], forest.mTrees[treeId]);
+                }
+            }
+            combiner.WriteResult(p, tileYs);
+
+            const IntType m = startM + p / tileColumns;
+            const IntType n = startN + p % tileColumns;
+            for(IntType c=0; c<tileYs.GetN(); c++)
+            {
+                ysOut->SetUnsafe(c, m, n, tileYs.GetUnsafe(p, c));
+            }
+        }
+    }
+}
+
+// Same walk as walkTree with ScaledDepthDeltaFeatureBinding.  The offsets are
+// scaled before they are multiplied by 2/depth as in the binding so the
+// probes match exactly.
+template <class Combiner, class FloatType, class IntType>
+IntType DepthImagePredictor<Combiner, FloatType, IntType>::WalkTree( IntType treeId,
+                                                                     const FloatType* depthImg,
+                                                                     IntType numberOfRows,
+                                                                     IntType numberOfColumns,
+                                                                     IntType m,
+                                                                     IntType n,
+                                                                     FloatType scaleByDepth,
+                                                                     FloatType scaleM,
+                                                                     FloatType scaleN ) const
+{
+    const DepthDeltaNode<FloatType, IntType>* nodes = &mNodes[mTreeOffsets[treeId]];
+    IntType nodeId = 0;
+    while( nodes[nodeId].mLeftChild != NULL_CHILD || nodes[nodeId].mRightChild != NULL_CHILD )
+    {
+        const DepthDeltaNode<FloatType, IntType>& node = nodes[nodeId];
+        IntType mU = m + IntType(scaleByDepth * (node.mUm * scaleM));
+        IntType nU = n + IntType(scaleByDepth * (node.mUn * scaleN));
+        IntType mV = m + IntType(scaleByDepth * (node.mVm * scaleM));
+        IntType nV = n + IntType(scaleByDepth * (node.mVn * scaleN));
+        ClampPixel<IntType>(numberOfRows, numberOfColumns, &mU, &nU);
+        ClampPixel<IntType>(numberOfRows, numberOfColumns, &mV, &nV);
+
+        const FloatType delta = depthImg[mU*numberOfColumns + nU] - depthImg[mV*numberOfColumns + nV];
+        const IntType childNodeId = (delta > node.mSplitpoint) ? node.mLeftChild : node.mRightChild;
+        if( childNodeId == NULL_CHILD )
+        {
+            break;
+        }
+        nodeId = childNodeId;
+    }
+    return nodeId;
+}
+
+template <class Combiner, class FloatType, class IntType>
+ForestHandle DepthImagePredictor<Combiner, FloatType, IntType>::GetForest() const
+{
+    return mForest;
+}
@@ -35,27 +35,44 @@ IntType walkTree( const FeatureBinding& feature,
 }
 
 
+// ----------------------------------------------------------------------------
+//
+// TemplateForestPredictor walks each datapoint down every tree of a forest and
+// combines the leaf estimators.  Prediction is const and keeps all of its
+// working state (feature bindings, combiner accumulator) local to the call so
+// a single predictor can be used from many threads at once.  The forest is
+// held by a ForestHandle so many predictors can share one immutable forest.
+//
+// ----------------------------------------------------------------------------
 template <class Feature, class Combiner, class FloatType, class IntType>
 class TemplateForestPredictor
 {
 public:
-    TemplateForestPredictor( const Forest& forest, const Feature& feature, const Combiner& combiner, const PipelineStepI* preSteps );
+    TemplateForestPredictor( const ForestHandle& forest, const Feature& feature, const Combiner& combiner, const PipelineStepI* preSteps );
     ~TemplateForestPredictor();
 
     void PredictLeafs(const BufferCollection& data, MatrixBufferTemplate<IntType>& leafsOut) const;
-    void PredictYs(const BufferCollection& data, MatrixBufferTemplate<FloatType>& ysOut);
+    void PredictYs(const BufferCollection& data, MatrixBufferTemplate<FloatType>& ysOut) const;
 
-    Forest GetForest() const;
+    ForestHandle GetForest() const;
 
 private:
-    const Forest mForest;
-    Feature mFeature;
-    Combiner mCombiner;
+    TemplateForestPredictor( const TemplateForestPredictor& other );
+    TemplateForestPredictor& operator=( const TemplateForestPredictor& rhs );
+
+    void BindFeatures( BufferCollectionStack& stack,
+                       BufferCollection& preStepsBufferCollection,
+                       BufferCollection* perTreeBufferCollection,
+                       std::vector<typename Feature::FeatureBinding>& featureBindings ) const;
+
+    const ForestHandle mForest;
+    const Feature mFeature;
+    const Combiner mCombiner;
     const PipelineStepI* mPreSteps;
 };
 
 template <class Feature, class Combiner, class FloatType, class IntType>
-TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::TemplateForestPredictor( const Forest& forest, const Feature& feature, const Combiner& combiner, const PipelineStepI* preSteps )
+TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::TemplateForestPredictor( const ForestHandle& forest, const Feature& feature, const Combiner& combiner, const PipelineStepI* preSteps )
 : mForest(forest)
 , mFeature(feature)
 , mCombiner(combiner)
@@ -69,29 +86,46 @@ TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::~TemplateForestP
 }
 
 template <class Feature, class Combiner, class FloatType, class IntType>
-void TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::PredictLeafs( const BufferCollection& data,
-                                                                                  MatrixBufferTemplate<IntType>& leafsOut) const
+void TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::BindFeatures( BufferCollectionStack& stack,
+                                                                                  BufferCollection& preStepsBufferCollection,
+                                                                                  BufferCollection* perTreeBufferCollection,
+                                                                                  std::vector<typename Feature::FeatureBinding>& featureBindings ) const
 {
     boost::mt19937 gen;
     gen.seed(0);
 
-    const int numberOfTreesInForest = mForest.mTrees.size();
-    BufferCollectionStack stack;
-    stack.Push(&data);
+    // The pre steps do not depend on the tree so they run once per call and
+    // their outputs (indices, tiled or integral images) are shared by all
+    // trees
+    mPreSteps->ProcessStep(stack, preStepsBufferCollection, gen);
+    stack.Push(&preStepsBufferCollection);
 
-    BufferCollection* perTreeBufferCollection = new BufferCollection[numberOfTreesInForest];
-    std::vector<typename Feature::FeatureBinding> featureBindings(numberOfTreesInForest);
-    for(int treeId=0; treeId<numberOfTreesInForest; treeId++)
+    const Forest& forest = *mForest;
+    for(unsigned int treeId=0; treeId<featureBindings.size(); treeId++)
     {
         BufferCollection& bc = perTreeBufferCollection[treeId];
-        bc.AddBuffer< MatrixBufferTemplate<FloatType> >(mFeature.mFloatParamsBufferId, mForest.mTrees[treeId].mFloatFeatureParams);
-        bc.AddBuffer< MatrixBufferTemplate<IntType> >(mFeature.mIntParamsBufferId, mForest.mTrees[treeId].mIntFeatureParams);
-        mPreSteps->ProcessStep(stack, bc, gen);
+        bc.AddBuffer< MatrixBufferTemplate<FloatType> >(mFeature.mFloatParamsBufferId, forest.mTrees[treeId].mFloatFeatureParams);
+        bc.AddBuffer< MatrixBufferTemplate<IntType> >(mFeature.mIntParamsBufferId, forest.mTrees[treeId].mIntFeatureParams);
 
         stack.Push(&bc);
         featureBindings[treeId] = mFeature.Bind(stack);
         stack.Pop();
     }
+}
+
+template <class Feature, class Combiner, class FloatType, class IntType>
+void TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::PredictLeafs( const BufferCollection& data,
+                                                                                  MatrixBufferTemplate<IntType>& leafsOut) const
+{
+    const Forest& forest = *mForest;
+    const int numberOfTreesInForest = forest.mTrees.size();
+    BufferCollectionStack stack;
+    stack.Push(&data);
+
+    BufferCollection preStepsBufferCollection;
+    BufferCollection* perTreeBufferCollection = new BufferCollection[numberOfTreesInForest];
+    std::vector<typename Feature::FeatureBinding> featureBindings(numberOfTreesInForest);
+    BindFeatures(stack, preStepsBufferCollection, perTreeBufferCollection, featureBindings);
 
     const int numberOfIndices = featureBindings[0].GetNumberOfDatapoints();
     leafsOut.Resize(numberOfIndices, numberOfTreesInForest);
@@ -101,7 +135,7 @@ void TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::PredictLeaf
         for(IntType treeId=0; treeId<numberOfTreesInForest; treeId++)
         {
             IntType leafNodeId = walkTree<typename Feature::FeatureBinding, FloatType, IntType>(
-                                          featureBindings[treeId], mForest.mTrees[treeId], 0, i);
+                                          featureBindings[treeId], forest.mTrees[treeId], 0, i);
             leafsOut.Set(i, treeId, leafNodeId);
         }
     }
@@ -111,49 +145,40 @@ void TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::PredictLeaf
 
 template <class Feature, class Combiner, class FloatType, class IntType>
 void TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::PredictYs( const BufferCollection& data,
-                                                                              MatrixBufferTemplate<FloatType>& ysOut)
+                                                                              MatrixBufferTemplate<FloatType>& ysOut) const
 {
-    boost::mt19937 gen;
-    gen.seed(0);
-
-    const int numberOfTreesInForest = mForest.mTrees.size();
+    const Forest& forest = *mForest;
+    const int numberOfTreesInForest = forest.mTrees.size();
     BufferCollectionStack stack;
     stack.Push(&data);
 
+    BufferCollection preStepsBufferCollection;
     BufferCollection* perTreeBufferCollection = new BufferCollection[numberOfTreesInForest];
     std::vector<typename Feature::FeatureBinding> featureBindings(numberOfTreesInForest);
-    for(int treeId=0; treeId<numberOfTreesInForest; treeId++)
-    {
-        BufferCollection& bc = perTreeBufferCollection[treeId];
-        bc.AddBuffer< MatrixBufferTemplate<FloatType> >(mFeature.mFloatParamsBufferId, mForest.mTrees[treeId].mFloatFeatureParams);
-        bc.AddBuffer< MatrixBufferTemplate<IntType> >(mFeature.mIntParamsBufferId, mForest.mTrees[treeId].mIntFeatureParams);
-        mPreSteps->ProcessStep(stack, bc, gen);
-
-        stack.Push(&bc);
-        featureBindings[treeId] = mFeature.Bind(stack);
-        stack.Pop();
-    }
+    BindFeatures(stack, preStepsBufferCollection, perTreeBufferCollection, featureBindings);
 
     const int numberOfIndices = featureBindings[0].GetNumberOfDatapoints();
     ysOut.Resize(numberOfIndices, mCombiner.GetResultDim());
 
+    // Make a local non-const combiner so its accumulator is per call
+    Combiner combiner = mCombiner;
     for(IntType i=0; i<numberOfIndices; i++)
     {
-        mCombiner.Reset();
+        combiner.Reset();
         for(IntType treeId=0; treeId<numberOfTreesInForest; treeId++)
         {
             IntType leafNodeId = walkTree<typename Feature::FeatureBinding, FloatType, IntType>(
-                                        featureBindings[treeId], mForest.mTrees[treeId], 0, i);
-            mCombiner.Combine(leafNodeId, mForest.mTrees[treeId].mYs);
+                                        featureBindings[treeId], forest.mTrees[treeId], 0, i);
+            combiner.Combine(leafNodeId, forest.mTrees[treeId]);
         }
-        mCombiner.WriteResult(i, ysOut);
+        combiner.WriteResult(i, ysOut);
     }
 
     delete[] perTreeBufferCollection;
 }
 
 template <class Feature, class Combiner, class FloatType, class IntType>
-Forest TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::GetForest() const
+ForestHandle TemplateForestPredictor<Feature, Combiner, FloatType, IntType>::GetForest() const
 {
     return mForest;
 }
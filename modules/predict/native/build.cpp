@@ -1 +1,3 @@
-#include "ForestPredictor.h"
\ No newline at end of file
+#include "ForestPredictor.h"
+#include "BinnedForestPredictor.h"
+#include "DepthImagePredictor.h"
\ No newline at end of file
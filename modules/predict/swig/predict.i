@@ -2,6 +2,8 @@
 %{
     #define SWIG_FILE_WITH_INIT
     #include "ForestPredictor.h"
+    #include "BinnedForestPredictor.h"
+    #include "DepthImagePredictor.h"
 %}
 
 %include <exception.i>
@@ -18,6 +20,20 @@
 %include <classification.i>
 
 %include "ForestPredictor.h"
+%include "BinnedForestPredictor.h"
+%include "DepthImagePredictor.h"
 
 %template(LinearMatrixClassificationPredictin_f32i32) TemplateForestPredictor< LinearMatrixFeature< MatrixBufferTemplate<float>, float, int >, ClassProbabilityCombiner<float>, float, int>;
-%template(ScaledDepthDeltaClassificationPredictin_f32i32) TemplateForestPredictor< ScaledDepthDeltaFeature< float, int >, ClassProbabilityCombiner<float>, float, int>;
\ No newline at end of file
+%template(AxisAlignedMatrixClassificationPredictin_f32i32) TemplateForestPredictor< AxisAlignedMatrixFeature< MatrixBufferTemplate<float>, float, int >, ClassProbabilityCombiner<float>, float, int>;
+%template(ScaledDepthDeltaClassificationPredictin_f32i32) TemplateForestPredictor< ScaledDepthDeltaFeature< float, int >, ClassProbabilityCombiner<float>, float, int>;
+%template(LinearMatrixQuantizedU8ClassificationPredictin_f32i32) TemplateForestPredictor< LinearMatrixFeature< MatrixBufferTemplate<float>, float, int >, QuantizedClassProbabilityCombiner<float, unsigned char>, float, int>;
+%template(LinearMatrixQuantizedU16ClassificationPredictin_f32i32) TemplateForestPredictor< LinearMatrixFeature< MatrixBufferTemplate<float>, float, int >, QuantizedClassProbabilityCombiner<float, unsigned short>, float, int>;
+%template(LinearMatrixTopKClassificationPredictin_f32i32) TemplateForestPredictor< LinearMatrixFeature< MatrixBufferTemplate<float>, float, int >, TopKClassProbabilityCombiner<float>, float, int>;
+%template(TiledScaledDepthDeltaClassificationPredictin_f32i32) TemplateForestPredictor< ScaledDepthDeltaFeature< float, int, TiledDepthImagesTemplate<float> >, ClassProbabilityCombiner<float>, float, int>;
+%template(BoxDepthDeltaClassificationPredictin_f32i32) TemplateForestPredictor< BoxDepthDeltaFeature< float, int >, ClassProbabilityCombiner<float>, float, int>;
+%template(ScaledDepthDeltaQuantizedU8ClassificationPredictin_f32i32) TemplateForestPredictor< ScaledDepthDeltaFeature< float, int >, QuantizedClassProbabilityCombiner<float, unsigned char>, float, int>;
+%template(ScaledDepthDeltaQuantizedU16ClassificationPredictin_f32i32) TemplateForestPredictor< ScaledDepthDeltaFeature< float, int >, QuantizedClassProbabilityCombiner<float, unsigned short>, float, int>;
+%template(ScaledDepthDeltaTopKClassificationPredictin_f32i32) TemplateForestPredictor< ScaledDepthDeltaFeature< float, int >, TopKClassProbabilityCombiner<float>, float, int>;
+%template(BinnedU8ClassificationPredictin_f32i32) BinnedForestPredictor< ClassProbabilityCombiner<float>, float, int, unsigned char >;
+%template(BinnedU16ClassificationPredictin_f32i32) BinnedForestPredictor< ClassProbabilityCombiner<float>, float, int, unsigned short >;
+%template(ScaledDepthDeltaImageClassificationPredictin_f32i32) DepthImagePredictor< ClassProbabilityCombiner<float>, float, int >;
\ No newline at end of file
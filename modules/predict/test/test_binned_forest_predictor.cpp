@@ -0,0 +1,190 @@
+#include <boost/test/unit_test.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "BufferCollection.h"
+#include "Constants.h"
+#include "ForestPredictor.h"
+#include "BinnedForestPredictor.h"
+#include "LinearMatrixFeature.h"
+#include "ClassProbabilityCombiner.h"
+#include "AllSamplesStep.h"
+
+struct BinnedForestPredictorFixture {
+    BinnedForestPredictorFixture()
+    : forest(2)
+    , numberOfClasses(3)
+    {
+        VectorBufferTemplate<int> depth(5);
+        VectorBufferTemplate<float> counts(5);
+
+        int path_data[] = {1, 2,
+                           3, 4,
+                          -1, -1,
+                          -1, -1,
+                          -1, -1};
+        MatrixBufferTemplate<int> path(&path_data[0], 5, 2);
+
+        int int_params_1_data[] = {MATRIX_FEATURES, 1, 0,
+                                   MATRIX_FEATURES, 1, 1,
+                                   0, 0, 0,
+                                   0, 0, 0,
+                                   0, 0, 0};
+        float float_params_1_data[] = {2.0, 0, 1.0,
+                                      -5.0, 0, 1.0,
+                                       0, 0, 0,
+                                       0, 0, 0,
+                                       0, 0, 0};
+        float ys_1_data[] = {0, 0, 0,
+                             0, 0, 0,
+                             0.7,0.1,0.2,
+                             0.3,0.3,0.4,
+                             0.3,0.6,0.1 };
+        forest.mTrees[0] = Tree(path,
+                                MatrixBufferTemplate<int>(&int_params_1_data[0], 5, 3),
+                                MatrixBufferTemplate<float>(&float_params_1_data[0], 5, 3),
+                                depth, counts,
+                                MatrixBufferTemplate<float>(&ys_1_data[0], 5, 3));
+
+        // The weight of 2.0 on the root gives a threshold of 2.5 on x0 which
+        // is shared with node 1
+        int int_params_2_data[] = {MATRIX_FEATURES, 1, 0,
+                                   MATRIX_FEATURES, 1, 0,
+                                   0, 0, 0,
+                                   0, 0, 0,
+                                   0, 0, 0};
+        float float_params_2_data[] = {5.0, 0, 2.0,
+                                       2.5, 0, 1.0,
+                                       0, 0, 0,
+                                       0, 0, 0,
+                                       0, 0, 0};
+        float ys_2_data[] = {0, 0, 0,
+                             0, 0, 0,
+                             0.8,0.1,0.1,
+                             0.2,0.2,0.6,
+                             0.2,0.7,0.1 };
+        forest.mTrees[1] = Tree(path,
+                                MatrixBufferTemplate<int>(&int_params_2_data[0], 5, 3),
+                                MatrixBufferTemplate<float>(&float_params_2_data[0], 5, 3),
+                                depth, counts,
+                                MatrixBufferTemplate<float>(&ys_2_data[0], 5, 3));
+
+        float xs_data[] = {4.0, 0.0,
+                           2.5, -5.0,
+                           2.0, -6.0,
+                           -1.0, 3.0,
+                           2.6, -5.0,
+                           10.0, 10.0};
+        xs = MatrixBufferTemplate<float>(&xs_data[0], 6, 2);
+    }
+
+    Forest forest;
+    int numberOfClasses;
+    MatrixBufferTemplate<float> xs;
+};
+
+BOOST_FIXTURE_TEST_SUITE( BinnedForestPredictorTests, BinnedForestPredictorFixture )
+
+BOOST_AUTO_TEST_CASE(test_BinRows)
+{
+    BinnedForestPredictor< ClassProbabilityCombiner<float>, float, int, unsigned char > predictor(
+                            ForestHandle(new Forest(forest)), ClassProbabilityCombiner<float>(numberOfClasses));
+
+    BOOST_CHECK_EQUAL(predictor.GetNumberOfBinnedDimensions(), 2);
+    BOOST_CHECK_EQUAL(predictor.GetBinnedDimension(0), 0);
+    BOOST_CHECK_EQUAL(predictor.GetNumberOfThresholds(0), 2);
+    BOOST_CHECK_EQUAL(predictor.GetBinnedDimension(1), 1);
+    BOOST_CHECK_EQUAL(predictor.GetNumberOfThresholds(1), 1);
+
+    MatrixBufferTemplate<unsigned char> bins;
+    predictor.BinRows(xs, bins);
+    unsigned char expected_bins_data[] = {2, 1,
+                                          1, 0,
+                                          0, 0,
+                                          0, 1,
+                                          2, 0,
+                                          2, 1};
+    for(int i=0; i<6; i++)
+    {
+        BOOST_CHECK_EQUAL(bins.Get(i,0), expected_bins_data[2*i]);
+        BOOST_CHECK_EQUAL(bins.Get(i,1), expected_bins_data[2*i+1]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_PredictLeafs_matches_float_predictor)
+{
+    typedef LinearMatrixFeature< MatrixBufferTemplate<float>, float, int> LinearMatrixFeature_t;
+    BufferCollectionKey_t xs_key("xs");
+    BufferCollection collection;
+    collection.AddBuffer(xs_key, xs);
+    AllSamplesStep<MatrixBufferTemplate<float>, float, int> indicesStep(xs_key);
+    LinearMatrixFeature_t feature(indicesStep.IndicesBufferId, xs_key);
+    ClassProbabilityCombiner<float> combiner(numberOfClasses);
+    ForestHandle forestHandle(new Forest(forest));
+
+    const TemplateForestPredictor< LinearMatrixFeature_t, ClassProbabilityCombiner<float>, float, int> floatPredictor(
+                            forestHandle, feature, combiner, &indicesStep);
+    const BinnedForestPredictor< ClassProbabilityCombiner<float>, float, int, unsigned char > binnedPredictor(
+                            forestHandle, combiner);
+    const BinnedForestPredictor< ClassProbabilityCombiner<float>, float, int, unsigned short > binned16Predictor(
+                            forestHandle, combiner);
+
+    MatrixBufferTemplate<int> expectedLeafs;
+    floatPredictor.PredictLeafs(collection, expectedLeafs);
+    MatrixBufferTemplate<int> leafs;
+    binnedPredictor.PredictLeafs(xs, leafs);
+    BOOST_CHECK( leafs == expectedLeafs );
+    binned16Predictor.PredictLeafs(xs, leafs);
+    BOOST_CHECK( leafs == expectedLeafs );
+
+    MatrixBufferTemplate<float> expectedYs;
+    floatPredictor.PredictYs(collection, expectedYs);
+    MatrixBufferTemplate<float> ys;
+    binnedPredictor.PredictYs(xs, ys);
+    BOOST_CHECK( ys == expectedYs );
+}
+
+BOOST_AUTO_TEST_CASE(test_too_many_thresholds_for_bin_type)
+{
+    // A chain of 256 splits on x0 with distinct thresholds
+    const int numberOfSplits = 256;
+    MatrixBufferTemplate<int> path(numberOfSplits+1, 2, NULL_CHILD);
+    MatrixBufferTemplate<int> intParams(numberOfSplits+1, 3);
+    MatrixBufferTemplate<float> floatParams(numberOfSplits+1, 3);
+    for(int nodeId=0; nodeId<numberOfSplits; nodeId++)
+    {
+        path.Set(nodeId, LEFT_CHILD, nodeId+1);
+        intParams.Set(nodeId, NUMBER_OF_DIMENSIONS_INDEX, 1);
+        floatParams.Set(nodeId, SPLIT_POINT_INDEX, static_cast<float>(nodeId));
+        floatParams.Set(nodeId, PARAM_START_INDEX, 1.0f);
+    }
+    Forest chainForest(1);
+    chainForest.mTrees[0] = Tree(path, intParams, floatParams,
+                                 VectorBufferTemplate<int>(numberOfSplits+1),
+                                 VectorBufferTemplate<float>(numberOfSplits+1),
+                                 MatrixBufferTemplate<float>(numberOfSplits+1, numberOfClasses));
+    const ForestHandle forestHandle(new Forest(chainForest));
+    const ClassProbabilityCombiner<float> combiner(numberOfClasses);
+
+    typedef BinnedForestPredictor< ClassProbabilityCombiner<float>, float, int, unsigned char > Binned8Predictor_t;
+    typedef BinnedForestPredictor< ClassProbabilityCombiner<float>, float, int, unsigned short > Binned16Predictor_t;
+    BOOST_CHECK_THROW(Binned8Predictor_t(forestHandle, combiner), std::overflow_error);
+    const Binned16Predictor_t binned16Predictor(forestHandle, combiner);
+    BOOST_CHECK_EQUAL(binned16Predictor.GetNumberOfThresholds(0), numberOfSplits);
+}
+
+BOOST_AUTO_TEST_CASE(test_not_axis_aligned_forest)
+{
+    typedef BinnedForestPredictor< ClassProbabilityCombiner<float>, float, int, unsigned char > Binned8Predictor_t;
+    const ClassProbabilityCombiner<float> combiner(numberOfClasses);
+
+    Forest obliqueForest(forest);
+    obliqueForest.mTrees[1].mIntFeatureParams.Set(1, NUMBER_OF_DIMENSIONS_INDEX, 2);
+    BOOST_CHECK_THROW(Binned8Predictor_t(ForestHandle(new Forest(obliqueForest)), combiner), std::invalid_argument);
+
+    Forest negativeWeightForest(forest);
+    negativeWeightForest.mTrees[0].mFloatFeatureParams.Set(0, PARAM_START_INDEX, -1.0f);
+    BOOST_CHECK_THROW(Binned8Predictor_t(ForestHandle(new Forest(negativeWeightForest)), combiner), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,187 @@
+#include <boost/test/unit_test.hpp>
+
+#include "VectorBuffer.h"
+#include "MatrixBuffer.h"
+#include "Tensor3Buffer.h"
+#include "BufferCollection.h"
+#include "Constants.h"
+#include "ForestPredictor.h"
+#include "DepthImagePredictor.h"
+#include "ScaledDepthDeltaFeature.h"
+#include "ClassProbabilityCombiner.h"
+#include "AllSamplesStep.h"
+
+struct DepthImagePredictorFixture {
+    DepthImagePredictorFixture()
+    : numberOfClasses(2)
+    , numberOfRows(7)
+    , numberOfColumns(9)
+    , forest(2)
+    , depths(2, numberOfRows, numberOfColumns)
+    {
+        for(int m=0; m<numberOfRows; m++)
+        {
+            for(int n=0; n<numberOfColumns; n++)
+            {
+                depths.Set(0, m, n, 1.0f + static_cast<float>((3*m + 5*n) % 7) * 0.5f);
+                depths.Set(1, m, n, 1.0f);
+            }
+        }
+
+        VectorBufferTemplate<int> depth(5);
+        VectorBufferTemplate<float> counts(5);
+        MatrixBufferTemplate<int> int_params(5, 5);
+        int path_data[] = {1, 2,
+                           3, 4,
+                          -1, -1,
+                          -1, -1,
+                          -1, -1};
+        MatrixBufferTemplate<int> path(&path_data[0], 5, 2);
+        float ys_data[] = {0.5, 0.5,
+                           0.5, 0.5,
+                           0.9, 0.1,
+                           0.2, 0.8,
+                           0.6, 0.4};
+        MatrixBufferTemplate<float> ys(&ys_data[0], 5, 2);
+
+        float float_params_1_data[] = {0.0, 1.0, 2.0, -3.0, 0.0,
+                                       0.5, -4.0, 4.0, 0.0, 9.0,
+                                       0, 0, 0, 0, 0,
+                                       0, 0, 0, 0, 0,
+                                       0, 0, 0, 0, 0};
+        forest.mTrees[0] = Tree(path, int_params, MatrixBufferTemplate<float>(&float_params_1_data[0], 5, 5), depth, counts, ys);
+        float float_params_2_data[] = {-0.5, 0.0, 3.0, 2.0, -2.0,
+                                        1.0, 6.0, -1.0, -6.0, 1.0,
+                                        0, 0, 0, 0, 0,
+                                        0, 0, 0, 0, 0,
+                                        0, 0, 0, 0, 0};
+        forest.mTrees[1] = Tree(path, int_params, MatrixBufferTemplate<float>(&float_params_2_data[0], 5, 5), depth, counts, ys);
+    }
+
+    // Predict each pixel of the first image with TemplateForestPredictor
+    MatrixBufferTemplate<float> PredictPixels(float scaleM=1.0f, float scaleN=1.0f)
+    {
+        BufferCollectionKey_t depths_key("depths");
+        BufferCollectionKey_t pixel_indices_key("pixel_indices");
+        BufferCollectionKey_t offset_scales_key("offset_scales");
+        MatrixBufferTemplate<int> pixelIndices(numberOfRows*numberOfColumns, 3);
+        MatrixBufferTemplate<float> offsetScales(numberOfRows*numberOfColumns, 2);
+        for(int m=0; m<numberOfRows; m++)
+        {
+            for(int n=0; n<numberOfColumns; n++)
+            {
+                pixelIndices.Set(m*numberOfColumns + n, 1, m);
+                pixelIndices.Set(m*numberOfColumns + n, 2, n);
+                offsetScales.Set(m*numberOfColumns + n, 0, scaleM);
+                offsetScales.Set(m*numberOfColumns + n, 1, scaleN);
+            }
+        }
+        BufferCollection collection;
+        collection.AddBuffer(depths_key, depths);
+        collection.AddBuffer(pixel_indices_key, pixelIndices);
+        collection.AddBuffer(offset_scales_key, offsetScales);
+
+        AllSamplesStep<MatrixBufferTemplate<int>, float, int> indicesStep(pixel_indices_key);
+        ScaledDepthDeltaFeature<float, int> feature(GetBufferId("floatParams"), GetBufferId("intParams"),
+                                                    indicesStep.IndicesBufferId, pixel_indices_key, depths_key,
+                                                    offset_scales_key);
+        const TemplateForestPredictor< ScaledDepthDeltaFeature<float, int>, ClassProbabilityCombiner<float>, float, int > predictor(
+                                ForestHandle(new Forest(forest)), feature, ClassProbabilityCombiner<float>(numberOfClasses), &indicesStep);
+        MatrixBufferTemplate<float> ys;
+        predictor.PredictYs(collection, ys);
+        return ys;
+    }
+
+    int numberOfClasses;
+    int numberOfRows;
+    int numberOfColumns;
+    Forest forest;
+    Tensor3BufferTemplate<float> depths;
+};
+
+BOOST_FIXTURE_TEST_SUITE( DepthImagePredictorTests, DepthImagePredictorFixture )
+
+BOOST_AUTO_TEST_CASE(test_PredictYs_matches_pixel_predictor)
+{
+    const MatrixBufferTemplate<float> expectedYs = PredictPixels();
+
+    const DepthImagePredictor< ClassProbabilityCombiner<float>, float, int > predictor(
+                                ForestHandle(new Forest(forest)), ClassProbabilityCombiner<float>(numberOfClasses), 4, 2);
+    Tensor3BufferTemplate<float> ys;
+    predictor.PredictYs(depths, 0, ys);
+
+    BOOST_CHECK_EQUAL(ys.GetL(), numberOfClasses);
+    BOOST_CHECK_EQUAL(ys.GetM(), numberOfRows);
+    BOOST_CHECK_EQUAL(ys.GetN(), numberOfColumns);
+    for(int m=0; m<numberOfRows; m++)
+    {
+        for(int n=0; n<numberOfColumns; n++)
+        {
+            for(int c=0; c<numberOfClasses; c++)
+            {
+                BOOST_CHECK_EQUAL(ys.Get(c, m, n), expectedYs.Get(m*numberOfColumns + n, c));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_PredictYsMasked)
+{
+    const MatrixBufferTemplate<float> expectedYs = PredictPixels();
+
+    MatrixBufferTemplate<int> mask(numberOfRows, numberOfColumns);
+    for(int m=0; m<numberOfRows; m++)
+    {
+        mask.Set(m, m % numberOfColumns, 1);
+        mask.Set(m, numberOfColumns-1, 1);
+    }
+
+    const DepthImagePredictor< ClassProbabilityCombiner<float>, float, int > predictor(
+                                ForestHandle(new Forest(forest)), ClassProbabilityCombiner<float>(numberOfClasses), 3, 1);
+    Tensor3BufferTemplate<float> ys;
+    predictor.PredictYsMasked(depths, 0, mask, ys);
+
+    for(int m=0; m<numberOfRows; m++)
+    {
+        for(int n=0; n<numberOfColumns; n++)
+        {
+            for(int c=0; c<numberOfClasses; c++)
+            {
+                const float expected = mask.Get(m, n) ? expectedYs.Get(m*numberOfColumns + n, c) : 0.0f;
+                BOOST_CHECK_EQUAL(ys.Get(c, m, n), expected);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_PredictYs_offset_scales)
+{
+    const MatrixBufferTemplate<float> expectedYs = PredictPixels(1.5f, 0.5f);
+    const MatrixBufferTemplate<float> unscaledYs = PredictPixels();
+
+    // One row of scales per image
+    float offset_scales_data[] = {1.5, 0.5,
+                                  1.0, 1.0};
+    const MatrixBufferTemplate<float> offsetScales(&offset_scales_data[0], 2, 2);
+
+    const DepthImagePredictor< ClassProbabilityCombiner<float>, float, int > predictor(
+                                ForestHandle(new Forest(forest)), ClassProbabilityCombiner<float>(numberOfClasses), 4, 2);
+    Tensor3BufferTemplate<float> ys;
+    predictor.PredictYs(depths, offsetScales, 0, ys);
+
+    bool scalesChangePrediction = false;
+    for(int m=0; m<numberOfRows; m++)
+    {
+        for(int n=0; n<numberOfColumns; n++)
+        {
+            for(int c=0; c<numberOfClasses; c++)
+            {
+                BOOST_CHECK_EQUAL(ys.Get(c, m, n), expectedYs.Get(m*numberOfColumns + n, c));
+                scalesChangePrediction |= (expectedYs.Get(m*numberOfColumns + n, c) != unscaledYs.Get(m*numberOfColumns + n, c));
+            }
+        }
+    }
+    BOOST_CHECK(scalesChangePrediction);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
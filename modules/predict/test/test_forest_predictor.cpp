@@ -10,9 +10,30 @@
 #include "ForestPredictor.h"
 #include "LinearMatrixFeature.h"
 #include "ClassProbabilityCombiner.h"
+#include "CompressedClassProbabilityCombiner.h"
 #include "AllSamplesStep.h"
+#include "Pipeline.h"
 
 
+// Counts how many times it is processed
+class CountingStep: public PipelineStepI
+{
+public:
+    virtual PipelineStepI* Clone() const { return new CountingStep(*this); }
+    virtual void ProcessStep(   const BufferCollectionStack& readCollection,
+                                BufferCollection& writeCollection,
+                                boost::mt19937& gen) const
+    {
+        UNUSED_PARAM(readCollection);
+        UNUSED_PARAM(writeCollection);
+        UNUSED_PARAM(gen);
+        ++sNumberOfProcessCalls;
+    }
+
+    static int sNumberOfProcessCalls;
+};
+int CountingStep::sNumberOfProcessCalls = 0;
+
 struct ForestPredictorFixture {
     ForestPredictorFixture()
     : xs_key("xs")
@@ -87,7 +108,7 @@ struct ForestPredictorFixture {
         forest.mTrees[1] = Tree(path_2, int_params_2, float_params_2, depth, counts, estimator_params_2);
 
         forestPredictor = new TemplateForestPredictor< LinearMatrixFeature_t, ClassProbabilityCombiner<float>, float, int>(
-                                forest, feature, combiner, &indicesStep);
+                                ForestHandle(new Forest(forest)), feature, combiner, &indicesStep);
 
     }
 
@@ -144,4 +165,112 @@ BOOST_AUTO_TEST_CASE(test_PredictYs)
     BOOST_CHECK_CLOSE(ys.Get(0,2), 0.25, 0.1);
 }
 
+BOOST_AUTO_TEST_CASE(test_PredictYs_shared_forest)
+{
+    ForestHandle sharedForest(new Forest(forest));
+    const TemplateForestPredictor< LinearMatrixFeature_t, ClassProbabilityCombiner<float>, float, int> predictorA(
+                                sharedForest, feature, combiner, &indicesStep);
+    const TemplateForestPredictor< LinearMatrixFeature_t, ClassProbabilityCombiner<float>, float, int> predictorB(
+                                sharedForest, feature, combiner, &indicesStep);
+
+    MatrixBufferTemplate<float> ysA;
+    predictorA.PredictYs(collection, ysA);
+    MatrixBufferTemplate<float> ysB;
+    predictorB.PredictYs(collection, ysB);
+    predictorA.PredictYs(collection, ysA);
+
+    BOOST_CHECK_CLOSE(ysA.Get(0,0), 0.55, 0.1);
+    BOOST_CHECK_CLOSE(ysA.Get(0,1), 0.2, 0.1);
+    BOOST_CHECK_CLOSE(ysA.Get(0,2), 0.25, 0.1);
+    BOOST_CHECK( ysA == ysB );
+    BOOST_CHECK( predictorA.GetForest() == predictorB.GetForest() );
+}
+
+BOOST_AUTO_TEST_CASE(test_PredictYs_runs_pre_steps_once_per_call)
+{
+    CountingStep countingStep;
+    std::vector<PipelineStepI*> steps;
+    steps.push_back(&indicesStep);
+    steps.push_back(&countingStep);
+    const Pipeline preSteps(steps);
+    const TemplateForestPredictor< LinearMatrixFeature_t, ClassProbabilityCombiner<float>, float, int> predictor(
+                                ForestHandle(new Forest(forest)), feature, combiner, &preSteps);
+
+    CountingStep::sNumberOfProcessCalls = 0;
+    MatrixBufferTemplate<float> ys;
+    predictor.PredictYs(collection, ys);
+    BOOST_CHECK_EQUAL(CountingStep::sNumberOfProcessCalls, 1);
+    BOOST_CHECK_CLOSE(ys.Get(0,0), 0.55, 0.1);
+
+    MatrixBufferTemplate<int> leafs;
+    predictor.PredictLeafs(collection, leafs);
+    BOOST_CHECK_EQUAL(CountingStep::sNumberOfProcessCalls, 2);
+    BOOST_CHECK_EQUAL(leafs.Get(0,0), 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_ExportForInference)
+{
+    const Forest exported = forest.ExportForInference();
+    BOOST_CHECK_EQUAL(exported.GetNumberOfTrees(), 2);
+    BOOST_CHECK( exported.GetTree(0).mPath == path_1 );
+    BOOST_CHECK( exported.GetTree(1).mFloatFeatureParams == float_params_2 );
+    BOOST_CHECK_EQUAL(exported.GetTree(0).mYs.GetM(), 0);
+    BOOST_CHECK_EQUAL(exported.GetTree(0).mCounts.GetN(), 0);
+    BOOST_CHECK_EQUAL(exported.GetTree(0).mDepths.GetN(), 0);
+    BOOST_CHECK( !exported.GetTree(0).HasTrainingData() );
+    BOOST_CHECK_EQUAL(exported.GetTree(0).mFloatLeafYs.GetYDim(), 3);
+    BOOST_CHECK_EQUAL(exported.GetTree(0).mFloatLeafYs.GetLeafYs().GetN(), 3);
+    BOOST_CHECK_EQUAL(exported.GetTree(0).mTopKLeafYs.GetYDim(), 0);
+    BOOST_CHECK_EQUAL(exported.GetTree(0).mQuantizedU8LeafYs.GetYDim(), 0);
+
+    BOOST_CHECK_EQUAL(forest.GetYDim(), 3);
+    BOOST_CHECK_EQUAL(exported.GetYDim(), 3);
+    BOOST_CHECK_EQUAL(forest.ExportForInference(Tree::LEAF_YS_QUANTIZED_U16).GetYDim(), 3);
+    BOOST_CHECK_EQUAL(forest.ExportForInference(Tree::LEAF_YS_TOP_K, 1).GetYDim(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_PredictYs_exported_float_leafs)
+{
+    ClassProbabilityCombiner<float> classProbCombiner(3);
+    const TemplateForestPredictor< LinearMatrixFeature_t, ClassProbabilityCombiner<float>, float, int> predictor(
+                                ForestHandle(new Forest(forest.ExportForInference())), feature, classProbCombiner, &indicesStep);
+
+    MatrixBufferTemplate<float> ys;
+    predictor.PredictYs(collection, ys);
+
+    BOOST_CHECK_CLOSE(ys.Get(0,0), 0.55, 0.1);
+    BOOST_CHECK_CLOSE(ys.Get(0,1), 0.2, 0.1);
+    BOOST_CHECK_CLOSE(ys.Get(0,2), 0.25, 0.1);
+}
+
+BOOST_AUTO_TEST_CASE(test_PredictYs_quantized_leafs)
+{
+    const ForestHandle exported(new Forest(forest.ExportForInference(Tree::LEAF_YS_QUANTIZED_U8)));
+    QuantizedClassProbabilityCombiner<float, unsigned char> quantizedCombiner(*exported);
+    const TemplateForestPredictor< LinearMatrixFeature_t, QuantizedClassProbabilityCombiner<float, unsigned char>, float, int> predictor(
+                                exported, feature, quantizedCombiner, &indicesStep);
+
+    MatrixBufferTemplate<float> ys;
+    predictor.PredictYs(collection, ys);
+
+    BOOST_CHECK_CLOSE(ys.Get(0,0), 0.55, 1.0);
+    BOOST_CHECK_CLOSE(ys.Get(0,1), 0.2, 1.0);
+    BOOST_CHECK_CLOSE(ys.Get(0,2), 0.25, 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_PredictYs_top_k_leafs)
+{
+    const ForestHandle exported(new Forest(forest.ExportForInference(Tree::LEAF_YS_TOP_K, 2)));
+    TopKClassProbabilityCombiner<float> topKCombiner(*exported);
+    const TemplateForestPredictor< LinearMatrixFeature_t, TopKClassProbabilityCombiner<float>, float, int> predictor(
+                                exported, feature, topKCombiner, &indicesStep);
+
+    MatrixBufferTemplate<float> ys;
+    predictor.PredictYs(collection, ys);
+
+    BOOST_CHECK_CLOSE(ys.Get(0,0), 0.4, 0.1);
+    BOOST_CHECK_CLOSE(ys.Get(0,1), 0.15, 0.1);
+    BOOST_CHECK_CLOSE(ys.Get(0,2), 0.25, 0.1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,8 @@
 
 #include <limits>
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
 #include "VectorBuffer.h"
 #include "MatrixBuffer.h"
@@ -10,6 +12,13 @@
 #include "PipelineStepI.h"
 #include "UniqueBufferId.h"
 #include "FeatureSorter.h"
+#include "RunningJobs.h"
+
+#if USE_BOOST_THREAD
+#include <boost/thread.hpp>
+#include <boost/ref.hpp>
+#include <boost/make_shared.hpp>
+#endif
 
 // ----------------------------------------------------------------------------
 //
@@ -17,6 +26,12 @@
 // this by sorting the feature values and walking the sorted values to find
 // the split point with the highest impurity.
 //
+// With numberOfSortJobs > 1 the features of nodes with at least
+// MIN_SAMPLES_PER_SORT_JOB samples are shared by up to that many jobs, each
+// sorting and walking its features with its own copy of the walker.  The
+// jobs are reserved with ReserveRunningJobs so together with the tree and
+// subtree jobs already running they do not go past the number of cores.
+//
 // ----------------------------------------------------------------------------
 template <class ImpurityWalker>
 class BestSplitpointsWalkingSortedStep : public PipelineStepI
@@ -24,7 +39,8 @@ class BestSplitpointsWalkingSortedStep : public PipelineStepI
 public:
     BestSplitpointsWalkingSortedStep (const ImpurityWalker& impurityWalker,
                               const BufferId& featureValues,
-                              FeatureValueOrdering featureValueOrdering );
+                              FeatureValueOrdering featureValueOrdering,
+                              int numberOfSortJobs=1 );
     virtual ~BestSplitpointsWalkingSortedStep();
 
     virtual PipelineStepI* Clone() const;
@@ -33,6 +49,9 @@ public:
                                 BufferCollection& writeCollection,
                                 boost::mt19937& gen) const;
 
+    // Values of a feature are sorted together
+    static FeatureValueOrdering GetPreferredFeatureValueOrdering();
+
     // Read only output buffer
     const BufferId ImpurityBufferId;
     const BufferId SplitpointBufferId;
@@ -40,10 +59,28 @@ public:
     const BufferId ChildCountsBufferId;
     const BufferId LeftYsBufferId;
     const BufferId RightYsBufferId;
+
+    enum { MIN_SAMPLES_PER_SORT_JOB = 4096 };
 private:
+    void ProcessFeatures( const MatrixBufferTemplate<typename ImpurityWalker::Float>& featureValues,
+                          const FeatureValueOrdering ordering,
+                          ImpurityWalker& impurityWalker,
+                          const int firstFeature,
+                          const int featureStride,
+                          BufferCollection& writeCollection ) const;
+
+    // Each job binds its own walker
+    void ProcessFeaturesJob( const BufferCollectionStack* readCollection,
+                             const MatrixBufferTemplate<typename ImpurityWalker::Float>* featureValues,
+                             const FeatureValueOrdering ordering,
+                             const int firstFeature,
+                             const int featureStride,
+                             BufferCollection* writeCollection ) const;
+
     const ImpurityWalker mImpurityWalker;
     const BufferId mFeatureValuesBufferId;
     const FeatureValueOrdering mFeatureValueOrdering;
+    const int mNumberOfSortJobs;
 
 };
 
@@ -51,7 +88,8 @@ private:
 template <class ImpurityWalker>
 BestSplitpointsWalkingSortedStep<ImpurityWalker>::BestSplitpointsWalkingSortedStep(const ImpurityWalker& impurityWalker,
                                                                       const BufferId& featureValues,
-                                                                      FeatureValueOrdering featureValueOrdering )
+                                                                      FeatureValueOrdering featureValueOrdering,
+                                                                      int numberOfSortJobs )
 : ImpurityBufferId( GetBufferId("Impurity") )
 , SplitpointBufferId( GetBufferId("Splitpoints") )
 , SplitpointCountsBufferId( GetBufferId("SplitpointsCounts") )
@@ -61,6 +99,7 @@ BestSplitpointsWalkingSortedStep<ImpurityWalker>::BestSplitpointsWalkingSortedSt
 , mImpurityWalker(impurityWalker)
 , mFeatureValuesBufferId(featureValues)
 , mFeatureValueOrdering(featureValueOrdering)
+, mNumberOfSortJobs(numberOfSortJobs)
 {}
 
 template <class ImpurityWalker>
@@ -74,6 +113,12 @@ PipelineStepI* BestSplitpointsWalkingSortedStep<ImpurityWalker>::Clone() const
     return clone;
 }
 
+template <class ImpurityWalker>
+FeatureValueOrdering BestSplitpointsWalkingSortedStep<ImpurityWalker>::GetPreferredFeatureValueOrdering()
+{
+    return FEATURES_BY_DATAPOINTS;
+}
+
 template <class ImpurityWalker>
 void BestSplitpointsWalkingSortedStep<ImpurityWalker>::ProcessStep(const BufferCollectionStack& readCollection,
                                                               BufferCollection& writeCollection,
@@ -85,11 +130,9 @@ void BestSplitpointsWalkingSortedStep<ImpurityWalker>::ProcessStep(const BufferC
     ASSERT(readCollection.HasBuffer< MatrixBufferTemplate<typename ImpurityWalker::Float> >(mFeatureValuesBufferId));
     MatrixBufferTemplate<typename ImpurityWalker::Float> const& featureValues
            = readCollection.GetBuffer< MatrixBufferTemplate<typename ImpurityWalker::Float> >(mFeatureValuesBufferId);
+    const FeatureValueOrdering ordering = ResolveFeatureValueOrdering(mFeatureValueOrdering, readCollection, mFeatureValuesBufferId);
 
-    // Make a local non-const walker and bind it
-    ImpurityWalker impurityWalker = mImpurityWalker;
-    impurityWalker.Bind(readCollection);
-    const int numberOfFeatures =  mFeatureValueOrdering == FEATURES_BY_DATAPOINTS ? featureValues.GetM() : featureValues.GetN();
+    const int numberOfFeatures =  ordering == FEATURES_BY_DATAPOINTS ? featureValues.GetM() : featureValues.GetN();
 
     // Bind output buffers
     MatrixBufferTemplate<typename ImpurityWalker::Float>& impurities
@@ -110,13 +153,83 @@ void BestSplitpointsWalkingSortedStep<ImpurityWalker>::ProcessStep(const BufferC
 
     Tensor3BufferTemplate<typename ImpurityWalker::Float>& leftYs
            = writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<typename ImpurityWalker::Float> >(LeftYsBufferId);
-    leftYs.Resize(numberOfFeatures, 1, impurityWalker.GetYDim());
+    leftYs.Resize(numberOfFeatures, 1, mImpurityWalker.GetYDim());
 
     Tensor3BufferTemplate<typename ImpurityWalker::Float>& rightYs
            = writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<typename ImpurityWalker::Float> >(RightYsBufferId);
-    rightYs.Resize(numberOfFeatures, 1, impurityWalker.GetYDim());
+    rightYs.Resize(numberOfFeatures, 1, mImpurityWalker.GetYDim());
 
-    for(int f=0; f<numberOfFeatures; f++)
+    const int numberOfSamples = ordering == FEATURES_BY_DATAPOINTS ? featureValues.GetN() : featureValues.GetM();
+#if USE_BOOST_THREAD
+    // This thread waits for the jobs so only the jobs beyond it are reserved
+    const int numberOfRequestedJobs = std::min(mNumberOfSortJobs, numberOfFeatures);
+    if( numberOfRequestedJobs > 1 && numberOfSamples >= MIN_SAMPLES_PER_SORT_JOB )
+    {
+        const int numberOfReservedJobs = ReserveRunningJobs(numberOfRequestedJobs - 1);
+        const int numberOfJobs = numberOfReservedJobs + 1;
+        if( numberOfJobs > 1 )
+        {
+            std::vector< boost::shared_ptr< boost::thread > > threadVec;
+            for(int job=0; job<numberOfJobs; job++)
+            {
+                threadVec.push_back( boost::make_shared<boost::thread>(&BestSplitpointsWalkingSortedStep<ImpurityWalker>::ProcessFeaturesJob, this,
+                                                                       &readCollection, &featureValues, ordering, job, numberOfJobs, &writeCollection) );
+            }
+            for(int job=0; job<numberOfJobs; job++)
+            {
+                threadVec[job]->join();
+            }
+            RemoveRunningJobs(numberOfReservedJobs);
+            return;
+        }
+    }
+#else
+    UNUSED_PARAM(numberOfSamples);
+#endif
+    // Make a local non-const walker and bind it
+    ImpurityWalker impurityWalker = mImpurityWalker;
+    impurityWalker.Bind(readCollection);
+    ProcessFeatures(featureValues, ordering, impurityWalker, 0, 1, writeCollection);
+}
+
+template <class ImpurityWalker>
+void BestSplitpointsWalkingSortedStep<ImpurityWalker>::ProcessFeaturesJob( const BufferCollectionStack* readCollection,
+                                                                           const MatrixBufferTemplate<typename ImpurityWalker::Float>* featureValues,
+                                                                           const FeatureValueOrdering ordering,
+                                                                           const int firstFeature,
+                                                                           const int featureStride,
+                                                                           BufferCollection* writeCollection ) const
+{
+    ImpurityWalker impurityWalker = mImpurityWalker;
+    impurityWalker.Bind(*readCollection);
+    ProcessFeatures(*featureValues, ordering, impurityWalker, firstFeature, featureStride, *writeCollection);
+}
+
+template <class ImpurityWalker>
+void BestSplitpointsWalkingSortedStep<ImpurityWalker>::ProcessFeatures( const MatrixBufferTemplate<typename ImpurityWalker::Float>& featureValues,
+                                                                        const FeatureValueOrdering ordering,
+                                                                        ImpurityWalker& impurityWalker,
+                                                                        const int firstFeature,
+                                                                        const int featureStride,
+                                                                        BufferCollection& writeCollection ) const
+{
+    // The output buffers are sized by ProcessStep so jobs only write their
+    // own features
+    MatrixBufferTemplate<typename ImpurityWalker::Float>& impurities
+           = writeCollection.GetBuffer< MatrixBufferTemplate<typename ImpurityWalker::Float> >(ImpurityBufferId);
+    MatrixBufferTemplate<typename ImpurityWalker::Float>& thresholds
+           = writeCollection.GetBuffer< MatrixBufferTemplate<typename ImpurityWalker::Float> >(SplitpointBufferId);
+    VectorBufferTemplate<typename ImpurityWalker::Int>& thresholdCounts
+           = writeCollection.GetBuffer< VectorBufferTemplate<typename ImpurityWalker::Int> >(SplitpointCountsBufferId);
+    Tensor3BufferTemplate<typename ImpurityWalker::Float>& childCounts
+           = writeCollection.GetBuffer< Tensor3BufferTemplate<typename ImpurityWalker::Float> >(ChildCountsBufferId);
+    Tensor3BufferTemplate<typename ImpurityWalker::Float>& leftYs
+           = writeCollection.GetBuffer< Tensor3BufferTemplate<typename ImpurityWalker::Float> >(LeftYsBufferId);
+    Tensor3BufferTemplate<typename ImpurityWalker::Float>& rightYs
+           = writeCollection.GetBuffer< Tensor3BufferTemplate<typename ImpurityWalker::Float> >(RightYsBufferId);
+    const int numberOfFeatures = impurities.GetM();
+
+    for(int f=firstFeature; f<numberOfFeatures; f+=featureStride)
     {
         impurityWalker.Reset();
 
@@ -127,7 +240,7 @@ void BestSplitpointsWalkingSortedStep<ImpurityWalker>::ProcessStep(const BufferC
         VectorBufferTemplate<typename ImpurityWalker::Float> bestLeftYs(impurityWalker.GetYDim());
         VectorBufferTemplate<typename ImpurityWalker::Float> bestRightYs(impurityWalker.GetYDim());
 
-        FeatureSorter<typename ImpurityWalker::Float> sorter(featureValues, mFeatureValueOrdering, f);
+        FeatureSorter<typename ImpurityWalker::Float> sorter(featureValues, ordering, f);
         sorter.Sort();
         for(int sortedIndex=0; sortedIndex<sorter.GetNumberOfSamples()-1; sortedIndex++)
         {
@@ -156,4 +269,4 @@ void BestSplitpointsWalkingSortedStep<ImpurityWalker>::ProcessStep(const BufferC
         leftYs.SetRow(f, 0, bestLeftYs );
         rightYs.SetRow(f, 0, bestRightYs );
     }
-}
\ No newline at end of file
+}
@@ -1,17 +1,63 @@
 #pragma once
 
 #include <vector>
-#include <utility>
 #include <algorithm>
+#include <cstring>
+
+#include <boost/cstdint.hpp>
 
 #include "MatrixBuffer.h"
 #include "FeatureExtractorStep.h"
 
 // ----------------------------------------------------------------------------
 //
-// Sort feature values to get a mapping from unsorted indices to sorted 
+// Unsigned integer keys that sort in the same order as floating point values.
+// Negative values have all bits flipped and positive values have the sign bit
+// set so the keys of the IEEE bit patterns compare as unsigned integers.
+//
+// ----------------------------------------------------------------------------
+template <class FloatType>
+struct RadixSortKey;
+
+template <>
+struct RadixSortKey<float>
+{
+    typedef boost::uint32_t Type;
+};
+
+template <>
+struct RadixSortKey<double>
+{
+    typedef boost::uint64_t Type;
+};
+
+template <class FloatType>
+typename RadixSortKey<FloatType>::Type ToRadixSortKey(FloatType value)
+{
+    typedef typename RadixSortKey<FloatType>::Type KeyType;
+
+    // -0 and 0 compare equal so they get the same key
+    if( value == FloatType(0) )
+    {
+        value = FloatType(0);
+    }
+    KeyType bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const KeyType signBit = KeyType(1) << (sizeof(KeyType)*8 - 1);
+    return (bits & signBit) ? ~bits : (bits | signBit);
+}
+
+// ----------------------------------------------------------------------------
+//
+// Sort feature values to get a mapping from unsorted indices to sorted
 // indices.  Either by row or column.
 //
+// Values and indices are kept in separate arrays.  Small nodes are insertion
+// sorted and larger ones are LSD radix sorted one byte at a time on
+// RadixSortKey, skipping bytes that are the same for every value.  Both sorts
+// are stable so equal values stay in index order (as sorting value, index
+// pairs would).
+//
 // ----------------------------------------------------------------------------
 template <class FloatType>
 class FeatureSorter
@@ -25,9 +71,15 @@ public:
     FloatType GetFeatureValue(int sortedIndex) const;
     int GetNumberOfSamples() const;
 
+    enum { INSERTION_SORT_MAX_SIZE = 32 };
+
 private:
+    void InsertionSort();
+    void RadixSort();
+
     const int mNumberOfSamples;
-    std::vector< std::pair<FloatType, int> > mValueIndices;
+    std::vector<FloatType> mValues;
+    std::vector<int> mIndices;
 };
 
 template <class FloatType>
@@ -35,36 +87,111 @@ FeatureSorter<FloatType>::FeatureSorter(   const MatrixBufferTemplate<FloatType>
                                             const FeatureValueOrdering ordering,
                                             const int featureIndex)
 : mNumberOfSamples( ordering == FEATURES_BY_DATAPOINTS ? featureValues.GetN() : featureValues.GetM())
-, mValueIndices(mNumberOfSamples)
+, mValues(mNumberOfSamples)
+, mIndices(mNumberOfSamples)
 {
     for(int s=0; s<mNumberOfSamples; s++)
     {
         int r = (ordering == FEATURES_BY_DATAPOINTS) ? featureIndex : s;
         int c = (ordering == FEATURES_BY_DATAPOINTS) ? s : featureIndex;
-        mValueIndices[s] = std::pair<FloatType,int>(featureValues.Get(r,c), s);
+        mValues[s] = featureValues.Get(r,c);
+        mIndices[s] = s;
     }
 }
 
 template <class FloatType>
 void FeatureSorter<FloatType>::Sort()
 {
-    std::sort( mValueIndices.begin(), mValueIndices.end() );
+    if( mNumberOfSamples <= INSERTION_SORT_MAX_SIZE )
+    {
+        InsertionSort();
+    }
+    else
+    {
+        RadixSort();
+    }
+}
+
+template <class FloatType>
+void FeatureSorter<FloatType>::InsertionSort()
+{
+    for(int i=1; i<mNumberOfSamples; i++)
+    {
+        const FloatType value = mValues[i];
+        const int index = mIndices[i];
+        int j = i;
+        for(; j>0 && value < mValues[j-1]; j--)
+        {
+            mValues[j] = mValues[j-1];
+            mIndices[j] = mIndices[j-1];
+        }
+        mValues[j] = value;
+        mIndices[j] = index;
+    }
+}
+
+template <class FloatType>
+void FeatureSorter<FloatType>::RadixSort()
+{
+    typedef typename RadixSortKey<FloatType>::Type KeyType;
+    enum { RADIX_BITS = 8, RADIX_SIZE = 1 << RADIX_BITS };
+
+    std::vector<KeyType> keys(mNumberOfSamples);
+    for(int s=0; s<mNumberOfSamples; s++)
+    {
+        keys[s] = ToRadixSortKey(mValues[s]);
+    }
+    std::vector<KeyType> sortedKeys(mNumberOfSamples);
+    std::vector<int> sortedIndices(mNumberOfSamples);
+
+    for(unsigned int shift=0; shift<sizeof(KeyType)*8; shift+=RADIX_BITS)
+    {
+        int offsets[RADIX_SIZE+1];
+        std::fill(&offsets[0], &offsets[0]+RADIX_SIZE+1, 0);
+        for(int s=0; s<mNumberOfSamples; s++)
+        {
+            offsets[((keys[s] >> shift) & (RADIX_SIZE-1)) + 1]++;
+        }
+        if( std::find(&offsets[1], &offsets[0]+RADIX_SIZE+1, mNumberOfSamples) != &offsets[0]+RADIX_SIZE+1 )
+        {
+            continue;
+        }
+        for(int digit=0; digit<RADIX_SIZE; digit++)
+        {
+            offsets[digit+1] += offsets[digit];
+        }
+        for(int s=0; s<mNumberOfSamples; s++)
+        {
+            const int sortedIndex = offsets[(keys[s] >> shift) & (RADIX_SIZE-1)]++;
+            sortedKeys[sortedIndex] = keys[s];
+            sortedIndices[sortedIndex] = mIndices[s];
+        }
+        keys.swap(sortedKeys);
+        mIndices.swap(sortedIndices);
+    }
+
+    // mIndices are positions into the unsorted values
+    const std::vector<FloatType> values(mValues);
+    for(int s=0; s<mNumberOfSamples; s++)
+    {
+        mValues[s] = values[mIndices[s]];
+    }
 }
 
 template <class FloatType>
 int FeatureSorter<FloatType>::GetUnSortedIndex(int sortedIndex) const
 {
-    return mValueIndices[sortedIndex].second;
+    return mIndices[sortedIndex];
 }
 
 template <class FloatType>
 FloatType FeatureSorter<FloatType>::GetFeatureValue(int sortedIndex) const
 {
-    return mValueIndices[sortedIndex].first;
+    return mValues[sortedIndex];
 }
 
 template <class FloatType>
 int FeatureSorter<FloatType>::GetNumberOfSamples() const
 {
     return mNumberOfSamples;
-}
\ No newline at end of file
+}
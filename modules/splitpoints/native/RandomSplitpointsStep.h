@@ -35,6 +35,9 @@ public:
                                 BufferCollection& writeCollection,
                                 boost::mt19937& gen) const;
 
+    // Each sampled datapoint adds splitpoints to all features together
+    static FeatureValueOrdering GetPreferredFeatureValueOrdering();
+
     const BufferId SplitpointsBufferId;
     const BufferId SplitpointsCountsBufferId;
 private:
@@ -85,6 +88,12 @@ PipelineStepI* RandomSplitpointsStep<FloatType, IntType>::Clone() const
 }
 
 
+template <class FloatType, class IntType>
+FeatureValueOrdering RandomSplitpointsStep<FloatType, IntType>::GetPreferredFeatureValueOrdering()
+{
+    return DATAPOINTS_BY_FEATURES;
+}
+
 template <class FloatType, class IntType>
 void RandomSplitpointsStep<FloatType, IntType>::ProcessStep(const BufferCollectionStack& readCollection,
                                         BufferCollection& writeCollection,
@@ -94,6 +103,7 @@ void RandomSplitpointsStep<FloatType, IntType>::ProcessStep(const BufferCollecti
 
     const MatrixBufferTemplate<FloatType>& featureValues =
           readCollection.GetBuffer< MatrixBufferTemplate<FloatType> >(mFeatureValuesBufferId);
+    const FeatureValueOrdering ordering = ResolveFeatureValueOrdering(mFeatureValueOrdering, readCollection, mFeatureValuesBufferId);
 
     MatrixBufferTemplate<FloatType>& splitPoints =
             writeCollection.GetOrAddBuffer< MatrixBufferTemplate<FloatType> >(SplitpointsBufferId);
@@ -107,8 +117,8 @@ void RandomSplitpointsStep<FloatType, IntType>::ProcessStep(const BufferCollecti
         streamType = readCollection.GetBufferPtr< VectorBufferTemplate<IntType> >(mStreamTypeBufferId);
     }
 
-    const int numberOfFeatures =  mFeatureValueOrdering == FEATURES_BY_DATAPOINTS ? featureValues.GetM() : featureValues.GetN();
-    const int numberOfSamples =  mFeatureValueOrdering == FEATURES_BY_DATAPOINTS ? featureValues.GetN() : featureValues.GetM();
+    const int numberOfFeatures =  ordering == FEATURES_BY_DATAPOINTS ? featureValues.GetM() : featureValues.GetN();
+    const int numberOfSamples =  ordering == FEATURES_BY_DATAPOINTS ? featureValues.GetN() : featureValues.GetM();
    
     splitPoints.Resize(numberOfFeatures, mMaxSplitpointPerFeature);
     splitPointsCounts.Resize(numberOfFeatures);
@@ -125,8 +135,8 @@ void RandomSplitpointsStep<FloatType, IntType>::ProcessStep(const BufferCollecti
         {
             for(int f=0; f<numberOfFeatures; f++)
             {
-                const int r = (mFeatureValueOrdering == FEATURES_BY_DATAPOINTS) ? f : i;
-                const int c = (mFeatureValueOrdering == FEATURES_BY_DATAPOINTS) ? i : f;
+                const int r = (ordering == FEATURES_BY_DATAPOINTS) ? f : i;
+                const int c = (ordering == FEATURES_BY_DATAPOINTS) ? i : f;
                 const float featureValue = featureValues.Get(r,c);
                 AddSplitpoint(splitPoints, splitPointsCounts, f, featureValue);
             }
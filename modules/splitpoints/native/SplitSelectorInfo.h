@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "asserts.h"
 #include "VectorBuffer.h"
 #include "MatrixBuffer.h"
@@ -35,8 +37,15 @@ public:
                           MatrixBufferTemplate<IntType>& treeIntFeatureParams,
                           MatrixBufferTemplate<FloatType>& treeFloatEstimatorParams ) const;
 
-    void SplitIndices(BufferCollection& leftIndicesBufCol, BufferCollection& rightIndicesBufCol,
-                      FloatType& leftSize, FloatType& rightSize) const;
+    // Stable partition of the node's indices into permutation[begin, end) so
+    // the left child owns [begin, split) and the right child [split, end).
+    // The node's indices buffer must hold a copy of that range (an empty
+    // permutation is sized for the root).
+    void PartitionIndices(std::vector<IntType>& permutation, IntType begin,
+                          IntType& split, IntType& end,
+                          FloatType& leftSize, FloatType& rightSize) const;
+
+    const BufferId& GetIndicesBufferId() const;
 
 private:
     const SplitSelectorBuffers& mSplitSelectorBuffers;
@@ -130,56 +139,73 @@ void SplitSelectorInfo<FloatType, IntType>::WriteToTree(int nodeId, int leftNode
 }
 
 template <class FloatType, class IntType>
-void SplitSelectorInfo<FloatType, IntType>::SplitIndices(BufferCollection& leftIndicesBufCol, BufferCollection& rightIndicesBufCol,
-                                                          FloatType& leftSize, FloatType& rightSize) const
+void SplitSelectorInfo<FloatType, IntType>::PartitionIndices(std::vector<IntType>& permutation, IntType begin,
+                                                              IntType& split, IntType& end,
+                                                              FloatType& leftSize, FloatType& rightSize) const
 {
     ASSERT(ValidSplit())
 
     const VectorBufferTemplate<IntType>& indices
           = mReadCollection.GetBuffer< VectorBufferTemplate<IntType> >(mSplitSelectorBuffers.mIndicesBufferId);
 
-    const MatrixBufferTemplate<FloatType>& featureValuesMatrix
+    const MatrixBufferTemplate<FloatType>& featureValues
           = mReadCollection.GetBuffer< MatrixBufferTemplate<FloatType> >(mSplitSelectorBuffers.mFeatureValuesBufferId);
 
     const MatrixBufferTemplate<FloatType>& splitpoints
           = mReadCollection.GetBuffer< MatrixBufferTemplate<FloatType> >(mSplitSelectorBuffers.mSplitpointsBufferId);
 
     const FloatType bestSplitpointValue = splitpoints.Get(mBestFeature, mBestSplitpoint);
-    VectorBufferTemplate<FloatType> featureValues;
-    if( mSplitSelectorBuffers.mOrdering == FEATURES_BY_DATAPOINTS )
+    const FeatureValueOrdering ordering = ResolveFeatureValueOrdering(mSplitSelectorBuffers.mOrdering, mReadCollection,
+                                                                      mSplitSelectorBuffers.mFeatureValuesBufferId);
+    const bool byDatapoints = (ordering == FEATURES_BY_DATAPOINTS);
+    const IntType numberOfIndices = indices.GetN();
+    ASSERT_ARG_DIM_1D(byDatapoints ? featureValues.GetN() : featureValues.GetM(), numberOfIndices)
+
+    if( permutation.empty() )
     {
-        featureValues = featureValuesMatrix.SliceRowAsVector(mBestFeature);
+        permutation.resize(begin + numberOfIndices);
     }
-    else if ( mSplitSelectorBuffers.mOrdering == DATAPOINTS_BY_FEATURES )
+    ASSERT(static_cast<IntType>(permutation.size()) >= begin + numberOfIndices)
+
+    // The indices buffer is a copy of the range so it can be overwritten
+    // without a temporary.  Left indices are counted first so both children
+    // keep the order of the parent.
+    IntType numberOfLeftIndices = 0;
+    for(IntType i=0; i<numberOfIndices; i++)
     {
-        featureValues = featureValuesMatrix.SliceColumnAsVector(mBestFeature);
+        const FloatType featureValue = byDatapoints ? featureValues.Get(mBestFeature, i) : featureValues.Get(i, mBestFeature);
+        if( featureValue > bestSplitpointValue )
+        {
+            numberOfLeftIndices++;
+        }
     }
-    ASSERT_ARG_DIM_1D(featureValues.GetN(), indices.GetN())
 
-    std::vector<IntType> leftIndices;
-    std::vector<IntType> rightIndices;
-    for(int i=0; i<indices.GetN(); i++)
+    split = begin + numberOfLeftIndices;
+    end = begin + numberOfIndices;
+    IntType left = begin;
+    IntType right = split;
+    for(IntType i=0; i<numberOfIndices; i++)
     {
-        const FloatType featureValue = featureValues.Get(i);
-        const IntType index = indices.Get(i);
+        const FloatType featureValue = byDatapoints ? featureValues.Get(mBestFeature, i) : featureValues.Get(i, mBestFeature);
         if( featureValue > bestSplitpointValue )
         {
-            leftIndices.push_back(index);
+            permutation[left++] = indices.Get(i);
         }
         else
         {
-            rightIndices.push_back(index);
+            permutation[right++] = indices.Get(i);
         }
     }
-    VectorBufferTemplate<IntType> leftIndicesBuf(&leftIndices[0], leftIndices.size());
-    leftIndicesBufCol.AddBuffer< VectorBufferTemplate<IntType> >(mSplitSelectorBuffers.mIndicesBufferId, leftIndicesBuf );
-
-    VectorBufferTemplate<IntType> rightIndicesBuf(&rightIndices[0], rightIndices.size());
-    rightIndicesBufCol.AddBuffer< VectorBufferTemplate<IntType> >(mSplitSelectorBuffers.mIndicesBufferId, rightIndicesBuf );
 
     const Tensor3BufferTemplate<FloatType>& childCounts
            = mReadCollection.GetBuffer< Tensor3BufferTemplate<FloatType> >(mSplitSelectorBuffers.mChildCountsBufferId);
-           
+
     leftSize = childCounts.Get(mBestFeature, mBestSplitpoint, LEFT_CHILD_INDEX);
-    rightSize = childCounts.Get(mBestFeature, mBestSplitpoint, RIGHT_CHILD_INDEX); 
-}
\ No newline at end of file
+    rightSize = childCounts.Get(mBestFeature, mBestSplitpoint, RIGHT_CHILD_INDEX);
+}
+
+template <class FloatType, class IntType>
+const BufferId& SplitSelectorInfo<FloatType, IntType>::GetIndicesBufferId() const
+{
+    return mSplitSelectorBuffers.mIndicesBufferId;
+}
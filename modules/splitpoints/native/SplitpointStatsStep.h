@@ -30,6 +30,9 @@ public:
                                 BufferCollection& writeCollection,
                                 boost::mt19937& gen) const;
 
+    // The y of a datapoint is applied to all features together
+    static FeatureValueOrdering GetPreferredFeatureValueOrdering();
+
     const BufferId ChildCountsBufferId;
     const BufferId LeftStatsBufferId;
     const BufferId RightStatsBufferId;
@@ -66,6 +69,12 @@ PipelineStepI* SplitpointStatsStep<StatsUpdater>::Clone() const
     return clone;
 }
 
+template <class StatsUpdater>
+FeatureValueOrdering SplitpointStatsStep<StatsUpdater>::GetPreferredFeatureValueOrdering()
+{
+    return DATAPOINTS_BY_FEATURES;
+}
+
 template <class StatsUpdater>
 void SplitpointStatsStep<StatsUpdater>::ProcessStep(const BufferCollectionStack& readCollection,
                                                         BufferCollection& writeCollection,
@@ -83,6 +92,7 @@ void SplitpointStatsStep<StatsUpdater>::ProcessStep(const BufferCollectionStack&
 
     const MatrixBufferTemplate<typename StatsUpdater::Float>& featureValues =
           readCollection.GetBuffer< MatrixBufferTemplate<typename StatsUpdater::Float> >(mFeatureValuesBufferId);
+    const FeatureValueOrdering ordering = ResolveFeatureValueOrdering(mFeatureValueOrdering, readCollection, mFeatureValuesBufferId);
 
     Tensor3BufferTemplate<typename StatsUpdater::Float>& childCounts =
           writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<typename StatsUpdater::Float> >(ChildCountsBufferId);
@@ -101,8 +111,8 @@ void SplitpointStatsStep<StatsUpdater>::ProcessStep(const BufferCollectionStack&
         for(int r=0; r<featureValues.GetN(); r++)
         {
             const typename StatsUpdater::Float featureValue = featureValues.Get(c,r);
-            const int feature = mFeatureValueOrdering == FEATURES_BY_DATAPOINTS ? c : r;
-            const int sample = mFeatureValueOrdering == FEATURES_BY_DATAPOINTS ? r : c;
+            const int feature = ordering == FEATURES_BY_DATAPOINTS ? c : r;
+            const int sample = ordering == FEATURES_BY_DATAPOINTS ? r : c;
 
             for(int splitpoint=0; splitpoint<splitpointsCounts.Get(feature); splitpoint++)
             {
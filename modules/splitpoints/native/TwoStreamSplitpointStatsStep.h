@@ -33,6 +33,9 @@ public:
                                 BufferCollection& writeCollection,
                                 boost::mt19937& gen) const;
 
+    // The y and stream of a datapoint are applied to all features together
+    static FeatureValueOrdering GetPreferredFeatureValueOrdering();
+
     const BufferId ChildCountsImpurityBufferId;
     const BufferId LeftImpurityStatsBufferId;
     const BufferId RightImpurityStatsBufferId;
@@ -79,6 +82,12 @@ PipelineStepI* TwoStreamSplitpointStatsStep<StatsUpdater>::Clone() const
     return clone;
 }
 
+template <class StatsUpdater>
+FeatureValueOrdering TwoStreamSplitpointStatsStep<StatsUpdater>::GetPreferredFeatureValueOrdering()
+{
+    return DATAPOINTS_BY_FEATURES;
+}
+
 template <class StatsUpdater>
 void TwoStreamSplitpointStatsStep<StatsUpdater>::ProcessStep(const BufferCollectionStack& readCollection,
                                                         BufferCollection& writeCollection,
@@ -99,6 +108,7 @@ void TwoStreamSplitpointStatsStep<StatsUpdater>::ProcessStep(const BufferCollect
 
     const MatrixBufferTemplate<typename StatsUpdater::Float>& featureValues =
           readCollection.GetBuffer< MatrixBufferTemplate<typename StatsUpdater::Float> >(mFeatureValuesBufferId);
+    const FeatureValueOrdering ordering = ResolveFeatureValueOrdering(mFeatureValueOrdering, readCollection, mFeatureValuesBufferId);
 
     Tensor3BufferTemplate<typename StatsUpdater::Float>& childCountsImpurity =
           writeCollection.GetOrAddBuffer< Tensor3BufferTemplate<typename StatsUpdater::Float> >(ChildCountsImpurityBufferId);
@@ -129,8 +139,8 @@ void TwoStreamSplitpointStatsStep<StatsUpdater>::ProcessStep(const BufferCollect
         for(int r=0; r<featureValues.GetN(); r++)
         {
             const typename StatsUpdater::Float featureValue = featureValues.Get(c,r);
-            const int feature = mFeatureValueOrdering == FEATURES_BY_DATAPOINTS ? c : r;
-            const int sample = mFeatureValueOrdering == FEATURES_BY_DATAPOINTS ? r : c;
+            const int feature = ordering == FEATURES_BY_DATAPOINTS ? c : r;
+            const int sample = ordering == FEATURES_BY_DATAPOINTS ? r : c;
             const int streamType = streamTypes.Get(sample);
 
             for(int splitpoint=0; splitpoint<splitpointsCounts.Get(feature); splitpoint++)
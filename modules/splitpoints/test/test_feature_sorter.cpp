@@ -6,6 +6,12 @@
 #include "BufferCollectionStack.h"
 #include "FeatureSorter.h"
 
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <boost/random.hpp>
+
 BOOST_AUTO_TEST_SUITE( FeatureSorterTests )
 
 template<typename T>
@@ -73,4 +79,63 @@ BOOST_AUTO_TEST_CASE(test_Feature_Sorter_GetUnSortedIndex_DATAPOINTS_BY_FEATURES
     BOOST_CHECK_EQUAL(fs.GetFeatureValue(2), 8.9);
 }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+// Sorting value, index pairs is the reference order (ties in index order)
+template<typename T>
+void CheckMatchesPairSort(int numberOfSamples, unsigned int seed)
+{
+    boost::mt19937 gen(seed);
+    boost::uniform_int<> valueDist(-50, 50);
+    MatrixBufferTemplate<T> mb(1, numberOfSamples);
+    std::vector< std::pair<T, int> > expected(numberOfSamples);
+    for(int s=0; s<numberOfSamples; s++)
+    {
+        // Repeated values, negatives and -0
+        const int v = valueDist(gen);
+        const T value = (v == 50) ? -T(0) : T(v) * T(0.37);
+        mb.Set(0, s, value);
+        expected[s] = std::pair<T, int>(value, s);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    FeatureSorter<T> fs(mb, FEATURES_BY_DATAPOINTS, 0);
+    fs.Sort();
+    BOOST_CHECK_EQUAL(fs.GetNumberOfSamples(), numberOfSamples);
+    for(int s=0; s<numberOfSamples; s++)
+    {
+        BOOST_CHECK_EQUAL(fs.GetFeatureValue(s), expected[s].first);
+    }
+    for(int s=1; s<numberOfSamples; s++)
+    {
+        // Equal values (including -0 and 0) stay in index order
+        if( fs.GetFeatureValue(s-1) == fs.GetFeatureValue(s) )
+        {
+            BOOST_CHECK(fs.GetUnSortedIndex(s-1) < fs.GetUnSortedIndex(s));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_Feature_Sorter_insertion_sort_matches_pair_sort)
+{
+    CheckMatchesPairSort<float>(FeatureSorter<float>::INSERTION_SORT_MAX_SIZE, 0);
+    CheckMatchesPairSort<double>(7, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_Feature_Sorter_radix_sort_matches_pair_sort)
+{
+    CheckMatchesPairSort<float>(FeatureSorter<float>::INSERTION_SORT_MAX_SIZE+1, 2);
+    CheckMatchesPairSort<float>(5000, 3);
+    CheckMatchesPairSort<double>(5000, 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_ToRadixSortKey_order)
+{
+    const float values[] = {-std::numeric_limits<float>::max(), -2.5f, -1e-30f, 0.0f, 1e-30f, 1.0f, 3.5f, std::numeric_limits<float>::max()};
+    for(int i=1; i<8; i++)
+    {
+        BOOST_CHECK(ToRadixSortKey(values[i-1]) < ToRadixSortKey(values[i]));
+    }
+    BOOST_CHECK_EQUAL(ToRadixSortKey(-0.0f), ToRadixSortKey(0.0f));
+    BOOST_CHECK_EQUAL(ToRadixSortKey(-0.0), ToRadixSortKey(0.0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
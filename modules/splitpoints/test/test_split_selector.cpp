@@ -348,7 +348,7 @@ BOOST_AUTO_TEST_CASE(test_ProcessSplit_two_SplitSelectorBuffers)
     BOOST_CHECK( estimatorParams.SliceRowAsVector(rightNodeId) == right.SliceRow(bestFeature, bestSplitpoint).Normalized());
 }
 
-BOOST_AUTO_TEST_CASE(test_SplitIndices_FEATURES_BY_DATAPOINTS)
+BOOST_AUTO_TEST_CASE(test_PartitionIndices_FEATURES_BY_DATAPOINTS)
 {
     SplitSelectorBuffers buffers(im_key, splitpoints_key, number_splitpoints_key, childcounts_key,
                               left_key, right_key, feature_floatparams_key, feature_intparams_key,
@@ -364,21 +364,21 @@ BOOST_AUTO_TEST_CASE(test_SplitIndices_FEATURES_BY_DATAPOINTS)
     SplitSelectorInfo<double, int> selectorInfo = splitselector.ProcessSplits(stack, depth);
     BOOST_CHECK( selectorInfo.ValidSplit() );
 
-    BufferCollection leftBufCol;
-    BufferCollection rightBufCol;
+    // Partition a range in the middle of the permutation
+    std::vector<int> permutation(9, -1);
+    int split, end;
     double leftSize, rightSize;
-    selectorInfo.SplitIndices(leftBufCol, rightBufCol, leftSize, rightSize);
+    selectorInfo.PartitionIndices(permutation, 2, split, end, leftSize, rightSize);
     BOOST_CHECK_CLOSE(leftSize, 11.0, 0.1);
     BOOST_CHECK_CLOSE(rightSize, 12.0, 0.1);
+    BOOST_CHECK_EQUAL(split, 4);
+    BOOST_CHECK_EQUAL(end, 7);
 
-    int leftExpectedIndexData[] = {0, 4};
-    int rightExpectedIndexData[] = {1, 2, 3};
-
-    BOOST_CHECK(leftBufCol.GetBuffer< VectorBufferTemplate<int> >(indices_key) == CreateVector<int>(leftExpectedIndexData, 2));
-    BOOST_CHECK(rightBufCol.GetBuffer< VectorBufferTemplate<int> >(indices_key) == CreateVector<int>(rightExpectedIndexData, 3));
+    int expectedPermutation[] = {-1, -1, 0, 4, 1, 2, 3, -1, -1};
+    BOOST_CHECK(permutation == std::vector<int>(&expectedPermutation[0], &expectedPermutation[0]+9));
 }
 
-BOOST_AUTO_TEST_CASE(test_SplitIndices_DATAPOINTS_BY_FEATURES)
+BOOST_AUTO_TEST_CASE(test_PartitionIndices_DATAPOINTS_BY_FEATURES)
 {
     MatrixBufferTemplate<double>& fv = collection.GetBuffer< MatrixBufferTemplate<double> >(feature_values_key);
     fv = fv.Transpose();
@@ -397,18 +397,18 @@ BOOST_AUTO_TEST_CASE(test_SplitIndices_DATAPOINTS_BY_FEATURES)
     SplitSelectorInfo<double, int> selectorInfo = splitselector.ProcessSplits(stack, depth);
     BOOST_CHECK( selectorInfo.ValidSplit() );
 
-    BufferCollection leftBufCol;
-    BufferCollection rightBufCol;
+    // The root sizes an empty permutation
+    std::vector<int> permutation;
+    int split, end;
     double leftSize, rightSize;
-    selectorInfo.SplitIndices(leftBufCol, rightBufCol, leftSize, rightSize);
+    selectorInfo.PartitionIndices(permutation, 0, split, end, leftSize, rightSize);
     BOOST_CHECK_CLOSE(leftSize, 11.0, 0.1);
     BOOST_CHECK_CLOSE(rightSize, 12.0, 0.1);
+    BOOST_CHECK_EQUAL(split, 2);
+    BOOST_CHECK_EQUAL(end, 5);
 
-    int leftExpectedIndexData[] = {0, 4};
-    int rightExpectedIndexData[] = {1, 2, 3};
-
-    BOOST_CHECK(leftBufCol.GetBuffer< VectorBufferTemplate<int> >(indices_key) == CreateVector<int>(leftExpectedIndexData, 2));
-    BOOST_CHECK(rightBufCol.GetBuffer< VectorBufferTemplate<int> >(indices_key) == CreateVector<int>(rightExpectedIndexData, 3));
+    int expectedPermutation[] = {0, 4, 1, 2, 3};
+    BOOST_CHECK(permutation == std::vector<int>(&expectedPermutation[0], &expectedPermutation[0]+5));
 }
 
 
@@ -8,6 +8,8 @@
 #include "UniqueBufferId.h"
 #include "SplitpointStatsStep.h"
 #include "ClassStatsUpdater.h"
+#include "BestSplitpointsWalkingSortedStep.h"
+#include "TestBufferWalker.h"
 
 BOOST_AUTO_TEST_SUITE(SplitpointStatsStepTest)
 
@@ -80,4 +82,17 @@ BOOST_AUTO_TEST_CASE(test_ProcessStep_FEATURES_BY_DATAPOINTS)
     BOOST_CHECK_CLOSE(rightStats.Get(1,1,2), 0.5, 0.1);
 }
 
+BOOST_AUTO_TEST_CASE(test_preferred_ordering_differs_from_walker)
+{
+    const FeatureValueOrdering statsOrdering = SplitpointStatsStep< ClassStatsUpdater<float, int> >::GetPreferredFeatureValueOrdering();
+    const FeatureValueOrdering walkerOrdering = BestSplitpointsWalkingSortedStep< TestBufferWalker<float, int> >::GetPreferredFeatureValueOrdering();
+    BOOST_CHECK_EQUAL(statsOrdering, DATAPOINTS_BY_FEATURES);
+    BOOST_CHECK_EQUAL(walkerOrdering, FEATURES_BY_DATAPOINTS);
+
+    // Large nodes follow the consumer and small nodes fit in L1 either way
+    BOOST_CHECK_EQUAL(SelectFeatureValueOrdering(37, 150, statsOrdering), DATAPOINTS_BY_FEATURES);
+    BOOST_CHECK_EQUAL(SelectFeatureValueOrdering(37, 150, walkerOrdering), FEATURES_BY_DATAPOINTS);
+    BOOST_CHECK_EQUAL(SelectFeatureValueOrdering(3, 5, walkerOrdering), DATAPOINTS_BY_FEATURES);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
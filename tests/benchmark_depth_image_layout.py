@@ -0,0 +1,84 @@
+'''
+Compares training and per-frame prediction throughput of depth delta forests
+with row-major depth images against the tiled depth image layout.
+
+    > python tests/benchmark_depth_image_layout.py
+'''
+import time
+import numpy as np
+
+import rftk.buffers as buffers
+import rftk.learn as learn
+
+
+def make_depth_frames(number_of_frames, m, n, seed=0):
+    rng = np.random.RandomState(seed)
+    depths = np.zeros((number_of_frames, m, n), dtype=np.float32)
+    classes = np.zeros((number_of_frames, m, n), dtype=np.int32)
+    for f in range(number_of_frames):
+        # background wall with a few blobs in front of it
+        depths[f,:,:] = 4.0
+        for blob in range(4):
+            cm, cn = rng.randint(0, m), rng.randint(0, n)
+            radius = rng.randint(m/10, m/4)
+            mm, nn = np.ogrid[:m,:n]
+            mask = (mm-cm)**2 + (nn-cn)**2 < radius**2
+            depths[f][mask] = 1.0 + blob * 0.5
+            classes[f][mask] = blob + 1
+    return depths, classes
+
+
+def sample_pixels(depths, classes, pixels_per_frame, seed=0):
+    rng = np.random.RandomState(seed)
+    number_of_frames, m, n = depths.shape
+    pixel_indices = np.zeros((number_of_frames*pixels_per_frame, 3), dtype=np.int32)
+    pixel_indices[:,0] = np.repeat(np.arange(number_of_frames), pixels_per_frame)
+    pixel_indices[:,1] = rng.randint(0, m, number_of_frames*pixels_per_frame)
+    pixel_indices[:,2] = rng.randint(0, n, number_of_frames*pixels_per_frame)
+    pixel_classes = classes[pixel_indices[:,0], pixel_indices[:,1], pixel_indices[:,2]]
+    return pixel_indices, pixel_classes
+
+
+def all_pixels(frame_id, m, n):
+    mm, nn = np.mgrid[:m,:n]
+    pixel_indices = np.zeros((m*n, 3), dtype=np.int32)
+    pixel_indices[:,0] = frame_id
+    pixel_indices[:,1] = mm.ravel()
+    pixel_indices[:,2] = nn.ravel()
+    return pixel_indices
+
+
+def benchmark(depth_layout, create_predictor, depths, pixel_indices, pixel_classes, test_depths):
+    learner = learn.create_scaled_depth_delta_learner_32f(ux=75.0, uy=75.0, vx=75.0, vy=75.0,
+                                                          number_of_trees=3,
+                                                          number_of_features=200,
+                                                          max_depth=12,
+                                                          classes=buffers.as_vector_buffer(pixel_classes),
+                                                          depth_layout=depth_layout)
+    data = learn.depth_delta_classification_data_prepare(depth_images=buffers.as_tensor_buffer(depths),
+                                                         pixel_indices=buffers.as_matrix_buffer(pixel_indices),
+                                                         classes=buffers.as_vector_buffer(pixel_classes))
+    start = time.time()
+    forest = learner.Learn(data)
+    train_seconds = time.time() - start
+
+    predictor = create_predictor(forest)
+    number_of_test_frames, m, n = test_depths.shape
+    start = time.time()
+    for f in range(number_of_test_frames):
+        predictor.predict(depth_images=buffers.as_tensor_buffer(test_depths[f:f+1]),
+                          pixel_indices=all_pixels(0, m, n))
+    frame_seconds = (time.time() - start) / number_of_test_frames
+
+    print '%-10s train %8.0f pixels/s   predict %6.2f frames/s' % (depth_layout,
+                                                                   pixel_indices.shape[0] / train_seconds,
+                                                                   1.0 / frame_seconds)
+
+
+if __name__ == '__main__':
+    depths, classes = make_depth_frames(20, 240, 320, seed=0)
+    pixel_indices, pixel_classes = sample_pixels(depths, classes, 2000, seed=1)
+    test_depths, _ = make_depth_frames(5, 240, 320, seed=2)
+
+    benchmark('row_major', learn.create_depth_delta_predictor_32f, depths, pixel_indices, pixel_classes, test_depths)
+    benchmark('tiled', learn.create_tiled_depth_delta_predictor_32f, depths, pixel_indices, pixel_classes, test_depths)